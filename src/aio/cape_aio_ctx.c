@@ -5,6 +5,8 @@
 #include "sys/cape_err.h"
 #include "stc/cape_list.h"
 #include "sys/cape_log.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_mutex.h"
 
 //*****************************************************************************
 
@@ -18,12 +20,14 @@
 
 #include <sys/epoll.h>
 #include <sys/signalfd.h>
+#include <sys/eventfd.h>
 
 #define CAPE_AIO_EPOLL_MAXEVENTS 1
 
 #endif
 
 #include <pthread.h>
+#include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -105,7 +109,23 @@ struct CapeAioContext_s
   
   CapeList events;      // store all events into this list (used only for destruction)
   
-  pthread_mutex_t mutex;
+  CapeMutexInline mutex;
+  
+  int pin_mode;         // placement of the reactor thread
+  
+  number_t pin_index;
+  
+  // posts from other threads
+  
+  CapeMutexInline post_mutex;
+  
+  CapeAioPost* post_head;
+  
+  CapeAioPost* post_tail;
+  
+  int post_fd[2];       // eventfd on linux (only first), pipe on BSD
+  
+  int post_active;
 };
 
 //-----------------------------------------------------------------------------
@@ -145,9 +165,7 @@ CapeAioContext cape_aio_context_new (void)
 {
   CapeAioContext self = CAPE_NEW (struct CapeAioContext_s);
   
-  memset (&(self->mutex), 0, sizeof(pthread_mutex_t));
-  
-  pthread_mutex_init (&(self->mutex), NULL);
+  cape_mutex_init (&(self->mutex), 0);
   
 #if defined __BSD_OS
 
@@ -171,6 +189,19 @@ CapeAioContext cape_aio_context_new (void)
     
   self->events = cape_list_new (cape_aio_context_events_onDestroy);
   
+  self->pin_mode = CAPE_THREAD_PIN_NONE;
+  self->pin_index = 0;
+  
+  cape_mutex_init (&(self->post_mutex), 0);
+  
+  self->post_head = NULL;
+  self->post_tail = NULL;
+  
+  self->post_fd[0] = -1;
+  self->post_fd[1] = -1;
+  
+  self->post_active = FALSE;
+  
   return self;
 }
 
@@ -200,14 +231,14 @@ void cape_aio_context_closeAll (CapeAioContext self)
   
   cape_log_msg (CAPE_LL_TRACE, "CAPE", "aio close", "start closing all handles");
 
-  pthread_mutex_lock(&(self->mutex));
+  cape_mutex_lock (&(self->mutex));
   
   if (self->events)
   {
     cape_list_del (&(self->events));
   }
   
-  pthread_mutex_unlock(&(self->mutex));
+  cape_mutex_unlock (&(self->mutex));
   
   cape_log_msg (CAPE_LL_TRACE, "CAPE", "aio close", "all handles were closed");
 }
@@ -222,7 +253,9 @@ void cape_aio_context_del (CapeAioContext* p_self)
     
     cape_aio_context_closeAll (self);
     
-    pthread_mutex_destroy (&(self->mutex));
+    cape_mutex_done (&(self->mutex));
+    
+    cape_mutex_done (&(self->post_mutex));
     
     CAPE_DEL (p_self, struct CapeAioContext_s);
   }
@@ -230,6 +263,182 @@ void cape_aio_context_del (CapeAioContext* p_self)
 
 //-----------------------------------------------------------------------------
 
+static void cape_aio_context__post_signal (CapeAioContext self)
+{
+#if defined __BSD_OS
+  
+  char c = 0;
+  
+  if (write (self->post_fd[1], &c, 1) == -1)
+  {
+    // the pipe is full, the reactor will wake up anyway
+  }
+
+#else
+  
+  eventfd_write (self->post_fd[0], 1);
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL cape_aio_context__post_on_event (void* ptr, int hflags, unsigned long events, unsigned long param1)
+{
+  CapeAioContext self = ptr;
+  CapeAioPost* post;
+  
+  // reset the wakeup signal
+#if defined __BSD_OS
+  
+  {
+    char buf[64];
+    
+    while (read (self->post_fd[0], buf, 64) > 0);
+  }
+
+#else
+  
+  {
+    eventfd_t value;
+    
+    eventfd_read (self->post_fd[0], &value);
+  }
+
+#endif
+  
+  // take all posts at once
+  cape_mutex_lock (&(self->post_mutex));
+  
+  post = self->post_head;
+  
+  self->post_head = NULL;
+  self->post_tail = NULL;
+  
+  cape_mutex_unlock (&(self->post_mutex));
+  
+  while (post)
+  {
+    // the callback might reuse the post struct
+    CapeAioPost* next = post->next;
+    
+    post->next = NULL;
+    
+    post->on_post (post->ptr);
+    
+    post = next;
+  }
+  
+  return CAPE_AIO_READ;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_context__post_on_unref (void* ptr, CapeAioHandle aioh, int force_close)
+{
+  CapeAioContext self = ptr;
+  
+  cape_mutex_lock (&(self->post_mutex));
+  
+  self->post_active = FALSE;
+  
+  cape_mutex_unlock (&(self->post_mutex));
+  
+  close (self->post_fd[0]);
+  
+  if (self->post_fd[1] != -1)
+  {
+    close (self->post_fd[1]);
+  }
+  
+  self->post_fd[0] = -1;
+  self->post_fd[1] = -1;
+  
+  cape_aio_handle_del (&aioh);
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_aio_context__post_open (CapeAioContext self, CapeErr err)
+{
+  CapeAioHandle aioh;
+
+#if defined __BSD_OS
+  
+  if (pipe (self->post_fd) == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+  
+  fcntl (self->post_fd[0], F_SETFL, fcntl (self->post_fd[0], F_GETFL, 0) | O_NONBLOCK);
+  fcntl (self->post_fd[1], F_SETFL, fcntl (self->post_fd[1], F_GETFL, 0) | O_NONBLOCK);
+
+#else
+  
+  self->post_fd[0] = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  
+  if (self->post_fd[0] == -1)
+  {
+    return cape_err_lastOSError (err);
+  }
+
+#endif
+  
+  aioh = cape_aio_handle_new (CAPE_AIO_READ, self, cape_aio_context__post_on_event, cape_aio_context__post_on_unref);
+  
+  if (!cape_aio_context_add (self, aioh, (void*)(number_t)self->post_fd[0], 0))
+  {
+    return cape_err_set (err, CAPE_ERR_OS, "can't register the post handle");
+  }
+  
+  self->post_active = TRUE;
+  
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_context_post (CapeAioContext self, CapeAioPost* post)
+{
+  int was_empty;
+  
+  post->next = NULL;
+  
+  cape_mutex_lock (&(self->post_mutex));
+  
+  if (!self->post_active)
+  {
+    cape_mutex_unlock (&(self->post_mutex));
+    
+    return FALSE;
+  }
+  
+  was_empty = (self->post_head == NULL);
+  
+  if (self->post_tail)
+  {
+    self->post_tail->next = post;
+  }
+  else
+  {
+    self->post_head = post;
+  }
+  
+  self->post_tail = post;
+  
+  cape_mutex_unlock (&(self->post_mutex));
+  
+  // only the first post needs to wake up the reactor
+  if (was_empty)
+  {
+    cape_aio_context__post_signal (self);
+  }
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
 int cape_aio_context_open (CapeAioContext self, CapeErr err)
 {
 #if defined __BSD_OS
@@ -256,7 +465,7 @@ int cape_aio_context_open (CapeAioContext self, CapeErr err)
 
 #endif
   
-  return CAPE_ERR_NONE;
+  return cape_aio_context__post_open (self, err);
 }
 
 //-----------------------------------------------------------------------------
@@ -278,8 +487,36 @@ int cape_aio_context_close (CapeAioContext self, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
+void cape_aio_context_pin (CapeAioContext self, int pin_mode, number_t index)
+{
+  self->pin_mode = pin_mode;
+  self->pin_index = index;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_context__pin_reactor (CapeAioContext self)
+{
+  if (self->pin_mode != CAPE_THREAD_PIN_NONE)
+  {
+    CapeErr err = cape_err_new ();
+    
+    if (cape_thread_pin_self (self->pin_mode, self->pin_index, err))
+    {
+      cape_log_fmt (CAPE_LL_WARN, "CAPE", "aio wait", "can't pin reactor thread: %s", cape_err_text (err));
+    }
+    
+    cape_err_del (&err);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 int cape_aio_context_wait (CapeAioContext self, CapeErr err)
 {
+  // the calling thread becomes the reactor
+  cape_aio_context__pin_reactor (self);
+  
   while (cape_aio_context_next (self, -1, err) == CAPE_ERR_NONE);
   
   return CAPE_ERR_NONE;
@@ -292,7 +529,7 @@ void cape_aio_remove_handle (CapeAioContext self, CapeAioHandle hobj)
   void* ptr = NULL;
   
   // enter monitor
-  pthread_mutex_lock (&(self->mutex));
+  cape_mutex_lock (&(self->mutex));
   
   // try to find the handle (expensive)
   // TODO: we might want to use a map for storing the handles
@@ -317,7 +554,7 @@ void cape_aio_remove_handle (CapeAioContext self, CapeAioHandle hobj)
 exit_and_unlock:
   
   // leave monitor
-  pthread_mutex_unlock (&(self->mutex));
+  cape_mutex_unlock (&(self->mutex));
   
   if (ptr)
   {
@@ -820,11 +1057,11 @@ int cape_aio_context_add (CapeAioContext self, CapeAioHandle aioh, void* handle,
   
 #endif
 
-  pthread_mutex_lock (&(self->mutex));
+  cape_mutex_lock (&(self->mutex));
   
   cape_list_push_back (self->events, aioh);
   
-  pthread_mutex_unlock (&(self->mutex));
+  cape_mutex_unlock (&(self->mutex));
 
   return TRUE;
 }
@@ -1086,7 +1323,21 @@ struct CapeAioContext_s
   
   CapeList events;      // store all events into this list (used only for destruction)
   
-  CRITICAL_SECTION* mutex;
+  CapeMutexInline mutex;
+  
+  int pin_mode;         // placement of the reactor thread
+  
+  number_t pin_index;
+  
+  // posts from other threads
+  
+  CapeMutexInline post_mutex;
+  
+  CapeAioPost* post_head;
+  
+  CapeAioPost* post_tail;
+  
+  CapeAioHandle post_aioh;
 };
 
 //-----------------------------------------------------------------------------
@@ -1105,9 +1356,16 @@ CapeAioContext cape_aio_context_new (void)
   self->port = NULL;
   self->events = cape_list_new (cape_aio_context__events_on_item_del);
   
-  self->mutex = CAPE_NEW (CRITICAL_SECTION);
+  cape_mutex_init (&(self->mutex), 0);
+  
+  self->pin_mode = CAPE_THREAD_PIN_NONE;
+  self->pin_index = 0;
   
-  InitializeCriticalSection (self->mutex);
+  cape_mutex_init (&(self->post_mutex), 0);
+  
+  self->post_head = NULL;
+  self->post_tail = NULL;
+  self->post_aioh = NULL;
   
   return self;
 }
@@ -1120,16 +1378,52 @@ void cape_aio_context_del (CapeAioContext* p_self)
   {
     CapeAioContext self = *p_self;
     
-    DeleteCriticalSection (self->mutex);
+    cape_mutex_done (&(self->mutex));
 
     cape_list_del (&(self->events));
     
+    cape_mutex_done (&(self->post_mutex));
+    
+    cape_aio_handle_del (&(self->post_aioh));
+    
     CAPE_DEL(p_self, struct CapeAioContext_s);
   }
 }
 
 //-----------------------------------------------------------------------------
 
+static int __STDCALL cape_aio_context__post_on_event (void* ptr, int hflags, unsigned long events, unsigned long param1)
+{
+  CapeAioContext self = ptr;
+  CapeAioPost* post;
+  
+  // take all posts at once
+  cape_mutex_lock (&(self->post_mutex));
+  
+  post = self->post_head;
+  
+  self->post_head = NULL;
+  self->post_tail = NULL;
+  
+  cape_mutex_unlock (&(self->post_mutex));
+  
+  while (post)
+  {
+    // the callback might reuse the post struct
+    CapeAioPost* next = post->next;
+    
+    post->next = NULL;
+    
+    post->on_post (post->ptr);
+    
+    post = next;
+  }
+  
+  return CAPE_AIO_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 int cape_aio_context_open (CapeAioContext self, CapeErr err)
 {
   // initialize windows io completion port
@@ -1139,11 +1433,52 @@ int cape_aio_context_open (CapeAioContext self, CapeErr err)
     return cape_err_lastOSError (err);
   }
 
+  self->post_aioh = cape_aio_handle_new (0, self, cape_aio_context__post_on_event, NULL);
+  
   return CAPE_ERR_NONE;
 }
 
 //-----------------------------------------------------------------------------
 
+int cape_aio_context_post (CapeAioContext self, CapeAioPost* post)
+{
+  int was_empty;
+  
+  if (self->post_aioh == NULL)
+  {
+    return FALSE;
+  }
+  
+  post->next = NULL;
+  
+  cape_mutex_lock (&(self->post_mutex));
+  
+  was_empty = (self->post_head == NULL);
+  
+  if (self->post_tail)
+  {
+    self->post_tail->next = post;
+  }
+  else
+  {
+    self->post_head = post;
+  }
+  
+  self->post_tail = post;
+  
+  cape_mutex_unlock (&(self->post_mutex));
+  
+  // only the first post needs to wake up the reactor
+  if (was_empty)
+  {
+    PostQueuedCompletionStatus (self->port, 0, (ULONG_PTR)NULL, (LPOVERLAPPED)self->post_aioh);
+  }
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
 static int __STDCALL cape_aio_context_close__on_event (void* ptr, int hflags, unsigned long events, unsigned long extra)
 {
   return CAPE_AIO_ABORT;
@@ -1166,8 +1501,36 @@ int cape_aio_context_close (CapeAioContext self, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
+void cape_aio_context_pin (CapeAioContext self, int pin_mode, number_t index)
+{
+  self->pin_mode = pin_mode;
+  self->pin_index = index;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_context__pin_reactor (CapeAioContext self)
+{
+  if (self->pin_mode != CAPE_THREAD_PIN_NONE)
+  {
+    CapeErr err = cape_err_new ();
+    
+    if (cape_thread_pin_self (self->pin_mode, self->pin_index, err))
+    {
+      cape_log_fmt (CAPE_LL_WARN, "CAPE", "aio wait", "can't pin reactor thread: %s", cape_err_text (err));
+    }
+    
+    cape_err_del (&err);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 int cape_aio_context_wait (CapeAioContext self, CapeErr err)
 {
+  // the calling thread becomes the reactor
+  cape_aio_context__pin_reactor (self);
+  
   while (cape_aio_context_next (self, -1, err) == CAPE_ERR_NONE);
   
   return CAPE_ERR_NONE;
@@ -1301,11 +1664,11 @@ int cape_aio_context_add (CapeAioContext self, CapeAioHandle aioh, void* handle,
     return FALSE;
   }
   
-  EnterCriticalSection (self->mutex);
+  cape_mutex_lock (&(self->mutex));
   
   cape_list_push_back (self->events, aioh);
   
-  LeaveCriticalSection (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
   return TRUE;
 }
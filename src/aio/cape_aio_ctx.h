@@ -64,6 +64,29 @@ __CAPE_LIBEX   void              cape_aio_context_mod           (CapeAioContext,
                // add handle for a signals to return a specific status
 __CAPE_LIBEX   int               cape_aio_context_set_interupts (CapeAioContext, int sigint, int term, CapeErr);
 
+//-----------------------------------------------------------------------------
+
+typedef void               (__STDCALL *fct_cape_aio_onPost)    (void* ptr);
+
+typedef struct CapeAioPost_s
+{
+  struct CapeAioPost_s* next;   // for internal use (don't change it)
+  
+  void* ptr;
+  
+  fct_cape_aio_onPost on_post;
+  
+} CapeAioPost;
+
+               // hands over a callback to the reactor thread, can be called from any thread
+               // -> the post struct is not copied, it must stay valid until the callback was called
+               // -> the context must be opened, returns FALSE otherwise
+__CAPE_LIBEX   int               cape_aio_context_post          (CapeAioContext, CapeAioPost*);
+
+               // pins the reactor thread (the thread calling cape_aio_context_wait) with one of the CAPE_THREAD_PIN_* modes
+               // -> index is the number of the reactor, it is used for the round-robin
+__CAPE_LIBEX   void              cape_aio_context_pin           (CapeAioContext, int pin_mode, number_t index);
+
 //=============================================================================
 
 #endif
@@ -2335,7 +2335,7 @@ struct CapeAioSocketCache_s
   
   CapeList cache;
   
-  CapeMutex mutex;
+  CapeMutexInline mutex;
   
   // for callback
 
@@ -2367,7 +2367,7 @@ CapeAioSocketCache cape_aio_socket_cache_new (CapeAioContext aio_ctx)
   
   self->cache = cape_list_new (cape_aio_socket_cache__cache_on_del);
   
-  self->mutex = cape_mutex_new ();
+  cape_mutex_init (&(self->mutex), 0);
   
   self->ptr = NULL;  
 
@@ -2398,12 +2398,12 @@ void cape_aio_socket_cache__close (CapeAioSocketCache self)
 {
   CapeAioSocket sock;
   
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
 
   sock = self->aio_socket;
   self->aio_socket = NULL;
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
   if (sock)
   {
@@ -2431,7 +2431,7 @@ void cape_aio_socket_cache_del (CapeAioSocketCache* p_self)
     cape_list_del (&(self->cache));
     
     // cleanup the mutex
-    cape_mutex_del (&(self->mutex));
+    cape_mutex_done (&(self->mutex));
 
     // free memory
     CAPE_DEL (p_self, struct CapeAioSocketCache_s);
@@ -2458,7 +2458,7 @@ static void __STDCALL cape_aio_socket_cache__on_sent (void* ptr, CapeAioSocket s
     cape_stream_del (&s);    
   }
 
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
   
   if (self->aio_socket == NULL)
   {
@@ -2469,7 +2469,7 @@ static void __STDCALL cape_aio_socket_cache__on_sent (void* ptr, CapeAioSocket s
     first_on_sent = TRUE;
   }
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
 
   if (first_on_sent)
   {
@@ -2485,11 +2485,11 @@ static void __STDCALL cape_aio_socket_cache__on_sent (void* ptr, CapeAioSocket s
     cape_aio_socket_change_r (self->aio_socket, self->aio_ctx);
   }
   
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
 
   s = cape_list_pop_front (self->cache);
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
   if (s)
   {
@@ -2536,7 +2536,7 @@ static void __STDCALL cape_aio_socket_cache__on_done (void* ptr, void* userdata)
     CapeStream s = userdata; cape_stream_del (&s);    
   }
   
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
 
   if (self->aio_socket)
   {
@@ -2557,7 +2557,7 @@ static void __STDCALL cape_aio_socket_cache__on_done (void* ptr, void* userdata)
   // clear the cache
   cape_list_clr (self->cache);
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
   // check for auto reconnect system
   if (retry)
@@ -2599,7 +2599,7 @@ void cape_aio_socket_cache_set (CapeAioSocketCache self, void* handle, void* ptr
   // set callback
   cape_aio_socket_callback (sock, self, cape_aio_socket_cache__on_sent, cape_aio_socket_cache__on_recv, cape_aio_socket_cache__on_done);
     
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
 
   // set the new socket handler
   self->aio_socket = NULL;
@@ -2612,7 +2612,7 @@ void cape_aio_socket_cache_set (CapeAioSocketCache self, void* handle, void* ptr
   self->on_retry = on_retry;
   self->on_connect = on_connect;
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
 
   // enable the event handling and activate events on 'sent'
   cape_aio_socket_add_w (&sock, self->aio_ctx);
@@ -2622,11 +2622,11 @@ void cape_aio_socket_cache_set (CapeAioSocketCache self, void* handle, void* ptr
 
 void cape_aio_socket_cache_retry (CapeAioSocketCache self, int auto_reconnect)
 {
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
   
   self->auto_reconnect = auto_reconnect;
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
 }
 
 //-----------------------------------------------------------------------------
@@ -2637,12 +2637,12 @@ void cape_aio_socket_cache_clr (CapeAioSocketCache self)
   
   cape_aio_socket_cache__close (self);
   
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
     
   // clear the cache
   cape_list_clr (self->cache);
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
 }
 
 //-----------------------------------------------------------------------------
@@ -2653,7 +2653,7 @@ int cape_aio_socket_cache_send_s (CapeAioSocketCache self, CapeStream* p_stream,
   
   if (*p_stream)
   {
-    cape_mutex_lock (self->mutex);
+    cape_mutex_lock (&(self->mutex));
     
     if (self->aio_socket)
     {
@@ -2674,7 +2674,7 @@ int cape_aio_socket_cache_send_s (CapeAioSocketCache self, CapeStream* p_stream,
       res = cape_err_set (err, CAPE_ERR_NO_OBJECT, "socket is not connected");
     }
     
-    cape_mutex_unlock (self->mutex);
+    cape_mutex_unlock (&(self->mutex));
   }  
   
   if (res == CAPE_ERR_NONE)
@@ -2691,11 +2691,11 @@ int cape_aio_socket_cache_active (CapeAioSocketCache self)
 {
   int active = FALSE;
   
-  cape_mutex_lock (self->mutex);
+  cape_mutex_lock (&(self->mutex));
 
   active = self->aio_socket != NULL;
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
   return active;
 }
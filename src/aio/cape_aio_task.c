@@ -0,0 +1,603 @@
+#include "cape_aio_task.h"
+#include "cape_aio_timer.h"
+
+// cape includes
+#include "sys/cape_types.h"
+#include "sys/cape_log.h"
+#include "stc/cape_stream.h"
+
+#if defined __LINUX_OS
+
+#include <sys/timerfd.h>
+#include <memory.h>
+#include <unistd.h>
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_AIO_TASK__WAIT_NONE       0
+#define CAPE_AIO_TASK__WAIT_START      1
+#define CAPE_AIO_TASK__WAIT_RECV       2
+#define CAPE_AIO_TASK__WAIT_SEND       3
+#define CAPE_AIO_TASK__WAIT_TIMER      4
+#define CAPE_AIO_TASK__WAIT_OFFLOAD    5
+#define CAPE_AIO_TASK__WAIT_FINAL      6
+
+//-----------------------------------------------------------------------------
+
+struct CapeAioTask_s
+{
+  CapeAioContext aio;
+  
+  void* ptr;
+  
+  fct_cape_aio_task__on_run on_run;
+  
+  fct_cape_aio_task__on_done on_done;
+  
+  int step;                   // resume point of the body
+  
+  int wait;                   // the operation the task is waiting for
+  
+  CapeAioPost post;           // used to get back to the reactor thread
+  
+  // socket
+  
+  CapeAioSocket sock;
+  
+  CapeStream recv_pending;    // data which arrived while the task was busy
+  
+  int recv_consumed;          // pending data was handed to the body
+  
+  const char* recv_bufdat;
+  
+  number_t recv_buflen;
+  
+  CapeStream send_buf;
+  
+  // timer
+  
+  CapeAioHandle timer_aioh;   // stays in the context for all sleeps of the task
+  
+  number_t timer_fd;
+  
+  // offload
+  
+  cape_future_fct off_fct;
+  
+  void* off_ptr;
+  
+  void* off_result;
+  
+  int off_done;
+  
+  CapeErr off_err;
+};
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__on_post (void* ptr);
+
+//-----------------------------------------------------------------------------
+
+CapeAioTask cape_aio_task_new (CapeAioContext aio, void* ptr, fct_cape_aio_task__on_run on_run, fct_cape_aio_task__on_done on_done)
+{
+  CapeAioTask self = CAPE_NEW (struct CapeAioTask_s);
+  
+  self->aio = aio;
+  self->ptr = ptr;
+  self->on_run = on_run;
+  self->on_done = on_done;
+  
+  self->step = 0;
+  self->wait = CAPE_AIO_TASK__WAIT_NONE;
+  
+  self->post.next = NULL;
+  self->post.ptr = self;
+  self->post.on_post = cape_aio_task__on_post;
+  
+  self->sock = NULL;
+  
+  self->recv_pending = cape_stream_new ();
+  self->recv_consumed = FALSE;
+  self->recv_bufdat = NULL;
+  self->recv_buflen = 0;
+  
+  self->send_buf = cape_stream_new ();
+  
+  self->timer_aioh = NULL;
+  self->timer_fd = -1;
+  
+  self->off_fct = NULL;
+  self->off_ptr = NULL;
+  self->off_result = NULL;
+  self->off_done = FALSE;
+  self->off_err = cape_err_new ();
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_task_del (CapeAioTask* p_self)
+{
+  if (*p_self)
+  {
+    CapeAioTask self = *p_self;
+    
+    if (self->sock)
+    {
+      cape_aio_socket_unref (self->sock);
+    }
+    
+#if defined __LINUX_OS
+
+    if (self->timer_aioh)
+    {
+      // removes the handle from the context, this calls the unref
+      cape_aio_context_mod (self->aio, self->timer_aioh, (void*)self->timer_fd, CAPE_AIO_DONE, 0);
+    }
+
+#endif
+    
+    cape_stream_del (&(self->recv_pending));
+    cape_stream_del (&(self->send_buf));
+    
+    cape_err_del (&(self->off_err));
+    
+    CAPE_DEL (p_self, struct CapeAioTask_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_task__finalize (CapeAioTask self)
+{
+  if (self->sock)
+  {
+    CapeAioSocket sock = self->sock;
+    
+    self->sock = NULL;
+    
+    // no more callbacks into this task
+    cape_aio_socket_callback (sock, NULL, NULL, NULL, NULL);
+    
+    cape_aio_socket_close (sock, self->aio);
+  }
+  
+  if (self->on_done)
+  {
+    self->on_done (self->ptr);
+  }
+  
+  cape_aio_task_del (&self);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_aio_task__resume (CapeAioTask self)
+{
+  self->wait = CAPE_AIO_TASK__WAIT_NONE;
+  
+  if (self->on_run (self->ptr, self) == CAPE_AIO_TASK_DONE)
+  {
+    self->wait = CAPE_AIO_TASK__WAIT_FINAL;
+    
+    // don't delete the task here, we might be called by one of the socket callbacks
+    if (!cape_aio_context_post (self->aio, &(self->post)))
+    {
+      cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio task", "can't finalize task, context was closed");
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__on_post (void* ptr)
+{
+  CapeAioTask self = ptr;
+  
+  if (self->wait == CAPE_AIO_TASK__WAIT_FINAL)
+  {
+    cape_aio_task__finalize (self);
+  }
+  else
+  {
+    cape_aio_task__resume (self);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__on_sent (void* ptr, CapeAioSocket socket, void* userdata)
+{
+  CapeAioTask self = ptr;
+  
+  // only our own buffers carry the task as userdata
+  if (userdata == self && self->wait == CAPE_AIO_TASK__WAIT_SEND)
+  {
+    cape_aio_task__resume (self);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__on_recv (void* ptr, CapeAioSocket socket, const char* bufdat, number_t buflen)
+{
+  CapeAioTask self = ptr;
+  
+  if (self->wait == CAPE_AIO_TASK__WAIT_RECV)
+  {
+    self->recv_bufdat = bufdat;
+    self->recv_buflen = buflen;
+    
+    cape_aio_task__resume (self);
+  }
+  else if (self->wait != CAPE_AIO_TASK__WAIT_FINAL)
+  {
+    if (self->recv_consumed)
+    {
+      cape_stream_clr (self->recv_pending);
+      
+      self->recv_consumed = FALSE;
+    }
+    
+    // keep it until the body asks for it
+    cape_stream_append_buf (self->recv_pending, bufdat, buflen);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__on_done (void* ptr, void* userdata)
+{
+  CapeAioTask self = ptr;
+  
+  // the socket is going to be deleted
+  self->sock = NULL;
+  
+  if (self->wait == CAPE_AIO_TASK__WAIT_RECV)
+  {
+    self->recv_bufdat = NULL;
+    self->recv_buflen = 0;
+    
+    cape_aio_task__resume (self);
+  }
+  else if (self->wait == CAPE_AIO_TASK__WAIT_SEND)
+  {
+    cape_aio_task__resume (self);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_task_callback (CapeAioTask self, void* ptr, fct_cape_aio_task__on_run on_run, fct_cape_aio_task__on_done on_done)
+{
+  self->ptr = ptr;
+  self->on_run = on_run;
+  self->on_done = on_done;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_task_attach (CapeAioTask self, CapeAioSocket sock)
+{
+  self->sock = sock;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_task_start (CapeAioTask* p_self)
+{
+  CapeAioTask self = *p_self;
+  
+  *p_self = NULL;
+  
+  self->wait = CAPE_AIO_TASK__WAIT_START;
+  
+  if (self->sock)
+  {
+    // the AIO subsystem gets its own reference
+    CapeAioSocket sock = self->sock;
+    
+    cape_aio_socket_callback (sock, self, cape_aio_task__on_sent, cape_aio_task__on_recv, cape_aio_task__on_done);
+    
+    cape_aio_socket_add_r (&sock, self->aio);
+  }
+  
+  if (!cape_aio_context_post (self->aio, &(self->post)))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio task", "can't start task, context is not open");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_recv (CapeAioTask self)
+{
+  if (self->recv_consumed)
+  {
+    cape_stream_clr (self->recv_pending);
+    
+    self->recv_consumed = FALSE;
+  }
+  
+  if (cape_stream_size (self->recv_pending))
+  {
+    self->recv_bufdat = cape_stream_data (self->recv_pending);
+    self->recv_buflen = cape_stream_size (self->recv_pending);
+    
+    self->recv_consumed = TRUE;
+    
+    return FALSE;
+  }
+  
+  if (self->sock == NULL)
+  {
+    self->recv_bufdat = NULL;
+    self->recv_buflen = 0;
+    
+    return FALSE;
+  }
+  
+  self->wait = CAPE_AIO_TASK__WAIT_RECV;
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_send (CapeAioTask self, const char* bufdat, number_t buflen)
+{
+  if (self->sock == NULL || buflen == 0)
+  {
+    return FALSE;
+  }
+  
+  cape_stream_clr (self->send_buf);
+  
+  cape_stream_append_buf (self->send_buf, bufdat, buflen);
+  
+  self->wait = CAPE_AIO_TASK__WAIT_SEND;
+  
+  cape_aio_socket_send (self->sock, self->aio, cape_stream_data (self->send_buf), cape_stream_size (self->send_buf), self);
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined __LINUX_OS
+
+static int __STDCALL cape_aio_task__timer__on_event (void* ptr, int hflags, unsigned long events, unsigned long param1)
+{
+  CapeAioTask self = ptr;
+  
+  {
+    long value;
+    read (self->timer_fd, &value, 8);
+  }
+  
+  if (self->wait == CAPE_AIO_TASK__WAIT_TIMER)
+  {
+    cape_aio_task__resume (self);
+  }
+  
+  // keep the timer for the next sleep
+  return CAPE_AIO_READ;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__timer__on_unref (void* ptr, CapeAioHandle aioh, int force_close)
+{
+  CapeAioTask self = ptr;
+  
+  close (self->timer_fd);
+  
+  self->timer_fd = -1;
+  
+  cape_aio_handle_del (&(self->timer_aioh));
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_sleep (CapeAioTask self, long timeout_in_ms)
+{
+  struct itimerspec value;
+  
+  // the timer is created once and armed for each sleep
+  if (self->timer_aioh == NULL)
+  {
+    self->timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK);
+    
+    if (self->timer_fd == -1)
+    {
+      CapeErr err = cape_err_new ();
+      
+      cape_err_lastOSError (err);
+      
+      cape_log_fmt (CAPE_LL_ERROR, "CAPE", "aio task", "can't create timer: %s", cape_err_text (err));
+      
+      cape_err_del (&err);
+      
+      return FALSE;
+    }
+    
+    self->timer_aioh = cape_aio_handle_new (CAPE_AIO_READ, self, cape_aio_task__timer__on_event, cape_aio_task__timer__on_unref);
+    
+    if (!cape_aio_context_add (self->aio, self->timer_aioh, (void*)self->timer_fd, 0))
+    {
+      // a closed context already released the handle
+      if (self->timer_aioh)
+      {
+        cape_aio_task__timer__on_unref (self, self->timer_aioh, TRUE);
+      }
+      
+      return FALSE;
+    }
+  }
+  
+  memset (&value, 0, sizeof(value));
+  
+  // one shot, a zero value would disarm the timer
+  value.it_value.tv_sec = timeout_in_ms / 1000;
+  value.it_value.tv_nsec = timeout_in_ms > 0 ? (timeout_in_ms % 1000) * 1000000 : 1;
+  
+  if (timerfd_settime (self->timer_fd, 0, &value, NULL) < 0)
+  {
+    CapeErr err = cape_err_new ();
+    
+    cape_err_lastOSError (err);
+    
+    cape_log_fmt (CAPE_LL_ERROR, "CAPE", "aio task", "can't set timer: %s", cape_err_text (err));
+    
+    cape_err_del (&err);
+    
+    return FALSE;
+  }
+  
+  self->wait = CAPE_AIO_TASK__WAIT_TIMER;
+  
+  return TRUE;
+}
+
+#else
+
+static int __STDCALL cape_aio_task__on_timer (void* ptr)
+{
+  CapeAioTask self = ptr;
+  
+  cape_aio_task__resume (self);
+  
+  // one shot
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_sleep (CapeAioTask self, long timeout_in_ms)
+{
+  int res;
+  CapeErr err = cape_err_new ();
+  
+  // the timer api can't arm a timer again, so each sleep has its own one
+  CapeAioTimer timer = cape_aio_timer_new ();
+  
+  res = cape_aio_timer_set (timer, timeout_in_ms, self, cape_aio_task__on_timer, err);
+  if (res)
+  {
+    cape_log_fmt (CAPE_LL_ERROR, "CAPE", "aio task", "can't create timer: %s", cape_err_text (err));
+    
+    cape_err_del (&err);
+    
+    return FALSE;
+  }
+  
+  cape_err_del (&err);
+  
+  self->wait = CAPE_AIO_TASK__WAIT_TIMER;
+  
+  cape_aio_timer_add (&timer, self->aio);
+  
+  return TRUE;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__offload__on_event (void* ptr, number_t pos)
+{
+  CapeAioTask self = ptr;
+  
+  // runs in the worker thread
+  self->off_result = self->off_fct (self->off_ptr, pos, self->off_err);
+  
+  self->off_done = TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_aio_task__offload__on_done (void* ptr, number_t pos)
+{
+  CapeAioTask self = ptr;
+  
+  if (!self->off_done)
+  {
+    cape_err_set (self->off_err, CAPE_ERR_PROCESS_ABORT, "queue was terminated");
+  }
+  
+  // continue on the reactor thread
+  if (!cape_aio_context_post (self->aio, &(self->post)))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio task", "can't resume task, context was closed");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_offload (CapeAioTask self, CapeQueue queue, cape_future_fct on_event, void* ptr)
+{
+  self->off_fct = on_event;
+  self->off_ptr = ptr;
+  self->off_result = NULL;
+  self->off_done = FALSE;
+  
+  cape_err_clr (self->off_err);
+  
+  self->wait = CAPE_AIO_TASK__WAIT_OFFLOAD;
+  
+  cape_queue_add (queue, NULL, cape_aio_task__offload__on_event, cape_aio_task__offload__on_done, self, 0);
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+const char* cape_aio_task_data (CapeAioTask self, number_t* p_len)
+{
+  if (p_len)
+  {
+    *p_len = self->recv_buflen;
+  }
+  
+  return self->recv_bufdat;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_aio_task_result (CapeAioTask self, CapeErr err)
+{
+  void* ret = NULL;
+  
+  if (cape_err_code (self->off_err))
+  {
+    cape_err_set (err, cape_err_code (self->off_err), cape_err_text (self->off_err));
+  }
+  else
+  {
+    // transfer the ownership
+    ret = self->off_result;
+    self->off_result = NULL;
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_aio_task_step (CapeAioTask self)
+{
+  return self->step;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_aio_task_set_step (CapeAioTask self, int step)
+{
+  self->step = step;
+}
+
+//-----------------------------------------------------------------------------
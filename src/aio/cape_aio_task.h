@@ -0,0 +1,88 @@
+#ifndef __CAPE_AIO__TASK__H
+#define __CAPE_AIO__TASK__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_err.h"
+#include "sys/cape_queue.h"
+#include "aio/cape_aio_ctx.h"
+#include "aio/cape_aio_sock.h"
+
+//=============================================================================
+
+/*
+ * \ brief This class implements a stackless coroutine which runs on the reactor thread of a CapeAioContext. The body of the task
+           is a callback which gets called again for every resumption. Use the CAPE_AIO_TASK_* macros to jump back to the await
+           point where the task was suspended. Local variables don't survive an await, keep the state in the ptr object.
+
+           A task can await socket reads and writes, timers and offloads to a CapeQueue. After an offload the task is resumed
+           on the reactor thread again. The resumption uses memory embedded in the task, there are no allocations per await.
+
+           The ownership of the task moves to the AIO subsystem with 'cape_aio_task_start'. The task is deleted when the body
+           returns CAPE_AIO_TASK_DONE, the attached socket will be closed.
+ */
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_AIO_TASK_WAIT     0
+#define CAPE_AIO_TASK_DONE     1
+
+//-----------------------------------------------------------------------------
+
+struct CapeAioTask_s; typedef struct CapeAioTask_s* CapeAioTask;
+
+typedef int        (__STDCALL *fct_cape_aio_task__on_run)      (void* ptr, CapeAioTask);   // returns CAPE_AIO_TASK_WAIT or CAPE_AIO_TASK_DONE
+typedef void       (__STDCALL *fct_cape_aio_task__on_done)     (void* ptr);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeAioTask        cape_aio_task_new             (CapeAioContext, void* ptr, fct_cape_aio_task__on_run, fct_cape_aio_task__on_done);
+
+__CAPE_LIBEX   void               cape_aio_task_del             (CapeAioTask*);      // only if the task was not started
+
+               // replaces the callbacks, must be called before the task was started
+__CAPE_LIBEX   void               cape_aio_task_callback        (CapeAioTask, void* ptr, fct_cape_aio_task__on_run, fct_cape_aio_task__on_done);
+
+               // takes over the socket, the socket will be added to the AIO subsystem with 'cape_aio_task_start'
+__CAPE_LIBEX   void               cape_aio_task_attach          (CapeAioTask, CapeAioSocket);
+
+               // schedules the first run on the reactor thread, can be called from any thread
+__CAPE_LIBEX   void               cape_aio_task_start           (CapeAioTask*);
+
+//-----------------------------------------------------------------------------
+// await operations: return TRUE if the task must be suspended, FALSE if the result is already available
+
+__CAPE_LIBEX   int                cape_aio_task_recv            (CapeAioTask);
+
+__CAPE_LIBEX   int                cape_aio_task_send            (CapeAioTask, const char* bufdat, number_t buflen);   // the buffer is copied
+
+__CAPE_LIBEX   int                cape_aio_task_sleep           (CapeAioTask, long timeout_in_ms);
+
+__CAPE_LIBEX   int                cape_aio_task_offload         (CapeAioTask, CapeQueue, cape_future_fct on_event, void* ptr);
+
+//-----------------------------------------------------------------------------
+// results of the last await
+
+               // received data, valid until the next await, returns NULL if the connection was closed
+__CAPE_LIBEX   const char*        cape_aio_task_data            (CapeAioTask, number_t* p_len);
+
+               // return value of the offloaded function, returns NULL and sets err if the function failed
+__CAPE_LIBEX   void*              cape_aio_task_result          (CapeAioTask, CapeErr err);
+
+//-----------------------------------------------------------------------------
+// for the macros
+
+__CAPE_LIBEX   int                cape_aio_task_step            (CapeAioTask);
+
+__CAPE_LIBEX   void               cape_aio_task_set_step        (CapeAioTask, int step);
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_AIO_TASK_BEGIN(task)         switch (cape_aio_task_step (task)) { case 0:
+
+#define CAPE_AIO_TASK_AWAIT(task, op)     cape_aio_task_set_step (task, __LINE__); if (op) return CAPE_AIO_TASK_WAIT; /* fallthrough */ case __LINE__:
+
+#define CAPE_AIO_TASK_END(task)           } return CAPE_AIO_TASK_DONE;
+
+//=============================================================================
+
+#endif
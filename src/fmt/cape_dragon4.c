@@ -29,6 +29,20 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined __WINDOWS_OS
+
+#include <windows.h>
+
+#define CAPE_DRAGON4__TLS __declspec(thread)
+
+#else
+
+#include <pthread.h>
+
+#define CAPE_DRAGON4__TLS __thread
+
+#endif
+
 #include <assert.h>
 
 #if 0
@@ -2008,7 +2022,26 @@ CapeDragon4 cape_dragon4_new ()
 {
   CapeDragon4 self = CAPE_NEW (struct CapeDragon4_s);
 
-  // set default values
+  cape_dragon4_reset (self);
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------------------------------------
+
+void cape_dragon4_del (CapeDragon4* p_self)
+{
+  if (*p_self)
+  {
+    CAPE_DEL (p_self, struct CapeDragon4_s);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------------
+
+void cape_dragon4_reset (CapeDragon4 self)
+{
+  // set default values, the bigints are always initialized before use
   self->scientific = FALSE;
   self->digit_mode = CAPE_DRAGON4__DMODE_UNIQUE;
   self->cutoff_mode = CAPE_DRAGON4__CMODE_TOTAL;
@@ -2022,22 +2055,84 @@ CapeDragon4 cape_dragon4_new ()
   self->buflen = 0;
   self->bufdat = NULL;
   self->bufpos = 0;
+}
 
-  return self;
+//-----------------------------------------------------------------------------------------------------------
+
+static CAPE_DRAGON4__TLS CapeDragon4 cape_dragon4__tls = NULL;
+
+#if defined __WINDOWS_OS
+
+static INIT_ONCE cape_dragon4__once = INIT_ONCE_STATIC_INIT;
+static DWORD cape_dragon4__key;
+
+#else
+
+static pthread_once_t cape_dragon4__once = PTHREAD_ONCE_INIT;
+static pthread_key_t cape_dragon4__key;
+
+#endif
+
+//-----------------------------------------------------------------------------------------------------------
+
+static void __STDCALL cape_dragon4__on_thread_done (void* ptr)
+{
+  CapeDragon4 self = ptr;
+
+  cape_dragon4_del (&self);
+
+  cape_dragon4__tls = NULL;
 }
 
 //-----------------------------------------------------------------------------------------------------------
 
-void cape_dragon4_del (CapeDragon4* p_self)
+#if defined __WINDOWS_OS
+
+static BOOL CALLBACK cape_dragon4__on_once (PINIT_ONCE once, PVOID param, PVOID* context)
 {
-  if (*p_self)
+  cape_dragon4__key = FlsAlloc (cape_dragon4__on_thread_done);
+
+  return TRUE;
+}
+
+#else
+
+static void cape_dragon4__on_once (void)
+{
+  pthread_key_create (&cape_dragon4__key, cape_dragon4__on_thread_done);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------------------------------------
+
+CapeDragon4 cape_dragon4_tls (void)
+{
+  if (cape_dragon4__tls == NULL)
   {
-    CapeDragon4 self = *p_self;
+    cape_dragon4__tls = cape_dragon4_new ();
 
-    
-    
-    CAPE_DEL (p_self, struct CapeDragon4_s);
+    // the context is released when the thread terminates
+#if defined __WINDOWS_OS
+
+    InitOnceExecuteOnce (&cape_dragon4__once, cape_dragon4__on_once, NULL, NULL);
+
+    FlsSetValue (cape_dragon4__key, cape_dragon4__tls);
+
+#else
+
+    pthread_once (&cape_dragon4__once, cape_dragon4__on_once);
+
+    pthread_setspecific (cape_dragon4__key, cape_dragon4__tls);
+
+#endif
+  }
+  else
+  {
+    cape_dragon4_reset (cape_dragon4__tls);
   }
+
+  return cape_dragon4__tls;
 }
 
 //-----------------------------------------------------------------------------------------------------------
@@ -2587,4 +2682,45 @@ void cape_dragon4_scientific (CapeDragon4 self, CapeDragon4DigitMode digit_mode,
 
 //-----------------------------------------------------------------------------------------------------------
 
+number_t cape_dragon4_format_to (char* bufdat, number_t buflen, double value, CapeDragon4DigitMode digit_mode, int precision, CapeDragon4TrimMode trim)
+{
+  CapeDragon4 self;
+
+  // the only error of cape_dragon4_run
+  if (buflen < 1)
+  {
+    return 0;
+  }
+
+  self = cape_dragon4_tls ();
+
+  cape_dragon4_positional (self, digit_mode, CAPE_DRAGON4__CMODE_TOTAL, precision, FALSE, trim, 0, 0);
+
+  cape_dragon4_run (self, bufdat, buflen, value, NULL);
+
+  return cape_dragon4_len (self);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+
+void cape_dragon4_batch (CapeDragon4 self, CapeStream stream, const double* values, number_t size, const char* separator)
+{
+  number_t i;
+  char buffer[CAPE_DRAGON4_BUF];
+
+  for (i = 0; i < size; i++)
+  {
+    if (i && separator)
+    {
+      cape_stream_append_str (stream, separator);
+    }
+
+    cape_dragon4_run (self, buffer, CAPE_DRAGON4_BUF, values[i], NULL);
+
+    cape_stream_append_buf (stream, buffer, cape_dragon4_len (self));
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------------
+
 #undef DEBUG_ASSERT
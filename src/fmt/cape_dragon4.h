@@ -4,6 +4,7 @@
 #include "sys/cape_export.h"
 #include "sys/cape_types.h"
 #include "stc/cape_str.h"
+#include "stc/cape_stream.h"
 #include "sys/cape_err.h"
 
 //-----------------------------------------------------------------------------
@@ -37,6 +38,7 @@ typedef enum CapeDragon4TrimMode
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_DRAGON4_BUF 1024     // enough for all doubles in UNIQUE mode
 
 //-----------------------------------------------------------------------------
 
@@ -48,6 +50,12 @@ __CAPE_LIBEX   CapeDragon4       cape_dragon4_new           (void);
 
 __CAPE_LIBEX   void              cape_dragon4_del           (CapeDragon4*);
 
+               // sets the default options, a context can be reused for any amount of runs
+__CAPE_LIBEX   void              cape_dragon4_reset         (CapeDragon4);
+
+               // a context of the current thread with default options, don't delete it
+__CAPE_LIBEX   CapeDragon4       cape_dragon4_tls           (void);
+
 __CAPE_LIBEX   int               cape_dragon4_run           (CapeDragon4, char* bufdat, number_t buflen, double value, CapeErr err);
 
 __CAPE_LIBEX   number_t          cape_dragon4_len           (CapeDragon4);
@@ -58,6 +66,14 @@ __CAPE_LIBEX   void              cape_dragon4_positional    (CapeDragon4, CapeDr
 
 __CAPE_LIBEX   void              cape_dragon4_scientific    (CapeDragon4, CapeDragon4DigitMode, int precision, int sign, CapeDragon4TrimMode trim, int pad_left, int exp_digits);
 
+//-----------------------------------------------------------------------------
+
+               // positional format with the context of the current thread, allocates nothing, returns the length
+__CAPE_LIBEX   number_t          cape_dragon4_format_to     (char* bufdat, number_t buflen, double value, CapeDragon4DigitMode, int precision, CapeDragon4TrimMode trim);
+
+               // appends all values with the options of the context, the separator can be NULL
+__CAPE_LIBEX   void              cape_dragon4_batch         (CapeDragon4, CapeStream, const double* values, number_t size, const char* separator);
+
 //-----------------------------------------------------------------------------
 
 #endif
@@ -0,0 +1,451 @@
+#include "cape_grisu.h"
+#include "cape_dragon4.h"
+
+// c includes
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_GRISU__SIGNIFICAND_SIZE   64
+#define CAPE_GRISU__MIN_TARGET_EXP    -60
+#define CAPE_GRISU__MAX_TARGET_EXP    -32
+#define CAPE_GRISU__CACHED_OFFSET      348
+#define CAPE_GRISU__CACHED_DISTANCE    8
+
+//-----------------------------------------------------------------------------
+
+// a floating point number with 64 bit significand: f * 2^e
+typedef struct
+{
+  cape_uint64 f;
+
+  int e;
+
+} CapeGrisuFp;
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  cape_uint64 f;
+
+  short e;
+
+  short k;      // the decimal exponent: f * 2^e ~ 10^k
+
+} CapeGrisuPower;
+
+//-----------------------------------------------------------------------------
+
+// normalized powers of ten from 10^-348 to 10^340 in steps of 8
+static const CapeGrisuPower cape_grisu__powers[87] =
+{
+  {0xFA8FD5A0081C0288ULL, -1220, -348},
+  {0xBAAEE17FA23EBF76ULL, -1193, -340},
+  {0x8B16FB203055AC76ULL, -1166, -332},
+  {0xCF42894A5DCE35EAULL, -1140, -324},
+  {0x9A6BB0AA55653B2DULL, -1113, -316},
+  {0xE61ACF033D1A45DFULL, -1087, -308},
+  {0xAB70FE17C79AC6CAULL, -1060, -300},
+  {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+  {0xBE5691EF416BD60CULL, -1007, -284},
+  {0x8DD01FAD907FFC3CULL,  -980, -276},
+  {0xD3515C2831559A83ULL,  -954, -268},
+  {0x9D71AC8FADA6C9B5ULL,  -927, -260},
+  {0xEA9C227723EE8BCBULL,  -901, -252},
+  {0xAECC49914078536DULL,  -874, -244},
+  {0x823C12795DB6CE57ULL,  -847, -236},
+  {0xC21094364DFB5637ULL,  -821, -228},
+  {0x9096EA6F3848984FULL,  -794, -220},
+  {0xD77485CB25823AC7ULL,  -768, -212},
+  {0xA086CFCD97BF97F4ULL,  -741, -204},
+  {0xEF340A98172AACE5ULL,  -715, -196},
+  {0xB23867FB2A35B28EULL,  -688, -188},
+  {0x84C8D4DFD2C63F3BULL,  -661, -180},
+  {0xC5DD44271AD3CDBAULL,  -635, -172},
+  {0x936B9FCEBB25C996ULL,  -608, -164},
+  {0xDBAC6C247D62A584ULL,  -582, -156},
+  {0xA3AB66580D5FDAF6ULL,  -555, -148},
+  {0xF3E2F893DEC3F126ULL,  -529, -140},
+  {0xB5B5ADA8AAFF80B8ULL,  -502, -132},
+  {0x87625F056C7C4A8BULL,  -475, -124},
+  {0xC9BCFF6034C13053ULL,  -449, -116},
+  {0x964E858C91BA2655ULL,  -422, -108},
+  {0xDFF9772470297EBDULL,  -396, -100},
+  {0xA6DFBD9FB8E5B88FULL,  -369,  -92},
+  {0xF8A95FCF88747D94ULL,  -343,  -84},
+  {0xB94470938FA89BCFULL,  -316,  -76},
+  {0x8A08F0F8BF0F156BULL,  -289,  -68},
+  {0xCDB02555653131B6ULL,  -263,  -60},
+  {0x993FE2C6D07B7FACULL,  -236,  -52},
+  {0xE45C10C42A2B3B06ULL,  -210,  -44},
+  {0xAA242499697392D3ULL,  -183,  -36},
+  {0xFD87B5F28300CA0EULL,  -157,  -28},
+  {0xBCE5086492111AEBULL,  -130,  -20},
+  {0x8CBCCC096F5088CCULL,  -103,  -12},
+  {0xD1B71758E219652CULL,   -77,   -4},
+  {0x9C40000000000000ULL,   -50,    4},
+  {0xE8D4A51000000000ULL,   -24,   12},
+  {0xAD78EBC5AC620000ULL,     3,   20},
+  {0x813F3978F8940984ULL,    30,   28},
+  {0xC097CE7BC90715B3ULL,    56,   36},
+  {0x8F7E32CE7BEA5C70ULL,    83,   44},
+  {0xD5D238A4ABE98068ULL,   109,   52},
+  {0x9F4F2726179A2245ULL,   136,   60},
+  {0xED63A231D4C4FB27ULL,   162,   68},
+  {0xB0DE65388CC8ADA8ULL,   189,   76},
+  {0x83C7088E1AAB65DBULL,   216,   84},
+  {0xC45D1DF942711D9AULL,   242,   92},
+  {0x924D692CA61BE758ULL,   269,  100},
+  {0xDA01EE641A708DEAULL,   295,  108},
+  {0xA26DA3999AEF774AULL,   322,  116},
+  {0xF209787BB47D6B85ULL,   348,  124},
+  {0xB454E4A179DD1877ULL,   375,  132},
+  {0x865B86925B9BC5C2ULL,   402,  140},
+  {0xC83553C5C8965D3DULL,   428,  148},
+  {0x952AB45CFA97A0B3ULL,   455,  156},
+  {0xDE469FBD99A05FE3ULL,   481,  164},
+  {0xA59BC234DB398C25ULL,   508,  172},
+  {0xF6C69A72A3989F5CULL,   534,  180},
+  {0xB7DCBF5354E9BECEULL,   561,  188},
+  {0x88FCF317F22241E2ULL,   588,  196},
+  {0xCC20CE9BD35C78A5ULL,   614,  204},
+  {0x98165AF37B2153DFULL,   641,  212},
+  {0xE2A0B5DC971F303AULL,   667,  220},
+  {0xA8D9D1535CE3B396ULL,   694,  228},
+  {0xFB9B7CD9A4A7443CULL,   720,  236},
+  {0xBB764C4CA7A44410ULL,   747,  244},
+  {0x8BAB8EEFB6409C1AULL,   774,  252},
+  {0xD01FEF10A657842CULL,   800,  260},
+  {0x9B10A4E5E9913129ULL,   827,  268},
+  {0xE7109BFBA19C0C9DULL,   853,  276},
+  {0xAC2820D9623BF429ULL,   880,  284},
+  {0x80444B5E7AA7CF85ULL,   907,  292},
+  {0xBF21E44003ACDD2DULL,   933,  300},
+  {0x8E679C2F5E44FF8FULL,   960,  308},
+  {0xD433179D9C8CB841ULL,   986,  316},
+  {0x9E19DB92B4E31BA9ULL,  1013,  324},
+  {0xEB96BF6EBADF77D9ULL,  1039,  332},
+  {0xAF87023B9BF0EE6BULL,  1066,  340},
+};
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE CapeGrisuFp cape_grisu__normalize (CapeGrisuFp x)
+{
+  while ((x.f & 0xFFC0000000000000ULL) == 0)
+  {
+    x.f <<= 10;
+    x.e -= 10;
+  }
+
+  while ((x.f & 0x8000000000000000ULL) == 0)
+  {
+    x.f <<= 1;
+    x.e -= 1;
+  }
+
+  return x;
+}
+
+//-----------------------------------------------------------------------------
+
+// the upper 64 bits of the product, rounded
+static __CAPE_INLINE CapeGrisuFp cape_grisu__multiply (CapeGrisuFp x, CapeGrisuFp y)
+{
+  CapeGrisuFp ret;
+
+  cape_uint64 a = x.f >> 32;
+  cape_uint64 b = x.f & 0xFFFFFFFF;
+  cape_uint64 c = y.f >> 32;
+  cape_uint64 d = y.f & 0xFFFFFFFF;
+
+  cape_uint64 ac = a * c;
+  cape_uint64 bc = b * c;
+  cape_uint64 ad = a * d;
+  cape_uint64 bd = b * d;
+
+  cape_uint64 h = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1U << 31);
+
+  ret.f = ac + (ad >> 32) + (bc >> 32) + (h >> 32);
+  ret.e = x.e + y.e + 64;
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+// returns a power of ten which scales the exponent into the target range
+static CapeGrisuFp cape_grisu__cached_power (int e, int* k)
+{
+  CapeGrisuFp ret;
+
+  int min_exp = CAPE_GRISU__MIN_TARGET_EXP - (e + CAPE_GRISU__SIGNIFICAND_SIZE);
+  int max_exp = CAPE_GRISU__MAX_TARGET_EXP - (e + CAPE_GRISU__SIGNIFICAND_SIZE);
+
+  // ceil ((min_exp + 63) * log10(2)), the bias avoids floating point math
+  int dk = ((min_exp + CAPE_GRISU__SIGNIFICAND_SIZE - 1) * 78913 + (1 << 18) - 1) >> 18;
+  int index = (CAPE_GRISU__CACHED_OFFSET + dk - 1) / CAPE_GRISU__CACHED_DISTANCE + 1;
+
+  if (index < 0)
+  {
+    index = 0;
+  }
+
+  while (index < 86 && cape_grisu__powers[index].e < min_exp)
+  {
+    index++;
+  }
+
+  while (index > 0 && cape_grisu__powers[index].e > max_exp)
+  {
+    index--;
+  }
+
+  ret.f = cape_grisu__powers[index].f;
+  ret.e = cape_grisu__powers[index].e;
+
+  *k = cape_grisu__powers[index].k;
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+// corrects the last digit towards w and checks if the result is safe
+static int cape_grisu__round_weed (char* digits, int len, cape_uint64 distance_too_high_w, cape_uint64 unsafe_interval, cape_uint64 rest, cape_uint64 ten_kappa, cape_uint64 unit)
+{
+  cape_uint64 small_distance = distance_too_high_w - unit;
+  cape_uint64 big_distance = distance_too_high_w + unit;
+
+  while (rest < small_distance && unsafe_interval - rest >= ten_kappa && (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance))
+  {
+    digits[len - 1]--;
+    rest += ten_kappa;
+  }
+
+  // the other side of w might be closer
+  if (rest < big_distance && unsafe_interval - rest >= ten_kappa && (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+  {
+    return FALSE;
+  }
+
+  return (2 * unit <= rest) && (rest <= unsafe_interval - 4 * unit);
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_grisu__digit_gen (CapeGrisuFp low, CapeGrisuFp w, CapeGrisuFp high, char* digits, int* len, int* kappa)
+{
+  cape_uint64 unit = 1;
+
+  cape_uint64 too_low = low.f - unit;
+  cape_uint64 too_high = high.f + unit;
+  cape_uint64 unsafe_interval = too_high - too_low;
+
+  int shift = -w.e;
+  cape_uint64 one = (cape_uint64)1 << shift;
+
+  cape_uint32 integrals = (cape_uint32)(too_high >> shift);
+  cape_uint64 fractionals = too_high & (one - 1);
+
+  cape_uint32 divisor = 1;
+
+  *kappa = 1;
+  *len = 0;
+
+  // the biggest power of ten below the integrals
+  while (*kappa < 10 && divisor * 10 <= integrals)
+  {
+    divisor *= 10;
+    (*kappa)++;
+  }
+
+  while (*kappa > 0)
+  {
+    cape_uint64 rest;
+
+    digits[(*len)++] = (char)('0' + integrals / divisor);
+
+    integrals %= divisor;
+    (*kappa)--;
+
+    rest = ((cape_uint64)integrals << shift) + fractionals;
+
+    if (rest < unsafe_interval)
+    {
+      return cape_grisu__round_weed (digits, *len, too_high - w.f, unsafe_interval, rest, (cape_uint64)divisor << shift, unit);
+    }
+
+    divisor /= 10;
+  }
+
+  for (;;)
+  {
+    fractionals *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+
+    digits[(*len)++] = (char)('0' + (fractionals >> shift));
+
+    fractionals &= one - 1;
+    (*kappa)--;
+
+    if (fractionals < unsafe_interval)
+    {
+      return cape_grisu__round_weed (digits, *len, (too_high - w.f) * unit, unsafe_interval, fractionals, one, unit);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_grisu_digits (double value, char* digits, int* len, int* exp10)
+{
+  union
+  {
+    double d;
+    cape_uint64 n;
+
+  } bits;
+
+  CapeGrisuFp v, w, low, high, c;
+
+  cape_uint64 mantissa;
+  int biased_e, mk, kappa;
+
+  bits.d = value;
+
+  mantissa = bits.n & 0x000FFFFFFFFFFFFFULL;
+  biased_e = (int)((bits.n >> 52) & 0x7FF);
+
+  // nan and inf
+  if (biased_e == 0x7FF)
+  {
+    return FALSE;
+  }
+
+  if (biased_e)
+  {
+    v.f = mantissa | 0x0010000000000000ULL;
+    v.e = biased_e - 1075;
+  }
+  else
+  {
+    // subnormal
+    if (mantissa == 0)
+    {
+      digits[0] = '0';
+
+      *len = 1;
+      *exp10 = 0;
+
+      return TRUE;
+    }
+
+    v.f = mantissa;
+    v.e = -1074;
+  }
+
+  // the boundaries are in the middle to the neighbors
+  high.f = (v.f << 1) + 1;
+  high.e = v.e - 1;
+  high = cape_grisu__normalize (high);
+
+  // the lower neighbor is closer for powers of two
+  if (mantissa == 0 && biased_e > 1)
+  {
+    low.f = (v.f << 2) - 1;
+    low.e = v.e - 2;
+  }
+  else
+  {
+    low.f = (v.f << 1) - 1;
+    low.e = v.e - 1;
+  }
+
+  low.f <<= low.e - high.e;
+  low.e = high.e;
+
+  w = cape_grisu__normalize (v);
+
+  c = cape_grisu__cached_power (w.e, &mk);
+
+  if (cape_grisu__digit_gen (cape_grisu__multiply (low, c), cape_grisu__multiply (w, c), cape_grisu__multiply (high, c), digits, len, &kappa))
+  {
+    *exp10 = kappa - mk;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_grisu__dragon4 (char* buf, double value)
+{
+  return cape_dragon4_format_to (buf, CAPE_GRISU_BUF, value, CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_grisu_positional (char* buf, double value)
+{
+  char digits[20];
+  int len, exp10, point;
+
+  char* pos = buf;
+
+  if (!cape_grisu_digits (value, digits, &len, &exp10))
+  {
+    return cape_grisu__dragon4 (buf, value);
+  }
+
+  if (value < 0 || (value == 0 && 1 / value < 0))
+  {
+    *pos++ = '-';
+  }
+
+  // the amount of digits before the decimal point
+  point = len + exp10;
+
+  if (point <= 0)
+  {
+    *pos++ = '0';
+    *pos++ = '.';
+
+    memset (pos, '0', -point);
+    pos += -point;
+
+    memcpy (pos, digits, len);
+    pos += len;
+  }
+  else if (point < len)
+  {
+    memcpy (pos, digits, point);
+    pos += point;
+
+    *pos++ = '.';
+
+    memcpy (pos, digits + point, len - point);
+    pos += len - point;
+  }
+  else
+  {
+    memcpy (pos, digits, len);
+    pos += len;
+
+    memset (pos, '0', point - len);
+    pos += point - len;
+
+    *pos++ = '.';
+    *pos++ = '0';
+  }
+
+  *pos = '\0';
+
+  return pos - buf;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,31 @@
+#ifndef __CAPE_FMT__GRISU__H
+#define __CAPE_FMT__GRISU__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* shortest round-trip formatting of doubles with Grisu3 (Florian Loitsch)
+ *
+ * -> Grisu3 works with 64 bit integers only and finds the shortest digits
+ *    for more than 99% of all doubles, for the rest it reports a failure
+ * -> cape_grisu_positional uses Dragon4 for those values and for nan / inf,
+ *    the output is always the same as with Dragon4
+ */
+
+//=============================================================================
+
+#define CAPE_GRISU_BUF 1024
+
+//-----------------------------------------------------------------------------
+
+               // the shortest digits without sign, value = digits * 10^exp10, returns FALSE if the digits can't be proven to be the shortest
+__CAPE_LIBEX   int               cape_grisu_digits          (double value, char* digits, int* len, int* exp10);
+
+               // same output as Dragon4 with UNIQUE, TOTAL and TMODE_ONE_ZERO, the buffer must have CAPE_GRISU_BUF bytes, returns the length
+__CAPE_LIBEX   number_t          cape_grisu_positional      (char* buf, double value);
+
+//-----------------------------------------------------------------------------
+
+#endif
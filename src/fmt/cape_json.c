@@ -9,11 +9,41 @@
 // c includes
 #include <wchar.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeAtoms atoms;
+  
+  int doc_mode;
+  
+  CapeUdc doc;       // the root of the document in document mode
+  
+} CapeJsonContext;
+
+//-----------------------------------------------------------------------------------------------------------
+
+static CapeUdc cape_json_new (CapeJsonContext* ctx, CapeUdc obj, u_t type, const char* key)
+{
+  if (ctx && ctx->atoms)
+  {
+    return cape_udc_new_atom (type, cape_atoms_get (ctx->atoms, key));
+  }
+  
+  // creates the udc in the document of obj
+  return cape_udc_new_in (obj, type, key);
+}
 
 //-----------------------------------------------------------------------------------------------------------
 
 static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* val, const char* key, int index)
 {
+  CapeJsonContext* ctx = ptr;
+  
   switch (type)
   {
     case CAPE_JPARSER_OBJECT_NODE:
@@ -21,12 +51,19 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
     {
       CapeUdc h = val;
       
-      cape_udc_add_name (obj, &h, key);
+      if (ctx && ctx->atoms)
+      {
+        cape_udc_add_atom (obj, &h, cape_atoms_get (ctx->atoms, key));
+      }
+      else
+      {
+        cape_udc_add_name (obj, &h, key);
+      }
       break;
     }
     case CAPE_JPARSER_OBJECT_TEXT:
     {
-      CapeUdc h = cape_udc_new (CAPE_UDC_STRING, key);
+      CapeUdc h = cape_json_new (ctx, obj, CAPE_UDC_STRING, key);
       
       cape_udc_set_s_cp (h, val);
       
@@ -35,7 +72,7 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
     }
     case CAPE_JPARSER_OBJECT_NUMBER:
     {
-      CapeUdc h = cape_udc_new (CAPE_UDC_NUMBER, key);
+      CapeUdc h = cape_json_new (ctx, obj, CAPE_UDC_NUMBER, key);
       
       number_t* dat = val;
       cape_udc_set_n (h, *dat);
@@ -45,7 +82,7 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
     }
     case CAPE_JPARSER_OBJECT_FLOAT:
     {
-      CapeUdc h = cape_udc_new (CAPE_UDC_FLOAT, key);
+      CapeUdc h = cape_json_new (ctx, obj, CAPE_UDC_FLOAT, key);
       
       double* dat = val;
       cape_udc_set_f (h, *dat);
@@ -55,7 +92,7 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
     }
     case CAPE_JPARSER_OBJECT_BOLEAN:
     {
-      CapeUdc h = cape_udc_new (CAPE_UDC_BOOL, key);
+      CapeUdc h = cape_json_new (ctx, obj, CAPE_UDC_BOOL, key);
       
       long dat = (long)val;
       cape_udc_set_b (h, dat);
@@ -65,7 +102,7 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
     }
     case CAPE_JPARSER_OBJECT_DATETIME:
     {
-      CapeUdc h = cape_udc_new (CAPE_UDC_DATETIME, key);
+      CapeUdc h = cape_json_new (ctx, obj, CAPE_UDC_DATETIME, key);
 
       cape_udc_set_d (h, val);
       
@@ -83,31 +120,67 @@ static void __STDCALL cape_json_onItem (void* ptr, void* obj, int type, void* va
 
 static void* __STDCALL cape_json_onObjCreate (void* ptr, int type)
 {
+  CapeJsonContext* ctx = ptr;
+  
+  u_t udc_type;
+  
   switch (type)
   {
     case CAPE_JPARSER_OBJECT_NODE:
     {
-      return cape_udc_new (CAPE_UDC_NODE, NULL);
+      udc_type = CAPE_UDC_NODE;
+      break;
     }
     case CAPE_JPARSER_OBJECT_LIST:
     {
-      return cape_udc_new (CAPE_UDC_LIST, NULL);
+      udc_type = CAPE_UDC_LIST;
+      break;
+    }
+    default:
+    {
+      return NULL;
     }
   }
   
-  return NULL;
+  if (ctx && ctx->doc_mode)
+  {
+    if (ctx->doc == NULL)
+    {
+      // the outer object is created first
+      ctx->doc = cape_udc_new_doc (udc_type, NULL);
+      
+      return ctx->doc;
+    }
+    
+    return cape_udc_new_in (ctx->doc, udc_type, NULL);
+  }
+  
+  return cape_udc_new (udc_type, NULL);
 }
 
 //-----------------------------------------------------------------------------------------------------------
 
 static void __STDCALL cape_json_onObjDestroy (void* ptr, void* obj)
 {
-  CapeUdc h = obj; cape_udc_del (&h);
+  CapeJsonContext* ctx = ptr;
+  
+  // the document is released as a whole
+  if (ctx == NULL || !ctx->doc_mode)
+  {
+    CapeUdc h = obj; cape_udc_del (&h);
+  }
 }
 
 //-----------------------------------------------------------------------------
 
 CapeUdc cape_json_from_buf (const char* buffer, number_t size)
+{
+  return cape_json_from_buf_ex (buffer, size, NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc cape_json__from_buf (const char* buffer, number_t size, CapeJsonContext* ctx)
 {
   CapeUdc ret = NULL;
   int res;
@@ -115,7 +188,7 @@ CapeUdc cape_json_from_buf (const char* buffer, number_t size)
   CapeErr err = cape_err_new ();
   
   // create a new parser for the json format
-  CapeParserJson parser_json = cape_parser_json_new (NULL, cape_json_onItem, cape_json_onObjCreate, cape_json_onObjDestroy);
+  CapeParserJson parser_json = cape_parser_json_new (ctx, cape_json_onItem, cape_json_onObjCreate, cape_json_onObjDestroy);
  
   // try to parse the current buffer
   res = cape_parser_json_process (parser_json, buffer, size, err);
@@ -141,6 +214,12 @@ CapeUdc cape_json_from_buf (const char* buffer, number_t size)
   // clean up
   cape_parser_json_del (&parser_json);
   
+  if (ret == NULL)
+  {
+    // releases all objects of the document
+    cape_udc_del (&(ctx->doc));
+  }
+  
   cape_err_del (&err);
   
   return ret;
@@ -148,6 +227,621 @@ CapeUdc cape_json_from_buf (const char* buffer, number_t size)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc cape_json_from_buf_ex (const char* buffer, number_t size, CapeAtoms atoms)
+{
+  CapeJsonContext ctx;
+  
+  ctx.atoms = atoms;
+  ctx.doc_mode = FALSE;
+  ctx.doc = NULL;
+  
+  return cape_json__from_buf (buffer, size, &ctx);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_json_from_buf_doc (const char* buffer, number_t size)
+{
+  CapeJsonContext ctx;
+  
+  ctx.atoms = NULL;
+  ctx.doc_mode = TRUE;
+  ctx.doc = NULL;
+  
+  return cape_json__from_buf (buffer, size, &ctx);
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  cape_uint32 pos;        // offset in the buffer, strings start after the quote
+  
+  cape_uint32 len;        // strings, numbers and literals: length, nodes and lists: position after the last child
+  
+  char type;              // '{', '[', '"', '0' for numbers, 'l' for literals
+  
+  char esc;               // the string has escape sequences
+  
+} CapeJsonLazyItem;
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeJsonLazyItem* items;
+  
+  char* buf;
+  
+} CapeJsonLazy;
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_JSON__LAZY_VALUE          0
+#define CAPE_JSON__LAZY_VALUE_OR_END   1
+#define CAPE_JSON__LAZY_KEY            2
+#define CAPE_JSON__LAZY_KEY_OR_END     3
+#define CAPE_JSON__LAZY_NEXT           4
+
+//-----------------------------------------------------------------------------
+
+static CapeJsonLazyItem* cape_json__lazy_push (CapeJsonLazyItem** p_items, number_t* p_size, number_t* p_capacity, char type, number_t pos)
+{
+  CapeJsonLazyItem* item;
+  
+  if (*p_size == *p_capacity)
+  {
+    *p_capacity = *p_capacity ? *p_capacity * 2 : 256;
+    *p_items = realloc (*p_items, *p_capacity * sizeof(CapeJsonLazyItem));
+  }
+  
+  item = *p_items + (*p_size)++;
+  
+  item->pos = (cape_uint32)pos;
+  item->len = 0;
+  item->type = type;
+  item->esc = FALSE;
+  
+  return item;
+}
+
+//-----------------------------------------------------------------------------
+
+// finds the end of the string and terminates it in the buffer, returns the position after the quote
+static number_t cape_json__lazy_string (char* buf, number_t size, number_t i, CapeJsonLazyItem* item)
+{
+  number_t j = i + 1;
+  
+  item->pos = (cape_uint32)j;
+  
+  while (j < size && buf[j])
+  {
+    if (buf[j] == '"')
+    {
+      buf[j] = 0;
+      
+      item->len = (cape_uint32)(j - i - 1);
+      
+      return j + 1;
+    }
+    
+    if (buf[j] == '\\')
+    {
+      item->esc = TRUE;
+      j++;
+    }
+    
+    j++;
+  }
+  
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+// one pass over the buffer, records the position of all values and the end of all nodes and lists
+static int cape_json__lazy_index (char* buf, number_t size, CapeJsonLazyItem** p_items, number_t* p_size)
+{
+  CapeJsonLazyItem* items = NULL;
+  number_t items_size = 0, items_capacity = 0;
+  
+  number_t* stack = NULL;
+  number_t stack_size = 0, stack_capacity = 0;
+  
+  int state = CAPE_JSON__LAZY_VALUE;
+  number_t i = 0;
+  
+  while (i < size && buf[i])
+  {
+    char c = buf[i];
+    
+    if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+    {
+      i++;
+      continue;
+    }
+    
+    switch (state)
+    {
+      case CAPE_JSON__LAZY_VALUE_OR_END:
+      case CAPE_JSON__LAZY_VALUE:
+      {
+        if (c == ']' && state == CAPE_JSON__LAZY_VALUE_OR_END)
+        {
+          goto close;
+        }
+        
+        if (c == '{' || c == '[')
+        {
+          cape_json__lazy_push (&items, &items_size, &items_capacity, c, i);
+          
+          if (stack_size == stack_capacity)
+          {
+            stack_capacity = stack_capacity ? stack_capacity * 2 : 32;
+            stack = realloc (stack, stack_capacity * sizeof(number_t));
+          }
+          
+          stack[stack_size++] = items_size - 1;
+          
+          state = (c == '{') ? CAPE_JSON__LAZY_KEY_OR_END : CAPE_JSON__LAZY_VALUE_OR_END;
+          i++;
+        }
+        else if (stack_size == 0)
+        {
+          // only nodes and lists are returned
+          goto failed;
+        }
+        else if (c == '"')
+        {
+          i = cape_json__lazy_string (buf, size, i, cape_json__lazy_push (&items, &items_size, &items_capacity, '"', i));
+          
+          if (i < 0)
+          {
+            goto failed;
+          }
+          
+          state = CAPE_JSON__LAZY_NEXT;
+        }
+        else if (c == '-' || (c >= '0' && c <= '9'))
+        {
+          CapeJsonLazyItem* item = cape_json__lazy_push (&items, &items_size, &items_capacity, '0', i);
+          number_t j = i + 1;
+          
+          while (j < size && ((buf[j] >= '0' && buf[j] <= '9') || buf[j] == '.' || buf[j] == 'e' || buf[j] == 'E' || buf[j] == '+' || buf[j] == '-'))
+          {
+            j++;
+          }
+          
+          item->len = (cape_uint32)(j - i);
+          
+          state = CAPE_JSON__LAZY_NEXT;
+          i = j;
+        }
+        else if (c >= 'a' && c <= 'z')
+        {
+          CapeJsonLazyItem* item = cape_json__lazy_push (&items, &items_size, &items_capacity, 'l', i);
+          number_t j = i + 1;
+          
+          while (j < size && buf[j] >= 'a' && buf[j] <= 'z')
+          {
+            j++;
+          }
+          
+          switch (j - i)
+          {
+            case 3:
+            {
+              if (strncmp (buf + i, "nan", 3) && strncmp (buf + i, "inf", 3))
+              {
+                goto failed;
+              }
+              
+              break;
+            }
+            case 4:
+            {
+              if (strncmp (buf + i, "true", 4) && strncmp (buf + i, "null", 4))
+              {
+                goto failed;
+              }
+              
+              break;
+            }
+            case 5:
+            {
+              if (strncmp (buf + i, "false", 5))
+              {
+                goto failed;
+              }
+              
+              break;
+            }
+            default:
+            {
+              goto failed;
+            }
+          }
+          
+          item->len = (cape_uint32)(j - i);
+          
+          state = CAPE_JSON__LAZY_NEXT;
+          i = j;
+        }
+        else
+        {
+          goto failed;
+        }
+        
+        break;
+      }
+      case CAPE_JSON__LAZY_KEY_OR_END:
+      case CAPE_JSON__LAZY_KEY:
+      {
+        if (c == '}' && state == CAPE_JSON__LAZY_KEY_OR_END)
+        {
+          goto close;
+        }
+        
+        if (c != '"')
+        {
+          goto failed;
+        }
+        
+        i = cape_json__lazy_string (buf, size, i, cape_json__lazy_push (&items, &items_size, &items_capacity, '"', i));
+        
+        if (i < 0)
+        {
+          goto failed;
+        }
+        
+        while (i < size && (buf[i] == ' ' || buf[i] == '\n' || buf[i] == '\r' || buf[i] == '\t'))
+        {
+          i++;
+        }
+        
+        if (i == size || buf[i] != ':')
+        {
+          goto failed;
+        }
+        
+        state = CAPE_JSON__LAZY_VALUE;
+        i++;
+        
+        break;
+      }
+      case CAPE_JSON__LAZY_NEXT:
+      {
+        char type;
+        
+        if (stack_size == 0)
+        {
+          // data after the root
+          goto failed;
+        }
+        
+        type = items[stack[stack_size - 1]].type;
+        
+        if (c == ',')
+        {
+          state = (type == '{') ? CAPE_JSON__LAZY_KEY : CAPE_JSON__LAZY_VALUE;
+          i++;
+        }
+        else if (c == (type == '{' ? '}' : ']'))
+        {
+          goto close;
+        }
+        else
+        {
+          goto failed;
+        }
+        
+        break;
+      }
+    }
+    
+    continue;
+    
+  close:
+    
+    stack_size--;
+    
+    items[stack[stack_size]].len = (cape_uint32)items_size;
+    
+    state = CAPE_JSON__LAZY_NEXT;
+    i++;
+  }
+  
+  if (stack_size || items_size == 0)
+  {
+    goto failed;
+  }
+  
+  free (stack);
+  
+  *p_items = items;
+  *p_size = items_size;
+  
+  return TRUE;
+  
+failed:
+  
+  free (stack);
+  free (items);
+  
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+// same conversion as the json parser
+static char* cape_json__lazy_unicode (char* w, unsigned int wc)
+{
+  if (wc <= 0x7f)
+  {
+    *w++ = (char)wc;
+  }
+  else if (wc <= 0x7ff)
+  {
+    *w++ = (char)(0xc0 | (wc >> 6));
+    *w++ = (char)(0x80 | (wc & 0x3f));
+  }
+  else
+  {
+    *w++ = (char)(0xe0 | (wc >> 12));
+    *w++ = (char)(0x80 | ((wc >> 6) & 0x3f));
+    *w++ = (char)(0x80 | (wc & 0x3f));
+  }
+  
+  return w;
+}
+
+//-----------------------------------------------------------------------------
+
+// escape sequences are replaced in the buffer, the result is never longer
+static const char* cape_json__lazy_str (CapeJsonLazy* ctx, CapeJsonLazyItem* item)
+{
+  char* s = ctx->buf + item->pos;
+  
+  if (item->esc)
+  {
+    const char* r = s;
+    const char* e = s + item->len;
+    char* w = s;
+    
+    while (r < e)
+    {
+      if (*r != '\\')
+      {
+        *w++ = *r++;
+        continue;
+      }
+      
+      r++;
+      
+      switch (*r)
+      {
+        case 'n': *w++ = '\n'; break;
+        case 't': *w++ = '\t'; break;
+        case 'r': *w++ = '\r'; break;
+        case 'b': *w++ = '\b'; break;
+        case 'f': *w++ = '\f'; break;
+        case 'u':
+        {
+          if (e - r > 4)
+          {
+            char hex[5];
+            
+            memcpy (hex, r + 1, 4);
+            hex[4] = 0;
+            
+            w = cape_json__lazy_unicode (w, (unsigned int)strtol (hex, NULL, 16));
+            
+            r += 4;
+          }
+          
+          break;
+        }
+        default:
+        {
+          // '"', '\\', '/' and unknown sequences
+          *w++ = *r;
+          break;
+        }
+      }
+      
+      r++;
+    }
+    
+    *w = 0;
+    
+    item->len = (cape_uint32)(w - s);
+    item->esc = FALSE;
+  }
+  
+  return s;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_json__lazy_onLoad (void* ptr, CapeUdc self, number_t pos)
+{
+  CapeJsonLazy* ctx = ptr;
+  
+  int is_node = cape_udc_type (self) == CAPE_UDC_NODE;
+  number_t i = pos + 1;
+  number_t end = ctx->items[pos].len;
+  
+  while (i < end)
+  {
+    const char* name = NULL;
+    CapeJsonLazyItem* item;
+    CapeUdc h = NULL;
+    
+    if (is_node)
+    {
+      name = cape_json__lazy_str (ctx, ctx->items + i);
+      i++;
+    }
+    
+    item = ctx->items + i;
+    
+    switch (item->type)
+    {
+      case '{':
+      case '[':
+      {
+        h = cape_udc_new_ref (self, item->type == '{' ? CAPE_UDC_NODE : CAPE_UDC_LIST, name);
+        
+        // the children are created when they are used
+        cape_udc_set_lazy (h, cape_json__lazy_onLoad, ctx, i);
+        
+        i = item->len;
+        break;
+      }
+      case '"':
+      {
+        const char* s = cape_json__lazy_str (ctx, item);
+        CapeDatetime dt;
+        
+        // same check as the json parser : 2012-04-23T18:25:43.511Z
+        if (item->len == 24 && s[4] == '-' && s[7] == '-' && s[10] == 'T' && s[13] == ':' && s[16] == ':' && s[19] == '.' && s[23] == 'Z' && cape_datetime__std (&dt, s))
+        {
+          h = cape_udc_new_ref (self, CAPE_UDC_DATETIME, name);
+          
+          cape_udc_set_d (h, &dt);
+        }
+        else
+        {
+          h = cape_udc_new_ref (self, CAPE_UDC_STRING, name);
+          
+          // the string stays in the buffer
+          cape_udc_set_s_ref (h, s);
+        }
+        
+        i++;
+        break;
+      }
+      case '0':
+      {
+        const char* s = ctx->buf + item->pos;
+        
+        if (memchr (s, '.', item->len) || memchr (s, 'e', item->len) || memchr (s, 'E', item->len))
+        {
+          h = cape_udc_new_ref (self, CAPE_UDC_FLOAT, name);
+          
+          cape_udc_set_f (h, strtod (s, NULL));
+        }
+        else
+        {
+          h = cape_udc_new_ref (self, CAPE_UDC_NUMBER, name);
+          
+          cape_udc_set_n (h, strtoll (s, NULL, 10));
+        }
+        
+        i++;
+        break;
+      }
+      case 'l':
+      {
+        const char* s = ctx->buf + item->pos;
+        
+        switch (s[0])
+        {
+          case 't':
+          case 'f':
+          {
+            h = cape_udc_new_ref (self, CAPE_UDC_BOOL, name);
+            
+            cape_udc_set_b (h, s[0] == 't');
+            break;
+          }
+          case 'i':
+          case 'n':
+          {
+            // null values are not added, like in the json parser
+            if (s[1] != 'u')
+            {
+              h = cape_udc_new_ref (self, CAPE_UDC_FLOAT, name);
+              
+              cape_udc_set_f (h, s[0] == 'n' ? CAPE_MATH_NAN : CAPE_MATH_INFINITY);
+            }
+            
+            break;
+          }
+        }
+        
+        i++;
+        break;
+      }
+      default:
+      {
+        i++;
+        break;
+      }
+    }
+    
+    if (h)
+    {
+      cape_udc_add (self, &h);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_json_from_buf_lazy (const char* buffer, number_t size)
+{
+  CapeUdc ret;
+  CapeArena arena;
+  CapeJsonLazy* ctx;
+  CapeJsonLazyItem* items;
+  number_t items_size, i;
+  
+  if (buffer == NULL)
+  {
+    return NULL;
+  }
+  
+  if (size > 0xffffffffL)
+  {
+    // the positions of the index have 32 bit
+    return cape_json_from_buf_doc (buffer, size);
+  }
+  
+  for (i = 0; i < size && (buffer[i] == ' ' || buffer[i] == '\n' || buffer[i] == '\r' || buffer[i] == '\t'); i++);
+  
+  if (i == size || (buffer[i] != '{' && buffer[i] != '['))
+  {
+    return NULL;
+  }
+  
+  // the copy of the buffer and the index are part of the document
+  ret = cape_udc_new_doc (buffer[i] == '{' ? CAPE_UDC_NODE : CAPE_UDC_LIST, NULL);
+  arena = cape_udc_arena (ret);
+  
+  ctx = cape_arena_alloc (arena, sizeof(CapeJsonLazy));
+  
+  ctx->buf = cape_arena_buf (arena, buffer, size);
+  
+  if (!cape_json__lazy_index (ctx->buf, size, &items, &items_size))
+  {
+    cape_udc_del (&ret);
+    return NULL;
+  }
+  
+  ctx->items = cape_arena_alloc (arena, items_size * sizeof(CapeJsonLazyItem));
+  
+  memcpy (ctx->items, items, items_size * sizeof(CapeJsonLazyItem));
+  
+  free (items);
+  
+  cape_udc_set_lazy (ret, cape_json__lazy_onLoad, ctx, 0);
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_json_from_s (const CapeString source)
 {
   if (source)
@@ -531,11 +1225,18 @@ void cape_json_fill (CapeStream stream, const CapeUdc node)
 
 CapeString cape_json_to_s (const CapeUdc source)
 {
-  CapeStream stream = cape_stream_new ();
+  CapeString ret;
+  
+  // reuse the buffer of a pooled stream, the result is copied with the exact size
+  CapeStream stream = cape_stream_pool_get ();
   
   cape_json_fill (stream, source);
   
-  return cape_stream_to_str (&stream);
+  ret = cape_stream_to_s (stream);
+  
+  cape_stream_pool_put (&stream);
+  
+  return ret;
 }
 
 //-----------------------------------------------------------------------------
@@ -622,27 +1323,22 @@ int cape_json_to_file (const CapeString file, const CapeUdc source, CapeErr err)
   }
 
   {
-    number_t bytes_to_write;
-    number_t bytes_cn_write;
-    const char* buf;
-    CapeStream stream = cape_stream_new ();
+    // large exports grow without copying, the chunks are written with writev
+    CapeStream stream = cape_stream_new_seg (0);
   
     cape_json_fill (stream, source);
   
-    buf = cape_stream_data (stream);
-
-    bytes_to_write = cape_stream_size (stream);
-    bytes_cn_write = 0;
-    
-    while (bytes_cn_write < bytes_to_write)
+    if (cape_fh_write_stream (fh, stream) < 0)
     {
-      bytes_cn_write += cape_fh_write_buf (fh, buf + bytes_cn_write, bytes_to_write - bytes_cn_write);
+      res = cape_err_lastOSError (err);
+    }
+    else
+    {
+      res = CAPE_ERR_NONE;
     }
     
     cape_stream_del (&stream);
   }
-    
-  res = CAPE_ERR_NONE;
   
 exit_and_cleanup:  
   
@@ -4,6 +4,7 @@
 #include "sys/cape_export.h"
 #include "sys/cape_types.h"
 #include "stc/cape_udc.h"
+#include "stc/cape_atom.h"
 #include "sys/cape_err.h"
 
 //-----------------------------------------------------------------------------
@@ -12,6 +13,17 @@ __CAPE_LIBEX   CapeUdc           cape_json_from_s           (const CapeString);
 
 __CAPE_LIBEX   CapeUdc           cape_json_from_buf         (const char* buffer, number_t size);
 
+                                 // all names of the nodes are interned in the atom table, the table can be shared by documents
+__CAPE_LIBEX   CapeUdc           cape_json_from_buf_ex      (const char* buffer, number_t size, CapeAtoms atoms);
+
+                                 // returns a document udc (see cape_udc_new_doc), all nodes are released together
+__CAPE_LIBEX   CapeUdc           cape_json_from_buf_doc     (const char* buffer, number_t size);
+
+                                 /* returns a lazy document udc, the buffer is copied into the document and indexed in one pass
+                                    -> nodes and lists are created when they are used the first time (see cape_udc_set_lazy)
+                                    -> strings stay in the copy of the buffer, they are terminated in place */
+__CAPE_LIBEX   CapeUdc           cape_json_from_buf_lazy    (const char* buffer, number_t size);
+
 __CAPE_LIBEX   CapeString        cape_json_to_s             (const CapeUdc source);
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,809 @@
+#include "cape_msgpack.h"
+
+// c includes
+#include <string.h>
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_MSGPACK__MAX_DEPTH     512       // protects the stack against nested data
+#define CAPE_MSGPACK__TIMESTAMP     -1        // the extension type of timestamps
+#define CAPE_MSGPACK__NAME_SIZE     128       // names up to this size don't need an allocation
+
+//=============================================================================
+
+// days since 1970-01-01 of the proleptic gregorian calendar
+static number_t cape_msgpack__days (number_t y, number_t m, number_t d)
+{
+  number_t era, yoe, doy, doe;
+
+  y -= m <= 2;
+
+  era = (y >= 0 ? y : y - 399) / 400;
+  yoe = y - era * 400;
+  doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return era * 146097 + doe - 719468;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_msgpack__date (CapeDatetime* dt, number_t days)
+{
+  number_t era, doe, yoe, doy, mp, y, m;
+
+  days += 719468;
+
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  doe = days - era * 146097;
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  mp = (5 * doy + 2) / 153;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+
+  dt->day = (unsigned int)(doy - (153 * mp + 2) / 5 + 1);
+  dt->month = (unsigned int)m;
+  dt->year = (unsigned int)y;
+}
+
+//=============================================================================
+
+void cape_msgpack_append_map (CapeStream self, number_t size)
+{
+  if (size < 16)
+  {
+    cape_stream_append_08 (self, 0x80 | (cape_uint8)size);
+  }
+  else if (size < 0x10000)
+  {
+    cape_stream_append_08 (self, 0xde);
+    cape_stream_append_16 (self, (cape_uint16)size, TRUE);
+  }
+  else
+  {
+    cape_stream_append_08 (self, 0xdf);
+    cape_stream_append_32 (self, (cape_uint32)size, TRUE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_array (CapeStream self, number_t size)
+{
+  if (size < 16)
+  {
+    cape_stream_append_08 (self, 0x90 | (cape_uint8)size);
+  }
+  else if (size < 0x10000)
+  {
+    cape_stream_append_08 (self, 0xdc);
+    cape_stream_append_16 (self, (cape_uint16)size, TRUE);
+  }
+  else
+  {
+    cape_stream_append_08 (self, 0xdd);
+    cape_stream_append_32 (self, (cape_uint32)size, TRUE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_s (CapeStream self, const char* s, number_t len)
+{
+  if (len < 32)
+  {
+    cape_stream_append_08 (self, 0xa0 | (cape_uint8)len);
+  }
+  else if (len < 0x100)
+  {
+    cape_stream_append_08 (self, 0xd9);
+    cape_stream_append_08 (self, (cape_uint8)len);
+  }
+  else if (len < 0x10000)
+  {
+    cape_stream_append_08 (self, 0xda);
+    cape_stream_append_16 (self, (cape_uint16)len, TRUE);
+  }
+  else
+  {
+    cape_stream_append_08 (self, 0xdb);
+    cape_stream_append_32 (self, (cape_uint32)len, TRUE);
+  }
+
+  if (len)
+  {
+    cape_stream_append_buf (self, s, len);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_n (CapeStream self, number_t val)
+{
+  if (val >= 0)
+  {
+    if (val < 0x80)
+    {
+      // positive fixint
+      cape_stream_append_08 (self, (cape_uint8)val);
+    }
+    else if (val < 0x100)
+    {
+      cape_stream_append_08 (self, 0xcc);
+      cape_stream_append_08 (self, (cape_uint8)val);
+    }
+    else if (val < 0x10000)
+    {
+      cape_stream_append_08 (self, 0xcd);
+      cape_stream_append_16 (self, (cape_uint16)val, TRUE);
+    }
+    else if (val <= 0xffffffffL)
+    {
+      cape_stream_append_08 (self, 0xce);
+      cape_stream_append_32 (self, (cape_uint32)val, TRUE);
+    }
+    else
+    {
+      cape_stream_append_08 (self, 0xcf);
+      cape_stream_append_64 (self, (cape_uint64)val, TRUE);
+    }
+  }
+  else
+  {
+    if (val >= -32)
+    {
+      // negative fixint
+      cape_stream_append_08 (self, (cape_uint8)val);
+    }
+    else if (val >= -128)
+    {
+      cape_stream_append_08 (self, 0xd0);
+      cape_stream_append_08 (self, (cape_uint8)val);
+    }
+    else if (val >= -32768)
+    {
+      cape_stream_append_08 (self, 0xd1);
+      cape_stream_append_16 (self, (cape_uint16)val, TRUE);
+    }
+    else if (val >= -2147483647L - 1)
+    {
+      cape_stream_append_08 (self, 0xd2);
+      cape_stream_append_32 (self, (cape_uint32)val, TRUE);
+    }
+    else
+    {
+      cape_stream_append_08 (self, 0xd3);
+      cape_stream_append_64 (self, (cape_uint64)val, TRUE);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_f (CapeStream self, double val)
+{
+  cape_stream_append_08 (self, 0xcb);
+  cape_stream_append_bd (self, val, TRUE);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_b (CapeStream self, int val)
+{
+  cape_stream_append_08 (self, val ? 0xc3 : 0xc2);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_z (CapeStream self)
+{
+  cape_stream_append_08 (self, 0xc0);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append_d (CapeStream self, const CapeDatetime* dt)
+{
+  number_t sec;
+  cape_uint32 nsec;
+
+  if (dt == NULL)
+  {
+    cape_msgpack_append_z (self);
+    return;
+  }
+
+  sec = cape_msgpack__days (dt->year, dt->month, dt->day) * 86400 + dt->hour * 3600 + dt->minute * 60 + dt->sec;
+
+  // usec has the full fraction if it is set
+  nsec = dt->usec ? (dt->usec % 1000000) * 1000 : (dt->msec % 1000) * 1000000;
+
+  if (nsec == 0 && sec >= 0 && sec <= 0xffffffffL)
+  {
+    // timestamp 32
+    cape_stream_append_08 (self, 0xd6);
+    cape_stream_append_08 (self, (cape_uint8)CAPE_MSGPACK__TIMESTAMP);
+    cape_stream_append_32 (self, (cape_uint32)sec, TRUE);
+  }
+  else if (sec >= 0 && sec < ((number_t)1 << 34))
+  {
+    // timestamp 64
+    cape_stream_append_08 (self, 0xd7);
+    cape_stream_append_08 (self, (cape_uint8)CAPE_MSGPACK__TIMESTAMP);
+    cape_stream_append_64 (self, ((cape_uint64)nsec << 34) | (cape_uint64)sec, TRUE);
+  }
+  else
+  {
+    // timestamp 96
+    cape_stream_append_08 (self, 0xc7);
+    cape_stream_append_08 (self, 12);
+    cape_stream_append_08 (self, (cape_uint8)CAPE_MSGPACK__TIMESTAMP);
+    cape_stream_append_32 (self, nsec, TRUE);
+    cape_stream_append_64 (self, (cape_uint64)sec, TRUE);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_msgpack_append (CapeStream self, const CapeUdc source)
+{
+  switch (cape_udc_type (source))
+  {
+    case CAPE_UDC_NODE:
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (source, CAPE_DIRECTION_FORW);
+
+      cape_msgpack_append_map (self, cape_udc_size (source));
+
+      while (cape_udc_cursor_next (cursor))
+      {
+        const char* name = cape_udc_name (cursor->item);
+
+        cape_msgpack_append_s (self, name, name ? strlen (name) : 0);
+        cape_msgpack_append (self, cursor->item);
+      }
+
+      cape_udc_cursor_del (&cursor);
+      break;
+    }
+    case CAPE_UDC_LIST:
+    {
+      CapeUdcCursor* cursor = cape_udc_cursor_new (source, CAPE_DIRECTION_FORW);
+
+      cape_msgpack_append_array (self, cape_udc_size (source));
+
+      while (cape_udc_cursor_next (cursor))
+      {
+        cape_msgpack_append (self, cursor->item);
+      }
+
+      cape_udc_cursor_del (&cursor);
+      break;
+    }
+    case CAPE_UDC_STRING:
+    {
+      const char* h = cape_udc_s (source, NULL);
+
+      cape_msgpack_append_s (self, h, h ? strlen (h) : 0);
+      break;
+    }
+    case CAPE_UDC_NUMBER:
+    {
+      cape_msgpack_append_n (self, cape_udc_n (source, 0));
+      break;
+    }
+    case CAPE_UDC_FLOAT:
+    {
+      cape_msgpack_append_f (self, cape_udc_f (source, 0));
+      break;
+    }
+    case CAPE_UDC_BOOL:
+    {
+      cape_msgpack_append_b (self, cape_udc_b (source, FALSE));
+      break;
+    }
+    case CAPE_UDC_DATETIME:
+    {
+      cape_msgpack_append_d (self, cape_udc_d (source, NULL));
+      break;
+    }
+    default:
+    {
+      cape_msgpack_append_z (self);
+      break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeStream cape_msgpack_to_stream (const CapeUdc source)
+{
+  CapeStream self = cape_stream_new ();
+
+  if (source)
+  {
+    cape_msgpack_append (self, source);
+  }
+
+  return self;
+}
+
+//=============================================================================
+
+// reads a big endian unsigned value of 1, 2, 4 or 8 bytes
+static int cape_msgpack__u (CapeCursor cursor, int bytes, cape_uint64* p_val, CapeErr err)
+{
+  *p_val = 0;
+
+  if (!cape_cursor__has_data (cursor, bytes))
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+  }
+
+  switch (bytes)
+  {
+    case 1: *p_val = cape_cursor_scan_08 (cursor); break;
+    case 2: *p_val = cape_cursor_scan_16 (cursor, TRUE); break;
+    case 4: *p_val = cape_cursor_scan_32 (cursor, TRUE); break;
+    case 8: *p_val = cape_cursor_scan_64 (cursor, TRUE); break;
+  }
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_msgpack__str (CapeCursor cursor, int bytes, CapeMsgpackItem* item, CapeErr err)
+{
+  cape_uint64 len;
+
+  int res = cape_msgpack__u (cursor, bytes, &len, err);
+  if (res)
+  {
+    return res;
+  }
+
+  item->type = CAPE_UDC_STRING;
+  item->size = (number_t)len;
+  item->s = cape_cursor_scan_p (cursor, item->size);
+
+  if (item->s == NULL)
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+  }
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_msgpack__ext (CapeCursor cursor, number_t len, CapeMsgpackItem* item, CapeErr err)
+{
+  number_t sec;
+  cape_uint32 nsec;
+
+  if (len < 0 || !cape_cursor__has_data (cursor, len + 1))
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+  }
+
+  if ((signed char)cape_cursor_scan_08 (cursor) != CAPE_MSGPACK__TIMESTAMP)
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "unsupported extension type");
+  }
+
+  switch (len)
+  {
+    case 4:
+    {
+      sec = cape_cursor_scan_32 (cursor, TRUE);
+      nsec = 0;
+      break;
+    }
+    case 8:
+    {
+      cape_uint64 v = cape_cursor_scan_64 (cursor, TRUE);
+
+      nsec = (cape_uint32)(v >> 34);
+      sec = (number_t)(v & (((cape_uint64)1 << 34) - 1));
+      break;
+    }
+    case 12:
+    {
+      nsec = cape_cursor_scan_32 (cursor, TRUE);
+      sec = (number_t)cape_cursor_scan_64 (cursor, TRUE);
+      break;
+    }
+    default:
+    {
+      return cape_err_set (err, CAPE_ERR_PARSER, "invalid timestamp");
+    }
+  }
+
+  if (nsec >= 1000000000)
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "invalid timestamp");
+  }
+
+  memset (&(item->d), 0, sizeof(CapeDatetime));
+
+  {
+    // floor division for times before 1970
+    number_t days = (sec >= 0 ? sec : sec - 86399) / 86400;
+    number_t rest = sec - days * 86400;
+
+    cape_msgpack__date (&(item->d), days);
+
+    item->d.hour = (unsigned int)(rest / 3600);
+    item->d.minute = (unsigned int)(rest % 3600 / 60);
+    item->d.sec = (unsigned int)(rest % 60);
+  }
+
+  item->d.msec = nsec / 1000000;
+
+  // only a fraction finer than milliseconds needs usec
+  item->d.usec = (nsec % 1000000) ? nsec / 1000 : 0;
+
+  item->d.is_utc = TRUE;
+
+  item->type = CAPE_UDC_DATETIME;
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_msgpack_next (CapeCursor cursor, CapeMsgpackItem* item, CapeErr err)
+{
+  int res;
+  cape_uint8 c;
+  cape_uint64 v;
+
+  if (!cape_cursor__has_data (cursor, 1))
+  {
+    return cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+  }
+
+  c = cape_cursor_scan_08 (cursor);
+
+  item->size = 0;
+
+  if (c < 0x80)
+  {
+    item->type = CAPE_UDC_NUMBER;
+    item->n = c;
+
+    return CAPE_ERR_NONE;
+  }
+
+  if (c < 0x90)
+  {
+    item->type = CAPE_UDC_NODE;
+    item->size = c & 0x0f;
+
+    return CAPE_ERR_NONE;
+  }
+
+  if (c < 0xa0)
+  {
+    item->type = CAPE_UDC_LIST;
+    item->size = c & 0x0f;
+
+    return CAPE_ERR_NONE;
+  }
+
+  if (c < 0xc0)
+  {
+    item->type = CAPE_UDC_STRING;
+    item->size = c & 0x1f;
+    item->s = cape_cursor_scan_p (cursor, item->size);
+
+    return item->s ? CAPE_ERR_NONE : cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+  }
+
+  if (c >= 0xe0)
+  {
+    item->type = CAPE_UDC_NUMBER;
+    item->n = (signed char)c;
+
+    return CAPE_ERR_NONE;
+  }
+
+  switch (c)
+  {
+    case 0xc0:
+    {
+      item->type = CAPE_UDC_NULL;
+      return CAPE_ERR_NONE;
+    }
+    case 0xc2:
+    case 0xc3:
+    {
+      item->type = CAPE_UDC_BOOL;
+      item->n = c == 0xc3;
+      return CAPE_ERR_NONE;
+    }
+    // binary data is handled as string
+    case 0xc4: return cape_msgpack__str (cursor, 1, item, err);
+    case 0xc5: return cape_msgpack__str (cursor, 2, item, err);
+    case 0xc6: return cape_msgpack__str (cursor, 4, item, err);
+    case 0xc7:
+    case 0xc8:
+    case 0xc9:
+    {
+      res = cape_msgpack__u (cursor, 1 << (c - 0xc7), &v, err);
+      if (res)
+      {
+        return res;
+      }
+
+      return cape_msgpack__ext (cursor, (number_t)v, item, err);
+    }
+    case 0xca:
+    {
+      float h;
+      cape_uint32 u;
+
+      res = cape_msgpack__u (cursor, 4, &v, err);
+      if (res)
+      {
+        return res;
+      }
+
+      u = (cape_uint32)v;
+      memcpy (&h, &u, 4);
+
+      item->type = CAPE_UDC_FLOAT;
+      item->f = h;
+      return CAPE_ERR_NONE;
+    }
+    case 0xcb:
+    {
+      if (!cape_cursor__has_data (cursor, 8))
+      {
+        return cape_err_set (err, CAPE_ERR_PARSER, "unexpected end of data");
+      }
+
+      item->type = CAPE_UDC_FLOAT;
+      item->f = cape_cursor_scan_bd (cursor, TRUE);
+      return CAPE_ERR_NONE;
+    }
+    case 0xcc:
+    case 0xcd:
+    case 0xce:
+    case 0xcf:
+    {
+      res = cape_msgpack__u (cursor, 1 << (c - 0xcc), &v, err);
+      if (res)
+      {
+        return res;
+      }
+
+      // values above the range of number_t wrap around
+      item->type = CAPE_UDC_NUMBER;
+      item->n = (number_t)v;
+      return CAPE_ERR_NONE;
+    }
+    case 0xd0:
+    case 0xd1:
+    case 0xd2:
+    case 0xd3:
+    {
+      res = cape_msgpack__u (cursor, 1 << (c - 0xd0), &v, err);
+      if (res)
+      {
+        return res;
+      }
+
+      item->type = CAPE_UDC_NUMBER;
+
+      switch (c)
+      {
+        case 0xd0: item->n = (signed char)v; break;
+        case 0xd1: item->n = (short)v; break;
+        case 0xd2: item->n = (cape_int32)v; break;
+        case 0xd3: item->n = (number_t)v; break;
+      }
+
+      return CAPE_ERR_NONE;
+    }
+    case 0xd4:
+    case 0xd5:
+    case 0xd6:
+    case 0xd7:
+    case 0xd8:
+    {
+      return cape_msgpack__ext (cursor, 1 << (c - 0xd4), item, err);
+    }
+    case 0xd9: return cape_msgpack__str (cursor, 1, item, err);
+    case 0xda: return cape_msgpack__str (cursor, 2, item, err);
+    case 0xdb: return cape_msgpack__str (cursor, 4, item, err);
+    case 0xdc:
+    case 0xdd:
+    case 0xde:
+    case 0xdf:
+    {
+      res = cape_msgpack__u (cursor, (c & 1) ? 4 : 2, &v, err);
+      if (res)
+      {
+        return res;
+      }
+
+      item->type = c < 0xde ? CAPE_UDC_LIST : CAPE_UDC_NODE;
+      item->size = (number_t)v;
+      return CAPE_ERR_NONE;
+    }
+  }
+
+  return cape_err_set_fmt (err, CAPE_ERR_PARSER, "invalid format byte 0x%02x", c);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc cape_msgpack__udc (CapeCursor cursor, const char* name, number_t depth, CapeErr err)
+{
+  CapeMsgpackItem item;
+  CapeUdc self;
+  number_t i;
+
+  if (depth > CAPE_MSGPACK__MAX_DEPTH)
+  {
+    cape_err_set (err, CAPE_ERR_PARSER, "maximum depth reached");
+    return NULL;
+  }
+
+  if (cape_msgpack_next (cursor, &item, err))
+  {
+    return NULL;
+  }
+
+  self = cape_udc_new (item.type, name);
+
+  switch (item.type)
+  {
+    case CAPE_UDC_NODE:
+    {
+      for (i = 0; i < item.size; i++)
+      {
+        CapeMsgpackItem key;
+        CapeUdc h;
+        char buf[CAPE_MSGPACK__NAME_SIZE];
+        char* key_name = buf;
+
+        if (cape_msgpack_next (cursor, &key, err))
+        {
+          cape_udc_del (&self);
+          return NULL;
+        }
+
+        switch (key.type)
+        {
+          case CAPE_UDC_STRING:
+          {
+            // the name must be terminated
+            if (key.size >= CAPE_MSGPACK__NAME_SIZE)
+            {
+              key_name = cape_str_sub (key.s, key.size);
+            }
+            else
+            {
+              memcpy (buf, key.s, key.size);
+              buf[key.size] = 0;
+            }
+
+            break;
+          }
+          case CAPE_UDC_NUMBER:
+          {
+            snprintf (buf, CAPE_MSGPACK__NAME_SIZE, "%li", key.n);
+            break;
+          }
+          default:
+          {
+            cape_err_set (err, CAPE_ERR_PARSER, "unsupported type of key");
+
+            cape_udc_del (&self);
+            return NULL;
+          }
+        }
+
+        h = cape_msgpack__udc (cursor, key_name, depth + 1, err);
+
+        if (key_name != buf)
+        {
+          cape_str_del (&key_name);
+        }
+
+        if (h == NULL)
+        {
+          cape_udc_del (&self);
+          return NULL;
+        }
+
+        cape_udc_add (self, &h);
+      }
+
+      break;
+    }
+    case CAPE_UDC_LIST:
+    {
+      for (i = 0; i < item.size; i++)
+      {
+        CapeUdc h = cape_msgpack__udc (cursor, NULL, depth + 1, err);
+
+        if (h == NULL)
+        {
+          cape_udc_del (&self);
+          return NULL;
+        }
+
+        cape_udc_add (self, &h);
+      }
+
+      break;
+    }
+    case CAPE_UDC_STRING:
+    {
+      CapeString h = cape_str_sub (item.s, item.size);
+
+      cape_udc_set_s_mv (self, &h);
+      break;
+    }
+    case CAPE_UDC_NUMBER:
+    {
+      cape_udc_set_n (self, item.n);
+      break;
+    }
+    case CAPE_UDC_FLOAT:
+    {
+      cape_udc_set_f (self, item.f);
+      break;
+    }
+    case CAPE_UDC_BOOL:
+    {
+      cape_udc_set_b (self, (int)item.n);
+      break;
+    }
+    case CAPE_UDC_DATETIME:
+    {
+      cape_udc_set_d (self, &(item.d));
+      break;
+    }
+  }
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_msgpack_from_cursor (CapeCursor cursor, CapeErr err)
+{
+  return cape_msgpack__udc (cursor, NULL, 0, err);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_msgpack_from_buf (const char* buffer, number_t size, CapeErr err)
+{
+  CapeUdc ret;
+  CapeCursor cursor = cape_cursor_new ();
+
+  cape_cursor_set (cursor, buffer, size);
+
+  ret = cape_msgpack__udc (cursor, NULL, 0, err);
+
+  if (ret && cape_cursor_tail (cursor))
+  {
+    cape_err_set (err, CAPE_ERR_PARSER, "data after the value");
+    cape_udc_del (&ret);
+  }
+
+  cape_cursor_del (&cursor);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+#ifndef __CAPE_FMT__MSGPACK__H
+#define __CAPE_FMT__MSGPACK__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "sys/cape_err.h"
+#include "sys/cape_time.h"
+#include "stc/cape_udc.h"
+#include "stc/cape_stream.h"
+#include "stc/cape_cursor.h"
+
+//=============================================================================
+
+/* this module implements the MessagePack binary format for udcs
+ *
+ * -> nodes are maps with string keys, lists are arrays, the names of list
+ *    items are not written
+ * -> numbers use the smallest integer format, floats are written with 64 bit
+ * -> datetimes use the timestamp extension (type -1), the fields are taken as
+ *    UTC with a precision of microseconds
+ * -> all formats of the specification are read, binary data becomes a string,
+ *    integer keys of maps become names, other extensions are an error
+ * -> the reader (cape_msgpack_next) returns one value after the other without
+ *    any allocation, strings point into the buffer and are not terminated
+ */
+
+//=============================================================================
+
+typedef struct
+{
+  u_t type;                   // one of CAPE_UDC_*
+
+  number_t size;              // nodes: number of key value pairs, lists: number of items, strings: length in bytes
+
+  const char* s;              // strings: points into the buffer, not terminated
+
+  number_t n;                 // numbers and bools
+
+  double f;                   // floats
+
+  CapeDatetime d;             // datetimes
+
+} CapeMsgpackItem;
+
+//-----------------------------------------------------------------------------
+// write values directly into the stream
+
+__CAPE_LIBEX   void              cape_msgpack_append_map    (CapeStream, number_t size);   // followed by size key value pairs
+
+__CAPE_LIBEX   void              cape_msgpack_append_array  (CapeStream, number_t size);   // followed by size values
+
+__CAPE_LIBEX   void              cape_msgpack_append_s      (CapeStream, const char* s, number_t len);
+
+__CAPE_LIBEX   void              cape_msgpack_append_n      (CapeStream, number_t);
+
+__CAPE_LIBEX   void              cape_msgpack_append_f      (CapeStream, double);
+
+__CAPE_LIBEX   void              cape_msgpack_append_b      (CapeStream, int);
+
+__CAPE_LIBEX   void              cape_msgpack_append_z      (CapeStream);
+
+__CAPE_LIBEX   void              cape_msgpack_append_d      (CapeStream, const CapeDatetime*);
+
+//-----------------------------------------------------------------------------
+
+                                 // appends the udc with all children
+__CAPE_LIBEX   void              cape_msgpack_append        (CapeStream, const CapeUdc source);
+
+__CAPE_LIBEX   CapeStream        cape_msgpack_to_stream     (const CapeUdc source);
+
+//-----------------------------------------------------------------------------
+
+                                 // reads the next value at the cursor, the children of nodes and lists follow
+__CAPE_LIBEX   int               cape_msgpack_next          (CapeCursor, CapeMsgpackItem*, CapeErr err);
+
+                                 // reads one value with all children at the cursor, more values might follow
+__CAPE_LIBEX   CapeUdc           cape_msgpack_from_cursor   (CapeCursor, CapeErr err);
+
+                                 // the buffer must contain exactly one value
+__CAPE_LIBEX   CapeUdc           cape_msgpack_from_buf      (const char* buffer, number_t size, CapeErr err);
+
+//-----------------------------------------------------------------------------
+
+#endif
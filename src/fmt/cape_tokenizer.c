@@ -1,4 +1,5 @@
 #include "cape_tokenizer.h"
+#include "stc/cape_utf8.h"
 
 // c includes
 #include <string.h>
@@ -111,6 +112,25 @@ CapeList cape_tokenizer_str_utf8 (const CapeString haystack, const CapeString ne
   number_t plh_size = 0;
 
   number_t len = cape_str_size (needle);
+  number_t size = cape_str_size (haystack);
+  
+  if (len && cape_utf8_check (haystack, size, NULL) && cape_utf8_check (needle, len, NULL))
+  {
+    const char* pos = haystack;
+    const char* found;
+    
+    // the string is checked only once
+    while ((found = cape_utf8_find (pos, haystack + size - pos, needle, len)))
+    {
+      plh_len += cape_utf8_count (pos, found - pos);
+      
+      cape_list_push_back (ret, (void*)plh_len);
+      
+      pos = found + len;
+    }
+    
+    return ret;
+  }
   
   while (cape_str_find_utf8 (haystack + plh_size, needle, &pos_len, &pos_size))
   {
@@ -0,0 +1,260 @@
+#ifndef __CAPE_AIO__HPP__H
+#define __CAPE_AIO__HPP__H 1
+
+#include <aio/cape_aio_task.h>
+#include <sys/cape_log.h>
+#include <hpp/cape_stc.hpp>
+
+// coroutines need C++20
+#if __cplusplus >= 202002L && defined __has_include
+#if __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#define CAPE_HPP_COROUTINES 1
+
+namespace cape
+{
+  //-----------------------------------------------------------------------------------------------------
+  
+  /*
+   * return type of a coroutine which runs as CapeAioTask on the reactor thread
+   * -> the first parameter of the coroutine must be the CapeAioTask, ownership moves to the coroutine
+   * -> the coroutine starts as soon as it was called
+   *
+   *   cape::AioTask session (CapeAioTask task, ...)
+   *   {
+   *     auto data = co_await cape::aio_recv (task);
+   *     auto res = co_await cape::aio_offload (task, queue, [&]() { return compute (data); });
+   *     co_await cape::aio_send (task, res.data(), res.size());
+   *   }
+   */
+  class AioTask
+  {
+  
+  public:
+    
+    struct promise_type
+    {
+      template <typename... Args> promise_type (CapeAioTask task, Args&&...) : m_task (task)
+      {
+      }
+      
+      AioTask get_return_object ()
+      {
+        auto h = std::coroutine_handle<promise_type>::from_promise (*this);
+        
+        cape_aio_task_callback (m_task, h.address(), AioTask::on_run, NULL);
+        
+        return AioTask ();
+      }
+      
+      struct Start
+      {
+        CapeAioTask task;
+        
+        bool await_ready () { return false; }
+        
+        // the coroutine is suspended now, it is safe to hand it over to the reactor
+        void await_suspend (std::coroutine_handle<>) { cape_aio_task_start (&task); }
+        
+        void await_resume () {}
+      };
+      
+      Start initial_suspend () { return Start {m_task}; }
+      
+      // keep the frame, it is destroyed by on_run
+      std::suspend_always final_suspend () noexcept { return {}; }
+      
+      void return_void () {}
+      
+      void unhandled_exception ()
+      {
+        try
+        {
+          std::rethrow_exception (std::current_exception());
+        }
+        catch (std::exception& e)
+        {
+          cape_log_fmt (CAPE_LL_ERROR, "CAPE", "aio task", "unhandled exception: %s", e.what());
+        }
+        catch (...)
+        {
+          cape_log_msg (CAPE_LL_ERROR, "CAPE", "aio task", "unhandled exception");
+        }
+      }
+      
+      CapeAioTask m_task;
+    };
+  
+  private:
+    
+    static int __STDCALL on_run (void* ptr, CapeAioTask)
+    {
+      auto h = std::coroutine_handle<promise_type>::from_address (ptr);
+      
+      h.resume ();
+      
+      if (h.done ())
+      {
+        h.destroy ();
+        
+        return CAPE_AIO_TASK_DONE;
+      }
+      
+      return CAPE_AIO_TASK_WAIT;
+    }
+  };
+  
+  //-----------------------------------------------------------------------------------------------------
+  
+  struct AioRecv
+  {
+    CapeAioTask task;
+    
+    bool await_ready () { return false; }
+    
+    bool await_suspend (std::coroutine_handle<>) { return cape_aio_task_recv (task) == TRUE; }
+    
+    // empty view if the connection was closed, valid until the next co_await
+    std::string_view await_resume ()
+    {
+      number_t len;
+      
+      const char* data = cape_aio_task_data (task, &len);
+      
+      return data ? std::string_view (data, len) : std::string_view ();
+    }
+  };
+  
+  inline AioRecv aio_recv (CapeAioTask task) { return AioRecv {task}; }
+  
+  //-----------------------------------------------------------------------------------------------------
+  
+  struct AioSend
+  {
+    CapeAioTask task;
+    
+    const char* bufdat;
+    
+    number_t buflen;
+    
+    bool await_ready () { return false; }
+    
+    bool await_suspend (std::coroutine_handle<>) { return cape_aio_task_send (task, bufdat, buflen) == TRUE; }
+    
+    void await_resume () {}
+  };
+  
+  inline AioSend aio_send (CapeAioTask task, const char* bufdat, number_t buflen) { return AioSend {task, bufdat, buflen}; }
+  
+  //-----------------------------------------------------------------------------------------------------
+  
+  struct AioSleep
+  {
+    CapeAioTask task;
+    
+    long timeout_in_ms;
+    
+    bool await_ready () { return false; }
+    
+    bool await_suspend (std::coroutine_handle<>) { return cape_aio_task_sleep (task, timeout_in_ms) == TRUE; }
+    
+    void await_resume () {}
+  };
+  
+  inline AioSleep aio_sleep (CapeAioTask task, long timeout_in_ms) { return AioSleep {task, timeout_in_ms}; }
+  
+  //-----------------------------------------------------------------------------------------------------
+  
+  // runs the function on a worker of the queue, the awaiter lives in the coroutine frame
+  template <typename F> struct AioOffload
+  {
+    typedef typename std::invoke_result<F&>::type R;
+    
+    typedef typename std::conditional<std::is_void<R>::value, int, R>::type V;
+    
+    CapeAioTask task;
+    
+    CapeQueue queue;
+    
+    F fct;
+    
+    V value;
+    
+    std::exception_ptr exception;
+    
+    static void* __STDCALL on_event (void* ptr, number_t, CapeErr)
+    {
+      AioOffload* self = static_cast<AioOffload*>(ptr);
+      
+      try
+      {
+        if constexpr (std::is_void<R>::value)
+        {
+          self->fct ();
+        }
+        else
+        {
+          self->value = self->fct ();
+        }
+      }
+      catch (...)
+      {
+        self->exception = std::current_exception ();
+      }
+      
+      return NULL;
+    }
+    
+    bool await_ready () { return false; }
+    
+    bool await_suspend (std::coroutine_handle<>) { return cape_aio_task_offload (task, queue, on_event, this) == TRUE; }
+    
+    R await_resume ()
+    {
+      if (exception)
+      {
+        std::rethrow_exception (exception);
+      }
+      
+      {
+        CapeErr err = cape_err_new ();
+        
+        cape_aio_task_result (task, err);
+        
+        number_t err_code = cape_err_code (err);
+        std::string err_text (err_code ? cape_err_text (err) : "");
+        
+        cape_err_del (&err);
+        
+        // the function was never called, there is no value
+        if (err_code)
+        {
+          throw cape::Exception (err_code, err_text.c_str());
+        }
+      }
+      
+      if constexpr (!std::is_void<R>::value)
+      {
+        return std::move (value);
+      }
+    }
+  };
+  
+  template <typename F> AioOffload<F> aio_offload (CapeAioTask task, CapeQueue queue, F&& fct)
+  {
+    return AioOffload<F> {task, queue, std::forward<F>(fct), {}, nullptr};
+  }
+  
+  //-----------------------------------------------------------------------------------------------------
+}
+
+#endif
+#endif
+
+#endif
@@ -4,6 +4,7 @@
 #include <stc/cape_stream.h>
 #include <stc/cape_list.h>
 #include <stc/cape_udc.h>
+#include <stc/cape_map.h>
 #include <fmt/cape_json.h>
 #include <sys/cape_log.h>
 
@@ -458,7 +459,7 @@ namespace cape
     
     //-----------------------------------------------------------------------------
     
-    // copy constructor
+    // copy constructor, the children of frozen udcs are shared
     Udc (const Udc& e) : m_owned (true), m_obj (cape_udc_cp (e.m_obj))
     {
     }
@@ -860,6 +861,14 @@ namespace cape
       return cape_udc_size (m_obj);
     }
     
+    //-----------------------------------------------------------------------------
+    
+    // the udc can't be changed anymore, copies are cheap and it can be used by different threads
+    void freeze ()
+    {
+      cape_udc_freeze (m_obj);
+    }
+    
   private:
 
     bool m_owned;
@@ -1020,6 +1029,60 @@ namespace cape
     CapeUdcCursor* m_obj;
   };
   
+  //-----------------------------------------------------------------------------------------------------
+
+  // a traits prototype for map keys, selects the inlined variants of the map
+  template <typename K> struct MapKeyType { };
+
+  template <> struct MapKeyType<number_t>
+  {
+    static CapeMap create () { return cape_map_new (cape_map__compare__n, NULL, NULL); }
+    static CapeMapNode find (CapeMap obj, number_t key) { return cape_map_find_n (obj, key); }
+    static CapeMapNode insert (CapeMap obj, number_t key, void* val) { return cape_map_insert_n (obj, key, val); }
+  };
+
+  template <> struct MapKeyType<const char*>
+  {
+    static CapeMap create () { return cape_map_new (cape_map__compare__s, NULL, NULL); }
+    static CapeMapNode find (CapeMap obj, const char* key) { return cape_map_find_s (obj, key); }
+    static CapeMapNode insert (CapeMap obj, const char* key, void* val) { return cape_map_insert_s (obj, (char*)key, val); }
+  };
+
+  //-----------------------------------------------------------------------------------------------------
+
+  // keys and values are not owned by the map
+  template <typename K, typename V> class Map
+  {
+
+  public:
+
+    Map () : m_obj (MapKeyType<K>::create ()) {}
+
+    ~Map () { cape_map_del (&m_obj); }
+
+    Map (const Map&) = delete;
+    Map& operator =(const Map&) = delete;
+
+    void insert (K key, V* val) { MapKeyType<K>::insert (m_obj, key, val); }
+
+    V* find (K key)
+    {
+      CapeMapNode n = MapKeyType<K>::find (m_obj, key);
+
+      return n ? (V*)cape_map_node_value (n) : NULL;
+    }
+
+    number_t size () { return cape_map_size (m_obj); }
+
+    CapeMap obj () { return m_obj; }
+
+  private:
+
+    CapeMap m_obj;
+  };
+
+  //-----------------------------------------------------------------------------------------------------
+
 }
 
 #endif
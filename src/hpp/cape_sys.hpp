@@ -36,29 +36,46 @@ namespace cape
     
   public:
     
-    Mutex ()
+    Mutex (int flags = 0)
     {
-      m_mutex = cape_mutex_new ();
+      cape_mutex_init (&m_mutex, flags);
     }
     
     ~Mutex ()
     {
-      cape_mutex_del (&m_mutex);
+      cape_mutex_done (&m_mutex);
     }
     
     void lock ()
     {
-      cape_mutex_lock (m_mutex);
+      cape_mutex_lock (&m_mutex);
     }
     
     void unlock ()
     {
-      cape_mutex_unlock (m_mutex);
+      cape_mutex_unlock (&m_mutex);
+    }
+    
+    bool try_lock ()
+    {
+      return cape_mutex_trylock (&m_mutex) == TRUE;
+    }
+    
+    CapeMutexStats stats ()
+    {
+      CapeMutexStats ret;
+      
+      cape_mutex_stats (&m_mutex, &ret);
+      
+      return ret;
     }
     
   private:
     
-    CapeMutex m_mutex;
+    Mutex (const Mutex&);
+    Mutex& operator= (const Mutex&);
+    
+    CapeMutexInline m_mutex;
     
   };
 
@@ -86,6 +103,98 @@ namespace cape
   };
   
   //======================================================================
+  
+  class RwLock
+  {
+    
+  public:
+    
+    RwLock ()
+    {
+      m_rwlock = cape_rwlock_new ();
+    }
+    
+    ~RwLock ()
+    {
+      cape_rwlock_del (&m_rwlock);
+    }
+    
+    void lock_r ()
+    {
+      cape_rwlock_lock_r (m_rwlock);
+    }
+    
+    void unlock_r ()
+    {
+      cape_rwlock_unlock_r (m_rwlock);
+    }
+    
+    void lock_w ()
+    {
+      cape_rwlock_lock_w (m_rwlock);
+    }
+    
+    void unlock_w ()
+    {
+      cape_rwlock_unlock_w (m_rwlock);
+    }
+    
+  private:
+    
+    RwLock (const RwLock&);
+    RwLock& operator= (const RwLock&);
+    
+    CapeRwLock m_rwlock;
+    
+  };
+  
+  //======================================================================
+  
+  class ScopeReadLock
+  {
+    
+  public:
+    
+    ScopeReadLock (RwLock& rwlock) : m_rwlock (rwlock)
+    {
+      m_rwlock.lock_r ();
+    }
+    
+    ~ScopeReadLock ()
+    {
+      m_rwlock.unlock_r ();
+    }
+    
+  private:
+    
+    RwLock& m_rwlock;
+    
+  };
+  
+  //======================================================================
+  
+  class ScopeWriteLock
+  {
+    
+  public:
+    
+    ScopeWriteLock (RwLock& rwlock) : m_rwlock (rwlock)
+    {
+      m_rwlock.lock_w ();
+    }
+    
+    ~ScopeWriteLock ()
+    {
+      m_rwlock.unlock_w ();
+    }
+    
+  private:
+    
+    RwLock& m_rwlock;
+    
+  };
+  
+  //======================================================================
 }
 
 #endif
@@ -0,0 +1,192 @@
+#include "cape_arena.h"
+
+// c includes
+#include <string.h>
+#include <stdlib.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_ARENA__ALIGN       8
+#define CAPE_ARENA__MIN_BLOCK   1024
+#define CAPE_ARENA__MAX_BLOCK   (1024 * 1024)
+
+#define CAPE_ARENA__ROUND(size)   (((size) + CAPE_ARENA__ALIGN - 1) & ~(number_t)(CAPE_ARENA__ALIGN - 1))
+
+//=============================================================================
+
+typedef struct CapeArenaBlock_s
+{
+  struct CapeArenaBlock_s* next;
+
+  number_t size;
+
+} CapeArenaBlock;
+
+// the data of a block starts after the aligned header
+#define CAPE_ARENA__DATA(block)   ((char*)(block) + CAPE_ARENA__ROUND (sizeof(CapeArenaBlock)))
+
+//-----------------------------------------------------------------------------
+
+struct CapeArena_s
+{
+  CapeArenaBlock* blocks;
+
+  char* pos;
+
+  char* end;
+
+  number_t block_size;   // the size of the next block
+
+  number_t used;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeArena cape_arena_new (void)
+{
+  CapeArena self = CAPE_NEW (struct CapeArena_s);
+
+  self->blocks = NULL;
+  self->pos = NULL;
+  self->end = NULL;
+  self->block_size = CAPE_ARENA__MIN_BLOCK;
+  self->used = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_arena_del (CapeArena* p_self)
+{
+  CapeArena self = *p_self;
+
+  if (self)
+  {
+    CapeArenaBlock* block = self->blocks;
+
+    while (block)
+    {
+      CapeArenaBlock* next = block->next;
+
+      free (block);
+
+      block = next;
+    }
+
+    CAPE_DEL (p_self, struct CapeArena_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeArenaBlock* cape_arena__block (number_t size)
+{
+  CapeArenaBlock* block = malloc (CAPE_ARENA__ROUND (sizeof(CapeArenaBlock)) + size);
+
+  if (block == NULL)
+  {
+    // same behavior as cape_alloc
+    abort ();
+  }
+
+  block->size = size;
+
+  return block;
+}
+
+//-----------------------------------------------------------------------------
+
+static void* cape_arena__alloc_block (CapeArena self, number_t size)
+{
+  CapeArenaBlock* block;
+
+  if (size > self->block_size / 4)
+  {
+    // a block of its own, the current block stays in use
+    block = cape_arena__block (size);
+
+    if (self->blocks)
+    {
+      block->next = self->blocks->next;
+      self->blocks->next = block;
+    }
+    else
+    {
+      block->next = NULL;
+      self->blocks = block;
+    }
+
+    return CAPE_ARENA__DATA (block);
+  }
+
+  block = cape_arena__block (self->block_size);
+
+  block->next = self->blocks;
+  self->blocks = block;
+
+  self->pos = CAPE_ARENA__DATA (block) + size;
+  self->end = CAPE_ARENA__DATA (block) + block->size;
+
+  if (self->block_size < CAPE_ARENA__MAX_BLOCK)
+  {
+    self->block_size *= 2;
+  }
+
+  return CAPE_ARENA__DATA (block);
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_arena_alloc (CapeArena self, number_t size)
+{
+  char* ret = self->pos;
+
+  size = CAPE_ARENA__ROUND (size);
+
+  self->used += size;
+
+  if (ret && size <= self->end - ret)
+  {
+    self->pos = ret + size;
+
+    return ret;
+  }
+
+  return cape_arena__alloc_block (self, size);
+}
+
+//-----------------------------------------------------------------------------
+
+char* cape_arena_buf (CapeArena self, const char* buf, number_t size)
+{
+  char* ret;
+
+  if (buf == NULL)
+  {
+    return NULL;
+  }
+
+  ret = cape_arena_alloc (self, size + 1);
+
+  memcpy (ret, buf, size);
+  ret[size] = 0;
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+char* cape_arena_str (CapeArena self, const char* source)
+{
+  return source ? cape_arena_buf (self, source, strlen (source)) : NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_arena_used (CapeArena self)
+{
+  return self->used;
+}
+
+//-----------------------------------------------------------------------------
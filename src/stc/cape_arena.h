@@ -0,0 +1,42 @@
+#ifndef __CAPE_STC__ARENA__H
+#define __CAPE_STC__ARENA__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* this class implements a bump allocator (arena)
+ *
+ * -> memory is taken from large blocks by moving a pointer, there is no
+ *    header per allocation and no way to release a single allocation
+ * -> all memory is released together when the arena is deleted
+ * -> the blocks grow from 1 KB up to 1 MB, larger requests get a block
+ *    of their own
+ * -> an arena is not thread safe
+ */
+
+//=============================================================================
+
+struct CapeArena_s; typedef struct CapeArena_s* CapeArena;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeArena         cape_arena_new             (void);
+
+__CAPE_LIBEX   void              cape_arena_del             (CapeArena*);
+
+                                 // returns uninitialized memory aligned for pointers and doubles
+__CAPE_LIBEX   void*             cape_arena_alloc           (CapeArena, number_t size);
+
+                                 // returns a terminated copy of the buffer, NULL if the buffer is NULL
+__CAPE_LIBEX   char*             cape_arena_buf             (CapeArena, const char* buf, number_t size);
+
+__CAPE_LIBEX   char*             cape_arena_str             (CapeArena, const char* source);
+
+                                 // the amount of bytes handed out so far
+__CAPE_LIBEX   number_t          cape_arena_used            (CapeArena);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,322 @@
+#include "cape_atom.h"
+
+// cape includes
+#include "stc/cape_hashmap.h"
+
+// c includes
+#include <string.h>
+
+#if defined __WINDOWS_OS
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+#if defined __WINDOWS_OS
+
+#define CAPE_ATOM__INC(p)         InterlockedIncrement (p)
+#define CAPE_ATOM__DEC(p)         InterlockedDecrement (p)
+#define CAPE_ATOM__CAS(p,o,n)     InterlockedCompareExchange (p, n, o)
+
+#else
+
+#define CAPE_ATOM__INC(p)         __sync_add_and_fetch (p, 1)
+#define CAPE_ATOM__DEC(p)         __sync_sub_and_fetch (p, 1)
+#define CAPE_ATOM__CAS(p,o,n)     __sync_val_compare_and_swap (p, o, n)
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#if defined __WINDOWS_OS
+
+static SRWLOCK cape_atoms__global_mutex = SRWLOCK_INIT;
+
+#define CAPE_ATOMS__GLOBAL_LOCK()       AcquireSRWLockExclusive (&cape_atoms__global_mutex)
+#define CAPE_ATOMS__GLOBAL_UNLOCK()     ReleaseSRWLockExclusive (&cape_atoms__global_mutex)
+
+#else
+
+static pthread_mutex_t cape_atoms__global_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define CAPE_ATOMS__GLOBAL_LOCK()       pthread_mutex_lock (&cape_atoms__global_mutex)
+#define CAPE_ATOMS__GLOBAL_UNLOCK()     pthread_mutex_unlock (&cape_atoms__global_mutex)
+
+#endif
+
+//=============================================================================
+
+#define CAPE_ATOM__GLOBAL      0x01      // the atom is in the global table
+#define CAPE_ATOM__PINNED      0x02      // the global table holds a reference
+
+typedef struct
+{
+  volatile long refcnt;
+
+  int flags;              // only changed with the global lock
+
+  number_t size;
+
+} CapeAtomHead;
+
+#define CAPE_ATOM__HEAD(atom)    ((CapeAtomHead*)(atom) - 1)
+
+//-----------------------------------------------------------------------------
+
+struct CapeAtoms_s
+{
+  CapeHashMap atoms;          // the atom is the key, the table owns one reference
+};
+
+static struct CapeAtoms_s cape_atoms__global = { NULL };
+
+//-----------------------------------------------------------------------------
+
+static const char* cape_atom__new (const char* name)
+{
+  number_t size = strlen (name);
+
+  // one block for the head and the characters
+  CapeAtomHead* head = CAPE_ALLOC (sizeof(CapeAtomHead) + size + 1);
+
+  head->refcnt = 1;
+  head->flags = 0;
+  head->size = size;
+
+  memcpy (head + 1, name, size + 1);
+
+  return (const char*)(head + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+const char* cape_atom_cp (const char* atom)
+{
+  if (atom)
+  {
+    CAPE_ATOM__INC (&(CAPE_ATOM__HEAD (atom)->refcnt));
+  }
+
+  return atom;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_atom_del (const char** p_atom)
+{
+  const char* atom = *p_atom;
+
+  if (atom)
+  {
+    CapeAtomHead* head = CAPE_ATOM__HEAD (atom);
+
+    if (head->flags & CAPE_ATOM__GLOBAL)
+    {
+      long refcnt = head->refcnt;
+
+      // fast path, this is not the last reference
+      while (refcnt > 1)
+      {
+        long h = CAPE_ATOM__CAS (&(head->refcnt), refcnt, refcnt - 1);
+
+        if (h == refcnt)
+        {
+          *p_atom = NULL;
+          return;
+        }
+
+        refcnt = h;
+      }
+
+      // the last reference, the table must not return the atom meanwhile
+      CAPE_ATOMS__GLOBAL_LOCK();
+
+      if (CAPE_ATOM__DEC (&(head->refcnt)) == 0)
+      {
+        cape_hashmap_erase (cape_atoms__global.atoms, cape_hashmap_find (cape_atoms__global.atoms, atom));
+
+        CAPE_FREE (head);
+      }
+
+      CAPE_ATOMS__GLOBAL_UNLOCK();
+    }
+    else if (CAPE_ATOM__DEC (&(head->refcnt)) == 0)
+    {
+      CAPE_FREE (head);
+    }
+
+    *p_atom = NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_atom_size (const char* atom)
+{
+  return atom ? CAPE_ATOM__HEAD (atom)->size : 0;
+}
+
+//=============================================================================
+
+static void __STDCALL cape_atoms__on_del (void* key, void* val)
+{
+  const char* atom = key; cape_atom_del (&atom);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_atoms__init (CapeAtoms self)
+{
+  self->atoms = cape_hashmap_new (NULL, NULL, cape_atoms__on_del, NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+static const char* cape_atoms__get (CapeAtoms self, const char* name)
+{
+  CapeHashMapNode n = cape_hashmap_find (self->atoms, name);
+
+  if (n == NULL)
+  {
+    n = cape_hashmap_insert (self->atoms, (void*)cape_atom__new (name), NULL);
+  }
+
+  return cape_hashmap_node_key (n);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeAtoms cape_atoms_new (void)
+{
+  CapeAtoms self = CAPE_NEW (struct CapeAtoms_s);
+
+  cape_atoms__init (self);
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_atoms_del (CapeAtoms* p_self)
+{
+  if (*p_self)
+  {
+    CapeAtoms self = *p_self;
+
+    cape_hashmap_del (&(self->atoms));
+
+    CAPE_DEL (p_self, struct CapeAtoms_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// must be called with the global lock, the table has no reference of the atom
+static CapeAtomHead* cape_atoms__global_get (const char* name)
+{
+  CapeHashMapNode n;
+
+  if (cape_atoms__global.atoms == NULL)
+  {
+    // the atoms are released by the last reference
+    cape_atoms__global.atoms = cape_hashmap_new (NULL, NULL, NULL, NULL);
+  }
+
+  n = cape_hashmap_find (cape_atoms__global.atoms, name);
+
+  if (n == NULL)
+  {
+    const char* atom = cape_atom__new (name);
+
+    CAPE_ATOM__HEAD (atom)->refcnt = 0;
+    CAPE_ATOM__HEAD (atom)->flags = CAPE_ATOM__GLOBAL;
+
+    n = cape_hashmap_insert (cape_atoms__global.atoms, (void*)atom, NULL);
+  }
+
+  return CAPE_ATOM__HEAD (cape_hashmap_node_key (n));
+}
+
+//-----------------------------------------------------------------------------
+
+const char* cape_atoms_get (CapeAtoms self, const char* name)
+{
+  CapeAtomHead* head;
+
+  if (name == NULL)
+  {
+    return NULL;
+  }
+
+  if (self)
+  {
+    return cape_atoms__get (self, name);
+  }
+
+  CAPE_ATOMS__GLOBAL_LOCK();
+
+  head = cape_atoms__global_get (name);
+
+  // the global table keeps this atom, it stays valid after the unlock
+  if ((head->flags & CAPE_ATOM__PINNED) == 0)
+  {
+    head->flags |= CAPE_ATOM__PINNED;
+
+    CAPE_ATOM__INC (&(head->refcnt));
+  }
+
+  CAPE_ATOMS__GLOBAL_UNLOCK();
+
+  return (const char*)(head + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+const char* cape_atoms_cp (CapeAtoms self, const char* name)
+{
+  CapeAtomHead* head;
+
+  if (name == NULL)
+  {
+    return NULL;
+  }
+
+  if (self)
+  {
+    return cape_atom_cp (cape_atoms__get (self, name));
+  }
+
+  CAPE_ATOMS__GLOBAL_LOCK();
+
+  head = cape_atoms__global_get (name);
+
+  CAPE_ATOM__INC (&(head->refcnt));
+
+  CAPE_ATOMS__GLOBAL_UNLOCK();
+
+  return (const char*)(head + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_atoms_size (CapeAtoms self)
+{
+  number_t ret;
+
+  if (self)
+  {
+    return cape_hashmap_size (self->atoms);
+  }
+
+  CAPE_ATOMS__GLOBAL_LOCK();
+
+  ret = cape_atoms__global.atoms ? cape_hashmap_size (cape_atoms__global.atoms) : 0;
+
+  CAPE_ATOMS__GLOBAL_UNLOCK();
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+#ifndef __CAPE_STC__ATOM__H
+#define __CAPE_STC__ATOM__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* this class implements a table of interned strings (atoms)
+ *
+ * -> every distinct string is stored only once, equal strings return the
+ *    same pointer, which can be compared by address
+ * -> an atom is a read only c-string with a hidden reference counter in front,
+ *    it can be used everywhere a const CapeString is expected
+ * -> a table holds one reference of each atom, the atoms stay valid after the
+ *    table was deleted as long as they are referenced
+ * -> a table is not thread safe, the global table (NULL) uses a mutex
+ * -> the global table keeps only the atoms returned by cape_atoms_get, atoms
+ *    taken with cape_atoms_cp are released with their last reference
+ *
+ * remarks: atoms must be released with cape_atom_del, never with cape_str_del
+ */
+
+//=============================================================================
+
+struct CapeAtoms_s; typedef struct CapeAtoms_s* CapeAtoms;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeAtoms         cape_atoms_new             (void);
+
+__CAPE_LIBEX   void              cape_atoms_del             (CapeAtoms*);
+
+                                 /* returns the atom of the string, the table keeps the reference
+                                    -> use NULL as table for the global table
+                                    -> returns NULL if the string is NULL */
+__CAPE_LIBEX   const char*       cape_atoms_get             (CapeAtoms, const char* name);
+
+                                 /* returns the atom of the string with a new reference, release it with cape_atom_del
+                                    -> use NULL as table for the global table
+                                    -> returns NULL if the string is NULL */
+__CAPE_LIBEX   const char*       cape_atoms_cp              (CapeAtoms, const char* name);
+
+__CAPE_LIBEX   number_t          cape_atoms_size            (CapeAtoms);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   const char*       cape_atom_cp               (const char* atom);        // adds a reference
+
+__CAPE_LIBEX   void              cape_atom_del              (const char** p_atom);     // releases a reference
+
+__CAPE_LIBEX   number_t          cape_atom_size             (const char* atom);        // the length is stored in the atom
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -112,6 +112,24 @@ char* cape_cursor_scan_s (CapeCursor self, number_t len)
 
 //-----------------------------------------------------------------------------
 
+const char* cape_cursor_scan_p (CapeCursor self, number_t len)
+{
+  if (len >= 0 && cape_cursor__has_data (self, len))
+  {
+    const char* h = self->pos;
+    
+    self->pos += len;
+    
+    return h;
+  }
+  else
+  {
+    return NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 cape_uint8 cape_cursor_scan_08 (CapeCursor self)
 {
   cape_uint8 ret = 0;
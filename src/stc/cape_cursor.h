@@ -39,6 +39,9 @@ __CAPE_LIBEX const char*     cape_cursor_dpos       (CapeCursor);
 
 __CAPE_LIBEX char*           cape_cursor_scan_s     (CapeCursor, number_t len);
 
+                             // returns the position in the buffer without a copy and moves forward, NULL if there is not enough data
+__CAPE_LIBEX const char*     cape_cursor_scan_p     (CapeCursor, number_t len);
+
 __CAPE_LIBEX cape_uint8      cape_cursor_scan_08    (CapeCursor);
 
 __CAPE_LIBEX cape_uint16     cape_cursor_scan_16    (CapeCursor, int network_byte_order);
@@ -0,0 +1,627 @@
+#include "cape_hashmap.h"
+
+// cape includes
+#include "sys/cape_log.h"
+
+// c includes
+#include <string.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAPE_HASHMAP__SSE2 1
+#endif
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_HASHMAP_GROUP      16          // amount of control bytes probed at once
+
+#define CAPE_HASHMAP_EMPTY      0x80        // the slot was never used
+#define CAPE_HASHMAP_DELETED    0xFE        // the slot was used, a probe must continue
+
+#define CAPE_HASHMAP__FULL(c)   ((c) < 0x80)
+
+//=============================================================================
+
+struct CapeHashMapNode_s
+{
+  void* key;
+
+  void* val;
+};
+
+//-----------------------------------------------------------------------------
+
+struct CapeHashMap_s
+{
+  struct CapeHashMapNode_s* slots;
+
+  unsigned char* ctrl;          // one control byte per slot, 0x00 - 0x7F for used slots
+
+  number_t capacity;            // amount of slots, power of 2 and multiple of the group size
+
+  number_t size;
+
+  number_t growth_left;         // amount of empty slots which can be used before a rehash
+
+  fct_cape_hashmap_hash hash_fct;
+
+  fct_cape_map_cmp cmp_fct;
+
+  void* ptr;
+
+  fct_cape_map_destroy del_fct;
+};
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_hashmap__hash__s (const void* key, void* ptr)
+{
+  const unsigned char* s = key;
+
+  // FNV-1a
+  cape_uint64 h = 0xcbf29ce484222325ULL;
+
+  while (*s)
+  {
+    h ^= *s++;
+    h *= 0x100000001b3ULL;
+  }
+
+  // the low bits are used for the control bytes, spread the entropy
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 __STDCALL cape_hashmap__hash__n (const void* key, void* ptr)
+{
+  cape_uint64 h = (cape_uint64)(number_t)key;
+
+  // murmur3 finalizer
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE int cape_hashmap__ctz (unsigned int mask)
+{
+#if defined _MSC_VER
+
+  unsigned long pos;
+
+  _BitScanForward (&pos, mask);
+
+  return (int)pos;
+
+#else
+
+  return __builtin_ctz (mask);
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+// returns a bit for each control byte of the group which equals the value
+static __CAPE_INLINE unsigned int cape_hashmap__match (const unsigned char* group, unsigned char value)
+{
+#if defined CAPE_HASHMAP__SSE2
+
+  __m128i ctrl = _mm_loadu_si128 ((const __m128i*)group);
+
+  return (unsigned int)_mm_movemask_epi8 (_mm_cmpeq_epi8 (ctrl, _mm_set1_epi8 ((char)value)));
+
+#else
+
+  unsigned int mask = 0;
+  int i;
+
+  for (i = 0; i < CAPE_HASHMAP_GROUP; i++)
+  {
+    if (group[i] == value)
+    {
+      mask |= (1u << i);
+    }
+  }
+
+  return mask;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+// returns a bit for each control byte of the group which is empty or deleted
+static __CAPE_INLINE unsigned int cape_hashmap__match_free (const unsigned char* group)
+{
+#if defined CAPE_HASHMAP__SSE2
+
+  // the high bit is only set for empty and deleted slots
+  return (unsigned int)_mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i*)group));
+
+#else
+
+  unsigned int mask = 0;
+  int i;
+
+  for (i = 0; i < CAPE_HASHMAP_GROUP; i++)
+  {
+    if (group[i] & 0x80)
+    {
+      mask |= (1u << i);
+    }
+  }
+
+  return mask;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_hashmap__alloc (CapeHashMap self, number_t capacity)
+{
+  // one block for the slots and the control bytes
+  self->slots = CAPE_ALLOC (capacity * (sizeof(struct CapeHashMapNode_s) + 1));
+  self->ctrl = (unsigned char*)(self->slots + capacity);
+
+  memset (self->ctrl, CAPE_HASHMAP_EMPTY, capacity);
+
+  self->capacity = capacity;
+  self->growth_left = capacity - capacity / 8;
+}
+
+//-----------------------------------------------------------------------------
+
+// returns the first free slot in the probe sequence of the hash
+static number_t cape_hashmap__find_free (CapeHashMap self, cape_uint64 hash)
+{
+  number_t groups_mask = self->capacity / CAPE_HASHMAP_GROUP - 1;
+  number_t g = (number_t)(hash >> 7) & groups_mask;
+  number_t stride = 0;
+
+  for (;;)
+  {
+    unsigned int mask = cape_hashmap__match_free (self->ctrl + g * CAPE_HASHMAP_GROUP);
+
+    if (mask)
+    {
+      return g * CAPE_HASHMAP_GROUP + cape_hashmap__ctz (mask);
+    }
+
+    // triangular probing visits all groups
+    stride++;
+    g = (g + stride) & groups_mask;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_hashmap__rehash (CapeHashMap self, number_t capacity)
+{
+  struct CapeHashMapNode_s* slots = self->slots;
+  unsigned char* ctrl = self->ctrl;
+  number_t old_capacity = self->capacity;
+  number_t i;
+
+  cape_hashmap__alloc (self, capacity);
+
+  for (i = 0; i < old_capacity; i++)
+  {
+    if (CAPE_HASHMAP__FULL (ctrl[i]))
+    {
+      cape_uint64 hash = self->hash_fct (slots[i].key, self->ptr);
+
+      number_t pos = cape_hashmap__find_free (self, hash);
+
+      self->ctrl[pos] = (unsigned char)(hash & 0x7F);
+      self->slots[pos] = slots[i];
+    }
+  }
+
+  self->growth_left -= self->size;
+
+  CAPE_FREE (slots);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeHashMapNode cape_hashmap__find (CapeHashMap self, const void* key, cape_uint64 hash)
+{
+  number_t groups_mask;
+  number_t g;
+  number_t stride = 0;
+
+  unsigned char h2 = (unsigned char)(hash & 0x7F);
+
+  if (self->capacity == 0)
+  {
+    return NULL;
+  }
+
+  groups_mask = self->capacity / CAPE_HASHMAP_GROUP - 1;
+  g = (number_t)(hash >> 7) & groups_mask;
+
+  for (;;)
+  {
+    const unsigned char* group = self->ctrl + g * CAPE_HASHMAP_GROUP;
+
+    unsigned int mask = cape_hashmap__match (group, h2);
+
+    while (mask)
+    {
+      number_t pos = g * CAPE_HASHMAP_GROUP + cape_hashmap__ctz (mask);
+
+      if (self->cmp_fct (key, self->slots[pos].key, self->ptr) == 0)
+      {
+        return self->slots + pos;
+      }
+
+      mask &= mask - 1;
+    }
+
+    // an empty slot stops the probe sequence
+    if (cape_hashmap__match (group, CAPE_HASHMAP_EMPTY))
+    {
+      return NULL;
+    }
+
+    stride++;
+    g = (g + stride) & groups_mask;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMap cape_hashmap_new (fct_cape_hashmap_hash on_hash, fct_cape_map_cmp on_cmp, fct_cape_map_destroy on_del, void* ptr)
+{
+  CapeHashMap self = CAPE_NEW(struct CapeHashMap_s);
+
+  self->slots = NULL;
+  self->ctrl = NULL;
+  self->capacity = 0;
+  self->size = 0;
+  self->growth_left = 0;
+
+  self->hash_fct = on_hash ? on_hash : cape_hashmap__hash__s;
+  self->cmp_fct = on_cmp ? on_cmp : cape_map__compare__s;
+  self->ptr = ptr;
+
+  self->del_fct = on_del;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_del (CapeHashMap* p_self)
+{
+  if (*p_self)
+  {
+    CapeHashMap self = *p_self;
+
+    cape_hashmap_clr (self);
+
+    CAPE_FREE (self->slots);
+
+    CAPE_DEL(p_self, struct CapeHashMap_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_clr (CapeHashMap self)
+{
+  if (self->size)
+  {
+    if (self->del_fct)
+    {
+      number_t i;
+
+      for (i = 0; i < self->capacity; i++)
+      {
+        if (CAPE_HASHMAP__FULL (self->ctrl[i]))
+        {
+          self->del_fct (self->slots[i].key, self->slots[i].val);
+        }
+      }
+    }
+  }
+
+  // keep the memory for the next usage
+  if (self->capacity)
+  {
+    memset (self->ctrl, CAPE_HASHMAP_EMPTY, self->capacity);
+
+    self->growth_left = self->capacity - self->capacity / 8;
+  }
+
+  self->size = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_reserve (CapeHashMap self, number_t size)
+{
+  number_t capacity = CAPE_HASHMAP_GROUP;
+
+  // the load factor is 7/8
+  while (capacity - capacity / 8 < size)
+  {
+    capacity *= 2;
+  }
+
+  if (capacity > self->capacity)
+  {
+    cape_hashmap__rehash (self, capacity);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMapNode cape_hashmap_insert (CapeHashMap self, void* key, void* val)
+{
+  cape_uint64 hash = self->hash_fct (key, self->ptr);
+  number_t pos;
+
+  {
+    CapeHashMapNode n = cape_hashmap__find (self, key, hash);
+
+    if (n)
+    {
+      cape_log_msg (CAPE_LL_WARN, "CAPE", "hashmap insert", "key already exists");
+      return n;
+    }
+  }
+
+  if (self->capacity == 0)
+  {
+    cape_hashmap__alloc (self, CAPE_HASHMAP_GROUP);
+  }
+
+  pos = cape_hashmap__find_free (self, hash);
+
+  if (self->growth_left == 0 && self->ctrl[pos] == CAPE_HASHMAP_EMPTY)
+  {
+    // grow if the map is more than half full, otherwise only remove the deleted slots
+    cape_hashmap__rehash (self, self->size * 2 >= self->capacity ? self->capacity * 2 : self->capacity);
+
+    pos = cape_hashmap__find_free (self, hash);
+  }
+
+  if (self->ctrl[pos] == CAPE_HASHMAP_EMPTY)
+  {
+    self->growth_left--;
+  }
+
+  self->ctrl[pos] = (unsigned char)(hash & 0x7F);
+
+  self->slots[pos].key = key;
+  self->slots[pos].val = val;
+
+  self->size++;
+
+  return self->slots + pos;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMapNode cape_hashmap_find (CapeHashMap self, const void* key)
+{
+  if (self->size == 0)
+  {
+    return NULL;
+  }
+
+  return cape_hashmap__find (self, key, self->hash_fct (key, self->ptr));
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMapNode cape_hashmap_extract (CapeHashMap self, CapeHashMapNode node)
+{
+  number_t pos = node - self->slots;
+  number_t g = pos / CAPE_HASHMAP_GROUP;
+
+  // if the group has an empty slot no probe sequence went beyond this group
+  if (cape_hashmap__match (self->ctrl + g * CAPE_HASHMAP_GROUP, CAPE_HASHMAP_EMPTY))
+  {
+    self->ctrl[pos] = CAPE_HASHMAP_EMPTY;
+    self->growth_left++;
+  }
+  else
+  {
+    self->ctrl[pos] = CAPE_HASHMAP_DELETED;
+  }
+
+  self->size--;
+
+  return node;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_erase (CapeHashMap self, CapeHashMapNode node)
+{
+  cape_hashmap_extract (self, node);
+
+  if (self->del_fct)
+  {
+    self->del_fct (node->key, node->val);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_hashmap_size (CapeHashMap self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_hashmap_node_value (CapeHashMapNode self)
+{
+  return self->val;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_hashmap_node_key (CapeHashMapNode self)
+{
+  return self->key;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_node_set (CapeHashMapNode self, void* val)
+{
+  self->val = val;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMap cape_hashmap_clone (CapeHashMap self, fct_cape_map__on_clone on_clone)
+{
+  // create a new object
+  CapeHashMap clone = cape_hashmap_new (self->hash_fct, self->cmp_fct, self->del_fct, self->ptr);
+
+  CapeHashMapCursor cursor;
+
+  cape_hashmap_reserve (clone, self->size);
+
+  cape_hashmap_cursor_init (self, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_hashmap_cursor_next (&cursor))
+  {
+    void* key_clone = NULL;
+    void* val_clone = NULL;
+
+    if (on_clone)
+    {
+      on_clone (cursor.node->key, cursor.node->val, &key_clone, &val_clone);
+    }
+
+    if (key_clone)
+    {
+      cape_hashmap_insert (clone, key_clone, val_clone);
+    }
+  }
+
+  return clone;
+}
+
+//=============================================================================
+
+void cape_hashmap_cursor_init (CapeHashMap self, CapeHashMapCursor* cursor, int direction)
+{
+  cursor->map = self;
+  cursor->node = NULL;
+  cursor->direction = direction;
+
+  // start outside of the slot array
+  cursor->position = (direction == CAPE_DIRECTION_FORW) ? -1 : self->capacity;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMapCursor* cape_hashmap_cursor_create (CapeHashMap self, int direction)
+{
+  CapeHashMapCursor* cursor = CAPE_NEW (CapeHashMapCursor);
+
+  cape_hashmap_cursor_init (self, cursor, direction);
+
+  return cursor;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_cursor_destroy (CapeHashMapCursor** pcursor)
+{
+  CAPE_DEL (pcursor, CapeHashMapCursor);
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_hashmap_cursor_next (CapeHashMapCursor* cursor)
+{
+  CapeHashMap self = cursor->map;
+
+  for (cursor->position++; cursor->position < self->capacity; cursor->position++)
+  {
+    if (CAPE_HASHMAP__FULL (self->ctrl[cursor->position]))
+    {
+      cursor->node = self->slots + cursor->position;
+      return TRUE;
+    }
+  }
+
+  cursor->node = NULL;
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_hashmap_cursor_prev (CapeHashMapCursor* cursor)
+{
+  CapeHashMap self = cursor->map;
+
+  for (cursor->position--; cursor->position >= 0; cursor->position--)
+  {
+    if (CAPE_HASHMAP__FULL (self->ctrl[cursor->position]))
+    {
+      cursor->node = self->slots + cursor->position;
+      return TRUE;
+    }
+  }
+
+  cursor->node = NULL;
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeHashMapNode cape_hashmap_cursor_extract (CapeHashMap self, CapeHashMapCursor* cursor)
+{
+  CapeHashMapNode x = cursor->node;
+
+  if (x)
+  {
+    // the other slots don't move, the cursor can continue from the current position
+    cursor->node = NULL;
+
+    return cape_hashmap_extract (self, x);
+  }
+  else
+  {
+    return NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_hashmap_cursor_erase (CapeHashMap self, CapeHashMapCursor* cursor)
+{
+  CapeHashMapNode x = cape_hashmap_cursor_extract (self, cursor);
+
+  if (x && self->del_fct)
+  {
+    self->del_fct (x->key, x->val);
+  }
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,98 @@
+#ifndef __CAPE_STC__HASHMAP__H
+#define __CAPE_STC__HASHMAP__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_map.h"
+
+//=============================================================================
+
+/* this class implements an unordered hash map with open addressing
+ *
+ * -> keys and values are stored inline in a flat array of slots
+ * -> every slot has a control byte with 7 bits of the hash, the control bytes
+ *    are probed in groups of 16 with SSE2 (scalar fallback on other platforms)
+ * -> the key callbacks and the onDestroy callback follow the CapeMap API
+ *
+ * remarks: a node is a pointer into the slot array, it stays valid until
+ *          the next insert, erasing doesn't move other nodes
+ */
+
+//=============================================================================
+
+struct CapeHashMap_s; typedef struct CapeHashMap_s* CapeHashMap;
+struct CapeHashMapNode_s; typedef struct CapeHashMapNode_s* CapeHashMapNode;
+
+typedef cape_uint64 (__STDCALL *fct_cape_hashmap_hash) (const void* key, void* ptr);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_hashmap__hash__s  (const void* key, void* ptr);   // for c-strings, use with cape_map__compare__s
+__CAPE_LIBEX   cape_uint64 __STDCALL cape_hashmap__hash__n  (const void* key, void* ptr);   // for numbers, use with cape_map__compare__n
+
+//-----------------------------------------------------------------------------
+
+               // the compare function is only used to check equality, NULL callbacks are for c-string keys
+__CAPE_LIBEX   CapeHashMap       cape_hashmap_new           (fct_cape_hashmap_hash, fct_cape_map_cmp, fct_cape_map_destroy, void* ptr);
+
+__CAPE_LIBEX   void              cape_hashmap_del           (CapeHashMap*);
+
+__CAPE_LIBEX   void              cape_hashmap_clr           (CapeHashMap);
+
+__CAPE_LIBEX   void              cape_hashmap_reserve       (CapeHashMap, number_t size);  // avoids rehashing until the map has this size
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeHashMapNode   cape_hashmap_insert        (CapeHashMap, void* key, void* data);
+
+__CAPE_LIBEX   CapeHashMapNode   cape_hashmap_find          (CapeHashMap, const void* key);
+
+__CAPE_LIBEX   void              cape_hashmap_erase         (CapeHashMap, CapeHashMapNode);   // removes the node and calls the onDestroy callback
+
+__CAPE_LIBEX   CapeHashMapNode   cape_hashmap_extract       (CapeHashMap, CapeHashMapNode);   // removes the node, key and value can be read until the next insert
+
+__CAPE_LIBEX   number_t          cape_hashmap_size          (CapeHashMap);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void*             cape_hashmap_node_value    (CapeHashMapNode);
+
+__CAPE_LIBEX   void*             cape_hashmap_node_key      (CapeHashMapNode);
+
+__CAPE_LIBEX   void              cape_hashmap_node_set      (CapeHashMapNode, void*);         // use with care
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeHashMap       cape_hashmap_clone         (CapeHashMap, fct_cape_map__on_clone on_clone);
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeHashMap map;          // the map
+  CapeHashMapNode node;     // the current node
+  int direction;            // the direction of the cursor
+  number_t position;        // the current slot
+
+} CapeHashMapCursor;
+
+//-----------------------------------------------------------------------------
+
+               // the order of the nodes is not defined, it is the same in both directions
+__CAPE_LIBEX   CapeHashMapCursor* cape_hashmap_cursor_create  (CapeHashMap, int direction);
+
+__CAPE_LIBEX   void               cape_hashmap_cursor_destroy (CapeHashMapCursor**);
+
+__CAPE_LIBEX   void               cape_hashmap_cursor_init    (CapeHashMap, CapeHashMapCursor*, int direction);
+
+__CAPE_LIBEX   int                cape_hashmap_cursor_next    (CapeHashMapCursor*);
+
+__CAPE_LIBEX   int                cape_hashmap_cursor_prev    (CapeHashMapCursor*);
+
+__CAPE_LIBEX   void               cape_hashmap_cursor_erase   (CapeHashMap, CapeHashMapCursor*);
+
+__CAPE_LIBEX   CapeHashMapNode    cape_hashmap_cursor_extract (CapeHashMap, CapeHashMapCursor*);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -2,6 +2,10 @@
 
 // cape includes
 #include "sys/cape_types.h"
+#include "sys/cape_queue.h"
+
+// c includes
+#include <string.h>
 
 //-----------------------------------------------------------------------------
 
@@ -427,111 +431,532 @@ void cape_list_link_next (CapeList self, CapeListNode node, CapeListNode next)
 
 //-----------------------------------------------------------------------------
 
-void cape_list_sort (CapeList self, fct_cape_list_onCompare onCompare)
+#define CAPE_LIST_SORT_INSERTION   16
+#define CAPE_LIST_SORT_PARALLEL    65536
+#define CAPE_LIST_SORT_RUNS        8
+
+//-----------------------------------------------------------------------------
+
+// all sort items start with the node
+typedef struct
+{
+  CapeListNode node;
+  
+  void* data;
+  
+} CapeListSortItem;
+
+typedef struct
+{
+  CapeListNode node;
+  
+  number_t key;
+  
+  number_t pos;         // the original position makes the order stable
+  
+} CapeListSortItemN;
+
+typedef struct
+{
+  CapeListNode node;
+  
+  const char* key;
+  
+  number_t pos;
+  
+  cape_uint64 prefix;   // the first bytes of the key, decides most comparisons
+  
+} CapeListSortItemS;
+
+//-----------------------------------------------------------------------------
+
+// links the nodes in the order of the array
+static void cape_list__relink (CapeList self, const char* items, number_t stride, number_t size)
+{
+  CapeListNode prev = NULL;
+  number_t i;
+  
+  for (i = 0; i < size; i++)
+  {
+    CapeListNode node = *(CapeListNode*)(items + i * stride);
+    
+    node->prev = prev;
+    
+    if (prev)
+    {
+      prev->next = node;
+    }
+    else
+    {
+      self->fpos = node;
+    }
+    
+    prev = node;
+  }
+  
+  prev->next = NULL;
+  self->lpos = prev;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeListSortItem* cape_list__sort_items (CapeList self, number_t* p_size)
+{
+  CapeListSortItem* items = CAPE_ALLOC (self->size * sizeof(CapeListSortItem));
+  CapeListNode node;
+  number_t size = 0;
+  
+  for (node = self->fpos; node && size < (number_t)self->size; node = node->next)
+  {
+    items[size].node = node;
+    items[size].data = node->data;
+    
+    size++;
+  }
+  
+  *p_size = size;
+  
+  return items;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_list__sort_insertion (CapeListSortItem* items, number_t size, fct_cape_list_onCompare onCompare)
 {
-  CapeListNode list = self->fpos;
-  CapeListNode tail;
-  CapeListNode p;
-  CapeListNode q;
-  CapeListNode e;
+  number_t i, j;
   
-  int insize = 1;
-  int psize, qsize;
-  int nmerges;
+  for (i = 1; i < size; i++)
+  {
+    CapeListSortItem h = items[i];
+    
+    for (j = i; j > 0 && onCompare (items[j - 1].data, h.data) > 0; j--)
+    {
+      items[j] = items[j - 1];
+    }
+    
+    items[j] = h;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// merges two sorted runs from src into dst, takes the left item on equal keys
+static void cape_list__sort_merge_runs (const CapeListSortItem* src, CapeListSortItem* dst, number_t lo, number_t mid, number_t hi, fct_cape_list_onCompare onCompare)
+{
+  number_t i = lo, j = mid, k = lo;
   
+  while (i < mid && j < hi)
+  {
+    if (onCompare (src[i].data, src[j].data) <= 0)
+    {
+      dst[k++] = src[i++];
+    }
+    else
+    {
+      dst[k++] = src[j++];
+    }
+  }
+  
+  while (i < mid)
+  {
+    dst[k++] = src[i++];
+  }
+  
+  while (j < hi)
+  {
+    dst[k++] = src[j++];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// stable merge sort of the array, temp must have the same size
+static void cape_list__sort_merge (CapeListSortItem* items, CapeListSortItem* temp, number_t size, fct_cape_list_onCompare onCompare)
+{
+  if (size <= CAPE_LIST_SORT_INSERTION)
+  {
+    cape_list__sort_insertion (items, size, onCompare);
+  }
+  else
+  {
+    number_t half = size / 2;
+    
+    cape_list__sort_merge (items, temp, half, onCompare);
+    cape_list__sort_merge (items + half, temp + half, size - half, onCompare);
+    
+    // already in order
+    if (onCompare (items[half - 1].data, items[half].data) <= 0)
+    {
+      return;
+    }
+    
+    memcpy (temp, items, size * sizeof(CapeListSortItem));
+    
+    cape_list__sort_merge_runs (temp, items, 0, half, size, onCompare);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_list_sort (CapeList self, fct_cape_list_onCompare onCompare)
+{
   // do some prechecks
-  if (onCompare == NULL)
+  if (onCompare == NULL || self->size < 2)
   {
     return;
   }
   
-  if (list == NULL)
   {
+    number_t size;
+    
+    // sort the pointers in an array, the nodes are only touched once
+    CapeListSortItem* items = cape_list__sort_items (self, &size);
+    CapeListSortItem* temp = CAPE_ALLOC (size * sizeof(CapeListSortItem));
+    
+    cape_list__sort_merge (items, temp, size, onCompare);
+    
+    cape_list__relink (self, (const char*)items, sizeof(CapeListSortItem), size);
+    
+    CAPE_FREE (temp);
+    CAPE_FREE (items);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeListSortItem* src;
+  
+  CapeListSortItem* dst;
+  
+  fct_cape_list_onCompare onCompare;
+  
+  number_t bounds[CAPE_LIST_SORT_RUNS + 1];   // the runs
+  
+  number_t width;                             // runs per merge
+  
+} CapeListSortContext;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_list__sort_run (void* ptr, number_t pos)
+{
+  CapeListSortContext* ctx = ptr;
+  
+  number_t lo = ctx->bounds[pos];
+  number_t hi = ctx->bounds[pos + 1];
+  
+  cape_list__sort_merge (ctx->src + lo, ctx->dst + lo, hi - lo, ctx->onCompare);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_list__sort_merge_step (void* ptr, number_t pos)
+{
+  CapeListSortContext* ctx = ptr;
+  
+  number_t lo = ctx->bounds[pos];
+  number_t mid = ctx->bounds[(pos + ctx->width) < CAPE_LIST_SORT_RUNS ? pos + ctx->width : CAPE_LIST_SORT_RUNS];
+  number_t hi = ctx->bounds[(pos + 2 * ctx->width) < CAPE_LIST_SORT_RUNS ? pos + 2 * ctx->width : CAPE_LIST_SORT_RUNS];
+  
+  cape_list__sort_merge_runs (ctx->src, ctx->dst, lo, mid, hi, ctx->onCompare);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_list_sort_queue (CapeList self, fct_cape_list_onCompare onCompare, CapeQueue queue)
+{
+  if (queue == NULL || self->size < CAPE_LIST_SORT_PARALLEL)
+  {
+    cape_list_sort (self, onCompare);
     return;
   }
   
-  while (1)
   {
-    p = list;
+    CapeListSortContext ctx;
+    CapeSync sync = cape_sync_new ();
+    CapeListSortItem* h;
+    number_t size, i;
+    
+    ctx.src = cape_list__sort_items (self, &size);
+    ctx.dst = CAPE_ALLOC (size * sizeof(CapeListSortItem));
+    ctx.onCompare = onCompare;
     
-    list = NULL;
-    tail = NULL;
+    for (i = 0; i <= CAPE_LIST_SORT_RUNS; i++)
+    {
+      ctx.bounds[i] = size * i / CAPE_LIST_SORT_RUNS;
+    }
+    
+    // sort all runs in parallel
+    for (i = 0; i < CAPE_LIST_SORT_RUNS; i++)
+    {
+      cape_queue_add (queue, sync, cape_list__sort_run, NULL, &ctx, i);
+    }
     
-    nmerges = 0;
+    cape_sync_wait (sync);
     
-    while (p)
+    // merge the runs pairwise until only one is left
+    for (ctx.width = 1; ctx.width < CAPE_LIST_SORT_RUNS; ctx.width *= 2)
     {
-      nmerges++;
+      for (i = 0; i < CAPE_LIST_SORT_RUNS; i += 2 * ctx.width)
+      {
+        cape_queue_add (queue, sync, cape_list__sort_merge_step, NULL, &ctx, i);
+      }
       
-      q = p;
-      psize = 0;
+      cape_sync_wait (sync);
       
+      h = ctx.src;
+      ctx.src = ctx.dst;
+      ctx.dst = h;
+    }
+    
+    cape_list__relink (self, (const char*)ctx.src, sizeof(CapeListSortItem), size);
+    
+    cape_sync_del (&sync);
+    
+    CAPE_FREE (ctx.dst);
+    CAPE_FREE (ctx.src);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/* introsort with an inlined comparison of the extracted keys
+ * -> quicksort with a median of three pivot
+ * -> heapsort if the recursion gets too deep
+ * -> insertion sort for short ranges
+ */
+#define CAPE_LIST__INTROSORT(name, item_t, LESS)                                           \
+                                                                                           \
+static void cape_list__heap_##name (item_t* items, number_t root, number_t size)          \
+{                                                                                          \
+  item_t h = items[root];                                                                  \
+                                                                                           \
+  while (2 * root + 1 < size)                                                              \
+  {                                                                                        \
+    number_t child = 2 * root + 1;                                                         \
+                                                                                           \
+    if (child + 1 < size && LESS ((&items[child]), (&items[child + 1])))                   \
+    {                                                                                      \
+      child++;                                                                             \
+    }                                                                                      \
+                                                                                           \
+    if (!LESS ((&h), (&items[child])))                                                     \
+    {                                                                                      \
+      break;                                                                               \
+    }                                                                                      \
+                                                                                           \
+    items[root] = items[child];                                                            \
+    root = child;                                                                          \
+  }                                                                                        \
+                                                                                           \
+  items[root] = h;                                                                         \
+}                                                                                          \
+                                                                                           \
+static void cape_list__introsort_##name (item_t* items, number_t size, int depth)         \
+{                                                                                          \
+  while (size > CAPE_LIST_SORT_INSERTION)                                                  \
+  {                                                                                        \
+    number_t i, j;                                                                         \
+    item_t h, pivot;                                                                       \
+                                                                                           \
+    if (depth-- == 0)                                                                      \
+    {                                                                                      \
+      for (i = size / 2; i > 0; i--)                                                       \
+      {                                                                                    \
+        cape_list__heap_##name (items, i - 1, size);                                       \
+      }                                                                                    \
+                                                                                           \
+      for (i = size - 1; i > 0; i--)                                                       \
+      {                                                                                    \
+        h = items[0]; items[0] = items[i]; items[i] = h;                                   \
+        cape_list__heap_##name (items, 0, i);                                              \
+      }                                                                                    \
+                                                                                           \
+      return;                                                                              \
+    }                                                                                      \
+                                                                                           \
+    /* median of three, moved to the front */                                              \
+    {                                                                                      \
+      item_t* a = &items[1];                                                               \
+      item_t* b = &items[size / 2];                                                        \
+      item_t* c = &items[size - 1];                                                        \
+      item_t* m;                                                                           \
+                                                                                           \
+      if (LESS (a, b))                                                                     \
+      {                                                                                    \
+        m = LESS (b, c) ? b : (LESS (a, c) ? c : a);                                       \
+      }                                                                                    \
+      else                                                                                 \
+      {                                                                                    \
+        m = LESS (a, c) ? a : (LESS (b, c) ? c : b);                                       \
+      }                                                                                    \
+                                                                                           \
+      h = items[0]; items[0] = *m; *m = h;                                                 \
+    }                                                                                      \
+                                                                                           \
+    pivot = items[0];                                                                      \
+    i = 0;                                                                                 \
+    j = size;                                                                              \
+                                                                                           \
+    /* hoare partition, the keys are unique */                                             \
+    for (;;)                                                                               \
+    {                                                                                      \
+      do { i++; } while (i < size && LESS ((&items[i]), (&pivot)));                        \
+      do { j--; } while (LESS ((&pivot), (&items[j])));                                    \
+                                                                                           \
+      if (i >= j)                                                                          \
+      {                                                                                    \
+        break;                                                                             \
+      }                                                                                    \
+                                                                                           \
+      h = items[i]; items[i] = items[j]; items[j] = h;                                     \
+    }                                                                                      \
+                                                                                           \
+    items[0] = items[j];                                                                   \
+    items[j] = pivot;                                                                      \
+                                                                                           \
+    /* recursion on the smaller part */                                                    \
+    if (j < size - j - 1)                                                                  \
+    {                                                                                      \
+      cape_list__introsort_##name (items, j, depth);                                       \
+      items += j + 1;                                                                      \
+      size -= j + 1;                                                                       \
+    }                                                                                      \
+    else                                                                                   \
+    {                                                                                      \
+      cape_list__introsort_##name (items + j + 1, size - j - 1, depth);                    \
+      size = j;                                                                            \
+    }                                                                                      \
+  }                                                                                        \
+                                                                                           \
+  {                                                                                        \
+    number_t i, j;                                                                         \
+                                                                                           \
+    for (i = 1; i < size; i++)                                                             \
+    {                                                                                      \
+      item_t h = items[i];                                                                 \
+                                                                                           \
+      for (j = i; j > 0 && LESS ((&h), (&items[j - 1])); j--)                              \
+      {                                                                                    \
+        items[j] = items[j - 1];                                                           \
+      }                                                                                    \
+                                                                                           \
+      items[j] = h;                                                                        \
+    }                                                                                      \
+  }                                                                                        \
+}
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_LIST__LESS_N(a, b) ((a)->key < (b)->key || ((a)->key == (b)->key && (a)->pos < (b)->pos))
+
+static __CAPE_INLINE int cape_list__less_s (const CapeListSortItemS* a, const CapeListSortItemS* b)
+{
+  int res;
+  
+  if (a->prefix != b->prefix)
+  {
+    return a->prefix < b->prefix;
+  }
+  
+  // the strings are equal if the prefix contains the terminator
+  res = (a->prefix & 0xFF) ? strcmp (a->key + 8, b->key + 8) : 0;
+  
+  return res < 0 || (res == 0 && a->pos < b->pos);
+}
+
+CAPE_LIST__INTROSORT (n, CapeListSortItemN, CAPE_LIST__LESS_N)
+CAPE_LIST__INTROSORT (s, CapeListSortItemS, cape_list__less_s)
+
+//-----------------------------------------------------------------------------
+
+static int cape_list__sort_depth (number_t size)
+{
+  int depth = 0;
+  
+  while (size > 1)
+  {
+    size >>= 1;
+    depth += 2;
+  }
+  
+  return depth;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_list_sort_key_n (CapeList self, fct_cape_list_onKeyN onKey)
+{
+  if (onKey && self->size > 1)
+  {
+    CapeListSortItemN* items = CAPE_ALLOC (self->size * sizeof(CapeListSortItemN));
+    CapeListNode node;
+    number_t size = 0;
+    
+    // extract all keys once
+    for (node = self->fpos; node && size < (number_t)self->size; node = node->next)
+    {
+      items[size].node = node;
+      items[size].key = onKey (node->data);
+      items[size].pos = size;
+      
+      size++;
+    }
+    
+    cape_list__introsort_n (items, size, cape_list__sort_depth (size));
+    
+    cape_list__relink (self, (const char*)items, sizeof(CapeListSortItemN), size);
+    
+    CAPE_FREE (items);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_list_sort_key_s (CapeList self, fct_cape_list_onKeyS onKey)
+{
+  if (onKey && self->size > 1)
+  {
+    CapeListSortItemS* items = CAPE_ALLOC (self->size * sizeof(CapeListSortItemS));
+    CapeListNode node;
+    number_t size = 0, i;
+    
+    // extract all keys once
+    for (node = self->fpos; node && size < (number_t)self->size; node = node->next)
+    {
+      const char* key = onKey (node->data);
+      
+      if (key == NULL)
       {
-        int i;
-        for (i = 0; i < insize; i++)
-        {
-          psize++;
-          q = q->next;
-          
-          if (!q) break;
-        }
+        key = "";
       }
       
-      qsize = insize;
+      items[size].node = node;
+      items[size].key = key;
+      items[size].pos = size;
+      items[size].prefix = 0;
       
-      while (psize > 0 || (qsize > 0 && q))
+      // big endian, the numeric order is the order of the bytes
+      for (i = 0; i < 8; i++)
       {
-        if (psize == 0)
-        {
-          e = q;
-          q = q->next;
-          qsize--;
-        }
-        else if (qsize == 0 || !q)
-        {
-          e = p;
-          p = p->next;
-          psize--;
-        }
-        else if (onCompare(p->data, q->data) <= 0)
-        {
-          e = p;
-          p = p->next;
-          psize--;
-        }
-        else
-        {
-          e = q;
-          q = q->next;
-          qsize--;
-        }
+        items[size].prefix <<= 8;
         
-        if (tail)
+        if (*key)
         {
-          tail->next = e;
+          items[size].prefix |= (unsigned char)*key++;
         }
-        else
-        {
-          list = e;
-        }
-        
-        e->prev = tail;
-        tail = e;
       }
       
-      p = q;
+      size++;
     }
     
-    tail->next = NULL;
+    cape_list__introsort_s (items, size, cape_list__sort_depth (size));
     
-    if (nmerges <= 1)
-    {
-      self->fpos = list;
-      self->lpos = tail;
-      return;
-    }
+    cape_list__relink (self, (const char*)items, sizeof(CapeListSortItemS), size);
     
-    insize *= 2;
+    CAPE_FREE (items);
   }
 }
 
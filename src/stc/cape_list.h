@@ -2,6 +2,8 @@
 #define __CAPE_STC__LIST__H 1
 
 #include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "sys/cape_queue.h"
 
 //=============================================================================
 
@@ -58,8 +60,20 @@ __CAPE_LIBEX   void              cape_list_node_swap        (CapeListNode, CapeL
 
 typedef int (__STDCALL *fct_cape_list_onCompare) (void* ptr1, void* ptr2);
 
+               // stable merge sort on an array of the nodes
 __CAPE_LIBEX   void              cape_list_sort             (CapeList, fct_cape_list_onCompare);
 
+               // same result as cape_list_sort, large lists are sorted in parallel by the workers of the queue
+__CAPE_LIBEX   void              cape_list_sort_queue       (CapeList, fct_cape_list_onCompare, CapeQueue);
+
+typedef number_t    (__STDCALL *fct_cape_list_onKeyN) (void* ptr);
+typedef const char* (__STDCALL *fct_cape_list_onKeyS) (void* ptr);
+
+               // the key is extracted only once for every element, the order is stable
+__CAPE_LIBEX   void              cape_list_sort_key_n       (CapeList, fct_cape_list_onKeyN);
+
+__CAPE_LIBEX   void              cape_list_sort_key_s       (CapeList, fct_cape_list_onKeyS);
+
 //-----------------------------------------------------------------------------
 
 typedef void* (__STDCALL *fct_cape_list_onClone) (void* ptr);
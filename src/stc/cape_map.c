@@ -13,6 +13,10 @@
 #define CAPE_MAP_CHILD     0
 #define CAPE_MAP_THREAD    1
 
+#define CAPE_MAP_MODE_GENERIC     0     // uses the compare callback
+#define CAPE_MAP_MODE_S           1     // c-string keys, inlined comparison with cached prefixes
+#define CAPE_MAP_MODE_N           2     // number keys, inlined comparison
+
 //-----------------------------------------------------------------------------
 
 int __STDCALL cape_map__compare__s (const void* a, const void* b, void* ptr)
@@ -20,6 +24,12 @@ int __STDCALL cape_map__compare__s (const void* a, const void* b, void* ptr)
   const char* s1 = a;
   const char* s2 = b;
   
+  // interned keys are equal by address
+  if (s1 == s2)
+  {
+    return 0;
+  }
+  
   return strcmp(s1, s2);
 }
 
@@ -46,38 +56,44 @@ int __STDCALL cape_map__compare__n (const void* a, const void* b, void* ptr)
 
 struct CapeMapNode_s
 {
-  CapeMapNode link[2];
+  union
+  {
+    CapeMapNode link[2];
     
+    CapeMap map;          // a released extracted node keeps its map to give the memory back
+  };
+  
+
   void* key;
 
   unsigned char tag[2];
   signed char balance;
+  
+  unsigned char owned;    // the node was copied out of the arena, uses the padding of the struct
+  
+  cape_uint32 prefix;     // first 4 bytes of string keys, uses the padding of the struct
 
   void* val;
 };
 
 //-----------------------------------------------------------------------------
 
-CapeMapNode cape_map_node_new (void* key, void* val)
-{
-  CapeMapNode self = CAPE_NEW(struct CapeMapNode_s);
-  
-  self->key = key;
-  self->val = val;
-  
-  self->tag[0] = 0;
-  self->tag[1] = 0;
-  
-  self->balance = 0;
-  
-  return self;
-}
-
-//-----------------------------------------------------------------------------
-
 void cape_map_node_del (CapeMapNode* pself)
 {
-  CAPE_DEL(pself, struct CapeMapNode_s);
+  CapeMapNode n = *pself;
+  
+  if (n)
+  {
+    if (n->owned)
+    {
+      CAPE_DEL (pself, struct CapeMapNode_s);
+    }
+    else
+    {
+      // the memory belongs to the arena of the map
+      cape_map_node_release (n->map, pself);
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -149,9 +165,27 @@ CapeMapNode cape_map_node_prev (CapeMapNode n)
 
 //=============================================================================
 
+#define CAPE_MAP_SLAB_MIN     16        // amount of nodes in the first slab
+#define CAPE_MAP_SLAB_MAX     4096      // the size of the slabs doubles until this amount
+
+//-----------------------------------------------------------------------------
+
+struct CapeMapSlab_s
+{
+  struct CapeMapSlab_s* next;
+  
+  number_t used;
+  
+  number_t size;
+  
+  // the nodes follow
+};
+
+//-----------------------------------------------------------------------------
+
 struct CapeMap_s
 {
-  CapeMapNode root;
+  struct CapeMapNode_s head;    // link[0] is the root, the head is used as parent of the root
   
   fct_cape_map_cmp cmp_fct;  
   void* cmp_ptr;
@@ -159,20 +193,141 @@ struct CapeMap_s
   fct_cape_map_destroy del_fct;
   
   size_t size;                  
+  
+  int mode;                     // the specialized variant for find and insert
+  
+  struct CapeMapSlab_s* slabs;  // arena of the nodes, the first slab is used for new nodes
+  
+  CapeMapNode free_nodes;       // released nodes, linked by link[0]
 };
 
 //-----------------------------------------------------------------------------
 
+static struct CapeMapSlab_s* cape_map__slab_new (CapeMap self, number_t size)
+{
+  struct CapeMapSlab_s* slab = CAPE_ALLOC (sizeof(struct CapeMapSlab_s) + size * sizeof(struct CapeMapNode_s));
+  
+  slab->used = 0;
+  slab->size = size;
+  
+  slab->next = self->slabs;
+  self->slabs = slab;
+  
+  return slab;
+}
+
+//-----------------------------------------------------------------------------
+
+// big endian, the integer order is the same as the order of strcmp
+static __CAPE_INLINE cape_uint32 cape_map__prefix (const char* key)
+{
+  const unsigned char* s = (const unsigned char*)key;
+  
+  cape_uint32 prefix = 0;
+  int i;
+  
+  for (i = 0; i < 4 && s[i]; i++)
+  {
+    prefix |= (cape_uint32)s[i] << (24 - 8 * i);
+  }
+  
+  return prefix;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeMapNode cape_map__node_new (CapeMap self, void* key, void* val)
+{
+  CapeMapNode n = self->free_nodes;
+  
+  if (n)
+  {
+    self->free_nodes = n->link[0];
+  }
+  else
+  {
+    struct CapeMapSlab_s* slab = self->slabs;
+    
+    if (slab == NULL || slab->used == slab->size)
+    {
+      number_t size = slab ? slab->size * 2 : CAPE_MAP_SLAB_MIN;
+      
+      slab = cape_map__slab_new (self, size > CAPE_MAP_SLAB_MAX ? CAPE_MAP_SLAB_MAX : size);
+    }
+    
+    n = (CapeMapNode)(slab + 1) + slab->used;
+    
+    slab->used++;
+  }
+  
+  n->link[0] = NULL;
+  n->link[1] = NULL;
+  
+  n->key = key;
+  n->val = val;
+  
+  n->tag[0] = 0;
+  n->tag[1] = 0;
+  
+  n->balance = 0;
+  n->owned = FALSE;
+  
+  n->prefix = (self->mode == CAPE_MAP_MODE_S) ? cape_map__prefix (key) : 0;
+  
+  return n;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_map_node_release (CapeMap self, CapeMapNode* pself)
+{
+  CapeMapNode n = *pself;
+  
+  if (n)
+  {
+    if (n->owned)
+    {
+      CAPE_DEL (pself, struct CapeMapNode_s);
+    }
+    else
+    {
+      n->link[0] = self->free_nodes;
+      self->free_nodes = n;
+      
+      *pself = NULL;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 CapeMap cape_map_new (fct_cape_map_cmp on_cmp, fct_cape_map_destroy on_del, void* ptr_cmp)
 {
   CapeMap self = CAPE_NEW(struct CapeMap_s);
   
-  self->root = NULL;
+  self->head.link[0] = NULL;
   self->size = 0;
   
+  self->slabs = NULL;
+  self->free_nodes = NULL;
+  
   self->cmp_fct = on_cmp ? on_cmp : cape_map__compare__s;
   self->cmp_ptr = ptr_cmp;
   
+  // use the inlined comparison for the default compare functions
+  if (self->cmp_fct == cape_map__compare__s)
+  {
+    self->mode = CAPE_MAP_MODE_S;
+  }
+  else if (self->cmp_fct == cape_map__compare__n)
+  {
+    self->mode = CAPE_MAP_MODE_N;
+  }
+  else
+  {
+    self->mode = CAPE_MAP_MODE_GENERIC;
+  }
+  
   self->del_fct = on_del;
   
   return self;
@@ -189,7 +344,7 @@ void cape_map_del_node (CapeMap self, CapeMapNode* pself)
     self->del_fct (n->key, n->val);
   }
   
-  cape_map_node_del (pself);
+  cape_map_node_release (self, pself);
 }
 
 //-----------------------------------------------------------------------------
@@ -199,28 +354,49 @@ void cape_map_clr (CapeMap self)
   CapeMapNode p;    // current node
   CapeMapNode n;    // next node
   
-  p = self->root;
+  struct CapeMapSlab_s* slab;
   
-  if (p != NULL) while (p->tag[0] == CAPE_MAP_CHILD)
-  {
-    p = p->link[0];
-  }
-    
-  while (p != NULL)
+  // the nodes don't need to be released one by one
+  if (self->del_fct)
   {
-    n = p->link[1];
+    p = self->head.link[0];
     
-    if (p->tag[1] == CAPE_MAP_CHILD) while (n->tag[0] == CAPE_MAP_CHILD)
+    if (p != NULL) while (p->tag[0] == CAPE_MAP_CHILD)
     {
-      n = n->link[0];
+      p = p->link[0];
     }
-     
-    cape_map_del_node (self, &p);
-         
-    p = n;
+      
+    while (p != NULL)
+    {
+      n = p->link[1];
+      
+      if (p->tag[1] == CAPE_MAP_CHILD) while (n->tag[0] == CAPE_MAP_CHILD)
+      {
+        n = n->link[0];
+      }
+       
+      self->del_fct (p->key, p->val);
+           
+      p = n;
+    }
+  }
+  
+  // release the arena in one step
+  slab = self->slabs;
+  
+  while (slab)
+  {
+    struct CapeMapSlab_s* next = slab->next;
+    
+    CAPE_FREE (slab);
+    
+    slab = next;
   }
+  
+  self->slabs = NULL;
+  self->free_nodes = NULL;
 
-  self->root = NULL;
+  self->head.link[0] = NULL;
   self->size = 0;
 }
 
@@ -240,11 +416,11 @@ void cape_map_del (CapeMap* p_self)
 
 //-----------------------------------------------------------------------------
 
-CapeMapNode cape_map_find (CapeMap self, const void* key)
+static CapeMapNode cape_map__find_generic (CapeMap self, const void* key)
 {
   CapeMapNode p;
   
-  p = self->root;
+  p = self->head.link[0];
   
   if (p == NULL)
   {
@@ -292,7 +468,7 @@ CapeMapNode cape_map_find_cmd (CapeMap self, const void* key, fct_cape_map_cmp o
     self->cmp_fct = on_cmp;
     
     // do the search
-    ret = cape_map_find (self, key);
+    ret = cape_map__find_generic (self, key);
     
     // set back
     self->cmp_fct = on_original_cmp;
@@ -303,62 +479,20 @@ CapeMapNode cape_map_find_cmd (CapeMap self, const void* key, fct_cape_map_cmp o
 
 //-----------------------------------------------------------------------------
 
-CapeMapNode cape_map_insert (CapeMap self, void* key, void* val)
+static CapeMapNode cape_map__insert_node (CapeMap self, CapeMapNode p, int dir, CapeMapNode y, CapeMapNode z, const unsigned char* da, void* key, void* val)
 {
-  CapeMapNode y;
-  CapeMapNode z;          /* Top node to update balance factor, and parent. */
-  CapeMapNode p;
-  CapeMapNode q;          /* Iterator, and parent. */
   CapeMapNode n;          /* Newly inserted node. */
   CapeMapNode w;          /* New root of rebalanced subtree. */
-  int dir;                /* Direction to descend. */
-  
-  unsigned char da[64];   /* Cached comparison results. */
-  int k = 0;              /* Number of cached results. */
-  
-  memset (da, 0, 64);
-  
-  z = (CapeMapNode)&self->root;
-  y = self->root;
-  
-  if (y != NULL)
-  {
-    for (q = z, p = y; ; q = p, p = p->link[dir])
-    {
-      int cmp = self->cmp_fct (key, p->key, self->cmp_ptr);      
-      if (cmp == 0)
-      {
-        cape_log_msg (CAPE_LL_WARN, "CAPE", "map insert", "key already exists");
-        return p;
-      }
-      
-      if (p->balance != 0)
-      {
-        z = q, y = p, k = 0;
-      }
-      
-      da[k++] = dir = cmp > 0;
-      
-      if (p->tag[dir] == CAPE_MAP_THREAD)
-      {
-        break;
-      }
-    }
-  }
-  else
-  {
-    p = z;
-    dir = 0;
-  }
+  int k;
   
-  n = cape_map_node_new (key, val);
+  n = cape_map__node_new (self, key, val);
   
   self->size++;
   
   n->tag[0] = n->tag[1] = CAPE_MAP_THREAD;
   n->link[dir] = p->link[dir];
   
-  if (self->root != NULL)
+  if (self->head.link[0] != NULL)
   {
     p->tag[dir] = CAPE_MAP_CHILD;
     n->link[!dir] = p;
@@ -371,7 +505,7 @@ CapeMapNode cape_map_insert (CapeMap self, void* key, void* val)
   p->link[dir] = n;
   n->balance = 0;
 
-  if (self->root == n)
+  if (self->head.link[0] == n)
   {
     return n;
   }
@@ -524,9 +658,219 @@ CapeMapNode cape_map_insert (CapeMap self, void* key, void* val)
 
 //-----------------------------------------------------------------------------
 
+static __CAPE_INLINE int cape_map__compare_s (const char* key, cape_uint32 prefix, CapeMapNode p)
+{
+  if (prefix != p->prefix)
+  {
+    return prefix > p->prefix ? 1 : -1;
+  }
+  
+  // the key is shorter than the prefix, or interned keys are equal by address
+  if ((prefix & 0xFF) == 0 || key == p->key)
+  {
+    return 0;
+  }
+  
+  return strcmp (key + 4, (const char*)p->key + 4);
+}
+
+//-----------------------------------------------------------------------------
+
+/*
+ * generates the search parts of find and insert for one key type
+ * -> PREPARE: statement which runs once before the search
+ * -> COMPARE: expression which compares 'key' with the node 'p', like strcmp
+ */
+#define CAPE_MAP__VARIANT_FIND(name, key_t, PREPARE, COMPARE)                            \
+                                                                                          \
+static CapeMapNode cape_map__find_##name (CapeMap self, key_t key)                        \
+{                                                                                         \
+  CapeMapNode p = self->head.link[0];                                                     \
+                                                                                          \
+  PREPARE                                                                                 \
+                                                                                          \
+  if (p) for (;;)                                                                         \
+  {                                                                                       \
+    int cmp = COMPARE;                                                                    \
+    int dir;                                                                              \
+                                                                                          \
+    if (cmp == 0)                                                                         \
+    {                                                                                     \
+      return p;                                                                           \
+    }                                                                                     \
+                                                                                          \
+    /* a branch instead of an index, the cpu can load the next node speculatively */     \
+    dir = cmp > 0 ? 1 : 0;                                                                \
+                                                                                          \
+    if (p->tag[dir] != CAPE_MAP_CHILD)                                                    \
+    {                                                                                     \
+      return NULL;                                                                        \
+    }                                                                                     \
+                                                                                          \
+    p = cmp > 0 ? p->link[1] : p->link[0];                                                \
+  }                                                                                       \
+                                                                                          \
+  return NULL;                                                                            \
+}
+
+#define CAPE_MAP__VARIANT_INSERT(name, key_t, PREPARE, COMPARE)                          \
+                                                                                          \
+static CapeMapNode cape_map__insert_##name (CapeMap self, key_t key, void* val)           \
+{                                                                                         \
+  CapeMapNode y;          /* Top node to update balance factor, and parent. */            \
+  CapeMapNode z;                                                                          \
+  CapeMapNode p;                                                                          \
+  CapeMapNode q;          /* Iterator, and parent. */                                     \
+  int dir;                /* Direction to descend. */                                     \
+                                                                                          \
+  unsigned char da[64];   /* Cached comparison results. */                                \
+  int k = 0;              /* Number of cached results. */                                 \
+                                                                                          \
+  PREPARE                                                                                 \
+                                                                                          \
+  memset (da, 0, 64);                                                                     \
+                                                                                          \
+  z = &(self->head);                                                                      \
+  y = self->head.link[0];                                                                 \
+                                                                                          \
+  if (y != NULL)                                                                          \
+  {                                                                                       \
+    for (q = z, p = y; ; q = p, p = p->link[dir])                                         \
+    {                                                                                     \
+      int cmp = COMPARE;                                                                  \
+                                                                                          \
+      if (cmp == 0)                                                                       \
+      {                                                                                   \
+        cape_log_msg (CAPE_LL_WARN, "CAPE", "map insert", "key already exists");          \
+        return p;                                                                         \
+      }                                                                                   \
+                                                                                          \
+      if (p->balance != 0)                                                                \
+      {                                                                                   \
+        z = q, y = p, k = 0;                                                              \
+      }                                                                                   \
+                                                                                          \
+      da[k++] = dir = cmp > 0;                                                            \
+                                                                                          \
+      if (p->tag[dir] == CAPE_MAP_THREAD)                                                 \
+      {                                                                                   \
+        break;                                                                            \
+      }                                                                                   \
+    }                                                                                     \
+  }                                                                                       \
+  else                                                                                    \
+  {                                                                                       \
+    p = z;                                                                                \
+    dir = 0;                                                                              \
+  }                                                                                       \
+                                                                                          \
+  return cape_map__insert_node (self, p, dir, y, z, da, (void*)key, val);                 \
+}
+
+//-----------------------------------------------------------------------------
+
+CAPE_MAP__VARIANT_INSERT (generic, const void*, , self->cmp_fct (key, p->key, self->cmp_ptr))
+
+CAPE_MAP__VARIANT_FIND (s, const char*, cape_uint32 prefix = cape_map__prefix (key);, cape_map__compare_s (key, prefix, p))
+CAPE_MAP__VARIANT_INSERT (s, const char*, cape_uint32 prefix = cape_map__prefix (key);, cape_map__compare_s (key, prefix, p))
+
+// explicit branches for both directions, the compiler would generate a
+// branchless loop otherwise which serializes the loads of the nodes
+static CapeMapNode cape_map__find_n (CapeMap self, number_t key)
+{
+  CapeMapNode p = self->head.link[0];
+  
+  while (p)
+  {
+    number_t h = (number_t)p->key;
+    
+    if (key < h)
+    {
+      if (p->tag[0] != CAPE_MAP_CHILD)
+      {
+        return NULL;
+      }
+      
+      p = p->link[0];
+    }
+    else if (key > h)
+    {
+      if (p->tag[1] != CAPE_MAP_CHILD)
+      {
+        return NULL;
+      }
+      
+      p = p->link[1];
+    }
+    else
+    {
+      return p;
+    }
+  }
+  
+  return NULL;
+}
+CAPE_MAP__VARIANT_INSERT (n, number_t, , (key > (number_t)p->key) - (key < (number_t)p->key))
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_find (CapeMap self, const void* key)
+{
+  switch (self->mode)
+  {
+    case CAPE_MAP_MODE_S: return cape_map__find_s (self, key);
+    case CAPE_MAP_MODE_N: return cape_map__find_n (self, (number_t)key);
+  }
+  
+  return cape_map__find_generic (self, key);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_insert (CapeMap self, void* key, void* val)
+{
+  switch (self->mode)
+  {
+    case CAPE_MAP_MODE_S: return cape_map__insert_s (self, key, val);
+    case CAPE_MAP_MODE_N: return cape_map__insert_n (self, (number_t)key, val);
+  }
+  
+  return cape_map__insert_generic (self, key, val);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_find_s (CapeMap self, const char* key)
+{
+  return cape_map__find_s (self, key);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_insert_s (CapeMap self, char* key, void* val)
+{
+  return cape_map__insert_s (self, key, val);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_find_n (CapeMap self, number_t key)
+{
+  return cape_map__find_n (self, key);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_insert_n (CapeMap self, number_t key, void* val)
+{
+  return cape_map__insert_n (self, key, val);
+}
+
+//-----------------------------------------------------------------------------
+
 CapeMapNode cape_map_find_parent (CapeMap self, CapeMapNode node)
 {
-  if (node != self->root)
+  if (node != self->head.link[0])
   {
     CapeMapNode x;
     CapeMapNode y;
@@ -569,13 +913,13 @@ CapeMapNode cape_map_find_parent (CapeMap self, CapeMapNode node)
   }
   else
   {
-    return (CapeMapNode) &self->root;
+    return &(self->head);
   }
 }
 
 //-----------------------------------------------------------------------------
 
-CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
+static CapeMapNode cape_map__extract (CapeMap self, CapeMapNode node)
 {
   CapeMapNode item;
   CapeMapNode p;       /* Traverses tree to find node to delete. */
@@ -583,13 +927,13 @@ CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
   int dir;             /* Index into |q->tavl_link[]| to get |p|. */
   int cmp;             /* Result of comparison between |item| and |p|. */
   
-  if (self->root == NULL)
+  if (self->head.link[0] == NULL)
   {
     return NULL;
   }
   
-  q = (CapeMapNode) &self->root;
-  p = self->root;
+  q = &(self->head);
+  p = self->head.link[0];
   dir = 0;
 
   // search for the node
@@ -635,7 +979,7 @@ CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
     {
       q->link[dir] = p->link[dir];
       
-      if (q != (CapeMapNode) &self->root)
+      if (q != &(self->head))
       {
         q->tag[dir] = CAPE_MAP_THREAD;
       }
@@ -723,7 +1067,7 @@ CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
   
   //tree->tavl_alloc->libavl_free (tree->tavl_alloc, p);
   
-  while (q != (CapeMapNode) &self->root)
+  while (q != &(self->head))
   {
     CapeMapNode y = q;
     
@@ -908,6 +1252,51 @@ CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
   }
   
   self->size--;
+  
+  return item;
+}
+
+//-----------------------------------------------------------------------------
+
+// moves an extracted node out of the arena, the node might live longer than the map
+static CapeMapNode cape_map__node_own (CapeMap self, CapeMapNode item)
+{
+  CapeMapNode ret = NULL;
+  
+  if (item)
+  {
+    ret = CAPE_NEW (struct CapeMapNode_s);
+    
+    *ret = *item;
+    
+    ret->link[0] = NULL;
+    ret->link[1] = NULL;
+    ret->owned = TRUE;
+    
+    cape_map_node_release (self, &item);
+  }
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_extract (CapeMap self, CapeMapNode node)
+{
+  return cape_map__node_own (self, cape_map__extract (self, node));
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMapNode cape_map_extract_release (CapeMap self, CapeMapNode node)
+{
+  CapeMapNode item = cape_map__extract (self, node);
+  
+  if (item)
+  {
+    item->map = self;
+  }
+  
   return item;
 }
 
@@ -917,7 +1306,7 @@ void cape_map_erase (CapeMap self, CapeMapNode node)
 {
   if (node)
   {
-    CapeMapNode node2 = cape_map_extract (self, node);
+    CapeMapNode node2 = cape_map__extract (self, node);
     
     if (node2)
     {
@@ -937,7 +1326,7 @@ unsigned long cape_map_size (CapeMap self)
 
 CapeMapNode cape_map_first (CapeMap self)
 {
-  CapeMapNode ret = self->root;
+  CapeMapNode ret = self->head.link[0];
 
   if (ret != NULL)
   {
@@ -954,7 +1343,7 @@ CapeMapNode cape_map_first (CapeMap self)
 
 CapeMapNode cape_map_last (CapeMap self)
 {
-  CapeMapNode ret = self->root;
+  CapeMapNode ret = self->head.link[0];
   
   if (ret != NULL)
   {
@@ -969,6 +1358,99 @@ CapeMapNode cape_map_last (CapeMap self)
 
 //-----------------------------------------------------------------------------
 
+static CapeMapNode cape_map__build (CapeMapNode nodes, number_t count, number_t lo, number_t hi, int* p_height)
+{
+  number_t mid = lo + (hi - lo) / 2;
+  
+  CapeMapNode n = nodes + mid;
+  
+  int height_l = 0;
+  int height_r = 0;
+  
+  // the position in the array is the position in the order, the threads point to the neighbours
+  if (mid > lo)
+  {
+    n->tag[0] = CAPE_MAP_CHILD;
+    n->link[0] = cape_map__build (nodes, count, lo, mid, &height_l);
+  }
+  else
+  {
+    n->tag[0] = CAPE_MAP_THREAD;
+    n->link[0] = mid > 0 ? n - 1 : NULL;
+  }
+  
+  if (mid + 1 < hi)
+  {
+    n->tag[1] = CAPE_MAP_CHILD;
+    n->link[1] = cape_map__build (nodes, count, mid + 1, hi, &height_r);
+  }
+  else
+  {
+    n->tag[1] = CAPE_MAP_THREAD;
+    n->link[1] = mid + 1 < count ? n + 1 : NULL;
+  }
+  
+  n->balance = height_r - height_l;
+  
+  *p_height = (height_l > height_r ? height_l : height_r) + 1;
+  
+  return n;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_map__build_sorted (CapeMap self, void** keys, void** vals, number_t size)
+{
+  struct CapeMapSlab_s* slab = cape_map__slab_new (self, size);
+  
+  CapeMapNode nodes = (CapeMapNode)(slab + 1);
+  
+  number_t i;
+  int height;
+  
+  for (i = 0; i < size; i++)
+  {
+    nodes[i].key = keys[i];
+    nodes[i].val = vals ? vals[i] : NULL;
+    nodes[i].prefix = (self->mode == CAPE_MAP_MODE_S) ? cape_map__prefix (keys[i]) : 0;
+  }
+  
+  slab->used = size;
+  
+  self->head.link[0] = cape_map__build (nodes, size, 0, size, &height);
+  self->size = size;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_map_build_sorted (CapeMap self, void** keys, void** vals, number_t size)
+{
+  number_t i;
+  
+  if (self->size)
+  {
+    return FALSE;
+  }
+  
+  // check the order
+  for (i = 1; i < size; i++)
+  {
+    if (self->cmp_fct (keys[i - 1], keys[i], self->cmp_ptr) >= 0)
+    {
+      return FALSE;
+    }
+  }
+  
+  if (size > 0)
+  {
+    cape_map__build_sorted (self, keys, vals, size);
+  }
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeMap cape_map_clone (CapeMap self, fct_cape_map__on_clone on_clone)
 {
   // create a new object
@@ -976,6 +1458,19 @@ CapeMap cape_map_clone (CapeMap self, fct_cape_map__on_clone on_clone)
   
   CapeMapCursor cursor;
   
+  number_t size = 0;
+  
+  void** keys;
+  void** vals;
+  
+  if (self->size == 0 || on_clone == NULL)
+  {
+    return clone;
+  }
+  
+  keys = CAPE_ALLOC (self->size * sizeof(void*));
+  vals = CAPE_ALLOC (self->size * sizeof(void*));
+  
   cape_map_cursor_init (self, &cursor, CAPE_DIRECTION_FORW);
   
   while (cape_map_cursor_next (&cursor))
@@ -983,18 +1478,31 @@ CapeMap cape_map_clone (CapeMap self, fct_cape_map__on_clone on_clone)
     void* key_clone = NULL;
     void* val_clone = NULL;
     
-    if (on_clone)
-    {
-      on_clone (cursor.node->key, cursor.node->val, &key_clone, &val_clone);
-    }
+    on_clone (cursor.node->key, cursor.node->val, &key_clone, &val_clone);
 
     if (key_clone)
     {
-      // trivial copying of the node
-      cape_map_insert (clone, key_clone, val_clone);
+      keys[size] = key_clone;
+      vals[size] = val_clone;
+      
+      size++;
     }    
   }
   
+  // usually the cloned keys have the same order, then the tree can be built without rebalancing
+  if (!cape_map_build_sorted (clone, keys, vals, size))
+  {
+    number_t i;
+    
+    for (i = 0; i < size; i++)
+    {
+      cape_map_insert (clone, keys[i], vals[i]);
+    }
+  }
+  
+  CAPE_FREE (keys);
+  CAPE_FREE (vals);
+  
   return clone;
 }
 
@@ -1098,7 +1606,7 @@ int cape_map_cursor_prev (CapeMapCursor* cursor)
 
 //-----------------------------------------------------------------------------
 
-CapeMapNode cape_map_cursor_extract (CapeMap self, CapeMapCursor* cursor)
+static CapeMapNode cape_map__cursor_extract (CapeMap self, CapeMapCursor* cursor)
 {
   CapeMapNode x = cursor->node;
   
@@ -1117,7 +1625,7 @@ CapeMapNode cape_map_cursor_extract (CapeMap self, CapeMapCursor* cursor)
     
     cursor->position -= 1;
 
-    ret = cape_map_extract (self, x);
+    ret = cape_map__extract (self, x);
     
     if (cursor->node == NULL)
     {
@@ -1134,9 +1642,16 @@ CapeMapNode cape_map_cursor_extract (CapeMap self, CapeMapCursor* cursor)
 
 //-----------------------------------------------------------------------------
 
+CapeMapNode cape_map_cursor_extract (CapeMap self, CapeMapCursor* cursor)
+{
+  return cape_map__node_own (self, cape_map__cursor_extract (self, cursor));
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_map_cursor_erase (CapeMap self, CapeMapCursor* cursor)
 {
-  CapeMapNode node2 = cape_map_cursor_extract (self, cursor);
+  CapeMapNode node2 = cape_map__cursor_extract (self, cursor);
   
   cape_map_del_node (self, &node2);
 }
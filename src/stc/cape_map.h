@@ -2,6 +2,7 @@
 #define __CAPE_STC__MAP__H 1
 
 #include "sys/cape_export.h"
+#include "sys/cape_types.h"
 
 //=============================================================================
 
@@ -29,8 +30,8 @@ typedef void  (__STDCALL *fct_cape_map_destroy)  (void* key, void* val);
 
 //-----------------------------------------------------------------------------
 
-int __STDCALL cape_map__compare__s (const void* a, const void* b, void* ptr);
-int __STDCALL cape_map__compare__n (const void* a, const void* b, void* ptr);
+__CAPE_LIBEX   int __STDCALL cape_map__compare__s (const void* a, const void* b, void* ptr);
+__CAPE_LIBEX   int __STDCALL cape_map__compare__n (const void* a, const void* b, void* ptr);
 
 //-----------------------------------------------------------------------------
 
@@ -38,7 +39,10 @@ __CAPE_LIBEX   CapeMap           cape_map_new               (fct_cape_map_cmp, f
 
 __CAPE_LIBEX   void              cape_map_del               (CapeMap*);
 
-__CAPE_LIBEX   void              cape_map_clr               (CapeMap);
+__CAPE_LIBEX   void              cape_map_clr               (CapeMap);                    // releases all nodes in one step
+
+                                 // builds a balanced tree in O(n), the map must be empty and the keys sorted and unique, vals can be NULL
+__CAPE_LIBEX   int               cape_map_build_sorted      (CapeMap, void** keys, void** vals, number_t size);
 
 //-----------------------------------------------------------------------------
 
@@ -48,9 +52,26 @@ __CAPE_LIBEX   CapeMapNode       cape_map_find              (CapeMap, const void
 
 __CAPE_LIBEX   CapeMapNode       cape_map_find_cmd          (CapeMap, const void* key, fct_cape_map_cmp);
 
+//-----------------------------------------------------------------------------
+// specialized variants with an inlined comparison, the map must use the matching compare function
+// -> cape_map_new with cape_map__compare__s (or NULL) caches a prefix of the string keys in every node
+// -> cape_map_find and cape_map_insert use the variants automatically
+
+__CAPE_LIBEX   CapeMapNode       cape_map_find_s            (CapeMap, const char* key);
+
+__CAPE_LIBEX   CapeMapNode       cape_map_insert_s          (CapeMap, char* key, void* data);
+
+__CAPE_LIBEX   CapeMapNode       cape_map_find_n            (CapeMap, number_t key);
+
+__CAPE_LIBEX   CapeMapNode       cape_map_insert_n          (CapeMap, number_t key, void* data);
+
+//-----------------------------------------------------------------------------
+
 __CAPE_LIBEX   void              cape_map_erase             (CapeMap, CapeMapNode);       // removes the node, calls the onDestroy callback and releases the node
 
-__CAPE_LIBEX   CapeMapNode       cape_map_extract           (CapeMap, CapeMapNode);       // extracts the node from the container and returns it
+__CAPE_LIBEX   CapeMapNode       cape_map_extract           (CapeMap, CapeMapNode);       // extracts the node from the container and returns it, the node is independent of the map
+
+__CAPE_LIBEX   CapeMapNode       cape_map_extract_release   (CapeMap, CapeMapNode);       // extracts the node without a copy, the node must be given back before the map is cleared
 
 __CAPE_LIBEX   void              cape_map_del_node          (CapeMap, CapeMapNode*);      // calls the onDestroy callback and releases the node
 
@@ -68,7 +89,9 @@ __CAPE_LIBEX   void*             cape_map_node_key          (CapeMapNode);
 
 __CAPE_LIBEX   void              cape_map_node_set          (CapeMapNode, void*);         // use with care
 
-__CAPE_LIBEX   void              cape_map_node_del          (CapeMapNode*);               // don't calls the onDestroy method, only releases the memory
+__CAPE_LIBEX   void              cape_map_node_del          (CapeMapNode*);               // don't calls the onDestroy method
+
+__CAPE_LIBEX   void              cape_map_node_release      (CapeMap, CapeMapNode*);      // don't calls the onDestroy method, the map reuses the memory of the node
 
 //-----------------------------------------------------------------------------
 
@@ -9,7 +9,9 @@
 // cape includes
 #include "sys/cape_err.h"
 #include "sys/cape_log.h"
-#include "fmt/cape_dragon4.h"
+#include "fmt/cape_grisu.h"
+#include "stc/cape_utf8.h"
+#include "sys/cape_random.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -18,6 +20,10 @@
 
 #include <stdio.h>
 
+#if defined __WINDOWS_OS
+#include <windows.h>
+#endif
+
 //-----------------------------------------------------------------------------
 
 CapeString cape_str_cp (const CapeString source)
@@ -129,15 +135,26 @@ number_t cape_str_char__len (unsigned char c)
 number_t cape_str_len (const CapeString s)
 {
   number_t len = 0;
-  const char* s_pos = s;
+  number_t size = (number_t)strlen (s);
 
-  while (*s_pos)
+  if (cape_utf8_check (s, size, &len))
   {
-    len++;
-    s_pos += cape_str_char__len (*s_pos);
+    return len;
+  }
+  else
+  {
+    // not valid utf8, count the lead bytes
+    const char* s_pos = s;
+    const char* s_end = s + size;
+    
+    while (s_pos < s_end)
+    {
+      len++;
+      s_pos += cape_str_char__len (*s_pos);
+    }
+    
+    return len;
   }
-  
-  return len;
 }
 
 //-----------------------------------------------------------------------------
@@ -151,33 +168,70 @@ number_t cape_str_size (const CapeString s)
 
 CapeString cape_str_f (double value)
 {
-  int res;
-
-  CapeString ret = CAPE_ALLOC (1025);
-  
-  CapeErr err = cape_err_new ();
+  char buffer[CAPE_GRISU_BUF];
   
-  CapeDragon4 dragon4 = cape_dragon4_new ();
+  return cape_str_sub (buffer, cape_grisu_positional (buffer, value));
+}
+
+//-----------------------------------------------------------------------------
+
+// all numbers from 00 to 99, two digits are written at once
+static const char cape_str__digits[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+//-----------------------------------------------------------------------------
+
+number_t cape_str_n_buf (char* buf, number_t value)
+{
+  char h[24];
+  char* pos = h + 24;
+  number_t len;
   
-  cape_dragon4_positional (dragon4, CAPE_DRAGON4__DMODE_UNIQUE, CAPE_DRAGON4__CMODE_TOTAL, -1, FALSE, CAPE_DRAGON4__TMODE_ONE_ZERO, 0, 0);
+  // works for the lowest number too
+  unsigned long v = (value < 0) ? 0UL - (unsigned long)value : (unsigned long)value;
   
-
-  res = cape_dragon4_run (dragon4, ret, 1024, value, err);
-  if (res)
+  while (v >= 100)
   {
+    const char* d = cape_str__digits + (v % 100) * 2;
     
+    v /= 100;
+    
+    pos -= 2;
+    pos[0] = d[0];
+    pos[1] = d[1];
+  }
+  
+  if (v >= 10)
+  {
+    pos -= 2;
+    pos[0] = cape_str__digits[v * 2];
+    pos[1] = cape_str__digits[v * 2 + 1];
   }
   else
   {
+    *--pos = (char)('0' + v);
   }
   
-  ret[cape_dragon4_len (dragon4)] = '\0';
+  if (value < 0)
+  {
+    *--pos = '-';
+  }
   
-  cape_dragon4_del (&dragon4);
+  len = h + 24 - pos;
   
-  cape_err_del (&err);
-
-  return ret;
+  memcpy (buf, pos, len);
+  buf[len] = '\0';
+  
+  return len;
 }
 
 //-----------------------------------------------------------------------------
@@ -186,17 +240,8 @@ CapeString cape_str_n (number_t value)
 {
   CapeString ret = CAPE_ALLOC (26);  // for very long intergers
   
-#ifdef _MSC_VER
-    
-  _snprintf_s (ret, 24, _TRUNCATE, "%li", value);
-    
-#else
-    
-  // TODO: use a different %i / %lli if number_t is 64bit etc
-  snprintf (ret, 24, "%li", value);
-    
-#endif
-
+  cape_str_n_buf (ret, value);
+  
   return ret;
 }
 
@@ -350,6 +395,28 @@ int cape_str_find (const CapeString haystack, const CapeString needle, number_t*
 
 int cape_str_find_utf8 (const CapeString haystack, const CapeString needle, number_t* pos_len, number_t* pos_size)
 {
+  if (pos_len && pos_size)
+  {
+    number_t haystack_size = (number_t)strlen (haystack);
+    number_t needle_size = (number_t)strlen (needle);
+    
+    // in valid utf8 a match of a valid needle always starts at a character
+    if (needle_size && cape_utf8_check (haystack, haystack_size, NULL) && cape_utf8_check (needle, needle_size, NULL))
+    {
+      const char* found = cape_utf8_find (haystack, haystack_size, needle, needle_size);
+      
+      if (found)
+      {
+        *pos_len = cape_utf8_count (haystack, found - haystack);
+        *pos_size = found - haystack;
+        
+        return TRUE;
+      }
+      
+      return FALSE;
+    }
+  }
+  
   if (pos_len && pos_size)
   {
     const char* spos = haystack;
@@ -379,61 +446,153 @@ int cape_str_find_utf8 (const CapeString haystack, const CapeString needle, numb
 
 //-----------------------------------------------------------------------------
 
-CapeString cape_str_uuid (void)
+// two hex characters for each byte
+static const char cape_str__hex[513] =
+  "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+  "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+  "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+  "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+  "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+  "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+  "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+  "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+//-----------------------------------------------------------------------------
+
+// milliseconds since 1970 and the fraction of the millisecond in 1/4096
+static void cape_str__uuid_time (cape_uint64* ms, unsigned int* frac)
 {
-  CapeString self = (CapeString)CAPE_ALLOC(38);
-  
-#if defined _MSC_VER
+#if defined __WINDOWS_OS
+
+  FILETIME ft;
+  cape_uint64 t;
 
-  sprintf_s (self, 38, "%04X%04X-%04X-%04X-%04X-%04X%04X%04X", 
-          rand() & 0xffff, rand() & 0xffff,                          // Generates a 64-bit Hex number
-          rand() & 0xffff,                                           // Generates a 32-bit Hex number
-          ((rand() & 0x0fff) | 0x4000),                              // Generates a 32-bit Hex number of the form 4xxx (4 indicates the UUID version)
-          rand() % 0x3fff + 0x8000,                                  // Generates a 32-bit Hex number in the range [0x8000, 0xbfff]
-          rand() & 0xffff, rand() & 0xffff, rand() & 0xffff);        // Generates a 96-bit Hex number
+  GetSystemTimePreciseAsFileTime (&ft);
+
+  // 100 ns intervals since 1601
+  t = (((cape_uint64)ft.dwHighDateTime << 32) | ft.dwLowDateTime) - 116444736000000000ULL;
+
+  *ms = t / 10000;
+  *frac = (unsigned int)(((t % 10000) << 12) / 10000);
 
 #else
 
-  sprintf (self, "%04X%04X-%04X-%04X-%04X-%04X%04X%04X", 
-          rand() & 0xffff, rand() & 0xffff,                          // Generates a 64-bit Hex number
-          rand() & 0xffff,                                           // Generates a 32-bit Hex number
-          ((rand() & 0x0fff) | 0x4000),                              // Generates a 32-bit Hex number of the form 4xxx (4 indicates the UUID version)
-          rand() % 0x3fff + 0x8000,                                  // Generates a 32-bit Hex number in the range [0x8000, 0xbfff]
-          rand() & 0xffff, rand() & 0xffff, rand() & 0xffff);        // Generates a 96-bit Hex number
+  struct timespec ts;
+
+  clock_gettime (CLOCK_REALTIME, &ts);
+
+  *ms = (cape_uint64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+  *frac = (unsigned int)(((cape_uint64)(ts.tv_nsec % 1000000) << 12) / 1000000);
 
 #endif
+}
 
-  return self;
-  
-  /*
-  CapeString self = CAPE_ALLOC(38);
-  int t = 0;
-  
-  char *szTemp = "xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx";
-  char *szHex = "0123456789ABCDEF-";
-  int nLen = 36;
-  unsigned char* pos = (unsigned char*)self;
-  
-  srand (clock());
-  
-  for (t = 0; t < nLen + 1; t++, pos++)
+//-----------------------------------------------------------------------------
+
+// sets version and variant, the bytes are random
+static void cape_str__uuid_fill (unsigned char* b, int version)
+{
+  if (version == 7)
   {
-    int r = rand () % 16;
-    char c = ' ';   
-    
-    switch (szTemp[t])
+    cape_uint64 ms;
+    unsigned int frac;
+
+    cape_str__uuid_time (&ms, &frac);
+
+    // 48 bit timestamp, big endian
+    b[0] = (unsigned char)(ms >> 40);
+    b[1] = (unsigned char)(ms >> 32);
+    b[2] = (unsigned char)(ms >> 24);
+    b[3] = (unsigned char)(ms >> 16);
+    b[4] = (unsigned char)(ms >> 8);
+    b[5] = (unsigned char)(ms);
+
+    // the sub millisecond fraction keeps the order within the thread
+    b[6] = (unsigned char)(frac >> 8);
+    b[7] = (unsigned char)(frac);
+  }
+
+  b[6] = (unsigned char)((b[6] & 0x0F) | (version << 4));
+  b[8] = (unsigned char)((b[8] & 0x3F) | 0x80);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_str__uuid_hex (char* pos, const unsigned char* b)
+{
+  int i;
+
+  for (i = 0; i < 16; i++)
+  {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
     {
-      case 'x' : { c = szHex [r]; } break;
-      case 'y' : { c = szHex [(r & 0x03) | 0x08]; } break;
-      case '-' : { c = '-'; } break;
-      case '4' : { c = '4'; } break;
+      *pos++ = '-';
     }
-    
-    *pos = ( t < nLen ) ? c : 0x00;
+
+    memcpy (pos, cape_str__hex + b[i] * 2, 2);
+    pos += 2;
   }
-  
+
+  *pos = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_str_uuid_buf (char* buf, int version)
+{
+  unsigned char b[16];
+
+  cape_random_bytes (b, 16);
+
+  cape_str__uuid_fill (b, version);
+  cape_str__uuid_hex (buf, b);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_str_uuid_batch (char* buf, number_t cnt, int version)
+{
+  unsigned char b[16 * 64];
+
+  while (cnt > 0)
+  {
+    number_t i, part = cnt > 64 ? 64 : cnt;
+
+    // one call for the random bytes of many uuids
+    cape_random_bytes (b, part * 16);
+
+    for (i = 0; i < part; i++)
+    {
+      cape_str__uuid_fill (b + i * 16, version);
+      cape_str__uuid_hex (buf, b + i * 16);
+
+      buf += CAPE_STR_UUID_SIZE;
+    }
+
+    cnt -= part;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString cape_str_uuid (void)
+{
+  CapeString self = (CapeString)CAPE_ALLOC(38);
+
+  cape_str_uuid_buf (self, 4);
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString cape_str_uuid_v7 (void)
+{
+  CapeString self = (CapeString)CAPE_ALLOC(38);
+
+  cape_str_uuid_buf (self, 7);
+
   return self;
-  */
 }
 
 //-----------------------------------------------------------------------------
@@ -442,15 +601,24 @@ CapeString cape_str_random (number_t len)
 {
   number_t i;
   CapeString self = CAPE_ALLOC (len + 1);
-  
-  for (i = 0; i < len; i++)
+
+  for (i = 0; i + 1 < len; i += 2)
   {
-    self[i] = (rand() % 26) + 97;
+    cape_uint64 r = cape_random_u64 ();
+
+    // two letters out of one number, the bias of 26 / 2^32 can be ignored
+    self[i] = (char)(((r & 0xFFFFFFFF) * 26) >> 32) + 97;
+    self[i + 1] = (char)(((r >> 32) * 26) >> 32) + 97;
   }
-  
+
+  if (i < len)
+  {
+    self[i++] = (char)cape_random_n (26) + 97;
+  }
+
   // set termination
   self[i] = 0;
-  
+
   return self;
 }
 
@@ -665,6 +833,26 @@ CapeString cape_str_trim_utf8 (const CapeString source)
     return NULL;
   }
   
+  pos_e = c + strlen (source);
+  
+  // in valid utf8 all bytes of multibyte characters are above 32
+  if (cape_utf8_check (source, pos_e - pos_s, NULL))
+  {
+    while (pos_s < pos_e && *pos_s <= 32)
+    {
+      pos_s++;
+    }
+    
+    while (pos_e > pos_s && *(pos_e - 1) <= 32)
+    {
+      pos_e--;
+    }
+    
+    return cape_str_sub ((const char*)pos_s, pos_e - pos_s);
+  }
+  
+  pos_e = c;
+  
   number_t clen = 0;
   
   while (*c)
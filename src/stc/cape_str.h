@@ -11,6 +11,8 @@
 
 #define CapeString char*
 
+#define CAPE_STR_UUID_SIZE     37                     // 36 characters and the terminator
+
 __CAPE_LIBEX   CapeString         cape_str_cp            (const CapeString);                            // allocate memory and initialize the object
 
 __CAPE_LIBEX   CapeString         cape_str_mv            (CapeString*);                                 // move string
@@ -19,7 +21,13 @@ __CAPE_LIBEX   void               cape_str_del           (CapeString*);
 
 __CAPE_LIBEX   CapeString         cape_str_sub           (const CapeString, number_t len);              // copy a part of the substring
 
-__CAPE_LIBEX   CapeString         cape_str_uuid          (void);                                        // create an UUID and copy it into the string
+__CAPE_LIBEX   CapeString         cape_str_uuid          (void);                                        // create a random UUID (version 4) and copy it into the string
+
+__CAPE_LIBEX   CapeString         cape_str_uuid_v7       (void);                                        // create a time ordered UUID (version 7) and copy it into the string
+
+__CAPE_LIBEX   void               cape_str_uuid_buf      (char* buf, int version);                      // version 4 or 7, writes CAPE_STR_UUID_SIZE bytes
+
+__CAPE_LIBEX   void               cape_str_uuid_batch    (char* buf, number_t cnt, int version);        // writes cnt terminated UUIDs, each CAPE_STR_UUID_SIZE bytes
 
 __CAPE_LIBEX   CapeString         cape_str_random        (number_t len);                                // create a randwom string with the length (len)
 
@@ -35,6 +43,8 @@ __CAPE_LIBEX   CapeString         cape_str_f             (double);
 
 __CAPE_LIBEX   CapeString         cape_str_n             (number_t);                                    // number to string
 
+__CAPE_LIBEX   number_t           cape_str_n_buf         (char* buf, number_t);                         // number into a buffer of min 22 bytes, returns the length
+
 __CAPE_LIBEX   int                cape_str_empty         (const CapeString);                            // string length in bytes
 
 __CAPE_LIBEX   int                cape_str_not_empty     (const CapeString);                            // string length in bytes
@@ -1,5 +1,5 @@
 #include "cape_stream.h"
-#include "fmt/cape_dragon4.h"
+#include "fmt/cape_grisu.h"
 #include "sys/cape_types.h"
 
 // c includes
@@ -14,6 +14,13 @@
 #include <winsock.h>
 #else
 #include <netinet/in.h>
+#include <pthread.h>
+#endif
+
+#if defined __WINDOWS_OS
+#define CAPE_STREAM__IOV_SET(iov,d,s)  { (iov).buf = (d); (iov).len = (unsigned long)(s); }
+#else
+#define CAPE_STREAM__IOV_SET(iov,d,s)  { (iov).iov_base = (d); (iov).iov_len = (s); }
 #endif
 
 #ifndef htonll
@@ -22,33 +29,87 @@
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_STREAM_INLINE        96        // bytes stored in the stream object itself
+#define CAPE_STREAM_GROWTH        200       // default growth in percent of the capacity
+#define CAPE_STREAM_POOL_SIZE     16        // amount of streams kept in the pool
+#define CAPE_STREAM_POOL_KEEP     65536     // capacity a pooled stream may keep
+#define CAPE_STREAM_CHUNK         65536     // default chunk size of segmented streams
+
+//-----------------------------------------------------------------------------
+
+typedef struct CapeStreamChunk_s
+{
+  struct CapeStreamChunk_s* next;
+  
+  char* data;
+  
+  number_t size;                  // used bytes of the chunk
+  
+} CapeStreamChunk;
+
+//-----------------------------------------------------------------------------
+
 struct CapeStream_s
 {
-  number_t size;
+  number_t size;                  // capacity of the buffer without the terminator
   
   char* buffer;
   
   char* pos;
   
+  number_t growth;                // in percent of the capacity
+  
+  number_t max_step;              // limits the growth, 0 is unlimited
+  
+  number_t chunk_size;            // segmented mode if not 0
+  
+  CapeStreamChunk* chunks_first;  // the full chunks, the buffer is the last one
+  
+  CapeStreamChunk* chunks_last;
+  
+  number_t chunks_bytes;          // amount of bytes in all full chunks
+  
+  number_t chunks_cnt;
+  
+  char local[CAPE_STREAM_INLINE]; // small streams don't need an extra buffer
+  
 };
 
 //-----------------------------------------------------------------------------
 
-number_t cape_stream_size (CapeStream self)
+static __CAPE_INLINE number_t cape_stream__used (CapeStream self)
 {
   return self->pos - self->buffer;
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_stream_allocate (CapeStream self, unsigned long amount)
+number_t cape_stream_size (CapeStream self)
+{
+  return self->chunks_bytes + (self->pos - self->buffer);
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_stream__resize (CapeStream self, number_t capacity)
 {
   // safe how much we have used from the buffer
-  unsigned long usedBytes = cape_stream_size (self);
+  number_t usedBytes = cape_stream__used (self);
   
-  // use realloc to minimalize coping the buffer
-  self->size += amount;
-  self->buffer = realloc(self->buffer, self->size + 1);
+  if (self->buffer == self->local)
+  {
+    // leave the inline buffer
+    self->buffer = malloc (capacity + 1);
+    
+    memcpy (self->buffer, self->local, usedBytes);
+  }
+  else
+  {
+    // use realloc to minimalize coping the buffer
+    self->buffer = realloc (self->buffer, capacity + 1);
+  }
+  
+  self->size = capacity;
   
   // reset the position
   self->pos = self->buffer + usedBytes;
@@ -56,21 +117,158 @@ void cape_stream_allocate (CapeStream self, unsigned long amount)
 
 //-----------------------------------------------------------------------------
 
-void cape_stream_reserve (CapeStream self, number_t amount)
+void cape_stream_allocate (CapeStream self, unsigned long amount)
+{
+  cape_stream__resize (self, self->size + amount);
+}
+
+//-----------------------------------------------------------------------------
+
+// moves the buffer into the chain and starts a new chunk
+static void cape_stream__chunk_next (CapeStream self, number_t amount)
 {
-  number_t diffBytes = cape_stream_size (self) + amount + 1;
+  number_t usedBytes = cape_stream__used (self);
   
-  if (diffBytes > self->size)
+  if (usedBytes)
   {
-    if (amount > self->size)
+    CapeStreamChunk* chunk = CAPE_NEW (CapeStreamChunk);
+    
+    if (self->buffer == self->local)
+    {
+      chunk->data = malloc (usedBytes);
+      
+      memcpy (chunk->data, self->local, usedBytes);
+    }
+    else
+    {
+      chunk->data = self->buffer;
+    }
+    
+    chunk->size = usedBytes;
+    chunk->next = NULL;
+    
+    if (self->chunks_last)
     {
-      cape_stream_allocate (self, amount);
+      self->chunks_last->next = chunk;
     }
     else
     {
-      cape_stream_allocate (self, self->size + self->size);
+      self->chunks_first = chunk;
     }
+    
+    self->chunks_last = chunk;
+    self->chunks_bytes += usedBytes;
+    self->chunks_cnt++;
   }
+  else if (self->buffer != self->local)
+  {
+    free (self->buffer);
+  }
+  
+  self->size = (amount > self->chunk_size) ? amount : self->chunk_size;
+  self->buffer = malloc (self->size + 1);
+  self->pos = self->buffer;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_stream__chunks_clr (CapeStream self)
+{
+  CapeStreamChunk* chunk = self->chunks_first;
+  
+  while (chunk)
+  {
+    CapeStreamChunk* next = chunk->next;
+    
+    free (chunk->data);
+    
+    CAPE_DEL (&chunk, CapeStreamChunk);
+    
+    chunk = next;
+  }
+  
+  self->chunks_first = NULL;
+  self->chunks_last = NULL;
+  self->chunks_bytes = 0;
+  self->chunks_cnt = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// copies all chunks into one buffer
+static void cape_stream__flatten (CapeStream self)
+{
+  if (self->chunks_first)
+  {
+    number_t usedBytes = cape_stream__used (self);
+    number_t total = self->chunks_bytes + usedBytes;
+    
+    char* buffer = malloc (total + 1);
+    char* pos = buffer;
+    
+    CapeStreamChunk* chunk;
+    
+    for (chunk = self->chunks_first; chunk; chunk = chunk->next)
+    {
+      memcpy (pos, chunk->data, chunk->size);
+      pos += chunk->size;
+    }
+    
+    memcpy (pos, self->buffer, usedBytes);
+    
+    if (self->buffer != self->local)
+    {
+      free (self->buffer);
+    }
+    
+    cape_stream__chunks_clr (self);
+    
+    self->buffer = buffer;
+    self->pos = buffer + total;
+    self->size = total;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_stream_reserve (CapeStream self, number_t amount)
+{
+  number_t needed = cape_stream__used (self) + amount;
+  
+  if (needed > self->size)
+  {
+    number_t capacity = self->size;
+    
+    if (self->chunk_size)
+    {
+      cape_stream__chunk_next (self, amount);
+      return;
+    }
+    
+    // grow geometric until the amount fits
+    while (capacity < needed)
+    {
+      number_t step = capacity * (self->growth - 100) / 100;
+      
+      if (self->max_step && step > self->max_step)
+      {
+        step = self->max_step;
+      }
+      
+      capacity += (step > CAPE_STREAM_INLINE) ? step : CAPE_STREAM_INLINE;
+    }
+    
+    cape_stream__resize (self, capacity);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_stream__init (CapeStream self)
+{
+  self->buffer = self->local;
+  self->pos = self->buffer;
+  self->size = CAPE_STREAM_INLINE - 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -79,15 +277,27 @@ CapeStream cape_stream_new ()
 {
   CapeStream self = CAPE_NEW(struct CapeStream_s);
   
-  self->size = 0;
-  self->buffer = 0;
-  self->pos = self->buffer;
+  cape_stream__init (self);
   
-  // initial alloc
-  cape_stream_allocate (self, 100);
+  self->growth = CAPE_STREAM_GROWTH;
+  self->max_step = 0;
   
-  // clean
-  cape_stream_clr (self);
+  self->chunk_size = 0;
+  self->chunks_first = NULL;
+  self->chunks_last = NULL;
+  self->chunks_bytes = 0;
+  self->chunks_cnt = 0;
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeStream cape_stream_new_seg (number_t chunk_size)
+{
+  CapeStream self = cape_stream_new ();
+  
+  self->chunk_size = (chunk_size > 0) ? chunk_size : CAPE_STREAM_CHUNK;
   
   return self;
 }
@@ -100,7 +310,12 @@ void cape_stream_del (CapeStream* pself)
   
   if (self)
   {
-    free (self->buffer);
+    cape_stream__chunks_clr (self);
+    
+    if (self->buffer != self->local)
+    {
+      free (self->buffer);
+    }
     
     CAPE_DEL (pself, struct CapeStream_s);
   }  
@@ -108,13 +323,50 @@ void cape_stream_del (CapeStream* pself)
 
 //-----------------------------------------------------------------------------
 
+void cape_stream_growth (CapeStream self, number_t percent, number_t max_step)
+{
+  self->growth = (percent > 100) ? percent : CAPE_STREAM_GROWTH;
+  self->max_step = max_step;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_stream_reset_keep (CapeStream self, number_t max_capacity)
+{
+  cape_stream__chunks_clr (self);
+  
+  if (self->buffer != self->local && self->size > max_capacity)
+  {
+    free (self->buffer);
+    
+    cape_stream__init (self);
+  }
+  else
+  {
+    self->pos = self->buffer;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 CapeString cape_stream_to_str (CapeStream* pself)
 {
   CapeStream self = *pself;  
-  CapeString ret = self->buffer;
+  CapeString ret;
   
-  // set terminator
-  *(self->pos) = 0;
+  cape_stream__flatten (self);
+  
+  if (self->buffer == self->local)
+  {
+    ret = cape_str_sub (self->buffer, self->pos - self->buffer);
+  }
+  else
+  {
+    ret = self->buffer;
+    
+    // set terminator
+    *(self->pos) = 0;
+  }
   
   CAPE_DEL(pself, struct CapeStream_s);
   
@@ -127,6 +379,8 @@ number_t cape_stream_to_n (CapeStream self)
 {
   number_t ret;
 
+  cape_stream__flatten (self);
+  
   // prepare and add termination
   *(self->pos) = '\0';
   
@@ -141,7 +395,11 @@ number_t cape_stream_to_n (CapeStream self)
 
 CapeString cape_stream_to_s (CapeStream self)
 {
-  CapeString ret = cape_str_sub (self->buffer, self->pos - self->buffer);
+  CapeString ret;
+  
+  cape_stream__flatten (self);
+  
+  ret = cape_str_sub (self->buffer, self->pos - self->buffer);
   
   cape_stream_clr (self);
   
@@ -152,6 +410,8 @@ CapeString cape_stream_to_s (CapeStream self)
 
 void cape_stream_clr (CapeStream self)
 {
+  cape_stream__chunks_clr (self);
+  
   self->pos = self->buffer;
 }
 
@@ -159,6 +419,8 @@ void cape_stream_clr (CapeStream self)
 
 const char* cape_stream_get (CapeStream self)
 {
+  cape_stream__flatten (self);
+  
   // set terminator
   *(self->pos) = 0;
   
@@ -169,6 +431,8 @@ const char* cape_stream_get (CapeStream self)
 
 const char* cape_stream_data (CapeStream self)
 {
+  cape_stream__flatten (self);
+  
   return self->buffer;
 }
 
@@ -206,10 +470,32 @@ void cape_stream_append_str (CapeStream self, const char* s)
 
 //-----------------------------------------------------------------------------
 
+void cape_stream_append_text (CapeStream self, const CapeText* text)
+{
+  cape_stream_append_buf (self, cape_text_get (text), cape_text_size (text));
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_stream_append_buf (CapeStream self, const char* buffer, unsigned long size)
 {
   if (size > 0)
   {
+    if (self->chunk_size)
+    {
+      number_t rest = self->size - cape_stream__used (self);
+      
+      // fill the current chunk first
+      if ((number_t)size > rest && rest > 0)
+      {
+        memcpy (self->pos, buffer, rest);
+        self->pos += rest;
+        
+        buffer += rest;
+        size -= rest;
+      }
+    }
+    
     cape_stream_reserve (self, size);
     
     memcpy (self->pos, buffer, size);
@@ -283,44 +569,17 @@ void cape_stream_append_n (CapeStream self, number_t val)
 {
   cape_stream_reserve (self, 26);  // for very long intergers
   
-#ifdef _MSC_VER
-  
-  self->pos += _snprintf_s (self->pos, 24, _TRUNCATE, "%li", val);
-  
-#else
-  
-  self->pos += snprintf(self->pos, 24, "%li", val);
-  
-#endif
+  self->pos += cape_str_n_buf (self->pos, val);
 }
 
 //-----------------------------------------------------------------------------
 
 void cape_stream_append_f (CapeStream self, double val)
 {
-  int res;
-  CapeErr err = cape_err_new ();
-  
-  CapeDragon4 dragon4 = cape_dragon4_new ();
-  
-  cape_dragon4_positional (dragon4, CAPE_DRAGON4__DMODE_UNIQUE, CAPE_DRAGON4__CMODE_TOTAL, -1, FALSE, CAPE_DRAGON4__TMODE_ONE_ZERO, 0, 0);
-  
-  cape_stream_reserve (self, 1024);  // for very long intergers
-
-  res = cape_dragon4_run (dragon4, self->pos, 1024, val, err);
-  if (res)
-  {
-    
-  }
-  else
-  {
-  }
-
-  self->pos += cape_dragon4_len (dragon4);
-
-  cape_dragon4_del (&dragon4);
+  // format on the stack to keep small streams inline
+  char buffer[CAPE_GRISU_BUF];
   
-  cape_err_del (&err);
+  cape_stream_append_buf (self, buffer, cape_grisu_positional (buffer, val));
 }
 
 //-----------------------------------------------------------------------------
@@ -329,11 +588,9 @@ void cape_stream_append_d (CapeStream self, const CapeDatetime* val)
 {
   if (val)
   {
-    CapeString h = cape_datetime_s__std (val);
-    
-    cape_stream_append_buf (self, h, cape_str_size (h));
+    cape_stream_reserve (self, CAPE_DATETIME_BUF);
     
-    cape_str_del (&h);
+    self->pos += cape_datetime_b__std (val, self->pos);
   }
 }
 
@@ -341,12 +598,14 @@ void cape_stream_append_d (CapeStream self, const CapeDatetime* val)
 
 void cape_stream_append_stream (CapeStream self, CapeStream stream)
 {
-  unsigned long usedBytes = stream->pos - stream->buffer;
+  CapeStreamChunk* chunk;
   
-  cape_stream_reserve (self, usedBytes);
+  for (chunk = stream->chunks_first; chunk; chunk = chunk->next)
+  {
+    cape_stream_append_buf (self, chunk->data, chunk->size);
+  }
   
-  memcpy (self->pos, stream->buffer, usedBytes);
-  self->pos += usedBytes;
+  cape_stream_append_buf (self, stream->buffer, stream->pos - stream->buffer);
 }
 
 //-----------------------------------------------------------------------------
@@ -436,3 +695,129 @@ void cape_stream_append_bd (CapeStream self, double val, int network_byte_order)
 }
 
 //-----------------------------------------------------------------------------
+
+number_t cape_stream_iov_cnt (CapeStream self)
+{
+  return self->chunks_cnt + (self->pos > self->buffer ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_stream_iov (CapeStream self, number_t first, CapeStreamIov* iov, number_t iov_max)
+{
+  CapeStreamChunk* chunk = self->chunks_first;
+  number_t i, cnt = 0;
+  
+  // skip the segments of previous calls
+  for (i = 0; i < first && chunk; i++)
+  {
+    chunk = chunk->next;
+  }
+  
+  for (; chunk && cnt < iov_max; chunk = chunk->next)
+  {
+    CAPE_STREAM__IOV_SET (iov[cnt], chunk->data, chunk->size);
+    cnt++;
+  }
+  
+  // the current buffer is the last segment
+  if (chunk == NULL && cnt < iov_max && first <= self->chunks_cnt && self->pos > self->buffer)
+  {
+    CAPE_STREAM__IOV_SET (iov[cnt], self->buffer, self->pos - self->buffer);
+    cnt++;
+  }
+  
+  return cnt;
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined __WINDOWS_OS
+
+static SRWLOCK cape_stream__pool_mutex = SRWLOCK_INIT;
+
+#define CAPE_STREAM__POOL_LOCK()       AcquireSRWLockExclusive (&cape_stream__pool_mutex)
+#define CAPE_STREAM__POOL_UNLOCK()     ReleaseSRWLockExclusive (&cape_stream__pool_mutex)
+
+#else
+
+static pthread_mutex_t cape_stream__pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define CAPE_STREAM__POOL_LOCK()       pthread_mutex_lock (&cape_stream__pool_mutex)
+#define CAPE_STREAM__POOL_UNLOCK()     pthread_mutex_unlock (&cape_stream__pool_mutex)
+
+#endif
+
+static CapeStream cape_stream__pool[CAPE_STREAM_POOL_SIZE];
+static number_t cape_stream__pool_used = 0;
+
+//-----------------------------------------------------------------------------
+
+CapeStream cape_stream_pool_get (void)
+{
+  CapeStream self = NULL;
+  
+  CAPE_STREAM__POOL_LOCK();
+  
+  if (cape_stream__pool_used)
+  {
+    cape_stream__pool_used--;
+    
+    self = cape_stream__pool[cape_stream__pool_used];
+  }
+  
+  CAPE_STREAM__POOL_UNLOCK();
+  
+  return self ? self : cape_stream_new ();
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_stream_pool_put (CapeStream* p_self)
+{
+  CapeStream self = *p_self;
+  
+  if (self)
+  {
+    cape_stream_reset_keep (self, CAPE_STREAM_POOL_KEEP);
+    
+    self->growth = CAPE_STREAM_GROWTH;
+    self->max_step = 0;
+    self->chunk_size = 0;
+    
+    CAPE_STREAM__POOL_LOCK();
+    
+    if (cape_stream__pool_used < CAPE_STREAM_POOL_SIZE)
+    {
+      cape_stream__pool[cape_stream__pool_used] = self;
+      cape_stream__pool_used++;
+      
+      self = NULL;
+    }
+    
+    CAPE_STREAM__POOL_UNLOCK();
+    
+    // the pool is full
+    cape_stream_del (&self);
+    
+    *p_self = NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_stream_pool_flush (void)
+{
+  CAPE_STREAM__POOL_LOCK();
+  
+  while (cape_stream__pool_used)
+  {
+    cape_stream__pool_used--;
+    
+    cape_stream_del (&(cape_stream__pool[cape_stream__pool_used]));
+  }
+  
+  CAPE_STREAM__POOL_UNLOCK();
+}
+
+//-----------------------------------------------------------------------------
@@ -6,9 +6,38 @@
 #include "sys/cape_types.h"
 #include "sys/cape_time.h"
 #include "stc/cape_str.h"
+#include "stc/cape_text.h"
+
+#if defined __WINDOWS_OS
+
+// compatible to WSABUF
+typedef struct
+{
+  unsigned long len;
+  
+  char* buf;
+  
+} CapeStreamIov;
+
+#else
+
+#include <sys/uio.h>
+
+typedef struct iovec CapeStreamIov;
+
+#endif
 
 //=============================================================================
 
+/* a growing buffer for building strings and binary messages
+ *
+ * -> small streams use a buffer inside the object, larger ones move to the heap
+ * -> the capacity grows geometric, see cape_stream_growth
+ * -> a segmented stream grows by a chain of chunks without copying, it is only
+ *    flattened for a contiguous view (get, data, to_str, to_s, to_n),
+ *    cape_stream_iov returns the chunks for writev
+ */
+
 struct CapeStream_s; typedef struct CapeStream_s* CapeStream;
 
 //-----------------------------------------------------------------------------
@@ -16,12 +45,21 @@ struct CapeStream_s; typedef struct CapeStream_s* CapeStream;
                              /* alloc memory and initialization */
 __CAPE_LIBEX CapeStream      cape_stream_new (void);
 
+                             /* a segmented stream with chunks of this size (0 for the default size) */
+__CAPE_LIBEX CapeStream      cape_stream_new_seg (number_t chunk_size);
+
                              /* free memory */
 __CAPE_LIBEX void            cape_stream_del (CapeStream*);
 
                              /* resets the position to the start of the buffer */
 __CAPE_LIBEX void            cape_stream_clr (CapeStream);
 
+                             /* resets the position, the buffer is only kept up to this capacity */
+__CAPE_LIBEX void            cape_stream_reset_keep (CapeStream, number_t max_capacity);
+
+                             /* the capacity grows by this percent (default 200), max_step limits the growth (0 = unlimited) */
+__CAPE_LIBEX void            cape_stream_growth (CapeStream, number_t percent, number_t max_step);
+
                              /* converts the stream into a c-string (adds zero termination) */
 __CAPE_LIBEX const char*     cape_stream_get (CapeStream);
 
@@ -62,6 +100,8 @@ __CAPE_LIBEX void            cape_stream_append_str (CapeStream, const char*);
 
 __CAPE_LIBEX void            cape_stream_append_buf (CapeStream, const char*, unsigned long size);
 
+__CAPE_LIBEX void            cape_stream_append_text (CapeStream, const CapeText*);     // uses the cached length
+
 __CAPE_LIBEX void            cape_stream_append_fmt (CapeStream, const char*, ...);
 
 __CAPE_LIBEX void            cape_stream_append_c (CapeStream, char);
@@ -86,6 +126,27 @@ __CAPE_LIBEX void            cape_stream_append_64  (CapeStream, cape_uint64, in
 
 __CAPE_LIBEX void            cape_stream_append_bd  (CapeStream, double, int network_byte_order);
 
+//-----------------------------------------------------------------------------
+// export of the segments without flattening
+
+                             /* amount of segments with content */
+__CAPE_LIBEX number_t        cape_stream_iov_cnt (CapeStream);
+
+                             /* fills the segments starting with first, returns the amount of filled entries */
+__CAPE_LIBEX number_t        cape_stream_iov (CapeStream, number_t first, CapeStreamIov* iov, number_t iov_max);
+
+//-----------------------------------------------------------------------------
+// a global pool of streams for hot paths, the streams keep their buffers
+
+                             /* returns an empty stream from the pool or a new one */
+__CAPE_LIBEX CapeStream      cape_stream_pool_get (void);
+
+                             /* returns the stream to the pool or deletes it if the pool is full */
+__CAPE_LIBEX void            cape_stream_pool_put (CapeStream*);
+
+                             /* deletes all streams of the pool */
+__CAPE_LIBEX void            cape_stream_pool_flush (void);
+
 //-----------------------------------------------------------------------------
 
 #endif
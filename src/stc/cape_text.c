@@ -0,0 +1,394 @@
+#include "cape_text.h"
+
+// c includes
+#include <string.h>
+#include <stdlib.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_TEXT__HEAP       0x80
+#define CAPE_TEXT__MIN_LOG2   5           // the smallest heap buffer has 32 bytes
+
+#define CAPE_TEXT__IS_HEAP(self)   ((self)->u.small.tag & CAPE_TEXT__HEAP)
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE char* cape_text__data (CapeText* self)
+{
+  return CAPE_TEXT__IS_HEAP (self) ? self->u.heap.data : self->u.small.buf;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE void cape_text__set_size (CapeText* self, number_t size)
+{
+  if (CAPE_TEXT__IS_HEAP (self))
+  {
+    self->u.heap.size = size;
+    self->u.heap.data[size] = 0;
+  }
+  else
+  {
+    self->u.small.tag = (unsigned char)size;
+    self->u.small.buf[size] = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// the capacity is stored as log2, the buffer must have at least this size
+static void cape_text__set_heap (CapeText* self, char* data, number_t size, number_t capacity)
+{
+  unsigned char lg = 0;
+
+  while (((number_t)2 << lg) <= capacity)
+  {
+    lg++;
+  }
+
+  self->u.heap.data = data;
+  self->u.heap.size = size;
+  self->u.heap.tag = CAPE_TEXT__HEAP | lg;
+}
+
+//-----------------------------------------------------------------------------
+
+// the size of the heap buffer for size bytes and the terminator
+static number_t cape_text__heap_capacity (number_t size)
+{
+  number_t capacity = (number_t)1 << CAPE_TEXT__MIN_LOG2;
+
+  while (capacity < size + 1)
+  {
+    capacity <<= 1;
+  }
+
+  return capacity;
+}
+
+//-----------------------------------------------------------------------------
+
+// makes room for size bytes and the terminator
+static void cape_text__grow (CapeText* self, number_t size)
+{
+  number_t capacity;
+
+  if (size <= cape_text_capacity (self))
+  {
+    return;
+  }
+
+  capacity = cape_text__heap_capacity (size);
+
+  if (CAPE_TEXT__IS_HEAP (self))
+  {
+    cape_text__set_heap (self, realloc (self->u.heap.data, capacity), self->u.heap.size, capacity);
+  }
+  else
+  {
+    number_t used = self->u.small.tag;
+
+    // leave the inline buffer
+    char* data = malloc (capacity);
+
+    memcpy (data, self->u.small.buf, used + 1);
+
+    cape_text__set_heap (self, data, used, capacity);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_init (CapeText* self)
+{
+  self->u.small.tag = 0;
+  self->u.small.buf[0] = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_init_cp (CapeText* self, const char* source)
+{
+  cape_text_init (self);
+
+  if (source)
+  {
+    cape_text_set_buf (self, source, strlen (source));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_init_mv (CapeText* self, CapeString* p_source)
+{
+  CapeString source = *p_source;
+
+  cape_text_init (self);
+
+  if (source)
+  {
+    number_t size = strlen (source);
+
+    if (size <= (number_t)CAPE_TEXT_INLINE)
+    {
+      cape_text_set_buf (self, source, size);
+
+      cape_str_del (p_source);
+    }
+    else
+    {
+      number_t capacity = cape_text__heap_capacity (size);
+
+      // the buffer of a CapeString is only known to have the size and the terminator,
+      // a capacity of a power of two can't be recorded for less (mostly done in place)
+      cape_text__set_heap (self, realloc (source, capacity), size, capacity);
+
+      *p_source = NULL;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_done (CapeText* self)
+{
+  if (CAPE_TEXT__IS_HEAP (self))
+  {
+    free (self->u.heap.data);
+  }
+
+  cape_text_init (self);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString cape_text_to_str (CapeText* self)
+{
+  CapeString ret;
+
+  if (CAPE_TEXT__IS_HEAP (self))
+  {
+    ret = self->u.heap.data;
+  }
+  else
+  {
+    ret = cape_str_sub (self->u.small.buf, self->u.small.tag);
+  }
+
+  cape_text_init (self);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString cape_text_cp_str (const CapeText* self)
+{
+  return cape_str_sub (cape_text_get (self), cape_text_size (self));
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_text_capacity (const CapeText* self)
+{
+  if (CAPE_TEXT__IS_HEAP (self))
+  {
+    // without the terminator
+    return ((number_t)1 << (self->u.heap.tag & ~CAPE_TEXT__HEAP)) - 1;
+  }
+
+  return CAPE_TEXT_INLINE;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_reserve (CapeText* self, number_t size)
+{
+  cape_text__grow (self, size);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_clr (CapeText* self)
+{
+  cape_text__set_size (self, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_cut (CapeText* self, number_t size)
+{
+  if (size < cape_text_size (self))
+  {
+    cape_text__set_size (self, size);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_set (CapeText* self, const char* source)
+{
+  cape_text_set_buf (self, source, source ? strlen (source) : 0);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_set_buf (CapeText* self, const char* buf, number_t size)
+{
+  const char* data = cape_text_get (self);
+
+  if (buf >= data && buf <= data + cape_text_size (self))
+  {
+    // the source is a part of the text, it moves with the buffer
+    number_t offset = buf - data;
+
+    cape_text__grow (self, size);
+
+    buf = cape_text_get (self) + offset;
+  }
+  else
+  {
+    cape_text__grow (self, size);
+  }
+
+  if (size)
+  {
+    memmove (cape_text__data (self), buf, size);
+  }
+
+  cape_text__set_size (self, size);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_append_str (CapeText* self, const char* source)
+{
+  if (source)
+  {
+    cape_text_append_buf (self, source, strlen (source));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_append_buf (CapeText* self, const char* buf, number_t size)
+{
+  number_t used = cape_text_size (self);
+  const char* data = cape_text_get (self);
+
+  if (size == 0)
+  {
+    return;
+  }
+
+  if (buf >= data && buf <= data + used)
+  {
+    // the source is a part of the text, it moves with the buffer
+    number_t offset = buf - data;
+
+    cape_text__grow (self, used + size);
+
+    buf = cape_text_get (self) + offset;
+  }
+  else
+  {
+    cape_text__grow (self, used + size);
+  }
+
+  memmove (cape_text__data (self) + used, buf, size);
+
+  cape_text__set_size (self, used + size);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_append_text (CapeText* self, const CapeText* source)
+{
+  cape_text_append_buf (self, cape_text_get (source), cape_text_size (source));
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_append_c (CapeText* self, char c)
+{
+  number_t used = cape_text_size (self);
+
+  cape_text__grow (self, used + 1);
+
+  cape_text__data (self)[used] = c;
+
+  cape_text__set_size (self, used + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_append_n (CapeText* self, number_t val)
+{
+  char buffer[26];
+
+  cape_text_append_buf (self, buffer, cape_str_n_buf (buffer, val));
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_text_equal (const CapeText* self, const char* source)
+{
+  number_t size = cape_text_size (self);
+
+  if (source == NULL)
+  {
+    return FALSE;
+  }
+
+  return strncmp (cape_text_get (self), source, size) == 0 && source[size] == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_text_replace (CapeText* self, const char* seek, const char* replace_with)
+{
+  number_t seek_size;
+  number_t replace_size;
+
+  const char* pos;
+  const char* found;
+
+  CapeText h;
+
+  if (seek == NULL || *seek == 0)
+  {
+    return;
+  }
+
+  pos = cape_text_get (self);
+  found = strstr (pos, seek);
+
+  if (found == NULL)
+  {
+    return;
+  }
+
+  seek_size = strlen (seek);
+  replace_size = replace_with ? strlen (replace_with) : 0;
+
+  cape_text_init (&h);
+  cape_text_reserve (&h, cape_text_size (self));
+
+  while (found)
+  {
+    cape_text_append_buf (&h, pos, found - pos);
+    cape_text_append_buf (&h, replace_with, replace_size);
+
+    pos = found + seek_size;
+    found = strstr (pos, seek);
+  }
+
+  cape_text_append_buf (&h, pos, cape_text_get (self) + cape_text_size (self) - pos);
+
+  cape_text_done (self);
+
+  // the struct can be moved, the inline buffer is part of it
+  *self = h;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,115 @@
+#ifndef __CAPE_STC__TEXT__H
+#define __CAPE_STC__TEXT__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_str.h"
+
+//=============================================================================
+
+/* this class implements a string with a cached length and spare capacity
+ *
+ * -> the object is a value type of 3 words, it lives on the stack or inside
+ *    other structs, use init and done like an embedded mutex
+ * -> short strings (CAPE_TEXT_INLINE bytes, 22 on 64 bit) are stored inline
+ *    without any allocation
+ * -> longer strings use a heap buffer which grows in powers of 2, appends are
+ *    amortized and the buffer is kept on clear
+ * -> the content is always terminated, cape_text_get returns a c-string
+ *    without any conversion
+ * -> the heap buffer is compatible with CapeString, init_mv and to_str move
+ *    the buffer in and out, init_mv resizes it to the next power of two
+ */
+
+//=============================================================================
+
+typedef struct
+{
+  union
+  {
+    struct
+    {
+      char* data;
+      number_t size;
+      unsigned char reserved[sizeof(number_t) - 1];
+      unsigned char tag;          // high bit set, the lower bits are log2 of the capacity
+
+    } heap;
+
+    struct
+    {
+      char buf[sizeof(char*) + 2 * sizeof(number_t) - 1];
+      unsigned char tag;          // the size of the inline string
+
+    } small;
+
+  } u;
+
+} CapeText;
+
+#define CAPE_TEXT_INLINE     (sizeof(((CapeText*)0)->u.small.buf) - 1)
+
+//-----------------------------------------------------------------------------
+
+               // the inline accessors don't need a function call
+static __CAPE_INLINE const char* cape_text_get (const CapeText* self)
+{
+  return (self->u.small.tag & 0x80) ? self->u.heap.data : self->u.small.buf;
+}
+
+static __CAPE_INLINE number_t cape_text_size (const CapeText* self)
+{
+  return (self->u.small.tag & 0x80) ? self->u.heap.size : (number_t)self->u.small.tag;
+}
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void               cape_text_init          (CapeText*);                                   // initialize an empty string
+
+__CAPE_LIBEX   void               cape_text_init_cp       (CapeText*, const char* source);               // initialize with a copy, NULL is empty
+
+__CAPE_LIBEX   void               cape_text_init_mv       (CapeText*, CapeString* p_source);             // takes over the buffer of the string
+
+__CAPE_LIBEX   void               cape_text_done          (CapeText*);                                   // release the buffer
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeString         cape_text_to_str        (CapeText*);                                   // moves the buffer out, the text is empty afterwards
+
+__CAPE_LIBEX   CapeString         cape_text_cp_str        (const CapeText*);                             // a copy as CapeString
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   number_t           cape_text_capacity      (const CapeText*);
+
+__CAPE_LIBEX   void               cape_text_reserve       (CapeText*, number_t size);                    // avoids reallocations until the text has this size
+
+__CAPE_LIBEX   void               cape_text_clr           (CapeText*);                                   // keeps the buffer
+
+__CAPE_LIBEX   void               cape_text_cut           (CapeText*, number_t size);                    // truncates the text
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void               cape_text_set           (CapeText*, const char* source);
+
+__CAPE_LIBEX   void               cape_text_set_buf       (CapeText*, const char* buf, number_t size);
+
+__CAPE_LIBEX   void               cape_text_append_str    (CapeText*, const char* source);
+
+__CAPE_LIBEX   void               cape_text_append_buf    (CapeText*, const char* buf, number_t size);
+
+__CAPE_LIBEX   void               cape_text_append_text   (CapeText*, const CapeText* source);
+
+__CAPE_LIBEX   void               cape_text_append_c      (CapeText*, char c);
+
+__CAPE_LIBEX   void               cape_text_append_n      (CapeText*, number_t val);
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   int                cape_text_equal         (const CapeText*, const char* source);         // case sensitive
+
+__CAPE_LIBEX   void               cape_text_replace       (CapeText*, const char* seek, const char* replace_with);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -2,12 +2,48 @@
 
 // cape includes
 #include "sys/cape_types.h"
-#include "stc/cape_map.h"
+#include "stc/cape_hashmap.h"
+#include "stc/cape_atom.h"
+#include "stc/cape_arena.h"
+#include "sys/cape_log.h"
 
 //-----------------------------------------------------------------------------
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#if defined __WINDOWS_OS
+#include <windows.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+#if defined __WINDOWS_OS
+
+#define CAPE_UDC__INC(p)     InterlockedIncrement (p)
+#define CAPE_UDC__DEC(p)     InterlockedDecrement (p)
+
+#else
+
+#define CAPE_UDC__INC(p)     __sync_add_and_fetch (p, 1)
+#define CAPE_UDC__DEC(p)     __sync_sub_and_fetch (p, 1)
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_UDC__ATOM          0x01      // the name is an atom
+#define CAPE_UDC__ROOT          0x02      // the udc owns the arena
+#define CAPE_UDC__LAZY          0x04      // the children are added by the load function
+#define CAPE_UDC__FROZEN        0x08      // the udc can't be changed anymore
+
+#define CAPE_UDC__CURSOR_ARRAY  0x10      // cursor type for children stored in an array
+
+#define CAPE_UDC__INDEX_SIZE    16        // nodes with more children get a hash index
+
+// nodes and lists store their children in an array
+#define CAPE_UDC__IS_ARRAY(self)   ((self)->type == CAPE_UDC_NODE || (self)->type == CAPE_UDC_LIST)
 
 //-----------------------------------------------------------------------------
 
@@ -15,18 +51,111 @@ struct CapeUdc_s
 {
   u_t type;
   
+  u_t flags;
+  
   void* data;
   
   CapeString name;
+  
+  CapeArena arena;   // all memory of a document udc is taken from the arena
 };
 
-//----------------------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeUdc item;
+  
+  unsigned int hash;        // the hash of the name
+  
+} CapeUdcSlot;
+
+//-----------------------------------------------------------------------------
 
-static void __STDCALL cape_udc_node_onDel (void* key, void* val)
+typedef struct
 {
-  // don't delete the key, because it is already stored in name
+  number_t size;
+  
+  number_t capacity;
+  
+  CapeUdc* items;           // the children of nodes are sorted by name
+  
+  // the hash index of large nodes, it is always up to date
+  
+  CapeUdcSlot* slots;       // open addressing, free slots have no item
+  
+  number_t mask;
+  
+  // copies of frozen udcs share the array until they change it (copy on write)
+  
+  volatile long refcnt;
+  
+  int frozen;
   
-  CapeUdc h = val; cape_udc_del (&h);
+} CapeUdcArray;
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeUdc udc;
+  
+  number_t index;
+  
+} CapeUdcArrayCursor;
+
+//-----------------------------------------------------------------------------
+
+// the data of lazy nodes and lists until they are loaded
+typedef struct
+{
+  fct_cape_udc_onLoad onLoad;
+  
+  void* ptr;
+  
+  number_t pos;
+  
+} CapeUdcLazy;
+
+//----------------------------------------------------------------------------------------
+
+static int cape_udc__intern = FALSE;
+
+//----------------------------------------------------------------------------------------
+
+void cape_udc_intern (int enable)
+{
+  cape_udc__intern = enable;
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__name_set (CapeUdc self, const CapeString name)
+{
+  if (cape_udc__intern && name)
+  {
+    self->name = (CapeString)cape_atoms_cp (NULL, name);
+    self->flags |= CAPE_UDC__ATOM;
+  }
+  else
+  {
+    self->name = cape_str_cp (name);
+    self->flags &= ~CAPE_UDC__ATOM;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__name_del (CapeUdc self)
+{
+  if (self->flags & CAPE_UDC__ATOM)
+  {
+    cape_atom_del ((const char**)&(self->name));
+  }
+  else
+  {
+    cape_str_del (&(self->name));
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -36,27 +165,472 @@ static void __STDCALL cape_udc_list_onDel (void* ptr)
   CapeUdc h = ptr; cape_udc_del (&h);
 }
 
+//----------------------------------------------------------------------------------------
+
+// resizes a buffer of the array, in documents the old buffer stays in the arena
+static void* cape_udc__array_realloc (CapeUdc self, void* ptr, number_t size, number_t new_size)
+{
+  if (self->arena)
+  {
+    void* ret = cape_arena_alloc (self->arena, new_size);
+    
+    if (size)
+    {
+      memcpy (ret, ptr, size);
+    }
+    
+    return ret;
+  }
+  
+  return realloc (ptr, new_size);
+}
+
+//----------------------------------------------------------------------------------------
+
+static __CAPE_INLINE unsigned int cape_udc__hash (const char* name)
+{
+  return name ? (unsigned int)cape_hashmap__hash__s (name, NULL) : 0;
+}
+
+//----------------------------------------------------------------------------------------
+
+static __CAPE_INLINE int cape_udc__name_cmp (const char* name1, const char* name2)
+{
+  if (name1 == name2)
+  {
+    return 0;
+  }
+  
+  // children without a name are the first ones
+  if (name1 == NULL)
+  {
+    return -1;
+  }
+  
+  if (name2 == NULL)
+  {
+    return 1;
+  }
+  
+  return strcmp (name1, name2);
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__index_put (CapeUdcArray* a, CapeUdc item, unsigned int hash)
+{
+  number_t pos = hash & a->mask;
+  
+  while (a->slots[pos].item)
+  {
+    pos = (pos + 1) & a->mask;
+  }
+  
+  a->slots[pos].item = item;
+  a->slots[pos].hash = hash;
+}
+
+//----------------------------------------------------------------------------------------
+
+// the slots are used at most by the half
+static void cape_udc__index_resize (CapeUdc self, CapeUdcArray* a)
+{
+  CapeUdcSlot* slots = a->slots;
+  number_t slots_size = slots ? a->mask + 1 : 0;
+  
+  number_t size = 64;
+  number_t i;
+  
+  while (size < a->capacity * 2)
+  {
+    size <<= 1;
+  }
+  
+  if (size == slots_size)
+  {
+    return;
+  }
+  
+  a->slots = cape_udc__array_realloc (self, NULL, 0, size * sizeof(CapeUdcSlot));
+  a->mask = size - 1;
+  
+  memset (a->slots, 0, size * sizeof(CapeUdcSlot));
+  
+  if (slots)
+  {
+    // the hashes are kept
+    for (i = 0; i < slots_size; i++)
+    {
+      if (slots[i].item)
+      {
+        cape_udc__index_put (a, slots[i].item, slots[i].hash);
+      }
+    }
+    
+    if (self->arena == NULL)
+    {
+      free (slots);
+    }
+  }
+  else
+  {
+    for (i = 0; i < a->size; i++)
+    {
+      cape_udc__index_put (a, a->items[i], cape_udc__hash (a->items[i]->name));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__index_rm (CapeUdcArray* a, CapeUdc item)
+{
+  number_t pos = cape_udc__hash (item->name) & a->mask;
+  number_t next;
+  
+  while (a->slots[pos].item != item)
+  {
+    if (a->slots[pos].item == NULL)
+    {
+      return;
+    }
+    
+    pos = (pos + 1) & a->mask;
+  }
+  
+  // move the following entries back if the free slot is on their probe path
+  for (next = (pos + 1) & a->mask; a->slots[next].item; next = (next + 1) & a->mask)
+  {
+    number_t home = a->slots[next].hash & a->mask;
+    
+    if (((next - home) & a->mask) >= ((next - pos) & a->mask))
+    {
+      a->slots[pos] = a->slots[next];
+      pos = next;
+    }
+  }
+  
+  a->slots[pos].item = NULL;
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__array_insert (CapeUdc self, number_t index, CapeUdc item)
+{
+  CapeUdcArray* a = self->data;
+  
+  if (a == NULL)
+  {
+    if (self->arena)
+    {
+      a = cape_arena_alloc (self->arena, sizeof(CapeUdcArray));
+      
+      memset (a, 0, sizeof(CapeUdcArray));
+    }
+    else
+    {
+      a = CAPE_NEW (CapeUdcArray);
+    }
+    
+    a->refcnt = 1;
+    
+    self->data = a;
+  }
+  
+  if (a->size == a->capacity)
+  {
+    number_t capacity = a->capacity ? a->capacity * 2 : 4;
+    
+    a->items = cape_udc__array_realloc (self, a->items, a->size * sizeof(CapeUdc), capacity * sizeof(CapeUdc));
+    
+    a->capacity = capacity;
+    
+    if (a->slots)
+    {
+      cape_udc__index_resize (self, a);
+    }
+  }
+  
+  if (index < a->size)
+  {
+    memmove (a->items + index + 1, a->items + index, (a->size - index) * sizeof(CapeUdc));
+  }
+  
+  a->items[index] = item;
+  a->size++;
+  
+  if (a->slots)
+  {
+    cape_udc__index_put (a, item, cape_udc__hash (item->name));
+  }
+  else if (a->size > CAPE_UDC__INDEX_SIZE && self->type == CAPE_UDC_NODE)
+  {
+    cape_udc__index_resize (self, a);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void cape_udc__load (CapeUdc self)
+{
+  CapeUdcLazy* l = self->data;
+  
+  // the loader adds the children with the normal functions
+  self->flags &= ~CAPE_UDC__LAZY;
+  self->data = NULL;
+  
+  l->onLoad (l->ptr, self, l->pos);
+}
+
+//----------------------------------------------------------------------------------------
+
+#define CAPE_UDC__LOAD(self)   if ((self)->flags & CAPE_UDC__LAZY) cape_udc__load (self)
+
+//----------------------------------------------------------------------------------------
+
+// returns the position of the name in a node, or where it must be inserted
+static number_t cape_udc__array_search (CapeUdcArray* a, const char* name, int* p_found)
+{
+  number_t lo = 0;
+  number_t hi = a->size;
+  
+  *p_found = FALSE;
+  
+  // the children are often added in order
+  if (hi && cape_udc__name_cmp (a->items[hi - 1]->name, name) < 0)
+  {
+    return hi;
+  }
+  
+  while (lo < hi)
+  {
+    number_t mid = (lo + hi) / 2;
+    
+    int cmp = cape_udc__name_cmp (a->items[mid]->name, name);
+    
+    if (cmp < 0)
+    {
+      lo = mid + 1;
+    }
+    else if (cmp > 0)
+    {
+      hi = mid;
+    }
+    else
+    {
+      *p_found = TRUE;
+      return mid;
+    }
+  }
+  
+  return lo;
+}
+
+//----------------------------------------------------------------------------------------
+
+// returns the position of the child or -1
+static number_t cape_udc__array_find (CapeUdc self, const char* name)
+{
+  CapeUdcArray* a;
+  number_t index;
+  int found;
+  
+  CAPE_UDC__LOAD (self);
+  
+  a = self->data;
+  
+  if (a == NULL || name == NULL)
+  {
+    return -1;
+  }
+  
+  index = cape_udc__array_search (a, name, &found);
+  
+  return found ? index : -1;
+}
+
+//----------------------------------------------------------------------------------------
+
+// reads only, the array might be shared
+static CapeUdc cape_udc__array_get (CapeUdc self, const char* name)
+{
+  CapeUdcArray* a;
+  
+  CAPE_UDC__LOAD (self);
+  
+  a = self->data;
+  
+  if (a == NULL || name == NULL)
+  {
+    return NULL;
+  }
+  
+  if (a->slots)
+  {
+    unsigned int hash = cape_udc__hash (name);
+    number_t pos;
+    
+    for (pos = hash & a->mask; a->slots[pos].item; pos = (pos + 1) & a->mask)
+    {
+      if (a->slots[pos].hash == hash)
+      {
+        const char* h = a->slots[pos].item->name;
+        
+        if (h == name || (h && strcmp (h, name) == 0))
+        {
+          return a->slots[pos].item;
+        }
+      }
+    }
+    
+    return NULL;
+  }
+  else
+  {
+    int found;
+    number_t index = cape_udc__array_search (a, name, &found);
+    
+    return found ? a->items[index] : NULL;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+// removes the child from the array, in documents the memory stays in the arena
+static CapeUdc cape_udc__array_rm (CapeUdc self, number_t index)
+{
+  CapeUdcArray* a = self->data;
+  
+  CapeUdc h = a->items[index];
+  
+  a->size--;
+  
+  memmove (a->items + index, a->items + index + 1, (a->size - index) * sizeof(CapeUdc));
+  
+  if (a->slots)
+  {
+    cape_udc__index_rm (a, h);
+  }
+  
+  return h;
+}
+
+//----------------------------------------------------------------------------------------
+
+// the children are deleted with the last reference
+static void cape_udc__array_release (CapeUdcArray** p_a)
+{
+  CapeUdcArray* a = *p_a;
+  
+  if (a && CAPE_UDC__DEC (&(a->refcnt)) == 0)
+  {
+    number_t i;
+    
+    for (i = 0; i < a->size; i++)
+    {
+      cape_udc_del (&(a->items[i]));
+    }
+    
+    free (a->items);
+    free (a->slots);
+    
+    CAPE_DEL (&a, CapeUdcArray);
+  }
+  
+  *p_a = NULL;
+}
+
+//----------------------------------------------------------------------------------------
+
+static CapeUdc cape_udc__cp (const CapeUdc self);
+
+//----------------------------------------------------------------------------------------
+
+// the children are copied, frozen arrays of the children are shared
+static CapeUdcArray* cape_udc__array_cp (CapeUdc clone, const CapeUdcArray* a)
+{
+  CapeUdcArray* ret;
+  number_t i;
+  
+  if (a == NULL || a->size == 0)
+  {
+    return NULL;
+  }
+  
+  ret = CAPE_NEW (CapeUdcArray);
+  
+  ret->size = a->size;
+  ret->capacity = a->size;
+  ret->items = malloc (a->size * sizeof(CapeUdc));
+  ret->refcnt = 1;
+  
+  for (i = 0; i < a->size; i++)
+  {
+    ret->items[i] = cape_udc__cp (a->items[i]);
+  }
+  
+  if (a->slots)
+  {
+    cape_udc__index_resize (clone, ret);
+  }
+  
+  return ret;
+}
+
+//----------------------------------------------------------------------------------------
+
+// must be called before the children are changed or handed out
+static void cape_udc__array_own (CapeUdc self)
+{
+  CapeUdcArray* a;
+  
+  CAPE_UDC__LOAD (self);
+  
+  a = self->data;
+  
+  // a frozen udc is only read, but a copy can't change the shared array
+  if (a && a->frozen && (self->flags & CAPE_UDC__FROZEN) == 0)
+  {
+    // only this level is copied
+    self->data = cape_udc__array_cp (self, a);
+    
+    cape_udc__array_release (&a);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static int cape_udc__frozen (CapeUdc self, const char* unit)
+{
+  if (self->flags & CAPE_UDC__FROZEN)
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", unit, "udc is frozen");
+    return TRUE;
+  }
+  
+  return FALSE;
+}
+
 //-----------------------------------------------------------------------------
 
-CapeUdc cape_udc_new (u_t type, const CapeString name)
+static CapeUdc cape_udc__new (u_t type)
 {
   CapeUdc self = CAPE_NEW(struct CapeUdc_s);
   
   self->type = type;
   self->data = NULL;
   
-  self->name = cape_str_cp (name);
-  
   switch (self->type)
   {
     case CAPE_UDC_NODE:
     {
-      self->data = cape_map_new (NULL, cape_udc_node_onDel, NULL);
+      // the array is created with the first child
+      self->data = NULL;
       break;
     }
     case CAPE_UDC_LIST:
     {
-      self->data = cape_list_new (cape_udc_list_onDel);
+      self->data = NULL;
       break;
     }
     case CAPE_UDC_STRING:
@@ -81,6 +655,118 @@ CapeUdc cape_udc_new (u_t type, const CapeString name)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc cape_udc_new (u_t type, const CapeString name)
+{
+  CapeUdc self = cape_udc__new (type);
+  
+  cape_udc__name_set (self, name);
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_new_atom (u_t type, const char* atom)
+{
+  CapeUdc self = cape_udc__new (type);
+  
+  self->name = (CapeString)cape_atom_cp (atom);
+  self->flags = atom ? CAPE_UDC__ATOM : 0;
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc cape_udc__arena_new (CapeArena arena, u_t type, const char* name)
+{
+  CapeUdc self = cape_arena_alloc (arena, sizeof(struct CapeUdc_s));
+  
+  self->type = type;
+  self->flags = 0;
+  self->data = NULL;
+  self->name = cape_arena_str (arena, name);
+  self->arena = arena;
+  
+  if (type == CAPE_UDC_FLOAT)
+  {
+    self->data = cape_arena_alloc (arena, sizeof(double));
+    
+    *(double*)(self->data) = 0;
+  }
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_new_doc (u_t type, const CapeString name)
+{
+  CapeUdc self = cape_udc__arena_new (cape_arena_new (), type, name);
+  
+  self->flags |= CAPE_UDC__ROOT;
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_new_in (const CapeUdc doc, u_t type, const CapeString name)
+{
+  if (doc && doc->arena)
+  {
+    return cape_udc__arena_new (doc->arena, type, name);
+  }
+  
+  return cape_udc_new (type, name);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeArena cape_udc_arena (const CapeUdc self)
+{
+  return self->arena;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_new_ref (const CapeUdc doc, u_t type, const char* name)
+{
+  if (doc && doc->arena)
+  {
+    CapeUdc self = cape_udc__arena_new (doc->arena, type, NULL);
+    
+    self->name = (CapeString)name;
+    
+    return self;
+  }
+  
+  return cape_udc_new (type, name);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_udc_set_lazy (CapeUdc self, fct_cape_udc_onLoad onLoad, void* ptr, number_t pos)
+{
+  if (self->arena && CAPE_UDC__IS_ARRAY (self) && self->data == NULL)
+  {
+    CapeUdcLazy* l = cape_arena_alloc (self->arena, sizeof(CapeUdcLazy));
+    
+    l->onLoad = onLoad;
+    l->ptr = ptr;
+    l->pos = pos;
+    
+    self->data = l;
+    self->flags |= CAPE_UDC__LAZY;
+  }
+  else
+  {
+    onLoad (ptr, self, pos);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_udc_del (CapeUdc* p_self)
 {
   CapeUdc self = *p_self;
@@ -90,18 +776,29 @@ void cape_udc_del (CapeUdc* p_self)
     return;
   }
   
-  cape_str_del (&(self->name));
+  if (self->arena)
+  {
+    // the udcs of a document are released all together by the root
+    if (self->flags & CAPE_UDC__ROOT)
+    {
+      // the root itself is part of the arena
+      CapeArena arena = self->arena;
+      
+      cape_arena_del (&arena);
+    }
+    
+    *p_self = NULL;
+    return;
+  }
+  
+  cape_udc__name_del (self);
   
   switch (self->type)
   {
     case CAPE_UDC_NODE:
-    {
-      cape_map_del ((CapeMap*)&(self->data));
-      break;
-    }
     case CAPE_UDC_LIST:
     {
-      cape_list_del ((CapeList*)&(self->data));
+      cape_udc__array_release ((CapeUdcArray**)&(self->data));
       break;
     }
     case CAPE_UDC_STRING:
@@ -126,51 +823,119 @@ void cape_udc_del (CapeUdc* p_self)
 
 //-----------------------------------------------------------------------------
 
-static void __STDCALL cape_udc_cp__map_on_clone (void* key_original, void* val_original, void** key_clone, void** val_clone)
+// copies the udc into the document of doc or to the heap if doc is NULL
+static CapeUdc cape_udc__clone (const CapeUdc doc, const CapeUdc self)
 {
-  // clone the udc object
-  CapeUdc cloned_udc = cape_udc_cp (val_original);
+  CapeUdc clone = cape_udc_new_in (doc, self->type, self->name);
   
-  // set the key -> we don't need to copy it (key is owned by the udc)
-  *key_clone = (void*)cape_udc_name (cloned_udc);
+  switch (self->type)
+  {
+    case CAPE_UDC_NODE:
+    case CAPE_UDC_LIST:
+    {
+      // read only, the array might be shared
+      CapeUdcArray* a;
+      number_t i;
+      
+      CAPE_UDC__LOAD (self);
+      
+      a = self->data;
+      
+      for (i = 0; a && i < a->size; i++)
+      {
+        CapeUdc h = cape_udc__clone (doc, a->items[i]);
+        
+        cape_udc_add (clone, &h);
+      }
+      
+      break;
+    }
+    case CAPE_UDC_STRING:
+    {
+      cape_udc_set_s_cp (clone, self->data);
+      break;
+    }
+    case CAPE_UDC_NUMBER:
+    case CAPE_UDC_BOOL:
+    {
+      clone->data = self->data;
+      break;
+    }
+    case CAPE_UDC_FLOAT:
+    {
+      cape_udc_set_f (clone, *(double*)(self->data));
+      break;
+    }
+    case CAPE_UDC_DATETIME:
+    {
+      cape_udc_set_d (clone, self->data);
+      break;
+    }
+  }
   
-  // set the cloned udc
-  *val_clone = (void*)cloned_udc;
+  return clone;
 }
 
 //-----------------------------------------------------------------------------
 
-static void* __STDCALL cape_udc_cp__list_on_clone (void* ptr)
+// removes the child, udcs of a document are returned as copies
+static CapeUdc cape_udc__array_ext (CapeUdc self, number_t index)
 {
-  return cape_udc_cp (ptr);
+  CapeUdc h = cape_udc__array_rm (self, index);
+  
+  return self->arena ? cape_udc__clone (NULL, h) : h;
 }
 
 //-----------------------------------------------------------------------------
 
-CapeUdc cape_udc_cp (const CapeUdc self)
+static CapeUdc cape_udc__cp (const CapeUdc self)
 {
   CapeUdc clone = NULL;
   
   if (self)
   {
+    if (self->arena)
+    {
+      // the copy of a document udc is a normal udc
+      return cape_udc__clone (NULL, self);
+    }
+    
     // copy the base type
     clone = CAPE_NEW (struct CapeUdc_s);
     
     clone->type = self->type;
     clone->data = NULL;
     
-    clone->name = cape_str_cp (self->name);
+    if (self->flags & CAPE_UDC__ATOM)
+    {
+      // atoms are shared
+      clone->name = (CapeString)cape_atom_cp (self->name);
+      clone->flags = CAPE_UDC__ATOM;
+    }
+    else
+    {
+      cape_udc__name_set (clone, self->name);
+    }
     
     switch (self->type)
     {
       case CAPE_UDC_NODE:
-      {
-        clone->data = cape_map_clone (self->data, cape_udc_cp__map_on_clone);
-        break;
-      }
       case CAPE_UDC_LIST:
       {
-        clone->data = cape_list_clone (self->data, cape_udc_cp__list_on_clone);
+        CapeUdcArray* a = self->data;
+        
+        if (a && a->frozen)
+        {
+          // nothing can be changed, the copy shares the array
+          CAPE_UDC__INC (&(a->refcnt));
+          
+          clone->data = a;
+        }
+        else
+        {
+          clone->data = cape_udc__array_cp (clone, a);
+        }
+        
         break;
       }
       case CAPE_UDC_STRING:
@@ -211,6 +976,43 @@ CapeUdc cape_udc_cp (const CapeUdc self)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc cape_udc_cp (const CapeUdc self)
+{
+  return cape_udc__cp (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_udc_freeze (CapeUdc self)
+{
+  CapeUdcArray* a;
+  number_t i;
+  
+  if (self == NULL)
+  {
+    return;
+  }
+  
+  // the readers must not load the children
+  CAPE_UDC__LOAD (self);
+  
+  self->flags |= CAPE_UDC__FROZEN;
+  
+  if (CAPE_UDC__IS_ARRAY (self) && self->data)
+  {
+    a = self->data;
+    
+    a->frozen = TRUE;
+    
+    for (i = 0; i < a->size; i++)
+    {
+      cape_udc_freeze (a->items[i]);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_udc_mv (CapeUdc* p_origin)
 {
   CapeUdc ret = *p_origin;
@@ -447,12 +1249,11 @@ number_t cape_udc_size (const CapeUdc self)
     switch (self->type)
     {
       case CAPE_UDC_NODE:
-      {
-        return cape_map_size (self->data);
-      }
       case CAPE_UDC_LIST:
       {
-        return cape_list_size (self->data);
+        CAPE_UDC__LOAD (self);
+        
+        return self->data ? ((CapeUdcArray*)self->data)->size : 0;
       }
       default:
       {
@@ -466,29 +1267,76 @@ number_t cape_udc_size (const CapeUdc self)
 
 //-----------------------------------------------------------------------------
 
+static CapeUdc cape_udc__array_add (CapeUdc self, number_t index, CapeUdc* p_item)
+{
+  CapeUdc h = *p_item;
+  
+  if (h->arena != self->arena)
+  {
+    // copy the item into the document
+    h = cape_udc__clone (self, h);
+    
+    cape_udc_del (p_item);
+  }
+  
+  cape_udc__array_insert (self, index, h);
+  
+  *p_item = NULL;
+  
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_udc_add (CapeUdc self, CapeUdc* p_item)
 {
+  if (cape_udc__frozen (self, "udc add"))
+  {
+    cape_udc_del (p_item);
+    return NULL;
+  }
+  
+  if (self->arena == NULL && *p_item && (*p_item)->arena)
+  {
+    // a document can't be part of a normal udc, use a copy
+    CapeUdc h = cape_udc__clone (NULL, *p_item);
+    
+    cape_udc_del (p_item);
+    
+    *p_item = h;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_NODE:
     {
-      CapeUdc h = *p_item; 
+      number_t index = 0;
+      int found = FALSE;
       
-      cape_map_insert (self->data, h->name, h);
+      cape_udc__array_own (self);
       
-      *p_item = NULL;
+      if (self->data)
+      {
+        index = cape_udc__array_search (self->data, (*p_item)->name, &found);
+      }
       
-      return h;
+      if (found)
+      {
+        cape_log_msg (CAPE_LL_WARN, "CAPE", "udc add", "key already exists");
+        
+        // keep the existing one
+        cape_udc_del (p_item);
+        
+        return ((CapeUdcArray*)self->data)->items[index];
+      }
+      
+      return cape_udc__array_add (self, index, p_item);
     }
     case CAPE_UDC_LIST:
     {
-      CapeUdc h = *p_item; 
-      
-      cape_list_push_back (self->data, h);
-      
-      *p_item = NULL;
+      cape_udc__array_own (self);
       
-      return h;
+      return cape_udc__array_add (self, cape_udc_size (self), p_item);
     }
     default:
     {
@@ -504,7 +1352,46 @@ CapeUdc cape_udc_add (CapeUdc self, CapeUdc* p_item)
 
 void cape_udc_set_name (const CapeUdc self, const CapeString name)
 {
-  cape_str_replace_cp (&(self->name), name);  
+  if (cape_udc__frozen (self, "udc set name"))
+  {
+    return;
+  }
+  
+  struct CapeUdc_s old = *self;
+  
+  if (self->arena)
+  {
+    self->name = cape_arena_str (self->arena, name);
+    return;
+  }
+  
+  // the name might be the current name
+  cape_udc__name_set (self, name);
+  
+  cape_udc__name_del (&old);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_udc_set_atom (const CapeUdc self, const char* atom)
+{
+  if (cape_udc__frozen (self, "udc set atom"))
+  {
+    return;
+  }
+  
+  struct CapeUdc_s old = *self;
+  
+  if (self->arena)
+  {
+    self->name = cape_arena_str (self->arena, atom);
+    return;
+  }
+  
+  self->name = (CapeString)cape_atom_cp (atom);
+  self->flags = atom ? self->flags | CAPE_UDC__ATOM : self->flags & ~CAPE_UDC__ATOM;
+  
+  cape_udc__name_del (&old);
 }
 
 //-----------------------------------------------------------------------------
@@ -525,7 +1412,24 @@ CapeUdc cape_udc_add_name (CapeUdc self, CapeUdc* p_item, const CapeString name)
 
 //-----------------------------------------------------------------------------
 
-CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
+CapeUdc cape_udc_add_atom (CapeUdc self, CapeUdc* p_item, const char* atom)
+{
+  if (*p_item)
+  {
+    cape_udc_set_atom (*p_item, atom);
+    
+    return cape_udc_add (self, p_item);
+  }
+  else
+  {
+    return NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// the child must not be changed, the array might be shared
+static CapeUdc cape_udc__get (CapeUdc self, const CapeString name)
 {
   // better to check here
   if (self == NULL)
@@ -543,16 +1447,7 @@ CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
   {
     case CAPE_UDC_NODE:
     {
-      CapeMapNode n = cape_map_find (self->data, (void*)name);
-      
-      if (n)
-      {
-        return cape_map_node_value (n);
-      }
-      else
-      {
-        return NULL;
-      }
+      return cape_udc__array_get (self, name);
     }
     default:
     {
@@ -563,6 +1458,19 @@ CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
 
 //-----------------------------------------------------------------------------
 
+CapeUdc cape_udc_get (CapeUdc self, const CapeString name)
+{
+  if (self && self->type == CAPE_UDC_NODE)
+  {
+    // the caller might change the child
+    cape_udc__array_own (self);
+  }
+  
+  return cape_udc__get (self, name);
+}
+
+//-----------------------------------------------------------------------------
+
 CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
 {
   // better to check here
@@ -571,6 +1479,11 @@ CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
     return NULL;
   }
   
+  if (cape_udc__frozen (self, "udc ext"))
+  {
+    return NULL;
+  }
+  
   // if we don't have a name we cannot find something
   if (name == NULL)
   {
@@ -581,23 +1494,13 @@ CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
   {
     case CAPE_UDC_NODE:
     {
-      CapeMapNode n = cape_map_find (self->data, (void*)name);
+      number_t index;
       
-      if (n)
-      {
-        CapeUdc h;
-
-        n = cape_map_extract (self->data, n);  
-        h = cape_map_node_value (n);
-        
-        cape_map_node_del (&n);
-        
-        return h;
-      }
-      else
-      {
-        return NULL;
-      }
+      cape_udc__array_own (self);
+      
+      index = cape_udc__array_find (self, name);
+      
+      return index < 0 ? NULL : cape_udc__array_ext (self, index);
     }
     default:
     {
@@ -610,10 +1513,21 @@ CapeUdc cape_udc_ext (CapeUdc self, const CapeString name)
 
 void cape_udc_set_s_cp (CapeUdc self, const CapeString val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_STRING:
     {
+      if (self->arena)
+      {
+        self->data = cape_arena_str (self->arena, val);
+        break;
+      }
+      
       cape_str_replace_cp ((CapeString*)&(self->data), val);
     }
   }   
@@ -623,10 +1537,24 @@ void cape_udc_set_s_cp (CapeUdc self, const CapeString val)
 
 void cape_udc_set_s_mv (CapeUdc self, CapeString* p_val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    cape_str_del (p_val);
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_STRING:
     {
+      if (self->arena)
+      {
+        self->data = cape_arena_str (self->arena, *p_val);
+        
+        cape_str_del (p_val);
+        break;
+      }
+      
       cape_str_replace_mv ((CapeString*)&(self->data), p_val);
     }
   }   
@@ -634,8 +1562,37 @@ void cape_udc_set_s_mv (CapeUdc self, CapeString* p_val)
 
 //-----------------------------------------------------------------------------
 
+void cape_udc_set_s_ref (CapeUdc self, const char* val)
+{
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
+  switch (self->type)
+  {
+    case CAPE_UDC_STRING:
+    {
+      if (self->arena)
+      {
+        self->data = (void*)val;
+        break;
+      }
+      
+      cape_str_replace_cp ((CapeString*)&(self->data), val);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_udc_set_n (CapeUdc self, number_t val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_NUMBER:
@@ -649,6 +1606,11 @@ void cape_udc_set_n (CapeUdc self, number_t val)
 
 void cape_udc_set_f (CapeUdc self, double val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_FLOAT:
@@ -664,6 +1626,11 @@ void cape_udc_set_f (CapeUdc self, double val)
 
 void cape_udc_set_b (CapeUdc self, int val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_BOOL:
@@ -678,11 +1645,32 @@ void cape_udc_set_b (CapeUdc self, int val)
 
 void cape_udc_set_d (CapeUdc self, const CapeDatetime* val)
 {
+  if (cape_udc__frozen (self, "udc set"))
+  {
+    return;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_DATETIME:
     {
-      if (val)
+      if (self->arena)
+      {
+        if (val && self->data == NULL)
+        {
+          self->data = cape_arena_alloc (self->arena, sizeof(CapeDatetime));
+        }
+        
+        if (val)
+        {
+          memcpy (self->data, val, sizeof(CapeDatetime));
+        }
+        else
+        {
+          self->data = NULL;
+        }
+      }
+      else if (val)
       {
         if (self->data == NULL)
         {
@@ -726,7 +1714,15 @@ CapeString cape_udc_s_mv (CapeUdc self, const CapeString alt)
   {
     case CAPE_UDC_STRING:
     {
-      CapeString h = self->data;
+      CapeString h;
+      
+      if (self->flags & CAPE_UDC__FROZEN)
+      {
+        // the value stays
+        return cape_str_cp (self->data);
+      }
+      
+      h = self->arena ? cape_str_cp (self->data) : self->data;
       
       self->data = NULL;
       
@@ -840,7 +1836,15 @@ CapeDatetime* cape_udc_d_mv (CapeUdc self, const CapeDatetime* alt)
   {
     case CAPE_UDC_DATETIME:
     {
-      CapeDatetime* h = self->data;
+      CapeDatetime* h;
+      
+      if (self->flags & CAPE_UDC__FROZEN)
+      {
+        // the value stays
+        return cape_datetime_cp (self->data);
+      }
+      
+      h = self->arena ? cape_datetime_cp (self->data) : self->data;
       
       self->data = NULL;
       
@@ -857,14 +1861,34 @@ CapeDatetime* cape_udc_d_mv (CapeUdc self, const CapeDatetime* alt)
 
 CapeList cape_udc_list_mv (CapeUdc self)
 {
+  if (cape_udc__frozen (self, "udc list mv"))
+  {
+    return NULL;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_LIST:
     {
-      CapeList h = self->data;
+      CapeList h = cape_list_new (cape_udc_list_onDel);
+      CapeUdcArray* a;
+      
+      cape_udc__array_own (self);
       
-      // create an empty list
-      self->data = cape_list_new (cape_udc_list_onDel);
+      a = self->data;
+      
+      if (a)
+      {
+        number_t i;
+        
+        for (i = 0; i < a->size; i++)
+        {
+          // udcs of a document are copied
+          cape_list_push_back (h, self->arena ? cape_udc__clone (NULL, a->items[i]) : a->items[i]);
+        }
+        
+        a->size = 0;
+      }
       
       return h;
     }
@@ -879,7 +1903,7 @@ CapeList cape_udc_list_mv (CapeUdc self)
 
 CapeUdc cape_udc_add_s_cp (CapeUdc self, const CapeString name, const CapeString val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_STRING, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_STRING, name);
   
   cape_udc_set_s_cp (h, val);
   
@@ -890,7 +1914,7 @@ CapeUdc cape_udc_add_s_cp (CapeUdc self, const CapeString name, const CapeString
 
 CapeUdc cape_udc_add_s_mv (CapeUdc self, const CapeString name, CapeString* p_val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_STRING, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_STRING, name);
   
   cape_udc_set_s_mv (h, p_val);
   
@@ -901,7 +1925,7 @@ CapeUdc cape_udc_add_s_mv (CapeUdc self, const CapeString name, CapeString* p_va
 
 CapeUdc cape_udc_add_n (CapeUdc self, const CapeString name, number_t val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_NUMBER, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_NUMBER, name);
   
   cape_udc_set_n (h, val);
   
@@ -912,7 +1936,7 @@ CapeUdc cape_udc_add_n (CapeUdc self, const CapeString name, number_t val)
 
 CapeUdc cape_udc_add_f (CapeUdc self, const CapeString name, double val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_FLOAT, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_FLOAT, name);
   
   cape_udc_set_f (h, val);
   
@@ -923,7 +1947,7 @@ CapeUdc cape_udc_add_f (CapeUdc self, const CapeString name, double val)
 
 CapeUdc cape_udc_add_b (CapeUdc self, const CapeString name, int val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_BOOL, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_BOOL, name);
   
   cape_udc_set_b (h, val);
   
@@ -934,7 +1958,7 @@ CapeUdc cape_udc_add_b (CapeUdc self, const CapeString name, int val)
 
 CapeUdc cape_udc_add_d (CapeUdc self, const CapeString name, const CapeDatetime* val)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_DATETIME, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_DATETIME, name);
   
   cape_udc_set_d (h, val);
   
@@ -945,7 +1969,7 @@ CapeUdc cape_udc_add_d (CapeUdc self, const CapeString name, const CapeDatetime*
 
 CapeUdc cape_udc_add_z (CapeUdc self, const CapeString name)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_NULL, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_NULL, name);
   
   return cape_udc_add (self, &h);
 }
@@ -954,7 +1978,7 @@ CapeUdc cape_udc_add_z (CapeUdc self, const CapeString name)
 
 CapeUdc cape_udc_add_node (CapeUdc self, const CapeString name)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_NODE, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_NODE, name);
   
   return cape_udc_add (self, &h);
 }
@@ -963,7 +1987,7 @@ CapeUdc cape_udc_add_node (CapeUdc self, const CapeString name)
 
 CapeUdc cape_udc_add_list (CapeUdc self, const CapeString name)
 {
-  CapeUdc h = cape_udc_new (CAPE_UDC_LIST, name);
+  CapeUdc h = cape_udc_new_in (self, CAPE_UDC_LIST, name);
   
   return cape_udc_add (self, &h);
 }
@@ -972,7 +1996,7 @@ CapeUdc cape_udc_add_list (CapeUdc self, const CapeString name)
 
 const CapeString cape_udc_get_s (CapeUdc self, const CapeString name, const CapeString alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
   
   if (h)
   {
@@ -986,7 +2010,7 @@ const CapeString cape_udc_get_s (CapeUdc self, const CapeString name, const Cape
 
 number_t cape_udc_get_n (CapeUdc self, const CapeString name, number_t alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
   
   if (h)
   {
@@ -1000,7 +2024,7 @@ number_t cape_udc_get_n (CapeUdc self, const CapeString name, number_t alt)
 
 double cape_udc_get_f (CapeUdc self, const CapeString name, double alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
   
   if (h)
   {
@@ -1014,7 +2038,7 @@ double cape_udc_get_f (CapeUdc self, const CapeString name, double alt)
 
 int cape_udc_get_b (CapeUdc self, const CapeString name, int alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
   
   if (h)
   {
@@ -1028,7 +2052,7 @@ int cape_udc_get_b (CapeUdc self, const CapeString name, int alt)
 
 const CapeDatetime* cape_udc_get_d (CapeUdc self, const CapeString name, const CapeDatetime* alt)
 {
-  CapeUdc h = cape_udc_get (self, name);
+  CapeUdc h = cape_udc__get (self, name);
   
   if (h)
   {
@@ -1076,60 +2100,75 @@ CapeUdc cape_udc_get_list (CapeUdc self, const CapeString name)
 
 CapeUdc cape_udc_get_first (CapeUdc self)
 {
-  switch (self->type)
+  if (CAPE_UDC__IS_ARRAY (self))
   {
-    case CAPE_UDC_LIST:
-    {
-      CapeListNode n = cape_list_node_front (self->data);
-      
-      if (n)
-      {
-        return cape_list_node_data (n);
-      }
-      else
-      {
-        return NULL;
-      }
-    }
-    case CAPE_UDC_NODE:
-    {
-      CapeMapNode n = cape_map_first (self->data);
+    cape_udc__array_own (self);
+    
+    return cape_udc_size (self) ? ((CapeUdcArray*)self->data)->items[0] : NULL;
+  }
+  
+  return NULL;
+}
 
-      if (n)
-      {
-        return cape_map_node_value (n);
-      }
-      else
-      {
-        return NULL;
-      }
+//-----------------------------------------------------------------------------
+
+CapeUdc cape_udc_get_at (CapeUdc self, number_t index)
+{
+  if (self && CAPE_UDC__IS_ARRAY (self))
+  {
+    number_t size = cape_udc_size (self);
+    
+    if (index < 0)
+    {
+      // counted from the end
+      index += size;
     }
-    default:
+    
+    if (index >= 0 && index < size)
     {
-      return NULL;
+      cape_udc__array_own (self);
+      
+      return ((CapeUdcArray*)self->data)->items[index];
     }
   }
+  
+  return NULL;
 }
 
 //-----------------------------------------------------------------------------
 
 CapeString cape_udc_ext_s (CapeUdc self, const CapeString name)
 {
+  if (cape_udc__frozen (self, "udc ext"))
+  {
+    return NULL;
+  }
+  
   switch (self->type)
   {
     case CAPE_UDC_NODE:
     {
-      CapeMapNode n = cape_map_find (self->data, (void*)name);
-      if (n)
+      number_t index;
+      
+      cape_udc__array_own (self);
+      
+      index = cape_udc__array_find (self, name);
+      
+      if (index >= 0)
       {
-        CapeUdc h = cape_map_node_value (n);
+        CapeUdc h = ((CapeUdcArray*)self->data)->items[index];
 
         if (h->type == CAPE_UDC_STRING)
         {
           CapeString ret;
           
-          // remove the UDC (h) from the map
-          n = cape_map_extract (self->data, n);
+          // remove the UDC (h) from the node
+          cape_udc__array_rm (self, index);
+          
+          if (self->arena)
+          {
+            return cape_str_cp (h->data);
+          }
 
           // get the content
           ret = h->data;
@@ -1137,7 +2176,6 @@ CapeString cape_udc_ext_s (CapeUdc self, const CapeString name)
 
           // clean up
           cape_udc_del (&h);
-          cape_map_node_del (&n);
           
           return ret;
         }
@@ -1206,46 +2244,19 @@ CapeUdc cape_udc_ext_list (CapeUdc self, const CapeString name)
 
 CapeUdc cape_udc_ext_first (CapeUdc self)
 {
-  switch (self->type)
+  if (cape_udc__frozen (self, "udc ext"))
   {
-    case CAPE_UDC_LIST:
-    {
-      CapeListCursor cursor; cape_list_cursor_init (self->data, &cursor, CAPE_DIRECTION_FORW);
-
-      if (cape_list_cursor_next (&cursor))
-      {
-        return cape_list_node_extract (self->data, cursor.node);
-      }
-      else
-      {
-        return NULL;
-      }
-    }
-    case CAPE_UDC_NODE:
-    {
-      CapeMapCursor cursor; cape_map_cursor_init (self->data, &cursor, CAPE_DIRECTION_FORW);
-      
-      if (cape_map_cursor_next (&cursor))
-      {
-        CapeMapNode n = cape_map_cursor_extract (self->data, &cursor);
-        
-        CapeUdc u = cape_map_node_value (n);
-
-        // releases the node memory
-        cape_map_node_del (&n);
-        
-        return u;
-      }
-      else
-      {
-        return NULL;
-      }
-    }
-    default:
-    {
-      return NULL;
-    }
+    return NULL;
+  }
+  
+  if (CAPE_UDC__IS_ARRAY (self))
+  {
+    cape_udc__array_own (self);
+    
+    return cape_udc_size (self) ? cape_udc__array_ext (self, 0) : NULL;
   }
+  
+  return NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -1258,30 +2269,24 @@ CapeUdcCursor* cape_udc_cursor_new (CapeUdc self, int direction)
   cursor->position = -1;
   cursor->item = NULL;
   
-  switch (self->type)
+  if (CAPE_UDC__IS_ARRAY (self))
   {
-    case CAPE_UDC_NODE:
-    {
-      cursor->data = cape_map_cursor_create (self->data, direction);
-      cursor->type = CAPE_UDC_NODE;
-      
-      break;
-    }
-    case CAPE_UDC_LIST:
-    {
-      cursor->data = cape_list_cursor_create (self->data, direction);
-      cursor->type = CAPE_UDC_LIST;
-      
-      break;
-    }
-    default:
-    {
-      cursor->data = NULL;
-      cursor->type = 0;
-      
-      break;
-    }
-  } 
+    CapeUdcArrayCursor* c = CAPE_NEW (CapeUdcArrayCursor);
+    
+    // the items might be changed by the caller
+    cape_udc__array_own (self);
+    
+    c->udc = self;
+    c->index = (direction == CAPE_DIRECTION_FORW) ? -1 : cape_udc_size (self);
+    
+    cursor->data = c;
+    cursor->type = CAPE_UDC__CURSOR_ARRAY;
+    
+    return cursor;
+  }
+  
+  cursor->data = NULL;
+  cursor->type = 0;
   
   return cursor;
 }
@@ -1296,14 +2301,9 @@ void cape_udc_cursor_del (CapeUdcCursor** p_cursor)
     
     switch (cursor->type)
     {
-      case CAPE_UDC_NODE:
-      {
-        cape_map_cursor_destroy ((CapeMapCursor**)&(cursor->data));
-        break;
-      }
-      case CAPE_UDC_LIST:
+      case CAPE_UDC__CURSOR_ARRAY:
       {
-        cape_list_cursor_destroy ((CapeListCursor**)&(cursor->data));
+        CAPE_DEL (&(cursor->data), CapeUdcArrayCursor);
         break;
       }
     }
@@ -1320,33 +2320,22 @@ int cape_udc_cursor_next (CapeUdcCursor* cursor)
   {
     switch (cursor->type)
     {
-      case CAPE_UDC_NODE:
-      {
-        CapeMapCursor* c = cursor->data;
-        
-        int res = cape_map_cursor_next (c);
-        
-        if (res)
-        {
-          cursor->position++;
-          cursor->item = cape_map_node_value (c->node);
-        }
-        
-        return res;
-      }
-      case CAPE_UDC_LIST:
+      case CAPE_UDC__CURSOR_ARRAY:
       {
-        CapeListCursor* c = cursor->data;
+        CapeUdcArrayCursor* c = cursor->data;
         
-        int res = cape_list_cursor_next (c);
-        
-        if (res)
+        // the array might be changed in between
+        if (c->index + 1 < cape_udc_size (c->udc))
         {
+          c->index++;
+          
           cursor->position++;
-          cursor->item = cape_list_node_data (c->node);
+          cursor->item = ((CapeUdcArray*)c->udc->data)->items[c->index];
+          
+          return TRUE;
         }
         
-        return res;
+        return FALSE;
       }
     }
   }
@@ -1362,33 +2351,21 @@ int cape_udc_cursor_prev (CapeUdcCursor* cursor)
   {
     switch (cursor->type)
     {
-      case CAPE_UDC_NODE:
-      {
-        CapeMapCursor* c = cursor->data;
-        
-        int res = cape_map_cursor_prev (c);
-        
-        if (res)
-        {
-          cursor->position--;
-          cursor->item = cape_map_node_value (c->node);
-        }
-        
-        return res;
-      }
-      case CAPE_UDC_LIST:
+      case CAPE_UDC__CURSOR_ARRAY:
       {
-        CapeListCursor* c = cursor->data;
-        
-        int res = cape_list_cursor_prev (c);
+        CapeUdcArrayCursor* c = cursor->data;
         
-        if (res)
+        if (c->index > 0 && c->index - 1 < cape_udc_size (c->udc))
         {
+          c->index--;
+          
           cursor->position--;
-          cursor->item = cape_list_node_data (c->node);
+          cursor->item = ((CapeUdcArray*)c->udc->data)->items[c->index];
+          
+          return TRUE;
         }
         
-        return res;
+        return FALSE;
       }
     }
   }
@@ -1407,27 +2384,34 @@ void cape_udc_cursor_rm (CapeUdc self, CapeUdcCursor* cursor)
 
 CapeUdc cape_udc_cursor_ext (CapeUdc self, CapeUdcCursor* cursor)
 {
-  switch (self->type)
+  if (cape_udc__frozen (self, "udc ext"))
   {
-    case CAPE_UDC_NODE:
+    return NULL;
+  }
+  
+  if (cursor->type == CAPE_UDC__CURSOR_ARRAY)
+  {
+    CapeUdcArrayCursor* c = cursor->data;
+    
+    CapeUdc h;
+    
+    if (c->index < 0 || c->index >= cape_udc_size (self))
     {
-      CapeMapNode n = cape_map_cursor_extract (self->data, cursor->data);
-      
-      if (n)
-      {
-        CapeUdc h = cape_map_node_value (n);
-        
-        cape_map_node_del (&n);
-        
-        return h;
-      }
-
-      break;
+      return NULL;
     }
-    case CAPE_UDC_LIST:
+    
+    // the udc might have been copied in between
+    cape_udc__array_own (self);
+    
+    h = cape_udc__array_ext (self, c->index);
+    
+    if (cursor->direction == CAPE_DIRECTION_FORW)
     {
-      return cape_list_cursor_extract (self->data, cursor->data);
+      // the next item moved to the current index
+      c->index--;
     }
+    
+    return h;
   }
   
   return NULL;
@@ -5,6 +5,7 @@
 #include "sys/cape_time.h"
 #include "stc/cape_str.h"
 #include "stc/cape_list.h"
+#include "stc/cape_arena.h"
 
 //-----------------------------------------------------------------------------
 
@@ -28,6 +29,38 @@ __CAPE_LIBEX   CapeUdc              cape_udc_new              (u_t type, const C
 
 __CAPE_LIBEX   void                 cape_udc_del              (CapeUdc*);
 
+                                    /* the name must be an atom of a CapeAtoms table, the udc adds a reference */
+__CAPE_LIBEX   CapeUdc              cape_udc_new_atom         (u_t type, const char* atom);
+
+                                    /* if enabled all new names are interned in the global atom table
+                                       -> equal names share one allocation, the name compare is done by address */
+__CAPE_LIBEX   void                 cape_udc_intern           (int enable);
+
+                                    /* creates the root of a document, all udcs, names and values of the document are
+                                       allocated in one arena and released together with the root
+                                       -> removed children stay in the arena until the document is released
+                                       -> udcs and values taken out of a document (ext, cp and _mv functions) are copies */
+__CAPE_LIBEX   CapeUdc              cape_udc_new_doc          (u_t type, const CapeString name);
+
+                                    /* creates a udc in the document of doc, it must be added to this document
+                                       -> for normal udcs it is the same as cape_udc_new */
+__CAPE_LIBEX   CapeUdc              cape_udc_new_in           (const CapeUdc doc, u_t type, const CapeString name);
+
+                                    // returns the arena of a document udc, NULL for normal udcs
+__CAPE_LIBEX   CapeArena            cape_udc_arena            (const CapeUdc);
+
+                                    /* like cape_udc_new_in, but the name of a document udc is not copied
+                                       -> the name must stay valid as long as the document, e.g. memory of its arena */
+__CAPE_LIBEX   CapeUdc              cape_udc_new_ref          (const CapeUdc doc, u_t type, const char* name);
+
+typedef void (__STDCALL *fct_cape_udc_onLoad) (void* ptr, CapeUdc self, number_t pos);
+
+                                    /* the children of an empty document node or list are added by onLoad when the udc
+                                       is used the first time (size, get, add, cursors, copies, ...)
+                                       -> a lazy document is changed by reading, it must not be used by different threads
+                                       -> for normal udcs onLoad is called directly */
+__CAPE_LIBEX   void                 cape_udc_set_lazy         (CapeUdc, fct_cape_udc_onLoad, void* ptr, number_t pos);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   const CapeString     cape_udc_name             (const CapeUdc);
@@ -40,10 +73,18 @@ __CAPE_LIBEX   number_t             cape_udc_size             (const CapeUdc);
 
 //-----------------------------------------------------------------------------
 
+                                    /* the copy shares the children of frozen nodes and lists, all other children are copied */
 __CAPE_LIBEX   CapeUdc              cape_udc_cp               (const CapeUdc);
 
 __CAPE_LIBEX   CapeUdc              cape_udc_mv               (CapeUdc*);
 
+                                    /* the udc and all its children can't be changed anymore, it can be read and copied by different threads
+                                       -> changes are refused with an error log, ext returns NULL
+                                       -> copies are normal udcs, a node or list of a copy gets its own children when they are changed
+                                          or handed out (add, ext, get, get_first, cursors), only this level is copied
+                                       -> a copy must not be used by different threads at the same time */
+__CAPE_LIBEX   void                 cape_udc_freeze           (CapeUdc);
+
 __CAPE_LIBEX   void                 cape_udc_replace_cp       (CapeUdc*, const CapeUdc replace_with_copy);
 
 __CAPE_LIBEX   void                 cape_udc_replace_mv       (CapeUdc*, CapeUdc* replace_with);
@@ -54,10 +95,15 @@ __CAPE_LIBEX   void                 cape_udc_merge_cp         (CapeUdc, const Ca
 
 //-----------------------------------------------------------------------------
 
+                                    /* the children of nodes are sorted by name, large nodes get a hash index
+                                       -> if the name exists already, a warning is logged, the item is deleted and the existing child
+                                          is returned unchanged, even if it has another type */
 __CAPE_LIBEX   CapeUdc              cape_udc_add              (CapeUdc, CapeUdc*);
 
 __CAPE_LIBEX   CapeUdc              cape_udc_add_name         (CapeUdc, CapeUdc*, const CapeString name);
 
+__CAPE_LIBEX   CapeUdc              cape_udc_add_atom         (CapeUdc, CapeUdc*, const char* atom);
+
 __CAPE_LIBEX   CapeUdc              cape_udc_get              (CapeUdc, const CapeString name);
 
 __CAPE_LIBEX   CapeUdc              cape_udc_ext              (CapeUdc, const CapeString name);
@@ -68,6 +114,9 @@ __CAPE_LIBEX   void                 cape_udc_set_s_cp         (CapeUdc, const Ca
 
 __CAPE_LIBEX   void                 cape_udc_set_s_mv         (CapeUdc, CapeString* p_val);
 
+                                    // the value of a document udc is not copied, it must stay valid as long as the document
+__CAPE_LIBEX   void                 cape_udc_set_s_ref        (CapeUdc, const char* val);
+
 __CAPE_LIBEX   void                 cape_udc_set_n            (CapeUdc, number_t val);
 
 __CAPE_LIBEX   void                 cape_udc_set_f            (CapeUdc, double val);
@@ -132,6 +181,9 @@ __CAPE_LIBEX   CapeUdc              cape_udc_get_list         (CapeUdc, const Ca
 
 __CAPE_LIBEX   CapeUdc              cape_udc_get_first        (CapeUdc);
 
+                                    // the child at the position of a node or list, negative positions count from the end
+__CAPE_LIBEX   CapeUdc              cape_udc_get_at           (CapeUdc, number_t index);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   CapeString           cape_udc_ext_s            (CapeUdc, const CapeString name);
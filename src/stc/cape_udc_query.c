@@ -0,0 +1,246 @@
+#include "cape_udc_query.h"
+
+// c includes
+#include <string.h>
+#include <stdlib.h>
+
+//=============================================================================
+
+typedef struct CapeUdcQueryStep_s CapeUdcQueryStep;
+
+struct CapeUdcQueryStep_s
+{
+  CapeString name;                // NULL if the step is a position
+
+  number_t index;
+
+  CapeUdcQueryStep** steps;       // the next steps of all paths through this step
+
+  number_t steps_size;
+
+  number_t* results;              // the paths ending here
+
+  number_t results_size;
+};
+
+//-----------------------------------------------------------------------------
+
+struct CapeUdcQuery_s
+{
+  CapeUdcQueryStep* root;
+
+  number_t size;
+};
+
+//-----------------------------------------------------------------------------
+
+static void cape_udc_query__step_del (CapeUdcQueryStep** p_self)
+{
+  CapeUdcQueryStep* self = *p_self;
+  number_t i;
+
+  for (i = 0; i < self->steps_size; i++)
+  {
+    cape_udc_query__step_del (&(self->steps[i]));
+  }
+
+  cape_str_del (&(self->name));
+
+  free (self->steps);
+  free (self->results);
+
+  CAPE_DEL (p_self, CapeUdcQueryStep);
+}
+
+//-----------------------------------------------------------------------------
+
+// returns the existing step or adds a new one
+static CapeUdcQueryStep* cape_udc_query__step_get (CapeUdcQueryStep* self, const char* name, number_t len, number_t index)
+{
+  CapeUdcQueryStep* step;
+  number_t i;
+
+  for (i = 0; i < self->steps_size; i++)
+  {
+    step = self->steps[i];
+
+    if (name ? (step->name && (number_t)strlen (step->name) == len && strncmp (step->name, name, len) == 0) : (step->name == NULL && step->index == index))
+    {
+      return step;
+    }
+  }
+
+  step = CAPE_NEW (CapeUdcQueryStep);
+
+  step->name = name ? cape_str_sub (name, len) : NULL;
+  step->index = index;
+
+  self->steps = realloc (self->steps, (self->steps_size + 1) * sizeof(CapeUdcQueryStep*));
+  self->steps[self->steps_size++] = step;
+
+  return step;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeUdcQuery cape_udc_query_new (void)
+{
+  CapeUdcQuery self = CAPE_NEW (struct CapeUdcQuery_s);
+
+  self->root = CAPE_NEW (CapeUdcQueryStep);
+  self->size = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_udc_query_del (CapeUdcQuery* p_self)
+{
+  CapeUdcQuery self = *p_self;
+
+  if (self)
+  {
+    cape_udc_query__step_del (&(self->root));
+
+    CAPE_DEL (p_self, struct CapeUdcQuery_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// the path is checked first and compiled in the second run, a wrong path doesn't leave any steps
+static int cape_udc_query__parse (CapeUdcQuery self, const char* path, int compile, CapeErr err)
+{
+  const char* pos = path;
+  CapeUdcQueryStep* step = self->root;
+
+  while (*pos)
+  {
+    if (*pos == '[')
+    {
+      char* end;
+      number_t index = strtol (pos + 1, &end, 10);
+
+      if (end == pos + 1 || *end != ']')
+      {
+        return cape_err_set_fmt (err, CAPE_ERR_PARSER, "invalid position in '%s'", path);
+      }
+
+      if (compile)
+      {
+        step = cape_udc_query__step_get (step, NULL, 0, index);
+      }
+
+      pos = end + 1;
+    }
+    else
+    {
+      const char* end = pos;
+
+      while (*end && *end != '.' && *end != '[' && *end != ']')
+      {
+        end++;
+      }
+
+      if (end == pos)
+      {
+        return cape_err_set_fmt (err, CAPE_ERR_PARSER, "empty name in '%s'", path);
+      }
+
+      if (compile)
+      {
+        step = cape_udc_query__step_get (step, pos, end - pos, 0);
+      }
+
+      pos = end;
+    }
+
+    if (*pos == '.')
+    {
+      pos++;
+
+      // a name must follow
+      if (*pos == 0 || *pos == '.' || *pos == '[')
+      {
+        return cape_err_set_fmt (err, CAPE_ERR_PARSER, "empty name in '%s'", path);
+      }
+    }
+    else if (*pos && *pos != '[')
+    {
+      return cape_err_set_fmt (err, CAPE_ERR_PARSER, "unexpected '%c' in '%s'", *pos, path);
+    }
+  }
+
+  if (compile)
+  {
+    step->results = realloc (step->results, (step->results_size + 1) * sizeof(number_t));
+    step->results[step->results_size++] = self->size++;
+  }
+
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_udc_query_add (CapeUdcQuery self, const char* path, CapeErr err)
+{
+  int res;
+
+  if (path == NULL)
+  {
+    return cape_err_set (err, CAPE_ERR_WRONG_VALUE, "path is NULL");
+  }
+
+  res = cape_udc_query__parse (self, path, FALSE, err);
+  if (res)
+  {
+    return res;
+  }
+
+  return cape_udc_query__parse (self, path, TRUE, err);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_udc_query_size (CapeUdcQuery self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_udc_query__run (CapeUdcQueryStep* self, CapeUdc udc, CapeUdc* results)
+{
+  number_t i, found = self->results_size;
+
+  for (i = 0; i < self->results_size; i++)
+  {
+    results[self->results[i]] = udc;
+  }
+
+  for (i = 0; i < self->steps_size; i++)
+  {
+    CapeUdcQueryStep* step = self->steps[i];
+
+    CapeUdc h = step->name ? cape_udc_get (udc, step->name) : cape_udc_get_at (udc, step->index);
+
+    if (h)
+    {
+      found += cape_udc_query__run (step, h, results);
+    }
+  }
+
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_udc_query_run (CapeUdcQuery self, CapeUdc udc, CapeUdc* results)
+{
+  memset (results, 0, self->size * sizeof(CapeUdc));
+
+  return udc ? cape_udc_query__run (self->root, udc, results) : 0;
+}
+
+//-----------------------------------------------------------------------------
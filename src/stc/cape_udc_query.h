@@ -0,0 +1,45 @@
+#ifndef __CAPE_STC__UDC_QUERY__H
+#define __CAPE_STC__UDC_QUERY__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "sys/cape_err.h"
+#include "stc/cape_udc.h"
+
+//=============================================================================
+
+/* this class implements compiled path queries for udcs
+ *
+ * -> a path names the children from the root, separated by dots, positions
+ *    of lists and nodes are given in brackets: "a.b[3].c", "[0].id", "list[-1]"
+ * -> all paths are compiled once into a tree of steps, paths with the same
+ *    beginning share these steps
+ * -> running the query looks up every step only once and writes the udc of
+ *    each path into the results array, in the order the paths were added
+ * -> names can't contain '.', '[' or ']'
+ */
+
+//=============================================================================
+
+struct CapeUdcQuery_s; typedef struct CapeUdcQuery_s* CapeUdcQuery;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeUdcQuery      cape_udc_query_new         (void);
+
+__CAPE_LIBEX   void              cape_udc_query_del         (CapeUdcQuery*);
+
+                                 // compiles the path, the result has the position of the number of paths added before
+__CAPE_LIBEX   int               cape_udc_query_add         (CapeUdcQuery, const char* path, CapeErr err);
+
+                                 // the number of paths and the size of the results array
+__CAPE_LIBEX   number_t          cape_udc_query_size        (CapeUdcQuery);
+
+                                 /* extracts all paths in one traversal, results must have the size of the query
+                                    -> paths which don't exist are set to NULL
+                                    -> returns the number of paths found */
+__CAPE_LIBEX   number_t          cape_udc_query_run         (CapeUdcQuery, CapeUdc udc, CapeUdc* results);
+
+//-----------------------------------------------------------------------------
+
+#endif
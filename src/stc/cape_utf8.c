@@ -0,0 +1,691 @@
+#include "cape_utf8.h"
+
+// c includes
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#if defined __x86_64__ || defined _M_X64
+
+#define CAPE_UTF8__X86 1
+
+#include <immintrin.h>
+
+#if defined _MSC_VER
+
+#include <intrin.h>
+
+#define CAPE_UTF8__AVX2
+
+static __CAPE_INLINE int cape_utf8__ctz (unsigned int mask)
+{
+  unsigned long ret;
+
+  _BitScanForward (&ret, mask);
+
+  return (int)ret;
+}
+
+#else
+
+#define CAPE_UTF8__AVX2                 __attribute__((target("avx2")))
+
+#define cape_utf8__ctz(mask)            __builtin_ctz (mask)
+
+#endif
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  int (*check) (const char*, number_t, number_t*);
+
+  number_t (*count) (const char*, number_t);
+
+  const char* (*find) (const char*, number_t, const char*, number_t);
+
+} CapeUtf8Kernel;
+
+//-----------------------------------------------------------------------------
+
+// returns the length of a valid character or 0
+static __CAPE_INLINE number_t cape_utf8__step (const unsigned char* pos, const unsigned char* end)
+{
+  unsigned char c = pos[0];
+
+  if (c < 0x80)
+  {
+    return 1;
+  }
+
+  if (c < 0xC2)
+  {
+    // continuation byte or overlong form of ascii
+    return 0;
+  }
+
+  if (c < 0xE0)
+  {
+    return (end - pos >= 2 && (pos[1] & 0xC0) == 0x80) ? 2 : 0;
+  }
+
+  if (c < 0xF0)
+  {
+    if (end - pos < 3 || (pos[1] & 0xC0) != 0x80 || (pos[2] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+
+    // overlong forms and surrogates
+    if ((c == 0xE0 && pos[1] < 0xA0) || (c == 0xED && pos[1] > 0x9F))
+    {
+      return 0;
+    }
+
+    return 3;
+  }
+
+  if (c < 0xF5)
+  {
+    if (end - pos < 4 || (pos[1] & 0xC0) != 0x80 || (pos[2] & 0xC0) != 0x80 || (pos[3] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+
+    // overlong forms and above U+10FFFF
+    if ((c == 0xF0 && pos[1] < 0x90) || (c == 0xF4 && pos[1] > 0x8F))
+    {
+      return 0;
+    }
+
+    return 4;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int cape_utf8__check_scalar (const char* bufdat, number_t buflen, number_t* chars)
+{
+  const unsigned char* pos = (const unsigned char*)bufdat;
+  const unsigned char* end = pos + buflen;
+
+  number_t cnt = 0;
+
+  while (pos < end)
+  {
+    number_t len = cape_utf8__step (pos, end);
+
+    if (len == 0)
+    {
+      return FALSE;
+    }
+
+    pos += len;
+    cnt++;
+  }
+
+  if (chars)
+  {
+    *chars = cnt;
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_utf8__count_scalar (const char* bufdat, number_t buflen)
+{
+  number_t i, cnt = 0;
+
+  for (i = 0; i < buflen; i++)
+  {
+    cnt += ((bufdat[i] & 0xC0) != 0x80);
+  }
+
+  return cnt;
+}
+
+//-----------------------------------------------------------------------------
+
+static const char* cape_utf8__find_scalar (const char* haystack, number_t haystack_len, const char* needle, number_t needle_len)
+{
+  const char* pos = haystack;
+  const char* end = haystack + haystack_len;
+
+  if (needle_len == 0)
+  {
+    return haystack;
+  }
+
+  while (end - pos >= needle_len)
+  {
+    pos = memchr (pos, needle[0], (end - pos) - needle_len + 1);
+
+    if (pos == NULL)
+    {
+      return NULL;
+    }
+
+    if (memcmp (pos + 1, needle + 1, needle_len - 1) == 0)
+    {
+      return pos;
+    }
+
+    pos++;
+  }
+
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static const CapeUtf8Kernel cape_utf8__scalar = {cape_utf8__check_scalar, cape_utf8__count_scalar, cape_utf8__find_scalar};
+
+//-----------------------------------------------------------------------------
+
+#if defined CAPE_UTF8__X86
+
+// bytes from 0x80 to 0xBF are negative and lower than 0xC0
+#define CAPE_UTF8__CONT_MIN   ((char)0xC0)
+
+//-----------------------------------------------------------------------------
+
+static int cape_utf8__check_sse2 (const char* bufdat, number_t buflen, number_t* chars)
+{
+  const unsigned char* pos = (const unsigned char*)bufdat;
+  const unsigned char* end = pos + buflen;
+
+  number_t cnt = 0;
+
+  while (end - pos >= 16)
+  {
+    if (_mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i*)pos)) == 0)
+    {
+      // ascii only
+      pos += 16;
+      cnt += 16;
+    }
+    else
+    {
+      // validate all characters starting in this block
+      const unsigned char* stop = pos + 16;
+
+      while (pos < stop)
+      {
+        number_t len = cape_utf8__step (pos, end);
+
+        if (len == 0)
+        {
+          return FALSE;
+        }
+
+        pos += len;
+        cnt++;
+      }
+    }
+  }
+
+  {
+    number_t rest;
+
+    if (!cape_utf8__check_scalar ((const char*)pos, end - pos, &rest))
+    {
+      return FALSE;
+    }
+
+    if (chars)
+    {
+      *chars = cnt + rest;
+    }
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_utf8__count_sse2 (const char* bufdat, number_t buflen)
+{
+  number_t i = 0, conts = 0;
+
+  const __m128i cont_min = _mm_set1_epi8 (CAPE_UTF8__CONT_MIN);
+
+  while (buflen - i >= 16)
+  {
+    __m128i acc = _mm_setzero_si128 ();
+    __m128i sum;
+
+    // the byte counters can take 255 blocks
+    number_t blocks = (buflen - i) / 16;
+    number_t j;
+
+    if (blocks > 255)
+    {
+      blocks = 255;
+    }
+
+    for (j = 0; j < blocks; j++, i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i*)(bufdat + i));
+
+      // the mask is -1 for continuation bytes
+      acc = _mm_sub_epi8 (acc, _mm_cmplt_epi8 (v, cont_min));
+    }
+
+    sum = _mm_sad_epu8 (acc, _mm_setzero_si128 ());
+
+    conts += _mm_cvtsi128_si32 (sum) + _mm_cvtsi128_si32 (_mm_srli_si128 (sum, 8));
+  }
+
+  return i - conts + cape_utf8__count_scalar (bufdat + i, buflen - i);
+}
+
+//-----------------------------------------------------------------------------
+
+static const char* cape_utf8__find_sse2 (const char* haystack, number_t haystack_len, const char* needle, number_t needle_len)
+{
+  number_t i = 0;
+
+  if (needle_len < 2)
+  {
+    return cape_utf8__find_scalar (haystack, haystack_len, needle, needle_len);
+  }
+
+  {
+    const __m128i first = _mm_set1_epi8 (needle[0]);
+    const __m128i last = _mm_set1_epi8 (needle[needle_len - 1]);
+
+    // compare the first and the last byte of 16 positions at once
+    for (; i + needle_len - 1 + 16 <= haystack_len; i += 16)
+    {
+      __m128i a = _mm_cmpeq_epi8 (first, _mm_loadu_si128 ((const __m128i*)(haystack + i)));
+      __m128i b = _mm_cmpeq_epi8 (last, _mm_loadu_si128 ((const __m128i*)(haystack + i + needle_len - 1)));
+
+      unsigned int mask = (unsigned int)_mm_movemask_epi8 (_mm_and_si128 (a, b));
+
+      while (mask)
+      {
+        number_t offset = i + cape_utf8__ctz (mask);
+
+        if (memcmp (haystack + offset + 1, needle + 1, needle_len - 2) == 0)
+        {
+          return haystack + offset;
+        }
+
+        mask &= mask - 1;
+      }
+    }
+  }
+
+  return cape_utf8__find_scalar (haystack + i, haystack_len - i, needle, needle_len);
+}
+
+//-----------------------------------------------------------------------------
+
+static const CapeUtf8Kernel cape_utf8__sse2 = {cape_utf8__check_sse2, cape_utf8__count_sse2, cape_utf8__find_sse2};
+
+//-----------------------------------------------------------------------------
+
+// error flags of the lookup tables, see Keiser and Lemire: Validating UTF-8 in less than one instruction per byte
+#define CAPE_UTF8__TOO_SHORT        (1 << 0)    // 11______ 0_______
+#define CAPE_UTF8__TOO_LONG         (1 << 1)    // 0_______ 10______
+#define CAPE_UTF8__OVERLONG_3       (1 << 2)    // 11100000 100_____
+#define CAPE_UTF8__TOO_LARGE        (1 << 3)    // 11110100 1001____
+#define CAPE_UTF8__SURROGATE        (1 << 4)    // 11101101 101_____
+#define CAPE_UTF8__OVERLONG_2       (1 << 5)    // 1100000_ 10______
+#define CAPE_UTF8__TOO_LARGE_1000   (1 << 6)    // 11110101 1000____
+#define CAPE_UTF8__OVERLONG_4       (1 << 6)    // 11110000 1000____
+#define CAPE_UTF8__TWO_CONTS        (1 << 7)    // 10______ 10______
+
+#define CAPE_UTF8__CARRY            (CAPE_UTF8__TOO_SHORT | CAPE_UTF8__TOO_LONG | CAPE_UTF8__TWO_CONTS)
+
+#define CAPE_UTF8__TABLE(a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p)   _mm256_setr_epi8 (a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p)
+
+//-----------------------------------------------------------------------------
+
+// the bytes before the input, taken from the previous block
+#define CAPE_UTF8__PREV(input,prev,n)   _mm256_alignr_epi8 (input, _mm256_permute2x128_si256 (prev, input, 0x21), 16 - n)
+
+//-----------------------------------------------------------------------------
+
+static CAPE_UTF8__AVX2 __m256i cape_utf8__avx2_errors (__m256i input, __m256i prev_input)
+{
+  const __m256i low_nibble = _mm256_set1_epi8 (0x0F);
+
+  const __m256i byte_1_high_table = CAPE_UTF8__TABLE
+  (
+    CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG,
+    CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG, CAPE_UTF8__TOO_LONG,
+    CAPE_UTF8__TWO_CONTS, CAPE_UTF8__TWO_CONTS, CAPE_UTF8__TWO_CONTS, CAPE_UTF8__TWO_CONTS,
+    CAPE_UTF8__TOO_SHORT | CAPE_UTF8__OVERLONG_2,
+    CAPE_UTF8__TOO_SHORT,
+    CAPE_UTF8__TOO_SHORT | CAPE_UTF8__OVERLONG_3 | CAPE_UTF8__SURROGATE,
+    CAPE_UTF8__TOO_SHORT | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000 | CAPE_UTF8__OVERLONG_4
+  );
+
+  const __m256i byte_1_low_table = CAPE_UTF8__TABLE
+  (
+    CAPE_UTF8__CARRY | CAPE_UTF8__OVERLONG_3 | CAPE_UTF8__OVERLONG_2 | CAPE_UTF8__OVERLONG_4,
+    CAPE_UTF8__CARRY | CAPE_UTF8__OVERLONG_2,
+    CAPE_UTF8__CARRY,
+    CAPE_UTF8__CARRY,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000 | CAPE_UTF8__SURROGATE,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000,
+    CAPE_UTF8__CARRY | CAPE_UTF8__TOO_LARGE | CAPE_UTF8__TOO_LARGE_1000
+  );
+
+  const __m256i byte_2_high_table = CAPE_UTF8__TABLE
+  (
+    CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT,
+    CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT,
+    CAPE_UTF8__TOO_LONG | CAPE_UTF8__OVERLONG_2 | CAPE_UTF8__TWO_CONTS | CAPE_UTF8__OVERLONG_3 | CAPE_UTF8__TOO_LARGE_1000 | CAPE_UTF8__OVERLONG_4,
+    CAPE_UTF8__TOO_LONG | CAPE_UTF8__OVERLONG_2 | CAPE_UTF8__TWO_CONTS | CAPE_UTF8__OVERLONG_3 | CAPE_UTF8__TOO_LARGE,
+    CAPE_UTF8__TOO_LONG | CAPE_UTF8__OVERLONG_2 | CAPE_UTF8__TWO_CONTS | CAPE_UTF8__SURROGATE | CAPE_UTF8__TOO_LARGE,
+    CAPE_UTF8__TOO_LONG | CAPE_UTF8__OVERLONG_2 | CAPE_UTF8__TWO_CONTS | CAPE_UTF8__SURROGATE | CAPE_UTF8__TOO_LARGE,
+    CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT, CAPE_UTF8__TOO_SHORT
+  );
+
+  __m256i prev1 = CAPE_UTF8__PREV (input, prev_input, 1);
+  __m256i prev2 = CAPE_UTF8__PREV (input, prev_input, 2);
+  __m256i prev3 = CAPE_UTF8__PREV (input, prev_input, 3);
+
+  // errors of two bytes in a row
+  __m256i special = _mm256_and_si256
+  (
+    _mm256_and_si256
+    (
+      _mm256_shuffle_epi8 (byte_1_high_table, _mm256_and_si256 (_mm256_srli_epi16 (prev1, 4), low_nibble)),
+      _mm256_shuffle_epi8 (byte_1_low_table, _mm256_and_si256 (prev1, low_nibble))
+    ),
+    _mm256_shuffle_epi8 (byte_2_high_table, _mm256_and_si256 (_mm256_srli_epi16 (input, 4), low_nibble))
+  );
+
+  // the third and fourth bytes of a character must be continuation bytes
+  __m256i must23 = _mm256_or_si256 (_mm256_subs_epu8 (prev2, _mm256_set1_epi8 ((char)(0xE0 - 0x80))), _mm256_subs_epu8 (prev3, _mm256_set1_epi8 ((char)(0xF0 - 0x80))));
+
+  return _mm256_xor_si256 (_mm256_and_si256 (must23, _mm256_set1_epi8 ((char)0x80)), special);
+}
+
+//-----------------------------------------------------------------------------
+
+static CAPE_UTF8__AVX2 int cape_utf8__check_avx2 (const char* bufdat, number_t buflen, number_t* chars)
+{
+  number_t i = 0, conts = 0;
+
+  __m256i error = _mm256_setzero_si256 ();
+  __m256i prev_input = _mm256_setzero_si256 ();
+  __m256i prev_incomplete = _mm256_setzero_si256 ();
+  __m256i acc = _mm256_setzero_si256 ();
+
+  const __m256i cont_min = _mm256_set1_epi8 (CAPE_UTF8__CONT_MIN);
+
+  // a character starting in the last bytes needs the next block
+  const __m256i max_value = _mm256_setr_epi8 (-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+  number_t blocks = 0;
+
+  while (i < buflen)
+  {
+    __m256i input;
+
+    if (buflen - i >= 32)
+    {
+      input = _mm256_loadu_si256 ((const __m256i*)(bufdat + i));
+    }
+    else
+    {
+      // the rest is filled with zeros, which finds all incomplete characters
+      char buffer[32];
+
+      memset (buffer, 0, 32);
+      memcpy (buffer, bufdat + i, buflen - i);
+
+      input = _mm256_loadu_si256 ((const __m256i*)buffer);
+    }
+
+    if (_mm256_movemask_epi8 (input) == 0)
+    {
+      error = _mm256_or_si256 (error, prev_incomplete);
+      prev_incomplete = _mm256_setzero_si256 ();
+    }
+    else
+    {
+      error = _mm256_or_si256 (error, cape_utf8__avx2_errors (input, prev_input));
+      prev_incomplete = _mm256_subs_epu8 (input, max_value);
+
+      acc = _mm256_sub_epi8 (acc, _mm256_cmpgt_epi8 (cont_min, input));
+    }
+
+    prev_input = input;
+
+    i += 32;
+
+    // the byte counters can take 255 blocks
+    if (++blocks == 255)
+    {
+      __m256i sum = _mm256_sad_epu8 (acc, _mm256_setzero_si256 ());
+
+      conts += _mm256_extract_epi64 (sum, 0) + _mm256_extract_epi64 (sum, 1) + _mm256_extract_epi64 (sum, 2) + _mm256_extract_epi64 (sum, 3);
+
+      acc = _mm256_setzero_si256 ();
+      blocks = 0;
+    }
+  }
+
+  error = _mm256_or_si256 (error, prev_incomplete);
+
+  if (!_mm256_testz_si256 (error, error))
+  {
+    return FALSE;
+  }
+
+  if (chars)
+  {
+    __m256i sum = _mm256_sad_epu8 (acc, _mm256_setzero_si256 ());
+
+    conts += _mm256_extract_epi64 (sum, 0) + _mm256_extract_epi64 (sum, 1) + _mm256_extract_epi64 (sum, 2) + _mm256_extract_epi64 (sum, 3);
+
+    *chars = buflen - conts;
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static CAPE_UTF8__AVX2 number_t cape_utf8__count_avx2 (const char* bufdat, number_t buflen)
+{
+  number_t i = 0, conts = 0;
+
+  const __m256i cont_min = _mm256_set1_epi8 (CAPE_UTF8__CONT_MIN);
+
+  while (buflen - i >= 32)
+  {
+    __m256i acc = _mm256_setzero_si256 ();
+    __m256i sum;
+
+    number_t blocks = (buflen - i) / 32;
+    number_t j;
+
+    if (blocks > 255)
+    {
+      blocks = 255;
+    }
+
+    for (j = 0; j < blocks; j++, i += 32)
+    {
+      acc = _mm256_sub_epi8 (acc, _mm256_cmpgt_epi8 (cont_min, _mm256_loadu_si256 ((const __m256i*)(bufdat + i))));
+    }
+
+    sum = _mm256_sad_epu8 (acc, _mm256_setzero_si256 ());
+
+    conts += _mm256_extract_epi64 (sum, 0) + _mm256_extract_epi64 (sum, 1) + _mm256_extract_epi64 (sum, 2) + _mm256_extract_epi64 (sum, 3);
+  }
+
+  return i - conts + cape_utf8__count_scalar (bufdat + i, buflen - i);
+}
+
+//-----------------------------------------------------------------------------
+
+static CAPE_UTF8__AVX2 const char* cape_utf8__find_avx2 (const char* haystack, number_t haystack_len, const char* needle, number_t needle_len)
+{
+  number_t i = 0;
+
+  if (needle_len < 2)
+  {
+    return cape_utf8__find_scalar (haystack, haystack_len, needle, needle_len);
+  }
+
+  {
+    const __m256i first = _mm256_set1_epi8 (needle[0]);
+    const __m256i last = _mm256_set1_epi8 (needle[needle_len - 1]);
+
+    for (; i + needle_len - 1 + 32 <= haystack_len; i += 32)
+    {
+      __m256i a = _mm256_cmpeq_epi8 (first, _mm256_loadu_si256 ((const __m256i*)(haystack + i)));
+      __m256i b = _mm256_cmpeq_epi8 (last, _mm256_loadu_si256 ((const __m256i*)(haystack + i + needle_len - 1)));
+
+      unsigned int mask = (unsigned int)_mm256_movemask_epi8 (_mm256_and_si256 (a, b));
+
+      while (mask)
+      {
+        number_t offset = i + cape_utf8__ctz (mask);
+
+        if (memcmp (haystack + offset + 1, needle + 1, needle_len - 2) == 0)
+        {
+          return haystack + offset;
+        }
+
+        mask &= mask - 1;
+      }
+    }
+  }
+
+  return cape_utf8__find_sse2 (haystack + i, haystack_len - i, needle, needle_len);
+}
+
+//-----------------------------------------------------------------------------
+
+static const CapeUtf8Kernel cape_utf8__avx2 = {cape_utf8__check_avx2, cape_utf8__count_avx2, cape_utf8__find_avx2};
+
+//-----------------------------------------------------------------------------
+
+static int cape_utf8__has_avx2 (void)
+{
+#if defined _MSC_VER
+
+  int info[4];
+
+  __cpuidex (info, 7, 0);
+
+  if ((info[1] & (1 << 5)) == 0)
+  {
+    return FALSE;
+  }
+
+  __cpuid (info, 1);
+
+  // the OS must save the YMM registers
+  if ((info[2] & (1 << 27)) == 0)
+  {
+    return FALSE;
+  }
+
+  return (_xgetbv (0) & 0x6) == 0x6;
+
+#else
+
+  __builtin_cpu_init ();
+
+  return __builtin_cpu_supports ("avx2");
+
+#endif
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static const CapeUtf8Kernel* cape_utf8__kernel = NULL;
+
+//-----------------------------------------------------------------------------
+
+int cape_utf8_kernel (int kernel)
+{
+  int best = CAPE_UTF8_SCALAR;
+
+#if defined CAPE_UTF8__X86
+
+  best = cape_utf8__has_avx2 () ? CAPE_UTF8_AVX2 : CAPE_UTF8_SSE2;
+
+#endif
+
+  if (kernel == CAPE_UTF8_AUTO || kernel > best)
+  {
+    kernel = best;
+  }
+
+  switch (kernel)
+  {
+#if defined CAPE_UTF8__X86
+
+    case CAPE_UTF8_AVX2: cape_utf8__kernel = &cape_utf8__avx2; break;
+    case CAPE_UTF8_SSE2: cape_utf8__kernel = &cape_utf8__sse2; break;
+
+#endif
+
+    default: cape_utf8__kernel = &cape_utf8__scalar; kernel = CAPE_UTF8_SCALAR; break;
+  }
+
+  return kernel;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE const CapeUtf8Kernel* cape_utf8__get (void)
+{
+  // the first call selects the kernel, all threads select the same
+  if (cape_utf8__kernel == NULL)
+  {
+    cape_utf8_kernel (CAPE_UTF8_AUTO);
+  }
+
+  return cape_utf8__kernel;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_utf8_check (const char* bufdat, number_t buflen, number_t* chars)
+{
+  return cape_utf8__get ()->check (bufdat, buflen, chars);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_utf8_count (const char* bufdat, number_t buflen)
+{
+  return cape_utf8__get ()->count (bufdat, buflen);
+}
+
+//-----------------------------------------------------------------------------
+
+const char* cape_utf8_find (const char* haystack, number_t haystack_len, const char* needle, number_t needle_len)
+{
+  return cape_utf8__get ()->find (haystack, haystack_len, needle, needle_len);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,42 @@
+#ifndef __CAPE_STC__UTF8__H
+#define __CAPE_STC__UTF8__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* kernels for UTF-8 text with SSE2 and AVX2 implementations
+ *
+ * -> the kernel is selected at runtime by the features of the CPU,
+ *    all other platforms use the portable scalar kernel
+ * -> the validation follows RFC 3629: no overlong forms, no surrogates
+ *    and nothing above U+10FFFF
+ * -> cape_str_len, cape_str_find_utf8, cape_str_trim_utf8 and
+ *    cape_tokenizer_str_utf8 use the kernels for valid text
+ */
+
+//=============================================================================
+
+#define CAPE_UTF8_AUTO      -1
+#define CAPE_UTF8_SCALAR     0
+#define CAPE_UTF8_SSE2       1
+#define CAPE_UTF8_AVX2       2
+
+//-----------------------------------------------------------------------------
+
+               // returns TRUE if the text is valid UTF-8 and the amount of characters, chars can be NULL
+__CAPE_LIBEX   int               cape_utf8_check            (const char* bufdat, number_t buflen, number_t* chars);
+
+               // counts all bytes which are not a continuation byte, the same as the characters of valid text
+__CAPE_LIBEX   number_t          cape_utf8_count            (const char* bufdat, number_t buflen);
+
+               // returns the first occurrence of the needle or NULL
+__CAPE_LIBEX   const char*       cape_utf8_find             (const char* haystack, number_t haystack_len, const char* needle, number_t needle_len);
+
+               // selects a kernel, falls back to the best supported one and returns it
+__CAPE_LIBEX   int               cape_utf8_kernel           (int kernel);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,526 @@
+#include "cape_vector.h"
+
+// c includes
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_VECTOR_MIN_CAPACITY   16
+#define CAPE_VECTOR_SORT_INSERTION 16
+
+//-----------------------------------------------------------------------------
+
+struct CapeVector_s
+{
+  fct_cape_list_onDestroy onDestroy;
+
+  void** data;         // ring buffer, the capacity is always a power of 2
+
+  number_t capacity;
+
+  number_t head;       // position of the first element in the buffer
+
+  number_t size;
+};
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE void** cape_vector__slot (CapeVector self, number_t index)
+{
+  return self->data + ((self->head + index) & (self->capacity - 1));
+}
+
+//-----------------------------------------------------------------------------
+
+// copies all elements in order into the buffer
+static void cape_vector__linearize (CapeVector self, void** buffer)
+{
+  number_t first = self->capacity - self->head;
+
+  if (first >= self->size)
+  {
+    memcpy (buffer, self->data + self->head, self->size * sizeof(void*));
+  }
+  else
+  {
+    memcpy (buffer, self->data + self->head, first * sizeof(void*));
+    memcpy (buffer + first, self->data, (self->size - first) * sizeof(void*));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_vector__resize (CapeVector self, number_t capacity)
+{
+  void** data = CAPE_ALLOC (capacity * sizeof(void*));
+
+  if (self->data)
+  {
+    cape_vector__linearize (self, data);
+
+    CAPE_FREE (self->data);
+  }
+
+  self->data = data;
+  self->capacity = capacity;
+  self->head = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE void cape_vector__grow (CapeVector self)
+{
+  if (self->size == self->capacity)
+  {
+    cape_vector__resize (self, self->capacity ? self->capacity * 2 : CAPE_VECTOR_MIN_CAPACITY);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeVector cape_vector_new (fct_cape_list_onDestroy onDestroy)
+{
+  CapeVector self = CAPE_NEW (struct CapeVector_s);
+
+  self->onDestroy = onDestroy;
+  self->data = NULL;
+  self->capacity = 0;
+  self->head = 0;
+  self->size = 0;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_clr (CapeVector self)
+{
+  if (self->onDestroy)
+  {
+    number_t i;
+
+    for (i = 0; i < self->size; i++)
+    {
+      void* data = *cape_vector__slot (self, i);
+
+      if (data)
+      {
+        self->onDestroy (data);
+      }
+    }
+  }
+
+  self->head = 0;
+  self->size = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_del (CapeVector* p_self)
+{
+  if (*p_self)
+  {
+    CapeVector self = *p_self;
+
+    cape_vector_clr (self);
+
+    CAPE_FREE (self->data);
+
+    CAPE_DEL (p_self, struct CapeVector_s);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_reserve (CapeVector self, number_t size)
+{
+  if (size > self->capacity)
+  {
+    number_t capacity = CAPE_VECTOR_MIN_CAPACITY;
+
+    while (capacity < size)
+    {
+      capacity *= 2;
+    }
+
+    cape_vector__resize (self, capacity);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_push_back (CapeVector self, void* data)
+{
+  cape_vector__grow (self);
+
+  *cape_vector__slot (self, self->size) = data;
+
+  self->size++;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_push_front (CapeVector self, void* data)
+{
+  cape_vector__grow (self);
+
+  self->head = (self->head - 1) & (self->capacity - 1);
+  self->data[self->head] = data;
+
+  self->size++;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_pop_front (CapeVector self)
+{
+  void* data = NULL;
+
+  if (self->size)
+  {
+    data = self->data[self->head];
+
+    self->head = (self->head + 1) & (self->capacity - 1);
+    self->size--;
+  }
+
+  return data;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_pop_back (CapeVector self)
+{
+  void* data = NULL;
+
+  if (self->size)
+  {
+    self->size--;
+
+    data = *cape_vector__slot (self, self->size);
+  }
+
+  return data;
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_vector_size (CapeVector self)
+{
+  return self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_vector_empty (CapeVector self)
+{
+  return self->size == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_vector_hasContent (CapeVector self)
+{
+  return self->size != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_at (CapeVector self, number_t index)
+{
+  if (index < 0 || index >= self->size)
+  {
+    return NULL;
+  }
+
+  return *cape_vector__slot (self, index);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_replace (CapeVector self, number_t index, void* data)
+{
+  if (index >= 0 && index < self->size)
+  {
+    void** slot = cape_vector__slot (self, index);
+
+    if (*slot && self->onDestroy)
+    {
+      self->onDestroy (*slot);
+    }
+
+    *slot = data;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_extract (CapeVector self, number_t index)
+{
+  void* ret;
+  number_t i;
+
+  if (index < 0 || index >= self->size)
+  {
+    return NULL;
+  }
+
+  ret = *cape_vector__slot (self, index);
+
+  if (index < self->size / 2)
+  {
+    // move the front part one step to the back
+    for (i = index; i > 0; i--)
+    {
+      *cape_vector__slot (self, i) = *cape_vector__slot (self, i - 1);
+    }
+
+    self->head = (self->head + 1) & (self->capacity - 1);
+  }
+  else
+  {
+    // move the back part one step to the front
+    for (i = index + 1; i < self->size; i++)
+    {
+      *cape_vector__slot (self, i - 1) = *cape_vector__slot (self, i);
+    }
+  }
+
+  self->size--;
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_erase (CapeVector self, number_t index)
+{
+  void* data = cape_vector_extract (self, index);
+
+  if (data && self->onDestroy)
+  {
+    self->onDestroy (data);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_node_data (CapeVectorNode node)
+{
+  return node ? *(void**)node : NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_vector__sort_insertion (void** data, number_t size, fct_cape_list_onCompare onCompare)
+{
+  number_t i, j;
+
+  for (i = 1; i < size; i++)
+  {
+    void* h = data[i];
+
+    for (j = i; j > 0 && onCompare (data[j - 1], h) > 0; j--)
+    {
+      data[j] = data[j - 1];
+    }
+
+    data[j] = h;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_vector__sort_merge (void** data, void** temp, number_t size, fct_cape_list_onCompare onCompare)
+{
+  if (size <= CAPE_VECTOR_SORT_INSERTION)
+  {
+    cape_vector__sort_insertion (data, size, onCompare);
+  }
+  else
+  {
+    number_t half = size / 2;
+    number_t i = 0, j = half, k = 0;
+
+    cape_vector__sort_merge (data, temp, half, onCompare);
+    cape_vector__sort_merge (data + half, temp, size - half, onCompare);
+
+    // already in order
+    if (onCompare (data[half - 1], data[half]) <= 0)
+    {
+      return;
+    }
+
+    memcpy (temp, data, half * sizeof(void*));
+
+    while (i < half && j < size)
+    {
+      // take the left element on equal keys to keep the sort stable
+      if (onCompare (temp[i], data[j]) <= 0)
+      {
+        data[k++] = temp[i++];
+      }
+      else
+      {
+        data[k++] = data[j++];
+      }
+    }
+
+    // the rest of the right part is already in place
+    while (i < half)
+    {
+      data[k++] = temp[i++];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_sort (CapeVector self, fct_cape_list_onCompare onCompare)
+{
+  if (onCompare == NULL || self->size < 2)
+  {
+    return;
+  }
+
+  // the elements must be in one piece
+  if (self->head + self->size > self->capacity)
+  {
+    cape_vector__resize (self, self->capacity);
+  }
+
+  {
+    void** data = self->data + self->head;
+    void** temp = CAPE_ALLOC ((self->size / 2 + 1) * sizeof(void*));
+
+    cape_vector__sort_merge (data, temp, self->size, onCompare);
+
+    CAPE_FREE (temp);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeVector cape_vector_clone (CapeVector orig, fct_cape_list_onClone onClone)
+{
+  CapeVector self = cape_vector_new (orig->onDestroy);
+  number_t i;
+
+  cape_vector_reserve (self, orig->size);
+
+  for (i = 0; i < orig->size; i++)
+  {
+    // if not, the value will be null
+    self->data[i] = onClone ? onClone (*cape_vector__slot (orig, i)) : NULL;
+  }
+
+  self->size = orig->size;
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeVectorCursor* cape_vector_cursor_create (CapeVector self, int direction)
+{
+  CapeVectorCursor* cursor = CAPE_NEW (CapeVectorCursor);
+
+  cape_vector_cursor_init (self, cursor, direction);
+
+  return cursor;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_cursor_destroy (CapeVectorCursor** p_cursor)
+{
+  if (*p_cursor)
+  {
+    CAPE_DEL (p_cursor, CapeVectorCursor);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_cursor_init (CapeVector self, CapeVectorCursor* cursor, int direction)
+{
+  cursor->node = NULL;
+  cursor->position = -1;
+  cursor->direction = direction;
+  cursor->vector = self;
+  cursor->index = (direction == CAPE_DIRECTION_FORW) ? -1 : self->size;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_vector_cursor_next (CapeVectorCursor* cursor)
+{
+  CapeVector self = cursor->vector;
+
+  if (cursor->index + 1 < self->size)
+  {
+    cursor->index++;
+    cursor->position++;
+
+    cursor->node = (CapeVectorNode)cape_vector__slot (self, cursor->index);
+    return TRUE;
+  }
+
+  cursor->node = NULL;
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_vector_cursor_prev (CapeVectorCursor* cursor)
+{
+  CapeVector self = cursor->vector;
+
+  if (cursor->index > 0)
+  {
+    cursor->index--;
+    cursor->position++;
+
+    cursor->node = (CapeVectorNode)cape_vector__slot (self, cursor->index);
+    return TRUE;
+  }
+
+  cursor->node = NULL;
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+void* cape_vector_cursor_extract (CapeVector self, CapeVectorCursor* cursor)
+{
+  void* ret = NULL;
+
+  if (cursor->node)
+  {
+    ret = cape_vector_extract (self, cursor->index);
+
+    if (cursor->direction == CAPE_DIRECTION_FORW)
+    {
+      // the next element moved to the current index
+      cursor->index--;
+    }
+
+    cursor->node = NULL;
+  }
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_vector_cursor_erase (CapeVector self, CapeVectorCursor* cursor)
+{
+  void* data = cape_vector_cursor_extract (self, cursor);
+
+  if (data && self->onDestroy)
+  {
+    self->onDestroy (data);
+  }
+}
+
+//-----------------------------------------------------------------------------
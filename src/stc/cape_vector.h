@@ -0,0 +1,106 @@
+#ifndef __CAPE_STC__VECTOR__H
+#define __CAPE_STC__VECTOR__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+#include "stc/cape_list.h"
+
+//=============================================================================
+
+/* this class implements a vector of pointers in one contiguous ring buffer
+ *
+ * -> push and pop on both ends in amortized O(1), access by index in O(1)
+ * -> the onDestroy, onCompare and onClone callbacks are the same as for cape_list
+ * -> the cursor follows the cape_list API, the node of the cursor points
+ *    into the buffer and can be read with cape_vector_node_data
+ *
+ * remarks: nodes are only valid until the vector is changed, erasing an element
+ *          in the middle moves the smaller part of the vector
+ */
+
+//=============================================================================
+
+struct CapeVector_s; typedef struct CapeVector_s* CapeVector;
+struct CapeVectorNode_s; typedef struct CapeVectorNode_s* CapeVectorNode;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeVector        cape_vector_new            (fct_cape_list_onDestroy);
+
+__CAPE_LIBEX   void              cape_vector_del            (CapeVector*);
+
+__CAPE_LIBEX   void              cape_vector_clr            (CapeVector);
+
+__CAPE_LIBEX   void              cape_vector_reserve        (CapeVector, number_t size);     // avoids reallocations until the vector has this size
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void              cape_vector_push_back      (CapeVector, void* data);
+
+__CAPE_LIBEX   void              cape_vector_push_front     (CapeVector, void* data);
+
+__CAPE_LIBEX   void*             cape_vector_pop_front      (CapeVector);
+
+__CAPE_LIBEX   void*             cape_vector_pop_back       (CapeVector);
+
+__CAPE_LIBEX   number_t          cape_vector_size           (CapeVector);
+
+__CAPE_LIBEX   int               cape_vector_empty          (CapeVector);
+
+__CAPE_LIBEX   int               cape_vector_hasContent     (CapeVector);
+
+__CAPE_LIBEX   void*             cape_vector_at             (CapeVector, number_t index);    // returns NULL if the index is out of range
+
+__CAPE_LIBEX   void              cape_vector_replace        (CapeVector, number_t index, void* data);   // calls onDestroy for the old data
+
+__CAPE_LIBEX   void*             cape_vector_extract        (CapeVector, number_t index);
+
+__CAPE_LIBEX   void              cape_vector_erase          (CapeVector, number_t index);    // calls onDestroy
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void*             cape_vector_node_data      (CapeVectorNode);
+
+//-----------------------------------------------------------------------------
+
+               // stable merge sort, same callback as cape_list_sort
+__CAPE_LIBEX   void              cape_vector_sort           (CapeVector, fct_cape_list_onCompare);
+
+__CAPE_LIBEX   CapeVector        cape_vector_clone          (CapeVector, fct_cape_list_onClone);
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+
+  CapeVectorNode node;
+
+  int position;
+
+  int direction;
+
+  CapeVector vector;
+
+  number_t index;     // the index of the current element
+
+} CapeVectorCursor;
+
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   CapeVectorCursor* cape_vector_cursor_create  (CapeVector, int direction);
+
+__CAPE_LIBEX   void              cape_vector_cursor_destroy (CapeVectorCursor**);
+
+__CAPE_LIBEX   void              cape_vector_cursor_init    (CapeVector, CapeVectorCursor*, int direction);
+
+__CAPE_LIBEX   int               cape_vector_cursor_next    (CapeVectorCursor*);
+
+__CAPE_LIBEX   int               cape_vector_cursor_prev    (CapeVectorCursor*);
+
+__CAPE_LIBEX   void              cape_vector_cursor_erase   (CapeVector, CapeVectorCursor*);
+
+__CAPE_LIBEX   void*             cape_vector_cursor_extract (CapeVector, CapeVectorCursor*);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,411 @@
+#include "cape_alloc.h"
+
+#if defined __WINDOWS_OS
+
+#include <windows.h>
+#include <malloc.h>
+
+#define CAPE_ALLOC__TLS                 __declspec(thread)
+#define CAPE_ALLOC__USABLE(ptr)         _msize(ptr)
+
+#elif defined __APPLE__
+
+#include <pthread.h>
+#include <malloc/malloc.h>
+
+#define CAPE_ALLOC__TLS                 __thread
+#define CAPE_ALLOC__USABLE(ptr)         malloc_size(ptr)
+
+#elif defined __FreeBSD__
+
+#include <pthread.h>
+#include <malloc_np.h>
+
+#define CAPE_ALLOC__TLS                 __thread
+#define CAPE_ALLOC__USABLE(ptr)         malloc_usable_size(ptr)
+
+#elif defined __LINUX_OS
+
+#include <pthread.h>
+#include <malloc.h>
+
+#define CAPE_ALLOC__TLS                 __thread
+#define CAPE_ALLOC__USABLE(ptr)         malloc_usable_size(ptr)
+
+#else
+
+// no way to get the size of a block, disable the caches
+#ifndef CAPE_ALLOC_NOCACHE
+#define CAPE_ALLOC_NOCACHE 1
+#endif
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#ifndef CAPE_ALLOC_LIMIT
+#define CAPE_ALLOC_LIMIT 128      // default amount of cached blocks per size class and thread
+#endif
+
+#define CAPE_ALLOC__STATE_NONE        0
+#define CAPE_ALLOC__STATE_ACTIVE      1
+#define CAPE_ALLOC__STATE_DONE        2
+
+//-----------------------------------------------------------------------------
+
+static void cape_alloc__fatal (void)
+{
+  // write some last words
+  printf ("*** FATAL *** CAN't ALLOCATE MEMORY *** FATAL ***\n");
+
+  // abort everything
+  abort ();
+}
+
+#ifndef CAPE_ALLOC_NOCACHE
+
+//-----------------------------------------------------------------------------
+
+typedef struct CapeAllocCache_s
+{
+  void* heads[CAPE_ALLOC_CLASSES + 1];      // single linked lists of free blocks, the link is stored in the block
+
+  number_t counts[CAPE_ALLOC_CLASSES + 1];
+
+  CapeAllocStats stats;
+
+  int state;
+
+  struct CapeAllocCache_s* prev;
+
+  struct CapeAllocCache_s* next;
+
+} CapeAllocCache;
+
+//-----------------------------------------------------------------------------
+
+static CAPE_ALLOC__TLS CapeAllocCache cape_alloc__cache;
+
+static CapeAllocCache* cape_alloc__caches = NULL;     // all active caches for the statistics
+
+static CapeAllocStats cape_alloc__retired;            // counters of terminated threads
+
+static number_t cape_alloc__limit = CAPE_ALLOC_LIMIT;
+
+#if defined __WINDOWS_OS
+
+static SRWLOCK cape_alloc__mutex = SRWLOCK_INIT;
+static INIT_ONCE cape_alloc__once = INIT_ONCE_STATIC_INIT;
+static DWORD cape_alloc__key = FLS_OUT_OF_INDEXES;
+
+#define CAPE_ALLOC__LOCK()       AcquireSRWLockExclusive (&cape_alloc__mutex)
+#define CAPE_ALLOC__UNLOCK()     ReleaseSRWLockExclusive (&cape_alloc__mutex)
+
+#else
+
+static pthread_mutex_t cape_alloc__mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t cape_alloc__once = PTHREAD_ONCE_INIT;
+static pthread_key_t cape_alloc__key;
+
+#define CAPE_ALLOC__LOCK()       pthread_mutex_lock (&cape_alloc__mutex)
+#define CAPE_ALLOC__UNLOCK()     pthread_mutex_unlock (&cape_alloc__mutex)
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static void cape_alloc__cache_flush (CapeAllocCache* cache)
+{
+  number_t i;
+
+  for (i = 1; i <= CAPE_ALLOC_CLASSES; i++)
+  {
+    void* ptr = cache->heads[i];
+
+    while (ptr)
+    {
+      void* next = *(void**)ptr;
+
+      free (ptr);
+
+      ptr = next;
+    }
+
+    cache->stats.released += cache->counts[i];
+
+    cache->heads[i] = NULL;
+    cache->counts[i] = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_alloc__on_thread_done (void* ptr)
+{
+  CapeAllocCache* cache = ptr;
+
+  cape_alloc__cache_flush (cache);
+
+  CAPE_ALLOC__LOCK();
+
+  // keep the counters
+  cape_alloc__retired.allocs += cache->stats.allocs;
+  cape_alloc__retired.hits += cache->stats.hits;
+  cape_alloc__retired.frees += cache->stats.frees;
+  cape_alloc__retired.released += cache->stats.released;
+
+  if (cache->prev)
+  {
+    cache->prev->next = cache->next;
+  }
+  else
+  {
+    cape_alloc__caches = cache->next;
+  }
+
+  if (cache->next)
+  {
+    cache->next->prev = cache->prev;
+  }
+
+  CAPE_ALLOC__UNLOCK();
+
+  // late releases of this thread bypass the cache
+  cache->state = CAPE_ALLOC__STATE_DONE;
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined __WINDOWS_OS
+
+static BOOL CALLBACK cape_alloc__on_once (PINIT_ONCE once, PVOID param, PVOID* context)
+{
+  cape_alloc__key = FlsAlloc (cape_alloc__on_thread_done);
+
+  return TRUE;
+}
+
+#else
+
+static void cape_alloc__on_once (void)
+{
+  pthread_key_create (&cape_alloc__key, cape_alloc__on_thread_done);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static void cape_alloc__cache_register (CapeAllocCache* cache)
+{
+#if defined __WINDOWS_OS
+
+  InitOnceExecuteOnce (&cape_alloc__once, cape_alloc__on_once, NULL, NULL);
+
+  // the fiber local storage calls the destructor when the thread terminates
+  FlsSetValue (cape_alloc__key, cache);
+
+#else
+
+  pthread_once (&cape_alloc__once, cape_alloc__on_once);
+
+  // the value is only used to trigger the destructor
+  pthread_setspecific (cape_alloc__key, cache);
+
+#endif
+
+  CAPE_ALLOC__LOCK();
+
+  cache->prev = NULL;
+  cache->next = cape_alloc__caches;
+
+  if (cape_alloc__caches)
+  {
+    cape_alloc__caches->prev = cache;
+  }
+
+  cape_alloc__caches = cache;
+
+  CAPE_ALLOC__UNLOCK();
+
+  cache->state = CAPE_ALLOC__STATE_ACTIVE;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+void* cape_alloc_new (number_t size)
+{
+  void* ptr;
+
+#ifndef CAPE_ALLOC_NOCACHE
+
+  number_t idx = (size + CAPE_ALLOC_CLASS_SIZE - 1) / CAPE_ALLOC_CLASS_SIZE;
+
+  if (idx <= CAPE_ALLOC_CLASSES)
+  {
+    CapeAllocCache* cache = &cape_alloc__cache;
+
+    if (cache->state == CAPE_ALLOC__STATE_ACTIVE)
+    {
+      cache->stats.allocs++;
+
+      ptr = cache->heads[idx];
+
+      if (ptr)
+      {
+        cache->heads[idx] = *(void**)ptr;
+        cache->counts[idx]--;
+
+        cache->stats.hits++;
+
+        memset (ptr, 0, size);
+
+        return ptr;
+      }
+    }
+    else if (cache->state == CAPE_ALLOC__STATE_NONE)
+    {
+      cape_alloc__cache_register (cache);
+
+      cache->stats.allocs++;
+    }
+
+    if (idx == 0)
+    {
+      idx = 1;
+    }
+
+    // always use the full class size, the block must fit into its class when it gets released
+    size = idx * CAPE_ALLOC_CLASS_SIZE;
+  }
+
+#endif
+
+  // calloc can skip the zeroing for fresh pages of the system
+  ptr = calloc (1, size);
+
+  if (ptr == NULL)
+  {
+    cape_alloc__fatal ();
+  }
+
+  return ptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_alloc_del (void* ptr, number_t size)
+{
+  if (ptr == NULL)
+  {
+    return;
+  }
+
+#ifdef CAPE_ALLOC_SCRUB
+
+  memset (ptr, 0, size);
+
+#endif
+
+#ifndef CAPE_ALLOC_NOCACHE
+
+  {
+    CapeAllocCache* cache = &cape_alloc__cache;
+
+    if (cache->state == CAPE_ALLOC__STATE_NONE)
+    {
+      cape_alloc__cache_register (cache);
+    }
+
+    if (cache->state == CAPE_ALLOC__STATE_ACTIVE)
+    {
+      // the usable size of the block decides the class, works also for blocks from other allocations
+      number_t idx = (number_t)CAPE_ALLOC__USABLE (ptr) / CAPE_ALLOC_CLASS_SIZE;
+
+      cache->stats.frees++;
+
+      if (idx > 0 && idx <= CAPE_ALLOC_CLASSES && cache->counts[idx] < cape_alloc__limit)
+      {
+        *(void**)ptr = cache->heads[idx];
+
+        cache->heads[idx] = ptr;
+        cache->counts[idx]++;
+
+        return;
+      }
+
+      cache->stats.released++;
+    }
+  }
+
+#endif
+
+  free (ptr);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_alloc_stats (CapeAllocStats* stats)
+{
+  memset (stats, 0, sizeof(CapeAllocStats));
+
+#ifndef CAPE_ALLOC_NOCACHE
+
+  {
+    CapeAllocCache* cache;
+
+    CAPE_ALLOC__LOCK();
+
+    *stats = cape_alloc__retired;
+
+    for (cache = cape_alloc__caches; cache; cache = cache->next)
+    {
+      number_t i;
+
+      stats->allocs += cache->stats.allocs;
+      stats->hits += cache->stats.hits;
+      stats->frees += cache->stats.frees;
+      stats->released += cache->stats.released;
+
+      for (i = 1; i <= CAPE_ALLOC_CLASSES; i++)
+      {
+        stats->cached += cache->counts[i];
+      }
+
+      stats->threads++;
+    }
+
+    CAPE_ALLOC__UNLOCK();
+  }
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_alloc_flush (void)
+{
+#ifndef CAPE_ALLOC_NOCACHE
+
+  if (cape_alloc__cache.state == CAPE_ALLOC__STATE_ACTIVE)
+  {
+    cape_alloc__cache_flush (&cape_alloc__cache);
+  }
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_alloc_limit (number_t blocks)
+{
+#ifndef CAPE_ALLOC_NOCACHE
+
+  cape_alloc__limit = blocks;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,55 @@
+#ifndef __CAPE_SYS__ALLOC__H
+#define __CAPE_SYS__ALLOC__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/*
+ * \ brief CAPE_NEW, CAPE_DEL, CAPE_ALLOC and CAPE_FREE are routed through the allocation layer. Small blocks are kept in
+           per thread caches of size classes and are reused without a round trip to the system heap. A block can be
+           released on any thread, it will be cached by the releasing thread.
+
+           build options:
+           CAPE_ALLOC_NOCACHE -> every block goes directly to the system heap
+           CAPE_ALLOC_SCRUB   -> CAPE_DEL wipes the memory of the object before it gets reused or released
+ */
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_ALLOC_CLASS_SIZE     16        // granularity of the size classes
+#define CAPE_ALLOC_CLASSES        32        // blocks up to 512 bytes are cached
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  number_t allocs;          // amount of allocations
+
+  number_t hits;            // amount of allocations served from a thread cache
+
+  number_t frees;           // amount of releases
+
+  number_t released;        // amount of blocks returned to the system heap
+
+  number_t cached;          // amount of blocks currently kept in the thread caches
+
+  number_t threads;         // amount of threads with a cache
+
+} CapeAllocStats;
+
+//-----------------------------------------------------------------------------
+
+               // sums up the counters of all threads, the values of running threads are a snapshot
+__CAPE_LIBEX   void               cape_alloc_stats              (CapeAllocStats*);
+
+               // returns all cached blocks of the calling thread to the system heap
+__CAPE_LIBEX   void               cape_alloc_flush              (void);
+
+               // maximum amount of cached blocks per size class and thread, 0 disables the caches
+__CAPE_LIBEX   void               cape_alloc_limit              (number_t blocks);
+
+//-----------------------------------------------------------------------------
+
+#endif
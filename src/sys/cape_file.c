@@ -19,6 +19,7 @@
 #include <linux/limits.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <stdio.h>
 #include <dirent.h>
 #include <fts.h>
@@ -32,6 +33,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <dirent.h>
 #include <fts.h>
 
@@ -603,6 +605,59 @@ number_t cape_fh_write_buf (CapeFileHandle self, const char* bufdat, number_t bu
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_FH_IOV 64
+
+number_t cape_fh_write_stream (CapeFileHandle self, CapeStream stream)
+{
+  struct iovec iov[CAPE_FH_IOV];
+  number_t first = 0, written = 0, cnt;
+  
+  for (cnt = cape_stream_iov (stream, first, iov, CAPE_FH_IOV); cnt; cnt = cape_stream_iov (stream, first, iov, CAPE_FH_IOV))
+  {
+    struct iovec* pos = iov;
+    number_t left = cnt;
+    
+    first += cnt;
+    
+    while (left)
+    {
+      ssize_t res = writev (self->fd, pos, left);
+      
+      if (res < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        
+        return -1;
+      }
+      
+      written += res;
+      
+      // skip all complete segments
+      while (left && (size_t)res >= pos->iov_len)
+      {
+        res -= pos->iov_len;
+        
+        pos++;
+        left--;
+      }
+      
+      // continue with the rest of a partial segment
+      if (left)
+      {
+        pos->iov_base = (char*)pos->iov_base + res;
+        pos->iov_len -= res;
+      }
+    }
+  }
+  
+  return written;
+}
+
+//-----------------------------------------------------------------------------
+
 struct CapeDirCursor_s
 {
   FTS* tree;
@@ -838,6 +893,37 @@ number_t cape_fh_write_buf (CapeFileHandle self, const char* bufdat, number_t bu
 
 //-----------------------------------------------------------------------------
 
+number_t cape_fh_write_stream (CapeFileHandle self, CapeStream stream)
+{
+  CapeStreamIov iov;
+  number_t first = 0, written = 0;
+  
+  // windows has no writev for files, write one segment after the other
+  while (cape_stream_iov (stream, first, &iov, 1))
+  {
+    unsigned long done = 0;
+    
+    while (done < iov.len)
+    {
+      int res = _write (self->fd, iov.buf + done, iov.len - done);
+      
+      if (res < 0)
+      {
+        return -1;
+      }
+      
+      done += res;
+    }
+    
+    written += done;
+    first++;
+  }
+  
+  return written;
+}
+
+//-----------------------------------------------------------------------------
+
 struct CapeDirCursor_s
 {
   /* the handle */
@@ -4,6 +4,7 @@
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
 #include "stc/cape_str.h"
+#include "stc/cape_stream.h"
 #include "sys/cape_types.h"
 
 #include <fcntl.h>
@@ -64,6 +65,9 @@ __CAPE_LIBEX   number_t           cape_fh_read_buf       (CapeFileHandle, char*
 
 __CAPE_LIBEX   number_t           cape_fh_write_buf      (CapeFileHandle, const char* bufdat, number_t buflen);
 
+                                  // writes all segments of the stream (writev), returns the written bytes or -1
+__CAPE_LIBEX   number_t           cape_fh_write_stream   (CapeFileHandle, CapeStream);
+
 __CAPE_LIBEX   const CapeString   cape_fh_file           (CapeFileHandle);
 
 //-----------------------------------------------------------------------------
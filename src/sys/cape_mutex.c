@@ -3,20 +3,25 @@
 
 //-----------------------------------------------------------------------------
 
-#if defined __LINUX_OS || defined __BSD_OS
-
-#include <pthread.h>
+#ifndef CAPE_MUTEX_SPIN
+#define CAPE_MUTEX_SPIN 100       // amount of tries before the thread gets parked
+#endif
 
 //-----------------------------------------------------------------------------
 
 CapeMutex cape_mutex_new (void)
 {
-  pthread_mutex_t* self = CAPE_NEW(pthread_mutex_t);
-  
-  memset (self, 0, sizeof(pthread_mutex_t));
-  
-  pthread_mutex_init (self, NULL);
-  
+  return cape_mutex_new_ex (0);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeMutex cape_mutex_new_ex (int flags)
+{
+  CapeMutexInline* self = CAPE_NEW(CapeMutexInline);
+
+  cape_mutex_init (self, flags);
+
   return self;
 }
 
@@ -26,26 +31,195 @@ void cape_mutex_del (CapeMutex* p_self)
 {
   if (*p_self)
   {
-    pthread_mutex_t* self = *p_self;
-    
-    pthread_mutex_destroy (self);
-    
-    CAPE_DEL(p_self, pthread_mutex_t);  
+    cape_mutex_done (*p_self);
+
+    CAPE_DEL(p_self, CapeMutexInline);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_stats (CapeMutex mutex, CapeMutexStats* stats)
+{
+  CapeMutexInline* self = mutex;
+
+  if (self->flags & CAPE_MUTEX_STATS)
+  {
+    // the counters are only changed by the owner of the lock
+    cape_mutex_lock (self);
+
+    *stats = self->stats;
+
+    // don't count our own lock
+    stats->acquired--;
+
+    cape_mutex_unlock (self);
+  }
+  else
+  {
+    memset (stats, 0, sizeof(CapeMutexStats));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined __LINUX_OS || defined __BSD_OS
+
+static __CAPE_INLINE void cape_mutex__relax (void)
+{
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+  __builtin_ia32_pause ();
+#elif defined __GNUC__ && (defined __aarch64__ || defined __arm__)
+  __asm__ __volatile__ ("yield");
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_init (CapeMutexInline* self, int flags)
+{
+  memset (self, 0, sizeof(CapeMutexInline));
+
+  pthread_mutex_init (&(self->os), NULL);
+
+  self->flags = flags;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_done (CapeMutexInline* self)
+{
+  pthread_mutex_destroy (&(self->os));
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_lock (CapeMutex mutex)
+{
+  CapeMutexInline* self = mutex;
+
+  // fast path: no contention
+  if (pthread_mutex_trylock (&(self->os)) == 0)
+  {
+    if (self->flags & CAPE_MUTEX_STATS)
+    {
+      self->stats.acquired++;
+    }
+
+    return;
+  }
+
+  // short critical sections might be left soon, spin a while
+  {
+    int i;
+
+    for (i = 0; i < CAPE_MUTEX_SPIN; i++)
+    {
+      cape_mutex__relax ();
+
+      if (pthread_mutex_trylock (&(self->os)) == 0)
+      {
+        if (self->flags & CAPE_MUTEX_STATS)
+        {
+          self->stats.acquired++;
+          self->stats.contended++;
+        }
+
+        return;
+      }
+    }
   }
+
+  // park the thread
+  pthread_mutex_lock (&(self->os));
+
+  if (self->flags & CAPE_MUTEX_STATS)
+  {
+    self->stats.acquired++;
+    self->stats.contended++;
+    self->stats.parked++;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_unlock (CapeMutex mutex)
+{
+  CapeMutexInline* self = mutex;
+
+  pthread_mutex_unlock (&(self->os));
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_mutex_lock (CapeMutex self)
+int cape_mutex_trylock (CapeMutex mutex)
 {
-  pthread_mutex_lock (self);
+  CapeMutexInline* self = mutex;
+
+  if (pthread_mutex_trylock (&(self->os)) == 0)
+  {
+    if (self->flags & CAPE_MUTEX_STATS)
+    {
+      self->stats.acquired++;
+    }
+
+    return TRUE;
+  }
+
+  return FALSE;
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_mutex_unlock (CapeMutex self)
+CapeRwLock cape_rwlock_new (void)
 {
-  pthread_mutex_unlock (self);
+  pthread_rwlock_t* self = CAPE_NEW(pthread_rwlock_t);
+
+  pthread_rwlock_init (self, NULL);
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_del (CapeRwLock* p_self)
+{
+  if (*p_self)
+  {
+    pthread_rwlock_t* self = *p_self;
+
+    pthread_rwlock_destroy (self);
+
+    CAPE_DEL(p_self, pthread_rwlock_t);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_lock_r (CapeRwLock self)
+{
+  pthread_rwlock_rdlock (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_unlock_r (CapeRwLock self)
+{
+  pthread_rwlock_unlock (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_lock_w (CapeRwLock self)
+{
+  pthread_rwlock_wrlock (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_unlock_w (CapeRwLock self)
+{
+  pthread_rwlock_unlock (self);
 }
 
 //-----------------------------------------------------------------------------
@@ -56,38 +230,126 @@ void cape_mutex_unlock (CapeMutex self)
 
 //-----------------------------------------------------------------------------
 
-CapeMutex cape_mutex_new (void)
+void cape_mutex_init (CapeMutexInline* self, int flags)
+{
+  memset (self, 0, sizeof(CapeMutexInline));
+
+  // the critical section does the spinning by itself
+  InitializeCriticalSectionAndSpinCount (&(self->os), CAPE_MUTEX_SPIN * 40);
+
+  self->flags = flags;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_done (CapeMutexInline* self)
+{
+  DeleteCriticalSection (&(self->os));
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_lock (CapeMutex mutex)
 {
-  CRITICAL_SECTION* self = CAPE_NEW (CRITICAL_SECTION);
-  
-  InitializeCriticalSection (self);
-  
+  CapeMutexInline* self = mutex;
+
+  if (self->flags & CAPE_MUTEX_STATS)
+  {
+    if (TryEnterCriticalSection (&(self->os)))
+    {
+      self->stats.acquired++;
+    }
+    else
+    {
+      // spinning and parking can't be distinguished here
+      EnterCriticalSection (&(self->os));
+
+      self->stats.acquired++;
+      self->stats.contended++;
+    }
+  }
+  else
+  {
+    EnterCriticalSection (&(self->os));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_mutex_unlock (CapeMutex mutex)
+{
+  CapeMutexInline* self = mutex;
+
+  LeaveCriticalSection (&(self->os));
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_mutex_trylock (CapeMutex mutex)
+{
+  CapeMutexInline* self = mutex;
+
+  if (TryEnterCriticalSection (&(self->os)))
+  {
+    if (self->flags & CAPE_MUTEX_STATS)
+    {
+      self->stats.acquired++;
+    }
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+CapeRwLock cape_rwlock_new (void)
+{
+  SRWLOCK* self = CAPE_NEW (SRWLOCK);
+
+  InitializeSRWLock (self);
+
   return self;
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_mutex_del (CapeMutex* p_self)
+void cape_rwlock_del (CapeRwLock* p_self)
+{
+  if (*p_self)
+  {
+    // slim reader/writer locks don't need to be destroyed
+    CAPE_DEL (p_self, SRWLOCK);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_lock_r (CapeRwLock self)
+{
+  AcquireSRWLockShared (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_rwlock_unlock_r (CapeRwLock self)
 {
-  CRITICAL_SECTION* self = *p_self;
-  
-  DeleteCriticalSection (self);
-  
-  CAPE_DEL (p_self, CRITICAL_SECTION);
+  ReleaseSRWLockShared (self);
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_mutex_lock (CapeMutex self)
+void cape_rwlock_lock_w (CapeRwLock self)
 {
-  EnterCriticalSection (self);
+  AcquireSRWLockExclusive (self);
 }
 
 //-----------------------------------------------------------------------------
 
-void cape_mutex_unlock (CapeMutex self)
+void cape_rwlock_unlock_w (CapeRwLock self)
 {
-  LeaveCriticalSection (self);
+  ReleaseSRWLockExclusive (self);
 }
 
 //-----------------------------------------------------------------------------
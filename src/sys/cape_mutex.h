@@ -3,6 +3,13 @@
 
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
+#include "sys/cape_types.h"
+
+#if defined __WINDOWS_OS
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 //=============================================================================
 
@@ -10,19 +17,86 @@ typedef void* CapeMutex;
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_MUTEX_STATS        0x0001    // count acquisitions and contention
+
+typedef struct
+{
+  number_t acquired;        // amount of successful locks
+
+  number_t contended;       // amount of locks which didn't succeed at the first try
+
+  number_t parked;          // amount of locks which had to wait in the kernel
+
+} CapeMutexStats;
+
+//-----------------------------------------------------------------------------
+
+/*
+ * the mutex spins a short while before the thread is parked in the kernel,
+ * the struct can be embedded into other structs to avoid a separate allocation,
+ * a pointer to the struct can be used as CapeMutex
+ */
+typedef struct
+{
+
+#if defined __WINDOWS_OS
+  CRITICAL_SECTION os;
+#else
+  pthread_mutex_t os;
+#endif
+
+  int flags;
+
+  CapeMutexStats stats;     // only updated with CAPE_MUTEX_STATS
+
+} CapeMutexInline;
+
+//-----------------------------------------------------------------------------
+
 __CAPE_LIBEX   CapeMutex         cape_mutex_new         (void);                // allocate memory and initialize the object
 
+__CAPE_LIBEX   CapeMutex         cape_mutex_new_ex      (int flags);           // allocate memory and initialize the object
+
 __CAPE_LIBEX   void              cape_mutex_del         (CapeMutex*);          // release memory
 
+                                 /* initialize an embedded mutex */
+__CAPE_LIBEX   void              cape_mutex_init        (CapeMutexInline*, int flags);
+
+                                 /* release all resources of an embedded mutex */
+__CAPE_LIBEX   void              cape_mutex_done        (CapeMutexInline*);
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   void              cape_mutex_lock        (CapeMutex);
 
 __CAPE_LIBEX   void              cape_mutex_unlock      (CapeMutex);
 
+__CAPE_LIBEX   int               cape_mutex_trylock     (CapeMutex);           // returns TRUE if the lock was acquired
+
+                                 /* copies the current counters, all zero if the mutex has no CAPE_MUTEX_STATS flag */
+__CAPE_LIBEX   void              cape_mutex_stats       (CapeMutex, CapeMutexStats*);
+
+//=============================================================================
+
+typedef void* CapeRwLock;
+
 //-----------------------------------------------------------------------------
 
-#endif
+__CAPE_LIBEX   CapeRwLock        cape_rwlock_new        (void);                // allocate memory and initialize the object
 
+__CAPE_LIBEX   void              cape_rwlock_del        (CapeRwLock*);         // release memory
 
+//-----------------------------------------------------------------------------
+
+__CAPE_LIBEX   void              cape_rwlock_lock_r     (CapeRwLock);          // shared lock for readers
+
+__CAPE_LIBEX   void              cape_rwlock_unlock_r   (CapeRwLock);
+
+__CAPE_LIBEX   void              cape_rwlock_lock_w     (CapeRwLock);          // exclusive lock for writers
+
+__CAPE_LIBEX   void              cape_rwlock_unlock_w   (CapeRwLock);
+
+//-----------------------------------------------------------------------------
+
+#endif
 
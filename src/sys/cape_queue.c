@@ -41,6 +41,10 @@ struct CapeSync_s
 
 #else
 
+  // the semaphore can't count above SEMVMX (32767), so it only holds
+  // the busy state and the tasks are counted here
+  volatile long refcnt;
+
   int semid;
 
 #endif
@@ -74,6 +78,8 @@ CapeSync cape_sync_new (void)
   
   semctl (self->semid, 0, SETVAL, 0);
 
+  self->refcnt = 0;
+
 #endif
 
   return self;
@@ -107,16 +113,29 @@ void cape_sync_del (CapeSync* p_self)
 
 void cape_sync_inc (CapeSync self)
 {
-  if (self)
+  cape_sync_inc_n (self, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_sync_inc_n (CapeSync self, number_t amount)
+{
+  if (self && amount > 0)
   {
 #if defined __WINDOWS_OS
 
-    InterlockedIncrement (&(self->refcnt));
+    InterlockedExchangeAdd (&(self->refcnt), (LONG)amount);
 
     ResetEvent (self->revent);
 
 #else
 
+    // only the first task sets the busy state
+    if (__sync_fetch_and_add (&(self->refcnt), (long)amount) > 0)
+    {
+      return;
+    }
+
     struct sembuf sops[1];
 
     sops[0].sem_num = 0;
@@ -155,6 +174,12 @@ void cape_sync_dec (CapeSync self)
 
 #else
 
+    // only the last task clears the busy state
+    if (__sync_sub_and_fetch (&(self->refcnt), 1) > 0)
+    {
+      return;
+    }
+
     struct sembuf sops[1];
     
     sops[0].sem_num = 0;
@@ -230,7 +255,7 @@ void cape_sync_wait (CapeSync self)
 
 struct CapeQueue_s
 {
-  CapeMutex mutex;
+  CapeMutexInline mutex;
   
   CapeList threads;
   
@@ -251,6 +276,12 @@ struct CapeQueue_s
 #endif
   
   int terminated;
+  
+  int pin_mode;
+  
+  number_t idle;     // amount of workers waiting on the semaphore
+  
+  number_t wakes;    // amount of semaphore posts not yet consumed by a worker
 };
 
 //-----------------------------------------------------------------------------
@@ -314,7 +345,7 @@ CapeQueue cape_queue_new (void)
 {
   CapeQueue self = CAPE_NEW (struct CapeQueue_s);
   
-  self->mutex = cape_mutex_new ();
+  cape_mutex_init (&(self->mutex), 0);
 
 #if defined __WINDOWS_OS
 
@@ -343,6 +374,11 @@ CapeQueue cape_queue_new (void)
   
   self->terminated = FALSE;
   
+  self->pin_mode = CAPE_THREAD_PIN_NONE;
+  
+  self->idle = 0;
+  self->wakes = 0;
+  
   self->threads = cape_list_new (cape_queue__threads__on_del);
   
   self->queue = cape_list_new (cape_queue__item__on_del);
@@ -358,8 +394,12 @@ void cape_queue_del (CapeQueue* p_self)
   {
     CapeQueue self = *p_self;
     
+    cape_mutex_lock (&(self->mutex));
+    
     self->terminated = TRUE;
     
+    cape_mutex_unlock (&(self->mutex));
+    
     {
       CapeListCursor* cursor = cape_list_cursor_create (self->threads, CAPE_DIRECTION_FORW);
       
@@ -393,7 +433,7 @@ void cape_queue_del (CapeQueue* p_self)
 
     cape_list_del (&(self->queue));
     
-    cape_mutex_del (&(self->mutex));
+    cape_mutex_done (&(self->mutex));
     
     CAPE_DEL (p_self, struct CapeQueue_s);
   }
@@ -423,6 +463,11 @@ int cape_queue_start  (CapeQueue self, int amount_of_threads, CapeErr err)
     ti->thread = cape_thread_new ();
     ti->queue = self;
     
+    if (self->pin_mode != CAPE_THREAD_PIN_NONE)
+    {
+      cape_thread_pin (ti->thread, self->pin_mode, i);
+    }
+    
     cape_log_msg (CAPE_LL_TRACE, "CAPE", "queue start", "start new thread");
     
     cape_thread_start (ti->thread, cape_queue__worker__thread, self);
@@ -435,8 +480,77 @@ int cape_queue_start  (CapeQueue self, int amount_of_threads, CapeErr err)
 
 //-----------------------------------------------------------------------------
 
+void cape_queue_pin (CapeQueue self, int pin_mode)
+{
+  self->pin_mode = pin_mode;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_queue__wake (CapeQueue self, number_t amount)
+{
+  if (amount <= 0)
+  {
+    return;
+  }
+  
+#if defined __WINDOWS_OS
+
+  // increase the count
+  if (ReleaseSemaphore (self->semaphore, (LONG)amount, NULL) == 0)
+  {
+    CapeErr err = cape_err_new ();
+    
+    cape_err_lastOSError (err);
+    
+    cape_log_fmt (CAPE_LL_ERROR, "CAPE", "queue next", "can't permforme queue next: %s", cape_err_text(err));
+    
+    cape_err_del (&err);
+  }
+
+#else
+  
+  {
+    number_t i;
+    
+    for (i = 0; i < amount; i++)
+    {
+#if defined __BSD_OS
+      dispatch_semaphore_signal (self->sem);
+#else
+      sem_post (&(self->sem));
+#endif
+    }
+  }
+  
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t cape_queue__wakes_needed (CapeQueue self, number_t added)
+{
+  // workers which are not waiting will fetch the next item by themselves
+  number_t sleeping = self->idle - self->wakes;
+  
+  number_t amount = added < sleeping ? added : sleeping;
+  
+  if (amount > 0)
+  {
+    self->wakes += amount;
+    
+    return amount;
+  }
+  
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
 void cape_queue_add (CapeQueue self, CapeSync sync, cape_queue_cb_fct on_event, cape_queue_cb_fct on_done, void* ptr, number_t pos)
 {
+  number_t wakes;
+  
   CapeQueueItem item = CAPE_NEW (struct CapeQueueItem_s);
   
   item->on_done = on_done;
@@ -445,56 +559,64 @@ void cape_queue_add (CapeQueue self, CapeSync sync, cape_queue_cb_fct on_event,
   item->sync = sync;
   item->pos = pos;
   
-  cape_mutex_lock (self->mutex);
+  cape_sync_inc (sync);
+  
+  cape_mutex_lock (&(self->mutex));
   
   cape_list_push_back (self->queue, item);
   
-  cape_mutex_unlock (self->mutex);
-
-  cape_sync_inc (sync);
+  wakes = cape_queue__wakes_needed (self, 1);
   
-#if defined __WINDOWS_OS
+  cape_mutex_unlock (&(self->mutex));
+  
+  cape_queue__wake (self, wakes);
+}
 
-  // increase the count
-  if (ReleaseSemaphore (self->semaphore, 1, NULL) == 0)
+//-----------------------------------------------------------------------------
+
+void cape_queue_add_batch (CapeQueue self, CapeSync sync, const CapeQueueTask* tasks, number_t tasks_len)
+{
+  number_t i;
+  number_t wakes;
+  
+  if (tasks_len <= 0)
   {
-    CapeErr err = cape_err_new ();
-    
-    cape_err_lastOSError (err);
+    return;
+  }
+  
+  cape_sync_inc_n (sync, tasks_len);
+  
+  cape_mutex_lock (&(self->mutex));
+  
+  for (i = 0; i < tasks_len; i++)
+  {
+    CapeQueueItem item = CAPE_NEW (struct CapeQueueItem_s);
     
-    cape_log_fmt (CAPE_LL_ERROR, "CAPE", "queue next", "can't permforme queue next: %s", cape_err_text(err));
+    item->on_done = tasks[i].on_done;
+    item->on_event = tasks[i].on_event;
+    item->ptr = tasks[i].ptr;
+    item->sync = sync;
+    item->pos = tasks[i].pos;
     
-    cape_err_del (&err);
+    cape_list_push_back (self->queue, item);
   }
-
-#elif defined __BSD_OS
-
-  dispatch_semaphore_signal (self->sem);
   
-#else
+  wakes = cape_queue__wakes_needed (self, tasks_len);
   
-  sem_post (&(self->sem));
+  cape_mutex_unlock (&(self->mutex));
   
-#endif
+  cape_queue__wake (self, wakes);
 }
 
 //-----------------------------------------------------------------------------
 
-int cape_queue_next (CapeQueue self)
+static void cape_queue__wait (CapeQueue self)
 {
-  int ret = TRUE;
-  CapeQueueItem item = NULL;
- 
 #if defined __WINDOWS_OS
 
   DWORD res = WaitForSingleObject (self->semaphore, INFINITE);
 
-  if (res == WAIT_OBJECT_0)
-  {
-    printf ("QUEUE WAIT DONE\n");
-
-  }
-  else
+  if (res != WAIT_OBJECT_0)
   {
     CapeErr err = cape_err_new ();
     
@@ -505,7 +627,6 @@ int cape_queue_next (CapeQueue self)
     cape_err_del (&err);
   }
 
-
 #elif defined __BSD_OS
   
   dispatch_semaphore_wait (self->sem, DISPATCH_TIME_FOREVER);
@@ -526,29 +647,313 @@ int cape_queue_next (CapeQueue self)
   }
 
 #endif
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_queue_next (CapeQueue self)
+{
+  CapeQueueItem item = NULL;
   
-  cape_mutex_lock (self->mutex);
-  
-  ret = !self->terminated;
+  cape_mutex_lock (&(self->mutex));
   
-  if (ret)
+  while (!self->terminated)
   {
     item = cape_list_pop_front (self->queue);
+    
+    if (item)
+    {
+      break;
+    }
+    
+    // nothing to do, wait until a producer wakes us up
+    self->idle++;
+    
+    cape_mutex_unlock (&(self->mutex));
+    
+    cape_queue__wait (self);
+    
+    cape_mutex_lock (&(self->mutex));
+    
+    self->idle--;
+    
+    if (self->wakes > 0)
+    {
+      self->wakes--;
+    }
   }
   
-  cape_mutex_unlock (self->mutex);
+  cape_mutex_unlock (&(self->mutex));
   
-  if (item && ret)
+  if (item == NULL)
   {
-    if (item->on_event)
+    // the queue was terminated
+    return FALSE;
+  }
+  
+  if (item->on_event)
+  {
+    item->on_event (item->ptr, item->pos);
+  }
+  
+  cape_queue__item__on_del (item);
+  
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+struct CapeFuture_s
+{
+  CapeMutexInline mutex;
+  
+#if defined __WINDOWS_OS
+  
+  CONDITION_VARIABLE cond;
+  
+#else
+  
+  pthread_cond_t cond;
+  
+#endif
+  
+  int refcnt;
+  
+  int ready;
+  
+  void* result;
+  
+  CapeErr err;
+};
+
+//-----------------------------------------------------------------------------
+
+CapeFuture cape_future_new (void)
+{
+  CapeFuture self = CAPE_NEW (struct CapeFuture_s);
+  
+  cape_mutex_init (&(self->mutex), 0);
+  
+#if defined __WINDOWS_OS
+  
+  InitializeConditionVariable (&(self->cond));
+  
+#else
+  
+  pthread_cond_init (&(self->cond), NULL);
+  
+#endif
+  
+  self->refcnt = 1;
+  self->ready = FALSE;
+  self->result = NULL;
+  self->err = cape_err_new ();
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_future_del (CapeFuture* p_self)
+{
+  if (*p_self)
+  {
+    CapeFuture self = *p_self;
+    int refcnt;
+    
+    cape_mutex_lock (&(self->mutex));
+    
+    refcnt = --(self->refcnt);
+    
+    cape_mutex_unlock (&(self->mutex));
+    
+    if (refcnt == 0)
+    {
+      cape_err_del (&(self->err));
+      
+#if !defined __WINDOWS_OS
+      
+      pthread_cond_destroy (&(self->cond));
+      
+#endif
+      
+      cape_mutex_done (&(self->mutex));
+      
+      CAPE_DEL (p_self, struct CapeFuture_s);
+    }
+    
+    *p_self = NULL;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CapeFuture cape_future_ref (CapeFuture self)
+{
+  cape_mutex_lock (&(self->mutex));
+  
+  self->refcnt++;
+  
+  cape_mutex_unlock (&(self->mutex));
+  
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_future_set (CapeFuture self, void* result, CapeErr err)
+{
+  int ret = FALSE;
+  
+  cape_mutex_lock (&(self->mutex));
+  
+  if (!self->ready)
+  {
+    if (err && cape_err_code (err))
+    {
+      cape_err_set (self->err, cape_err_code (err), cape_err_text (err));
+    }
+    else
     {
-      item->on_event (item->ptr, item->pos);
+      self->result = result;
     }
     
-    cape_queue__item__on_del (item);
+    self->ready = TRUE;
+    
+    ret = TRUE;
+    
+#if defined __WINDOWS_OS
+    
+    WakeAllConditionVariable (&(self->cond));
+    
+#else
+    
+    pthread_cond_broadcast (&(self->cond));
+    
+#endif
   }
   
+  cape_mutex_unlock (&(self->mutex));
+  
   return ret;
 }
 
 //-----------------------------------------------------------------------------
+
+void* cape_future_get (CapeFuture self, CapeErr err)
+{
+  void* ret = NULL;
+  
+  cape_mutex_lock (&(self->mutex));
+  
+  while (!self->ready)
+  {
+#if defined __WINDOWS_OS
+    
+    SleepConditionVariableCS (&(self->cond), &(self->mutex.os), INFINITE);
+    
+#else
+    
+    pthread_cond_wait (&(self->cond), &(self->mutex.os));
+    
+#endif
+  }
+  
+  if (cape_err_code (self->err))
+  {
+    cape_err_set (err, cape_err_code (self->err), cape_err_text (self->err));
+  }
+  else
+  {
+    // transfer the ownership
+    ret = self->result;
+    self->result = NULL;
+  }
+  
+  cape_mutex_unlock (&(self->mutex));
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_future_ready (CapeFuture self)
+{
+  int ret;
+  
+  cape_mutex_lock (&(self->mutex));
+  
+  ret = self->ready;
+  
+  cape_mutex_unlock (&(self->mutex));
+  
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+struct CapeFutureTask_s
+{
+  cape_future_fct on_event;
+  
+  void* ptr;
+  
+  CapeFuture future;    // own reference
+  
+}; typedef struct CapeFutureTask_s* CapeFutureTask;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_queue__future__on_event (void* ptr, number_t pos)
+{
+  CapeFutureTask task = ptr;
+  
+  CapeErr err = cape_err_new ();
+  
+  void* result = task->on_event (task->ptr, pos, err);
+  
+  cape_future_set (task->future, result, err);
+  
+  cape_err_del (&err);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL cape_queue__future__on_done (void* ptr, number_t pos)
+{
+  CapeFutureTask task = ptr;
+  
+  // in case the task was never executed
+  {
+    CapeErr err = cape_err_new ();
+    
+    cape_err_set (err, CAPE_ERR_PROCESS_ABORT, "queue was terminated");
+    
+    cape_future_set (task->future, NULL, err);
+    
+    cape_err_del (&err);
+  }
+  
+  cape_future_del (&(task->future));
+  
+  CAPE_DEL (&task, struct CapeFutureTask_s);
+}
+
+//-----------------------------------------------------------------------------
+
+CapeFuture cape_queue_add_future (CapeQueue self, cape_future_fct on_event, void* ptr, number_t pos)
+{
+  CapeFuture future = cape_future_new ();
+  
+  CapeFutureTask task = CAPE_NEW (struct CapeFutureTask_s);
+  
+  task->on_event = on_event;
+  task->ptr = ptr;
+  task->future = cape_future_ref (future);
+  
+  cape_queue_add (self, NULL, cape_queue__future__on_event, cape_queue__future__on_done, task, pos);
+  
+  return future;
+}
+
+//-----------------------------------------------------------------------------
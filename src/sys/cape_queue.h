@@ -17,6 +17,8 @@ __CAPE_LIBEX   void        cape_sync_del           (CapeSync*);
 
 __CAPE_LIBEX   void        cape_sync_inc           (CapeSync);
 
+__CAPE_LIBEX   void        cape_sync_inc_n         (CapeSync, number_t amount);
+
 __CAPE_LIBEX   void        cape_sync_dec           (CapeSync);
 
 __CAPE_LIBEX   void        cape_sync_wait          (CapeSync);
@@ -27,6 +29,18 @@ struct CapeQueue_s; typedef struct CapeQueue_s* CapeQueue;
 
 typedef void (__STDCALL *cape_queue_cb_fct)(void* ptr, number_t pos);
 
+typedef struct
+{
+  cape_queue_cb_fct on_event;
+  
+  cape_queue_cb_fct on_done;
+  
+  void* ptr;
+  
+  number_t pos;
+  
+} CapeQueueTask;
+
 //-----------------------------------------------------------------------------
 
 __CAPE_LIBEX   CapeQueue   cape_queue_new          (void);
@@ -49,6 +63,13 @@ __CAPE_LIBEX   int         cape_queue_next         (CapeQueue);
                             */
 __CAPE_LIBEX   void        cape_queue_add          (CapeQueue, CapeSync, cape_queue_cb_fct on_event, cape_queue_cb_fct on_done, void* ptr, number_t pos);
 
+                           /*
+                            * adds an array of tasks at once
+                            * -> the queue is locked only once
+                            * -> only as many idle workers are woken up as tasks were added
+                            */
+__CAPE_LIBEX   void        cape_queue_add_batch    (CapeQueue, CapeSync, const CapeQueueTask* tasks, number_t tasks_len);
+
                            /*
                             * starts the queueing in background
                             * -> threads will be created
@@ -56,6 +77,62 @@ __CAPE_LIBEX   void        cape_queue_add          (CapeQueue, CapeSync, cape_qu
                             */
 __CAPE_LIBEX   int         cape_queue_start        (CapeQueue, int amount_of_threads, CapeErr err);
 
+                           /*
+                            * pins the worker threads round-robin to cores or NUMA nodes
+                            * -> use one of the CAPE_THREAD_PIN_* modes
+                            * -> must be called before cape_queue_start
+                            */
+__CAPE_LIBEX   void        cape_queue_pin          (CapeQueue, int pin_mode);
+
+//-----------------------------------------------------------------------------
+
+struct CapeFuture_s; typedef struct CapeFuture_s* CapeFuture;
+
+typedef void* (__STDCALL *cape_future_fct)(void* ptr, number_t pos, CapeErr err);
+
+//-----------------------------------------------------------------------------
+
+                           /*
+                            * creates the shared state of a future / promise pair
+                            * -> the creator owns one reference
+                            */
+__CAPE_LIBEX   CapeFuture  cape_future_new         (void);
+
+                           /*
+                            * releases one reference, the last one frees the memory
+                            */
+__CAPE_LIBEX   void        cape_future_del         (CapeFuture*);
+
+                           /*
+                            * adds another reference, hand it over to the side which fulfills the promise
+                            */
+__CAPE_LIBEX   CapeFuture  cape_future_ref         (CapeFuture);
+
+                           /*
+                            * fulfills the promise with a result or an error (err can be NULL)
+                            * -> only the first call has an effect, returns FALSE otherwise
+                            */
+__CAPE_LIBEX   int         cape_future_set         (CapeFuture, void* result, CapeErr err);
+
+                           /*
+                            * waits until the promise was fulfilled (blocking)
+                            * -> returns the result and transfers its ownership to the caller
+                            * -> returns NULL and sets err if the promise failed
+                            */
+__CAPE_LIBEX   void*       cape_future_get         (CapeFuture, CapeErr err);
+
+                           /*
+                            * returns TRUE if the promise was fulfilled
+                            */
+__CAPE_LIBEX   int         cape_future_ready       (CapeFuture);
+
+                           /*
+                            * adds a new task, the return value of the task is delivered by the future
+                            * -> the caller owns the returned future
+                            * -> if the queue is terminated before the task runs, the future fails
+                            */
+__CAPE_LIBEX   CapeFuture  cape_queue_add_future   (CapeQueue, cape_future_fct on_event, void* ptr, number_t pos);
+
 //-----------------------------------------------------------------------------
 
 #endif
@@ -0,0 +1,347 @@
+#include "cape_random.h"
+
+// c includes
+#include <string.h>
+#include <time.h>
+
+#if defined __WINDOWS_OS
+
+#include <windows.h>
+#include <bcrypt.h>
+
+#if defined _MSC_VER
+#pragma comment (lib, "bcrypt.lib")
+#endif
+
+#define CAPE_RANDOM__TLS __declspec(thread)
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#if defined __LINUX_OS
+#include <sys/random.h>
+#endif
+
+#define CAPE_RANDOM__TLS __thread
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CAPE_RANDOM__POOL    256           // bytes read at once in secure mode
+
+//=============================================================================
+
+typedef struct
+{
+  cape_uint64 s[4];                       // xoshiro256** state
+
+  unsigned char pool[CAPE_RANDOM__POOL];  // secure mode
+
+  number_t pool_pos;
+
+  unsigned long generation;               // the state is valid for this generation
+
+} CapeRandomState;
+
+//-----------------------------------------------------------------------------
+
+static CAPE_RANDOM__TLS CapeRandomState cape_random__state;
+
+static volatile int cape_random__mode = CAPE_RANDOM_FAST;
+
+// increased in the child after a fork, 0 marks an unseeded state
+static volatile unsigned long cape_random__generation = 1;
+
+//-----------------------------------------------------------------------------
+
+int cape_random_os (void* buf, number_t size)
+{
+#if defined __WINDOWS_OS
+
+  return BCRYPT_SUCCESS (BCryptGenRandom (NULL, buf, (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG));
+
+#elif defined __BSD_OS
+
+  arc4random_buf (buf, size);
+
+  return TRUE;
+
+#else
+
+  unsigned char* pos = buf;
+
+#if defined __LINUX_OS
+
+  while (size > 0)
+  {
+    ssize_t res = getrandom (pos, size, 0);
+
+    if (res < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      // older kernels
+      break;
+    }
+
+    pos += res;
+    size -= res;
+  }
+
+  if (size == 0)
+  {
+    return TRUE;
+  }
+
+#endif
+
+  {
+    int fd = open ("/dev/urandom", O_RDONLY);
+
+    if (fd < 0)
+    {
+      return FALSE;
+    }
+
+    while (size > 0)
+    {
+      ssize_t res = read (fd, pos, size);
+
+      if (res <= 0)
+      {
+        if (res < 0 && errno == EINTR)
+        {
+          continue;
+        }
+
+        break;
+      }
+
+      pos += res;
+      size -= res;
+    }
+
+    close (fd);
+  }
+
+  return size == 0;
+
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+#if !defined __WINDOWS_OS
+
+static pthread_once_t cape_random__once = PTHREAD_ONCE_INIT;
+
+static void cape_random__on_fork (void)
+{
+  // the child must not continue the sequences of the parent
+  cape_random__generation++;
+}
+
+static void cape_random__register (void)
+{
+  pthread_atfork (NULL, NULL, cape_random__on_fork);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static void cape_random__seed (CapeRandomState* self)
+{
+#if !defined __WINDOWS_OS
+
+  pthread_once (&cape_random__once, cape_random__register);
+
+#endif
+
+  if (!cape_random_os (self->s, sizeof(self->s)))
+  {
+    // last resort, at least different for each thread and time
+    self->s[0] = (cape_uint64)(size_t)self;
+    self->s[1] = (cape_uint64)(size_t)&self;
+    self->s[2] = (cape_uint64)time (NULL);
+    self->s[3] = 0x9E3779B97F4A7C15ULL;
+  }
+
+  // the state must not be zero
+  if ((self->s[0] | self->s[1] | self->s[2] | self->s[3]) == 0)
+  {
+    self->s[0] = 0x9E3779B97F4A7C15ULL;
+  }
+
+  self->pool_pos = CAPE_RANDOM__POOL;
+  self->generation = cape_random__generation;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE CapeRandomState* cape_random__get (void)
+{
+  CapeRandomState* self = &cape_random__state;
+
+  if (self->generation != cape_random__generation)
+  {
+    cape_random__seed (self);
+  }
+
+  return self;
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE cape_uint64 cape_random__rotl (cape_uint64 x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE cape_uint64 cape_random__next (CapeRandomState* self)
+{
+  cape_uint64* s = self->s;
+
+  const cape_uint64 result = cape_random__rotl (s[1] * 5, 7) * 9;
+  const cape_uint64 t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+
+  s[2] ^= t;
+
+  s[3] = cape_random__rotl (s[3], 45);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+
+static void cape_random__secure (CapeRandomState* self, unsigned char* buf, number_t size)
+{
+  while (size > 0)
+  {
+    number_t part;
+
+    if (self->pool_pos == CAPE_RANDOM__POOL)
+    {
+      if (!cape_random_os (self->pool, CAPE_RANDOM__POOL))
+      {
+        // never return predictable numbers in secure mode
+        abort ();
+      }
+
+      self->pool_pos = 0;
+    }
+
+    part = CAPE_RANDOM__POOL - self->pool_pos;
+
+    if (part > size)
+    {
+      part = size;
+    }
+
+    memcpy (buf, self->pool + self->pool_pos, part);
+
+    // don't keep used bytes
+    memset (self->pool + self->pool_pos, 0, part);
+
+    self->pool_pos += part;
+
+    buf += part;
+    size -= part;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_random_mode (int mode)
+{
+  cape_random__mode = mode;
+}
+
+//-----------------------------------------------------------------------------
+
+cape_uint64 cape_random_u64 (void)
+{
+  CapeRandomState* self = cape_random__get ();
+
+  if (cape_random__mode == CAPE_RANDOM_SECURE)
+  {
+    cape_uint64 ret;
+
+    cape_random__secure (self, (unsigned char*)&ret, sizeof(ret));
+
+    return ret;
+  }
+
+  return cape_random__next (self);
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_random_bytes (void* buf, number_t size)
+{
+  CapeRandomState* self = cape_random__get ();
+
+  if (cape_random__mode == CAPE_RANDOM_SECURE)
+  {
+    cape_random__secure (self, buf, size);
+  }
+  else
+  {
+    unsigned char* pos = buf;
+
+    while (size >= 8)
+    {
+      cape_uint64 h = cape_random__next (self);
+
+      memcpy (pos, &h, 8);
+
+      pos += 8;
+      size -= 8;
+    }
+
+    if (size > 0)
+    {
+      cape_uint64 h = cape_random__next (self);
+
+      memcpy (pos, &h, size);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_random_n (number_t bound)
+{
+  cape_uint64 b = (cape_uint64)bound;
+
+  // the smallest value which doesn't produce a bias
+  cape_uint64 threshold = (0 - b) % b;
+
+  for (;;)
+  {
+    cape_uint64 r = cape_random_u64 ();
+
+    if (r >= threshold)
+    {
+      return (number_t)(r % b);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
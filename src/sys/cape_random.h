@@ -0,0 +1,40 @@
+#ifndef __CAPE_SYS__RANDOM__H
+#define __CAPE_SYS__RANDOM__H 1
+
+#include "sys/cape_export.h"
+#include "sys/cape_types.h"
+
+//=============================================================================
+
+/* random numbers without a global lock
+ *
+ * -> every thread has its own xoshiro256** generator, seeded from the
+ *    operating system (getrandom, arc4random or BCryptGenRandom)
+ * -> the secure mode takes all numbers from the system CSPRNG, they are read
+ *    in blocks into a per thread buffer
+ * -> after a fork the child reseeds, parent and child never share a sequence
+ */
+
+//=============================================================================
+
+#define CAPE_RANDOM_FAST          0         // xoshiro256**, not for secrets
+#define CAPE_RANDOM_SECURE        1         // the CSPRNG of the operating system
+
+//-----------------------------------------------------------------------------
+
+               // sets the mode for all threads, the default is CAPE_RANDOM_FAST
+__CAPE_LIBEX   void               cape_random_mode        (int mode);
+
+__CAPE_LIBEX   cape_uint64        cape_random_u64         (void);
+
+__CAPE_LIBEX   void               cape_random_bytes       (void* buf, number_t size);
+
+               // returns a uniform number in [0, bound), bound must be greater than 0
+__CAPE_LIBEX   number_t           cape_random_n           (number_t bound);
+
+               // always reads from the operating system, returns FALSE on errors
+__CAPE_LIBEX   int                cape_random_os          (void* buf, number_t size);
+
+//-----------------------------------------------------------------------------
+
+#endif
@@ -1,3 +1,8 @@
+// c includes
+#ifdef __GNUC__
+#define _GNU_SOURCE 1
+#endif
+
 #include "cape_thread.h"
 
 // cape includes
@@ -11,11 +16,269 @@
 #include <pthread.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <stdio.h>
+
+#if defined __LINUX_OS
+
+#include <sched.h>
+#include <sys/syscall.h>
+
+#endif
 
 #include "sys/cape_types.h"
 
 //-----------------------------------------------------------------------------------
 
+#define CAPE_THREAD_TOPO_MAX 1024
+
+#define CAPE_THREAD_MPOL_PREFERRED 1      // same value as MPOL_PREFERRED in numaif.h
+
+//-----------------------------------------------------------------------------------
+
+static number_t cape_thread_topo__cpus_len = 0;
+static number_t cape_thread_topo__nodes_len = 1;
+
+static number_t cape_thread_topo__cpus [CAPE_THREAD_TOPO_MAX];   // ids of all online cpus
+static number_t cape_thread_topo__node [CAPE_THREAD_TOPO_MAX];   // NUMA node of each online cpu
+
+static pthread_once_t cape_thread_topo__once = PTHREAD_ONCE_INIT;
+
+//-----------------------------------------------------------------------------------
+
+static void cape_thread_topo__add (number_t cpu)
+{
+  if (cape_thread_topo__cpus_len < CAPE_THREAD_TOPO_MAX)
+  {
+    cape_thread_topo__cpus [cape_thread_topo__cpus_len] = cpu;
+    cape_thread_topo__node [cape_thread_topo__cpus_len] = 0;
+    
+    cape_thread_topo__cpus_len++;
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+static void cape_thread_topo__probe_online (void)
+{
+  // the kernel provides the online cpus as ranges, eg: 0-7,16-23
+  FILE* fp = fopen ("/sys/devices/system/cpu/online", "r");
+  
+  if (fp)
+  {
+    char buffer [1024];
+    
+    if (fgets (buffer, 1024, fp))
+    {
+      char* pos = buffer;
+      
+      while (*pos >= '0' && *pos <= '9')
+      {
+        number_t cpu_from = strtol (pos, &pos, 10);
+        number_t cpu_to = cpu_from;
+        
+        if (*pos == '-')
+        {
+          cpu_to = strtol (pos + 1, &pos, 10);
+        }
+        
+        for (; cpu_from <= cpu_to; cpu_from++)
+        {
+          cape_thread_topo__add (cpu_from);
+        }
+        
+        if (*pos == ',')
+        {
+          pos++;
+        }
+      }
+    }
+    
+    fclose (fp);
+  }
+  
+  if (cape_thread_topo__cpus_len == 0)
+  {
+    // fallback if sysfs is not available
+    number_t i;
+    number_t n = sysconf (_SC_NPROCESSORS_ONLN);
+    
+    for (i = 0; i < n; i++)
+    {
+      cape_thread_topo__add (i);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+static void cape_thread_topo__probe_nodes (void)
+{
+  number_t i;
+  
+  for (i = 0; i < cape_thread_topo__cpus_len; i++)
+  {
+    char path [100];
+    DIR* dir;
+    
+    snprintf (path, 100, "/sys/devices/system/cpu/cpu%li", cape_thread_topo__cpus[i]);
+    
+    // the NUMA node is a symbolic link named nodeX in the cpu folder
+    dir = opendir (path);
+    
+    if (dir)
+    {
+      struct dirent* entry;
+      
+      while ((entry = readdir (dir)) != NULL)
+      {
+        if (strncmp (entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+        {
+          number_t node = strtol (entry->d_name + 4, NULL, 10);
+          
+          cape_thread_topo__node[i] = node;
+          
+          if (node + 1 > cape_thread_topo__nodes_len)
+          {
+            cape_thread_topo__nodes_len = node + 1;
+          }
+          
+          break;
+        }
+      }
+      
+      closedir (dir);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+static void cape_thread_topo__probe (void)
+{
+  cape_thread_topo__probe_online ();
+  cape_thread_topo__probe_nodes ();
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_cpus (void)
+{
+  pthread_once (&cape_thread_topo__once, cape_thread_topo__probe);
+  
+  return cape_thread_topo__cpus_len;
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_nodes (void)
+{
+  pthread_once (&cape_thread_topo__once, cape_thread_topo__probe);
+  
+  return cape_thread_topo__nodes_len;
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_node (number_t cpu)
+{
+  number_t i;
+  
+  pthread_once (&cape_thread_topo__once, cape_thread_topo__probe);
+  
+  for (i = 0; i < cape_thread_topo__cpus_len; i++)
+  {
+    if (cape_thread_topo__cpus[i] == cpu)
+    {
+      return cape_thread_topo__node[i];
+    }
+  }
+  
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+#if defined __LINUX_OS
+
+static int cape_thread__pin_set (int pin_mode, number_t index, cpu_set_t* cpus, number_t* p_node)
+{
+  number_t i;
+  
+  pthread_once (&cape_thread_topo__once, cape_thread_topo__probe);
+  
+  CPU_ZERO (cpus);
+  *p_node = -1;
+  
+  switch (pin_mode)
+  {
+    case CAPE_THREAD_PIN_CORES:
+    {
+      number_t cpu = cape_thread_topo__cpus [index % cape_thread_topo__cpus_len];
+      
+      if (cpu < CPU_SETSIZE)
+      {
+        CPU_SET (cpu, cpus);
+        return TRUE;
+      }
+      
+      break;
+    }
+    case CAPE_THREAD_PIN_NODES:
+    {
+      number_t node = index % cape_thread_topo__nodes_len;
+      int found = FALSE;
+      
+      for (i = 0; i < cape_thread_topo__cpus_len; i++)
+      {
+        if (cape_thread_topo__node[i] == node && cape_thread_topo__cpus[i] < CPU_SETSIZE)
+        {
+          CPU_SET (cape_thread_topo__cpus[i], cpus);
+          found = TRUE;
+        }
+      }
+      
+      if (found)
+      {
+        *p_node = node;
+      }
+      
+      return found;
+    }
+  }
+  
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------------
+
+static int cape_thread__mempolicy (number_t node)
+{
+  unsigned long mask [CAPE_THREAD_TOPO_MAX / (8 * sizeof(unsigned long))];
+  
+  memset (mask, 0, sizeof(mask));
+  
+  if (node < 0 || node >= CAPE_THREAD_TOPO_MAX)
+  {
+    return EINVAL;
+  }
+  
+  mask [node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+  
+  // use the syscall directly to avoid the dependency to libnuma
+  if (syscall (SYS_set_mempolicy, CAPE_THREAD_MPOL_PREFERRED, mask, CAPE_THREAD_TOPO_MAX) == -1)
+  {
+    return errno;
+  }
+  
+  return 0;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------------
+
 struct CapeThread_s
 {
   cape_thread_worker_fct fct;
@@ -25,6 +288,16 @@ struct CapeThread_s
   pthread_t tid;
   
   int status;
+  
+#if defined __LINUX_OS
+  
+  cpu_set_t cpus;
+  
+  int has_cpus;
+  
+#endif
+  
+  number_t memnode;
 };
 
 //-----------------------------------------------------------------------------------
@@ -33,6 +306,27 @@ static void* cape_thread_run (void* params)
 {
   CapeThread self = params;
   
+#if defined __LINUX_OS
+  
+  if (self->memnode >= 0)
+  {
+    // the memory policy is a property of the thread, so it can only be set from inside
+    int res = cape_thread__mempolicy (self->memnode);
+    
+    if (res)
+    {
+      CapeErr err = cape_err_new ();
+      
+      cape_err_formatErrorOS (err, res);
+      
+      cape_log_fmt (CAPE_LL_WARN, "CAPE", "thread", "can't set memory policy for node %li: %s", self->memnode, cape_err_text (err));
+      
+      cape_err_del (&err);
+    }
+  }
+  
+#endif
+  
   if (self->fct)
   {
     while (self->fct (self->ptr))
@@ -58,6 +352,15 @@ CapeThread cape_thread_new (void)
   
   self->status = FALSE;
   
+#if defined __LINUX_OS
+  
+  CPU_ZERO (&(self->cpus));
+  self->has_cpus = FALSE;
+  
+#endif
+  
+  self->memnode = -1;
+  
   return self;
 }
 
@@ -94,11 +397,20 @@ void cape_thread_start (CapeThread self, cape_thread_worker_fct fct, void* ptr)
   pthread_attr_t attr;
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+#if defined __LINUX_OS
+  // start the thread already on the right cpus
+  if (self->has_cpus)
+  {
+    pthread_attr_setaffinity_np (&attr, sizeof(cpu_set_t), &(self->cpus));
+  }
+#endif
   // assign the callback parameters
   self->fct = fct;
   self->ptr = ptr;
   // finally create the thread
   self->status = (pthread_create(&(self->tid), &attr, cape_thread_run, self) == 0);
+  
+  pthread_attr_destroy (&attr);
 }
 
 //-----------------------------------------------------------------------------------
@@ -122,6 +434,86 @@ void cape_thread_sleep (unsigned long milliseconds)
 
 //-----------------------------------------------------------------------------
 
+void cape_thread_cpus (CapeThread self, const number_t* cpus, number_t cpus_len)
+{
+#if defined __LINUX_OS
+  
+  number_t i;
+  
+  CPU_ZERO (&(self->cpus));
+  
+  for (i = 0; i < cpus_len; i++)
+  {
+    if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE)
+    {
+      CPU_SET (cpus[i], &(self->cpus));
+    }
+  }
+  
+  self->has_cpus = CPU_COUNT (&(self->cpus)) > 0;
+  
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_thread_memnode (CapeThread self, number_t node)
+{
+  self->memnode = node;
+}
+
+//-----------------------------------------------------------------------------
+
+void cape_thread_pin (CapeThread self, int pin_mode, number_t index)
+{
+#if defined __LINUX_OS
+  
+  number_t node;
+  
+  self->has_cpus = cape_thread__pin_set (pin_mode, index, &(self->cpus), &node);
+  
+  // only prefer the memory of the node if there are more than one
+  self->memnode = (cape_thread_topo__nodes_len > 1) ? node : -1;
+  
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+int cape_thread_pin_self (int pin_mode, number_t index, CapeErr err)
+{
+#if defined __LINUX_OS
+  
+  cpu_set_t cpus;
+  number_t node;
+  
+  if (cape_thread__pin_set (pin_mode, index, &cpus, &node))
+  {
+    int res = pthread_setaffinity_np (pthread_self (), sizeof(cpu_set_t), &cpus);
+    
+    if (res)
+    {
+      return cape_err_formatErrorOS (err, res);
+    }
+    
+    if (node >= 0 && cape_thread_topo__nodes_len > 1)
+    {
+      res = cape_thread__mempolicy (node);
+      
+      if (res)
+      {
+        return cape_err_formatErrorOS (err, res);
+      }
+    }
+  }
+  
+#endif
+  
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------
+
 #elif defined _WIN64 || defined _WIN32
 
 #include <windows.h>
@@ -135,6 +527,8 @@ struct CapeThread_s
   cape_thread_worker_fct fct;
   
   void* ptr;
+  
+  DWORD_PTR mask;
 };
 
 //-----------------------------------------------------------------------------------
@@ -158,6 +552,7 @@ CapeThread cape_thread_new (void)
   CapeThread self = CAPE_NEW (struct CapeThread_s);
   
   self->th = NULL;
+  self->mask = 0;
   
   return self;
 }
@@ -181,7 +576,17 @@ void cape_thread_start (CapeThread self, cape_thread_worker_fct fct, void* ptr)
   {
     self->fct = fct;
     self->ptr = ptr;
-    self->th = CreateThread (NULL, 0, (LPTHREAD_START_ROUTINE)cape_thread_run, (LPVOID)self, 0, NULL);
+    self->th = CreateThread (NULL, 0, (LPTHREAD_START_ROUTINE)cape_thread_run, (LPVOID)self, CREATE_SUSPENDED, NULL);
+    
+    if (self->th)
+    {
+      if (self->mask)
+      {
+        SetThreadAffinityMask (self->th, self->mask);
+      }
+      
+      ResumeThread (self->th);
+    }
   }
 }
 
@@ -225,6 +630,121 @@ void cape_thread_sleep (unsigned long milliseconds)
   Sleep (milliseconds);
 }
 
+//-----------------------------------------------------------------------------------
+
+static DWORD_PTR cape_thread__pin_mask (int pin_mode, number_t index)
+{
+  number_t cpus = cape_thread_topo_cpus ();
+  
+  switch (pin_mode)
+  {
+    case CAPE_THREAD_PIN_CORES:
+    {
+      return ((DWORD_PTR)1) << (index % cpus);
+    }
+    case CAPE_THREAD_PIN_NODES:
+    {
+      ULONGLONG mask = 0;
+      
+      if (GetNumaNodeProcessorMask ((UCHAR)(index % cape_thread_topo_nodes ()), &mask))
+      {
+        return (DWORD_PTR)mask;
+      }
+      
+      break;
+    }
+  }
+  
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+void cape_thread_cpus (CapeThread self, const number_t* cpus, number_t cpus_len)
+{
+  number_t i;
+  
+  self->mask = 0;
+  
+  for (i = 0; i < cpus_len; i++)
+  {
+    if (cpus[i] >= 0 && cpus[i] < (number_t)(8 * sizeof(DWORD_PTR)))
+    {
+      self->mask |= ((DWORD_PTR)1) << cpus[i];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------
+
+void cape_thread_memnode (CapeThread self, number_t node)
+{
+  // windows allocates on the node of the ideal processor
+}
+
+//-----------------------------------------------------------------------------------
+
+void cape_thread_pin (CapeThread self, int pin_mode, number_t index)
+{
+  self->mask = cape_thread__pin_mask (pin_mode, index);
+}
+
+//-----------------------------------------------------------------------------------
+
+int cape_thread_pin_self (int pin_mode, number_t index, CapeErr err)
+{
+  DWORD_PTR mask = cape_thread__pin_mask (pin_mode, index);
+  
+  if (mask)
+  {
+    if (SetThreadAffinityMask (GetCurrentThread (), mask) == 0)
+    {
+      return cape_err_lastOSError (err);
+    }
+  }
+  
+  return CAPE_ERR_NONE;
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_cpus (void)
+{
+  SYSTEM_INFO info;
+  
+  GetSystemInfo (&info);
+  
+  return info.dwNumberOfProcessors;
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_nodes (void)
+{
+  ULONG node = 0;
+  
+  if (GetNumaHighestNodeNumber (&node))
+  {
+    return node + 1;
+  }
+  
+  return 1;
+}
+
+//-----------------------------------------------------------------------------------
+
+number_t cape_thread_topo_node (number_t cpu)
+{
+  UCHAR node = 0;
+  
+  if (GetNumaProcessorNode ((UCHAR)cpu, &node))
+  {
+    return node;
+  }
+  
+  return 0;
+}
+
 #endif
 
 //-----------------------------------------------------------------------------
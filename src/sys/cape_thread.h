@@ -3,6 +3,7 @@
 
 #include "sys/cape_export.h"
 #include "sys/cape_err.h"
+#include "sys/cape_types.h"
 
 //=============================================================================
 
@@ -26,6 +27,45 @@ __CAPE_LIBEX   void              cape_thread_cancel     (CapeThread);
 
 __CAPE_LIBEX   void              cape_thread_sleep      (unsigned long milliseconds);
 
+//-----------------------------------------------------------------------------
+// placement of threads on cores and NUMA nodes
+
+#define CAPE_THREAD_PIN_NONE      0       // the scheduler decides where the thread runs
+#define CAPE_THREAD_PIN_CORES     1       // pin round-robin to a single core
+#define CAPE_THREAD_PIN_NODES     2       // pin round-robin to all cores of a NUMA node and prefer its memory
+
+                                 /*
+                                  * sets the cpus the thread is allowed to run on
+                                  * -> must be called before the thread was started
+                                  */
+__CAPE_LIBEX   void              cape_thread_cpus       (CapeThread, const number_t* cpus, number_t cpus_len);
+
+                                 /*
+                                  * prefers memory allocations from the given NUMA node (-1 disables it)
+                                  * -> must be called before the thread was started
+                                  */
+__CAPE_LIBEX   void              cape_thread_memnode    (CapeThread, number_t node);
+
+                                 /*
+                                  * assigns cpus and memory node by the pin mode
+                                  * -> index is the number of the thread in a pool, it is used for the round-robin
+                                  */
+__CAPE_LIBEX   void              cape_thread_pin        (CapeThread, int pin_mode, number_t index);
+
+                                 /*
+                                  * same as cape_thread_pin, but for the calling thread
+                                  */
+__CAPE_LIBEX   int               cape_thread_pin_self   (int pin_mode, number_t index, CapeErr err);
+
+//-----------------------------------------------------------------------------
+// topology (probed once from /sys/devices/system/cpu)
+
+__CAPE_LIBEX   number_t          cape_thread_topo_cpus  (void);                // amount of online cpus
+
+__CAPE_LIBEX   number_t          cape_thread_topo_nodes (void);                // amount of NUMA nodes
+
+__CAPE_LIBEX   number_t          cape_thread_topo_node  (number_t cpu);        // NUMA node of the cpu
+
 //-----------------------------------------------------------------------------
 
 #endif
@@ -429,31 +429,202 @@ CapeString cape_datetime_s__fmt (const CapeDatetime* dt, const CapeString format
 
 //-----------------------------------------------------------------------------
 
+static __CAPE_INLINE char* cape_datetime__cp (char* pos, const char* text)
+{
+  while (*text)
+  {
+    *pos++ = *text++;
+  }
+  
+  return pos;
+}
+
+//-----------------------------------------------------------------------------
+
+// writes the value with a fixed amount of digits, larger values are written completely
+static __CAPE_INLINE char* cape_datetime__d2 (char* pos, unsigned int v)
+{
+  if (v < 100)
+  {
+    pos[0] = (char)('0' + v / 10);
+    pos[1] = (char)('0' + v % 10);
+    
+    return pos + 2;
+  }
+  
+  return pos + cape_str_n_buf (pos, v);
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE char* cape_datetime__d3 (char* pos, unsigned int v)
+{
+  if (v < 1000)
+  {
+    pos[0] = (char)('0' + v / 100);
+    
+    return cape_datetime__d2 (pos + 1, v % 100);
+  }
+  
+  return pos + cape_str_n_buf (pos, v);
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE char* cape_datetime__d4 (char* pos, unsigned int v)
+{
+  if (v < 10000)
+  {
+    pos = cape_datetime__d2 (pos, v / 100);
+    
+    return cape_datetime__d2 (pos, v % 100);
+  }
+  
+  return pos + cape_str_n_buf (pos, v);
+}
+
+//-----------------------------------------------------------------------------
+
+// the date part with separators: 2013-10-21
+static __CAPE_INLINE char* cape_datetime__date (char* pos, const CapeDatetime* dt, const char* sep)
+{
+  pos = cape_datetime__d4 (pos, dt->year);
+  pos = cape_datetime__cp (pos, sep);
+  pos = cape_datetime__d2 (pos, dt->month);
+  pos = cape_datetime__cp (pos, sep);
+  
+  return cape_datetime__d2 (pos, dt->day);
+}
+
+//-----------------------------------------------------------------------------
+
+number_t cape_datetime_b__std (const CapeDatetime* dt, char* buf)
+{
+  char* pos = cape_datetime__date (buf, dt, "-");
+  
+  *pos++ = 'T';
+  pos = cape_datetime__d2 (pos, dt->hour);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->minute);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->sec);
+  *pos++ = '.';
+  pos = cape_datetime__d3 (pos, dt->msec);
+  *pos++ = 'Z';
+  *pos = '\0';
+  
+  return pos - buf;
+}
+
+//-----------------------------------------------------------------------------
+
 CapeString cape_datetime_s__std (const CapeDatetime* dt)
 {
-  return cape_str_fmt ("%04i-%02i-%02iT%02i:%02i:%02i.%03iZ", dt->year, dt->month, dt->day, dt->hour, dt->minute, dt->sec, dt->msec);
+  char buf[CAPE_DATETIME_BUF];
+  
+  return cape_str_sub (buf, cape_datetime_b__std (dt, buf));
+}
+
+//-----------------------------------------------------------------------------
+
+CapeString cape_datetime_s__std_s (const CapeDatetime* dt)
+{
+  char buf[CAPE_DATETIME_BUF];
+  char* pos = cape_datetime__date (buf, dt, "-");
+  
+  *pos++ = 'T';
+  pos = cape_datetime__d2 (pos, dt->hour);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->minute);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->sec);
+  *pos++ = 'Z';
+  
+  return cape_str_sub (buf, pos - buf);
 }
 
 //-----------------------------------------------------------------------------
 
 CapeString cape_datetime_s__str (const CapeDatetime* dt)
 {
-  return cape_str_fmt ("%i-%02i-%02i %02i:%02i:%02i", dt->year, dt->month, dt->day, dt->hour, dt->minute, dt->sec);
+  char buf[CAPE_DATETIME_BUF];
+  
+  // the year has no fixed width in this format
+  char* pos = buf + cape_str_n_buf (buf, dt->year);
+  
+  *pos++ = '-';
+  pos = cape_datetime__d2 (pos, dt->month);
+  *pos++ = '-';
+  pos = cape_datetime__d2 (pos, dt->day);
+  *pos++ = ' ';
+  pos = cape_datetime__d2 (pos, dt->hour);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->minute);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->sec);
+  
+  return cape_str_sub (buf, pos - buf);
 }
 
 //-----------------------------------------------------------------------------
 
 CapeString cape_datetime_s__log (const CapeDatetime* dt)
 {
-  return cape_str_fmt ("%04i%02i%02i-%02i:%02i:%02i.%03i", dt->year, dt->month, dt->day, dt->hour, dt->minute, dt->sec, dt->msec);
+  char buf[CAPE_DATETIME_BUF];
+  char* pos = cape_datetime__date (buf, dt, "");
+  
+  *pos++ = '-';
+  pos = cape_datetime__d2 (pos, dt->hour);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->minute);
+  *pos++ = ':';
+  pos = cape_datetime__d2 (pos, dt->sec);
+  *pos++ = '.';
+  pos = cape_datetime__d3 (pos, dt->msec);
+  
+  return cape_str_sub (buf, pos - buf);
 }
 
 //-----------------------------------------------------------------------------
 
 CapeString cape_datetime_s__gmt (const CapeDatetime* dt)
 {
-  // TODO: use the same method as cape_datetime_s__str
-  return cape_datetime_s__fmt (dt, "%a, %d %b %Y %H:%M:%S GMT");
+  static const char* days[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+  static const char* months[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  
+  // the weekday is only known for valid dates
+  if (dt->month < 1 || dt->month > 12 || dt->day < 1 || dt->day > 31 || dt->year < 1)
+  {
+    return cape_datetime_s__fmt (dt, "%a, %d %b %Y %H:%M:%S GMT");
+  }
+  
+  {
+    // weekday after sakamoto
+    static const int offsets[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    
+    char buf[CAPE_DATETIME_BUF];
+    char* pos = buf;
+    
+    unsigned int y = dt->year - (dt->month < 3);
+    unsigned int wday = (y + y / 4 - y / 100 + y / 400 + offsets[dt->month - 1] + dt->day) % 7;
+    
+    pos = cape_datetime__cp (pos, days[wday]);
+    pos = cape_datetime__cp (pos, ", ");
+    pos = cape_datetime__d2 (pos, dt->day);
+    *pos++ = ' ';
+    pos = cape_datetime__cp (pos, months[dt->month - 1]);
+    *pos++ = ' ';
+    pos = cape_datetime__d4 (pos, dt->year);
+    *pos++ = ' ';
+    pos = cape_datetime__d2 (pos, dt->hour);
+    *pos++ = ':';
+    pos = cape_datetime__d2 (pos, dt->minute);
+    *pos++ = ':';
+    pos = cape_datetime__d2 (pos, dt->sec);
+    pos = cape_datetime__cp (pos, " GMT");
+    
+    return cape_str_sub (buf, pos - buf);
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -467,16 +638,34 @@ CapeString cape_datetime_s__aph (const CapeDatetime* dt)
 
 CapeString cape_datetime_s__pre (const CapeDatetime* dt)
 {
-  // TODO: use the same method as cape_datetime_s__str
-  return cape_datetime_s__fmt (dt, "%Y_%m_%d__%H_%M_%S__");
+  char buf[CAPE_DATETIME_BUF];
+  char* pos = cape_datetime__date (buf, dt, "_");
+  
+  pos = cape_datetime__cp (pos, "__");
+  pos = cape_datetime__d2 (pos, dt->hour);
+  *pos++ = '_';
+  pos = cape_datetime__d2 (pos, dt->minute);
+  *pos++ = '_';
+  pos = cape_datetime__d2 (pos, dt->sec);
+  pos = cape_datetime__cp (pos, "__");
+  
+  return cape_str_sub (buf, pos - buf);
 }
 
 //-----------------------------------------------------------------------------
 
 CapeString cape_datetime_s__ISO8601 (const CapeDatetime* dt)
 {
-  // TODO: use the same method as cape_datetime_s__str
-  return cape_datetime_s__fmt (dt, "%Y%m%dT%H%M%SZ");
+  char buf[CAPE_DATETIME_BUF];
+  char* pos = cape_datetime__date (buf, dt, "");
+  
+  *pos++ = 'T';
+  pos = cape_datetime__d2 (pos, dt->hour);
+  pos = cape_datetime__d2 (pos, dt->minute);
+  pos = cape_datetime__d2 (pos, dt->sec);
+  *pos++ = 'Z';
+  
+  return cape_str_sub (buf, pos - buf);
 }
 
 //-----------------------------------------------------------------------------
@@ -95,6 +95,13 @@ __CAPE_LIBEX   CapeString      cape_datetime_s__ISO8601   (const CapeDatetime*);
 
 //-----------------------------------------------------------------------------
 
+#define CAPE_DATETIME_BUF 80
+
+                               /* same as cape_datetime_s__std, but writes into a buffer of CAPE_DATETIME_BUF bytes, returns the length */
+__CAPE_LIBEX   number_t        cape_datetime_b__std       (const CapeDatetime*, char* buf);
+
+//-----------------------------------------------------------------------------
+
 __CAPE_LIBEX   time_t          cape_datetime_n__unix      (const CapeDatetime*);
 
 //-----------------------------------------------------------------------------
@@ -30,6 +30,8 @@
 
 #include <stdio.h>
 
+#include "sys/cape_export.h"
+
 //-----------------------------------------------------------------------------
 
 #define u_t unsigned
@@ -37,40 +39,23 @@
 
 //-----------------------------------------------------------------------------
 
-static void* cape_alloc (number_t size)
-{
-  void* ptr = malloc (size);
-  
-  if (ptr == NULL)
-  {
-    // write some last words
-    printf ("*** FATAL *** CAN't ALLOCATE MEMORY *** FATAL ***\n");
-    
-    // abort everything
-    abort ();
-  }
-  
-  memset (ptr, 0, size);
-
-  return ptr;
-}
+// allocation layer, implemented in sys/cape_alloc.c
+// -> small blocks are served from per thread size-class caches
+// -> all blocks are plain system heap blocks, they can be released by free or CAPE_FREE
 
-//-----------------------------------------------------------------------------
+__CAPE_LIBEX   void*     cape_alloc_new        (number_t size);                // returns zeroed memory, aborts if out of memory
 
-static void cape_free (void* ptr)
-{
-  free (ptr);
-}
+__CAPE_LIBEX   void      cape_alloc_del        (void* ptr, number_t size);     // size can be 0 if not known, NULL is ignored
 
 //-----------------------------------------------------------------------------
 
-#define CAPE_ALLOC(size) cape_alloc(size)
-#define CAPE_FREE(ptr) cape_free(ptr)
+#define CAPE_ALLOC(size) cape_alloc_new(size)
+#define CAPE_FREE(ptr) cape_alloc_del(ptr, 0)
 
 //-----------------------------------------------------------------------------
 
-#define CAPE_NEW(type) (type*)cape_alloc(sizeof(type))
-#define CAPE_DEL(ptr, type) { memset(*ptr, 0, sizeof(type)); free(*ptr); *ptr = 0; }
+#define CAPE_NEW(type) (type*)cape_alloc_new(sizeof(type))
+#define CAPE_DEL(ptr, type) { cape_alloc_del(*ptr, sizeof(type)); *ptr = 0; }
 
 //-----------------------------------------------------------------------------
 
@@ -118,4 +103,20 @@ typedef float       cape_float32;
 
 #endif
 
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE void* cape_alloc (number_t size)
+{
+  return cape_alloc_new (size);
+}
+
+//-----------------------------------------------------------------------------
+
+static __CAPE_INLINE void cape_free (void* ptr)
+{
+  cape_alloc_del (ptr, 0);
+}
+
+//-----------------------------------------------------------------------------
+
 #endif
@@ -0,0 +1,470 @@
+#include "aio/cape_aio_task.h"
+#include "aio/cape_aio_sock.h"
+#include "sys/cape_queue.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_log.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_CONNECTIONS   8
+#define UT_ROUNDS        2000
+#define UT_MSG_SIZE      64
+#define UT_COMPUTE       2000
+
+//-----------------------------------------------------------------------------
+
+// some cpu work which transforms the message
+static void ut_compute (char* bufdat)
+{
+  number_t i;
+  unsigned int h = 0;
+  
+  for (i = 0; i < UT_COMPUTE; i++)
+  {
+    h = h * 31 + (unsigned char)bufdat[i % UT_MSG_SIZE];
+  }
+  
+  for (i = 0; i < UT_MSG_SIZE; i++)
+  {
+    bufdat[i] = bufdat[i] ^ 0x20;
+  }
+  
+  // use the hash, otherwise the loop is optimized away
+  if (h == 0)
+  {
+    bufdat[0] = bufdat[0];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  int fd;
+  
+  int failed;
+  
+} UtClient;
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_client__worker (void* ptr)
+{
+  UtClient* self = ptr;
+  number_t r;
+  
+  char msg[UT_MSG_SIZE];
+  char res[UT_MSG_SIZE];
+  
+  for (r = 0; r < UT_ROUNDS; r++)
+  {
+    number_t got = 0;
+    
+    memset (msg, 'a' + (r % 26), UT_MSG_SIZE);
+    
+    if (write (self->fd, msg, UT_MSG_SIZE) != UT_MSG_SIZE)
+    {
+      self->failed = TRUE;
+      break;
+    }
+    
+    while (got < UT_MSG_SIZE)
+    {
+      ssize_t n = read (self->fd, res + got, UT_MSG_SIZE - got);
+      
+      if (n <= 0)
+      {
+        break;
+      }
+      
+      got += n;
+    }
+    
+    ut_compute (msg);
+    
+    if (got != UT_MSG_SIZE || memcmp (msg, res, UT_MSG_SIZE) != 0)
+    {
+      self->failed = TRUE;
+      break;
+    }
+  }
+  
+  close (self->fd);
+  
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeQueue queue;
+  
+  CapeAioContext aio;
+  
+  char bufdat[UT_MSG_SIZE];
+  
+  number_t buflen;
+  
+  number_t* done;
+  
+  CapeAioSocket sock;     // only for the callback version
+  
+  CapeAioPost post;       // only for the callback version
+  
+} UtSession;
+
+//-----------------------------------------------------------------------------
+
+static void* __STDCALL ut_session__compute (void* ptr, number_t pos, CapeErr err)
+{
+  UtSession* self = ptr;
+  
+  ut_compute (self->bufdat);
+  
+  return NULL;
+}
+
+//=============================================================================
+// coroutine version
+
+static int __STDCALL ut_task__on_run (void* ptr, CapeAioTask task)
+{
+  UtSession* self = ptr;
+  
+  CAPE_AIO_TASK_BEGIN (task)
+  
+  while (TRUE)
+  {
+    self->buflen = 0;
+    
+    while (self->buflen < UT_MSG_SIZE)
+    {
+      CAPE_AIO_TASK_AWAIT (task, cape_aio_task_recv (task));
+      
+      {
+        number_t len;
+        const char* data = cape_aio_task_data (task, &len);
+        
+        if (data == NULL)
+        {
+          return CAPE_AIO_TASK_DONE;
+        }
+        
+        memcpy (self->bufdat + self->buflen, data, len);
+        
+        self->buflen += len;
+      }
+    }
+    
+    CAPE_AIO_TASK_AWAIT (task, cape_aio_task_offload (task, self->queue, ut_session__compute, self));
+    
+    CAPE_AIO_TASK_AWAIT (task, cape_aio_task_send (task, self->bufdat, self->buflen));
+  }
+  
+  CAPE_AIO_TASK_END (task)
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_task__on_done (void* ptr)
+{
+  UtSession* self = ptr;
+  
+  (*(self->done))++;
+}
+
+//=============================================================================
+// callback version
+
+static void __STDCALL ut_cb__on_post (void* ptr)
+{
+  UtSession* self = ptr;
+  
+  // back on the reactor thread
+  cape_aio_socket_send (self->sock, self->aio, self->bufdat, self->buflen, NULL);
+  
+  self->buflen = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_cb__on_event (void* ptr, number_t pos)
+{
+  ut_compute (((UtSession*)ptr)->bufdat);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_cb__on_computed (void* ptr, number_t pos)
+{
+  UtSession* self = ptr;
+  
+  cape_aio_context_post (self->aio, &(self->post));
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_cb__on_recv (void* ptr, CapeAioSocket socket, const char* bufdat, number_t buflen)
+{
+  UtSession* self = ptr;
+  
+  memcpy (self->bufdat + self->buflen, bufdat, buflen);
+  
+  self->buflen += buflen;
+  
+  if (self->buflen == UT_MSG_SIZE)
+  {
+    cape_queue_add (self->queue, NULL, ut_cb__on_event, ut_cb__on_computed, self, 0);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_cb__on_done (void* ptr, void* userdata)
+{
+  UtSession* self = ptr;
+  
+  (*(self->done))++;
+}
+
+//=============================================================================
+// sleeps
+
+#define UT_SLEEPS        5
+
+typedef struct
+{
+  number_t sleeps;
+  
+  number_t* done;
+  
+} UtSleeper;
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_sleep__on_run (void* ptr, CapeAioTask task)
+{
+  UtSleeper* self = ptr;
+  
+  CAPE_AIO_TASK_BEGIN (task)
+  
+  while (self->sleeps < UT_SLEEPS)
+  {
+    // the same timer is used for all sleeps
+    CAPE_AIO_TASK_AWAIT (task, cape_aio_task_sleep (task, 10));
+    
+    self->sleeps++;
+  }
+  
+  CAPE_AIO_TASK_END (task)
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_sleep__on_done (void* ptr)
+{
+  UtSleeper* self = ptr;
+  
+  (*(self->done))++;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_sleep (CapeAioContext aio, CapeErr err)
+{
+  int res = 0;
+  int i;
+  
+  number_t done = 0;
+  
+  UtSleeper sleepers[UT_CONNECTIONS];
+  
+  double t1;
+  
+  CapeStopTimer st = cape_stoptimer_new ();
+  
+  cape_stoptimer_start (st);
+  
+  for (i = 0; i < UT_CONNECTIONS; i++)
+  {
+    CapeAioTask task = cape_aio_task_new (aio, &(sleepers[i]), ut_sleep__on_run, ut_sleep__on_done);
+    
+    sleepers[i].sleeps = 0;
+    sleepers[i].done = &done;
+    
+    cape_aio_task_start (&task);
+  }
+  
+  while (done < UT_CONNECTIONS)
+  {
+    cape_aio_context_next (aio, 100, err);
+  }
+  
+  cape_stoptimer_stop (st);
+  
+  t1 = cape_stoptimer_get (st);
+  
+  cape_stoptimer_del (&st);
+  
+  for (i = 0; i < UT_CONNECTIONS; i++)
+  {
+    if (sleepers[i].sleeps != UT_SLEEPS)
+    {
+      res = 1;
+    }
+  }
+  
+  if (t1 < UT_SLEEPS * 10)
+  {
+    printf ("woke up too early: %.2f ms\n", t1);
+    res = 1;
+  }
+  
+  printf ("%-10s: %i tasks x %i sleeps in %.2f ms\n", "sleep", UT_CONNECTIONS, UT_SLEEPS, t1);
+  
+  return res;
+}
+
+//=============================================================================
+
+static int ut_run (CapeAioContext aio, CapeQueue queue, int use_tasks, CapeErr err)
+{
+  int res = 0;
+  int i;
+  
+  number_t done = 0;
+  
+  UtClient clients[UT_CONNECTIONS];
+  UtSession sessions[UT_CONNECTIONS];
+  CapeThread threads[UT_CONNECTIONS];
+  
+  CapeStopTimer st = cape_stoptimer_new ();
+  
+  cape_stoptimer_start (st);
+  
+  for (i = 0; i < UT_CONNECTIONS; i++)
+  {
+    int fds[2];
+    
+    socketpair (AF_UNIX, SOCK_STREAM, 0, fds);
+    
+    memset (&(sessions[i]), 0, sizeof(UtSession));
+    
+    sessions[i].queue = queue;
+    sessions[i].aio = aio;
+    sessions[i].done = &done;
+    
+    if (use_tasks)
+    {
+      CapeAioTask task = cape_aio_task_new (aio, &(sessions[i]), ut_task__on_run, ut_task__on_done);
+      
+      cape_aio_task_attach (task, cape_aio_socket_new ((void*)(number_t)fds[0]));
+      
+      cape_aio_task_start (&task);
+    }
+    else
+    {
+      CapeAioSocket sock = cape_aio_socket_new ((void*)(number_t)fds[0]);
+      
+      sessions[i].sock = sock;
+      sessions[i].post.ptr = &(sessions[i]);
+      sessions[i].post.on_post = ut_cb__on_post;
+      
+      cape_aio_socket_callback (sock, &(sessions[i]), NULL, ut_cb__on_recv, ut_cb__on_done);
+      
+      cape_aio_socket_add_r (&sock, aio);
+    }
+    
+    clients[i].fd = fds[1];
+    clients[i].failed = FALSE;
+    
+    threads[i] = cape_thread_new ();
+    
+    cape_thread_start (threads[i], ut_client__worker, &(clients[i]));
+  }
+  
+  while (done < UT_CONNECTIONS)
+  {
+    cape_aio_context_next (aio, 100, err);
+  }
+  
+  for (i = 0; i < UT_CONNECTIONS; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+    
+    if (clients[i].failed)
+    {
+      res = 1;
+    }
+  }
+  
+  cape_stoptimer_stop (st);
+  
+  printf ("%-10s: %i connections x %i rounds in %.2f ms\n", use_tasks ? "coroutine" : "callbacks", UT_CONNECTIONS, UT_ROUNDS, cape_stoptimer_get (st));
+  
+  cape_stoptimer_del (&st);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  
+  CapeErr err = cape_err_new ();
+  
+  CapeAioContext aio = cape_aio_context_new ();
+  
+  CapeQueue queue = cape_queue_new ();
+  
+  if (cape_aio_context_open (aio, err))
+  {
+    cape_log_fmt (CAPE_LL_ERROR, "CAPE", "UT :: aio task", "can't open context: %s", cape_err_text (err));
+    
+    res = 1;
+    goto exit_and_cleanup;
+  }
+  
+  cape_queue_start (queue, 2, err);
+  
+  if (ut_run (aio, queue, FALSE, err))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "UT :: aio task", "callback version failed");
+    res = 1;
+  }
+  
+  if (ut_run (aio, queue, TRUE, err))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "UT :: aio task", "coroutine version failed");
+    res = 1;
+  }
+
+  if (ut_sleep (aio, err))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "UT :: aio task", "sleep failed");
+    res = 1;
+  }
+
+exit_and_cleanup:
+  
+  cape_queue_del (&queue);
+  
+  cape_aio_context_del (&aio);
+  
+  cape_err_del (&err);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,392 @@
+#include "fmt/cape_grisu.h"
+#include "fmt/cape_dragon4.h"
+#include "stc/cape_stream.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_VALUES    200000
+#define UT_LOOPS     1000000
+
+//-----------------------------------------------------------------------------
+
+static cape_uint64 ut_random (cape_uint64* state)
+{
+  // xorshift64
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+
+  return *state;
+}
+
+//-----------------------------------------------------------------------------
+
+static double ut_double (cape_uint64 bits)
+{
+  double ret;
+
+  memcpy (&ret, &bits, sizeof(double));
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t ut_dragon4 (char* buf, double value)
+{
+  number_t ret;
+
+  CapeErr err = cape_err_new ();
+  CapeDragon4 dragon4 = cape_dragon4_new ();
+
+  cape_dragon4_positional (dragon4, CAPE_DRAGON4__DMODE_UNIQUE, CAPE_DRAGON4__CMODE_TOTAL, -1, FALSE, CAPE_DRAGON4__TMODE_ONE_ZERO, 0, 0);
+
+  cape_dragon4_run (dragon4, buf, CAPE_GRISU_BUF, value, err);
+
+  ret = cape_dragon4_len (dragon4);
+
+  cape_dragon4_del (&dragon4);
+  cape_err_del (&err);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+// same output as Dragon4 and the value must be parsed back exactly
+static int ut_check (double value)
+{
+  char buf1[CAPE_GRISU_BUF];
+  char buf2[CAPE_GRISU_BUF];
+
+  number_t len = cape_grisu_positional (buf1, value);
+
+  if (len != ut_dragon4 (buf2, value) || strcmp (buf1, buf2))
+  {
+    printf ("%.17g: '%s' != '%s'\n", value, buf1, buf2);
+    return 1;
+  }
+
+  if (isfinite (value) && strtod (buf1, NULL) != value)
+  {
+    printf ("%.17g: no round trip for '%s'\n", value, buf1);
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  number_t i, fallbacks = 0;
+  cape_uint64 state = 88172645463325252ULL;
+
+  double values[16] = {0.0, -0.0, 1.0, 0.1, 0.3, 1e21, 1e22, 1e23, 5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 9007199254740993.0, 123456.789, NAN, INFINITY, -INFINITY};
+
+  for (i = 0; i < 16; i++)
+  {
+    if (ut_check (values[i]))
+    {
+      return 1;
+    }
+  }
+
+  for (i = 0; i < UT_VALUES; i++)
+  {
+    char digits[20];
+    int len, exp10;
+
+    // random bits cover all exponents, random integers and short fractions are typical data
+    double value = ut_double (ut_random (&state));
+
+    switch (i % 3)
+    {
+      case 1: value = (double)(number_t)(ut_random (&state) >> (ut_random (&state) % 64)); break;
+      case 2: value = (double)(number_t)(ut_random (&state) % 100000000) / 1000.0; break;
+    }
+
+    if (!cape_grisu_digits (value, digits, &len, &exp10))
+    {
+      fallbacks++;
+    }
+
+    if (ut_check (value))
+    {
+      return 1;
+    }
+  }
+
+  printf ("values: %i, dragon4 fallbacks: %li\n", UT_VALUES, fallbacks);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_context (void)
+{
+  number_t i;
+  char buf1[CAPE_DRAGON4_BUF];
+  char buf2[CAPE_DRAGON4_BUF];
+
+  double values[5] = {0.5, -1e-7, 3.0, 1e22, 0.1};
+
+  CapeDragon4 dragon4 = cape_dragon4_new ();
+  CapeStream s1 = cape_stream_new ();
+  CapeStream s2 = cape_stream_new ();
+
+  // the thread local context doesn't keep the options
+  cape_dragon4_scientific (cape_dragon4_tls (), CAPE_DRAGON4__DMODE_EXACT, 5, TRUE, CAPE_DRAGON4__TMODE_NONE, 0, 3);
+
+  if (cape_dragon4_tls () != cape_dragon4_tls () || cape_dragon4_format_to (buf1, CAPE_DRAGON4_BUF, 0.1, CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO) != 3 || strcmp (buf1, "0.1"))
+  {
+    return 1;
+  }
+
+  // exact digits
+  if (cape_dragon4_format_to (buf1, CAPE_DRAGON4_BUF, 0.1, CAPE_DRAGON4__DMODE_EXACT, 20, CAPE_DRAGON4__TMODE_NONE) != 22 || strcmp (buf1, "0.10000000000000000555"))
+  {
+    printf ("wrong exact value: '%s'\n", buf1);
+    return 1;
+  }
+
+  // a too small buffer is truncated
+  if (cape_dragon4_format_to (buf1, 4, 123456.0, CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO) != 3 || cape_dragon4_format_to (buf1, 0, 1.0, CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO) != 0)
+  {
+    return 1;
+  }
+
+  // the batch is the same as single values
+  cape_dragon4_positional (dragon4, CAPE_DRAGON4__DMODE_UNIQUE, CAPE_DRAGON4__CMODE_TOTAL, -1, FALSE, CAPE_DRAGON4__TMODE_ONE_ZERO, 0, 0);
+
+  cape_dragon4_batch (dragon4, s1, values, 5, ",");
+
+  for (i = 0; i < 5; i++)
+  {
+    if (i)
+    {
+      cape_stream_append_c (s2, ',');
+    }
+
+    cape_stream_append_buf (s2, buf2, cape_dragon4_format_to (buf2, CAPE_DRAGON4_BUF, values[i], CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO));
+  }
+
+  if (strcmp (cape_stream_get (s1), cape_stream_get (s2)) || strcmp (cape_stream_get (s1), "0.5,-0.0000001,3.0,10000000000000000000000.0,0.1"))
+  {
+    printf ("wrong batch: '%s'\n", cape_stream_get (s1));
+    return 1;
+  }
+
+  cape_stream_del (&s1);
+  cape_stream_del (&s2);
+  cape_dragon4_del (&dragon4);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_thread (void* ptr)
+{
+  number_t i;
+  int* res = ptr;
+  char buf[CAPE_DRAGON4_BUF];
+
+  // each thread has its own context
+  for (i = 0; i < 10000; i++)
+  {
+    double value = (double)i / 7.0;
+
+    cape_dragon4_format_to (buf, CAPE_DRAGON4_BUF, value, CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO);
+
+    if (strtod (buf, NULL) != value)
+    {
+      *res = 1;
+    }
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_threads (void)
+{
+  int i, res = 0;
+  CapeThread threads[4];
+
+  for (i = 0; i < 4; i++)
+  {
+    threads[i] = cape_thread_new ();
+
+    cape_thread_start (threads[i], ut_thread, &res);
+  }
+
+  for (i = 0; i < 4; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_benchmark (void)
+{
+  number_t i, sum = 0;
+  char buf[CAPE_GRISU_BUF];
+
+  double values[16];
+  cape_uint64 state = 2463534242ULL;
+
+  CapeStream s = cape_stream_new ();
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  // typical values of a json document
+  for (i = 0; i < 16; i++)
+  {
+    values[i] = (double)(number_t)(ut_random (&state) % 100000000) / 1000.0;
+  }
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS / 10; i++)
+  {
+    sum += ut_dragon4 (buf, values[i % 16]);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("dragon4   : %.2f ms (%i values)\n", cape_stoptimer_get (st), UT_LOOPS / 10);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS / 10; i++)
+  {
+    sum -= cape_dragon4_format_to (buf, CAPE_GRISU_BUF, values[i % 16], CAPE_DRAGON4__DMODE_UNIQUE, -1, CAPE_DRAGON4__TMODE_ONE_ZERO);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("dragon4 tls: %.2f ms (%i values)\n", cape_stoptimer_get (st), UT_LOOPS / 10);
+
+  {
+    double* array = CAPE_ALLOC (sizeof(double) * UT_LOOPS / 10);
+    CapeDragon4 dragon4 = cape_dragon4_new ();
+
+    for (i = 0; i < UT_LOOPS / 10; i++)
+    {
+      array[i] = values[i % 16];
+    }
+
+    cape_dragon4_positional (dragon4, CAPE_DRAGON4__DMODE_UNIQUE, CAPE_DRAGON4__CMODE_TOTAL, -1, FALSE, CAPE_DRAGON4__TMODE_ONE_ZERO, 0, 0);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_dragon4_batch (dragon4, s, array, UT_LOOPS / 10, ",");
+
+    cape_stoptimer_stop (st);
+
+    printf ("dragon4 batch: %.2f ms (%i values)\n", cape_stoptimer_get (st), UT_LOOPS / 10);
+
+    cape_stream_clr (s);
+    cape_dragon4_del (&dragon4);
+
+    CAPE_FREE (array);
+  }
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum -= snprintf (buf, CAPE_GRISU_BUF, "%.17g", values[i % 16]);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("snprintf  : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum += cape_grisu_positional (buf, values[i % 16]);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("grisu     : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_stream_append_f (s, values[i % 16]);
+
+    if (cape_stream_size (s) > 60000)
+    {
+      cape_stream_clr (s);
+    }
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("stream    : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stream_del (&s);
+  cape_stoptimer_del (&st);
+
+  if (sum == 0)
+  {
+    printf ("no output\n");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_correctness ())
+  {
+    printf ("correctness test failed\n");
+    res = 1;
+  }
+
+  if (ut_context ())
+  {
+    printf ("context test failed\n");
+    res = 1;
+  }
+
+  if (ut_threads ())
+  {
+    printf ("thread test failed\n");
+    res = 1;
+  }
+
+  ut_benchmark ();
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 
 int main (int argc, char *argv[])
 {
@@ -79,5 +80,44 @@ int main (int argc, char *argv[])
     cape_udc_del (&m);
   }
   
+  // the keys are written in the order of their names
+  {
+    CapeString s1;
+    CapeUdc m;
+    
+    CapeUdc n = cape_udc_new (CAPE_UDC_NODE, NULL);
+    
+    cape_udc_add_n (n, "zeta", 1);
+    cape_udc_add_n (n, "alpha", 2);
+    cape_udc_add_n (n, "mu", 3);
+    
+    s1 = cape_json_to_s (n);
+    
+    printf ("OUT1: %s\n", s1);
+    
+    if (strcmp (s1, "{\"alpha\":2,\"mu\":3,\"zeta\":1}"))
+    {
+      cape_log_msg (CAPE_LL_ERROR, "TEST", "udc order", "keys are not sorted");
+      return 1;
+    }
+    
+    cape_str_del (&s1);
+    
+    m = cape_json_from_s ("{\"zeta\":1,\"alpha\":2,\"mu\":3}");
+    
+    s1 = cape_json_to_s (m);
+    
+    if (strcmp (s1, "{\"alpha\":2,\"mu\":3,\"zeta\":1}"))
+    {
+      cape_log_msg (CAPE_LL_ERROR, "TEST", "udc order", "parsed keys are not sorted");
+      return 1;
+    }
+    
+    cape_str_del (&s1);
+    
+    cape_udc_del (&n);
+    cape_udc_del (&m);
+  }
+  
   return 0;
 }
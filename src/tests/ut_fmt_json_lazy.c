@@ -0,0 +1,408 @@
+#include "fmt/cape_json.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_OBJECTS   100000
+#define UT_LOOPS     5
+
+//-----------------------------------------------------------------------------
+
+// the lazy document must give the same result as the parser
+static int ut_same (void)
+{
+  int res = 0;
+
+  const char* docs[] =
+  {
+    "{}", "[]", " \r\n\t{ \"a\" : 1 , \"b\" : [ ] , \"c\" : { } } ",
+    "{\"n\":-42,\"f\":3.25,\"t\":true,\"x\":false,\"z\":null,\"s\":\"text\",\"e\":\"\"}",
+    "[1,[2,[3,[4,{\"deep\":[5,6,{\"deeper\":\"yes\"}]}]]],7]",
+    "{\"esc\":\"a\\\"b\\\\c\\/d\\ne\\tf\\rg\\bh\\fi\",\"uni\":\"\\u00e4\\u20ac\\u0041\",\"k\\\"ey\":1}",
+    "{\"d\":\"2012-04-23T18:25:43.511Z\",\"nd\":\"2012-04-23 18:25:43.511Z\"}",
+    "{\"same\":1,\"same\":2,\"other\":[null,1,null]}",
+    "{\"text\":\"with , : { } [ ] inside\",\"utf8\":\"\xc3\xa4\xc3\xb6\"}",
+    NULL
+  };
+
+  const char** p;
+
+  for (p = docs; *p; p++)
+  {
+    CapeUdc u1 = cape_json_from_s (*p);
+    CapeUdc u2 = cape_json_from_buf_lazy (*p, strlen (*p));
+
+    if (u1 == NULL || u2 == NULL)
+    {
+      printf ("can't parse: %s\n", *p);
+      res = 1;
+    }
+    else
+    {
+      CapeString s1 = cape_json_to_s (u1);
+      CapeString s2 = cape_json_to_s (u2);
+
+      if (strcmp (s1, s2))
+      {
+        printf ("different result:\n  %s\n  %s\n", s1, s2);
+        res = 1;
+      }
+
+      cape_str_del (&s1);
+      cape_str_del (&s2);
+    }
+
+    cape_udc_del (&u1);
+    cape_udc_del (&u2);
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_errors (void)
+{
+  int res = 0;
+
+  const char* wrong[] =
+  {
+    "", "  ", "1", "\"text\"", "true", "{", "[", "{\"a\" 1}", "{\"a\":}", "{\"a\":1,}", "[1,]", "[1 2]", "{}x", "{}{}",
+    "[tru]", "[nulls]", "{\"a\":\"x}", "[}", "{]", "{1:2}", "[1]]", "[\"a\\\"]", "{\"a\":1 \"b\":2}", NULL
+  };
+
+  const char** p;
+
+  for (p = wrong; *p; p++)
+  {
+    CapeUdc u = cape_json_from_buf_lazy (*p, strlen (*p));
+
+    if (u)
+    {
+      printf ("wrong json accepted: %s\n", *p);
+      cape_udc_del (&u);
+      res = 1;
+    }
+  }
+
+  // only the given size is used
+  {
+    CapeUdc u = cape_json_from_buf_lazy ("{\"a\":1}garbage", 7);
+
+    if (u == NULL || cape_udc_get_n (u, "a", 0) != 1)
+    {
+      res = 1;
+    }
+
+    cape_udc_del (&u);
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+// the normal functions work on the lazy nodes
+static int ut_access (void)
+{
+  int res = 0;
+
+  const char* json = "{\"id\":\"4711\",\"version\":3,\"price\":9.5,\"exp\":1.5e3,\"active\":true,\"ts\":\"2020-02-29T23:59:59.419Z\","
+                     "\"user\":{\"name\":\"admin\",\"roles\":[\"read\",\"write\",\"root\"]},\"items\":[{\"sku\":\"A1\"},{\"sku\":\"B2\"}]}";
+
+  CapeUdc u = cape_json_from_buf_lazy (json, strlen (json));
+  CapeUdc h;
+
+  if (u == NULL)
+  {
+    return 1;
+  }
+
+  if (strcmp (cape_udc_get_s (u, "id", ""), "4711") || cape_udc_get_n (u, "version", 0) != 3 || cape_udc_get_f (u, "price", 0) != 9.5 || cape_udc_get_f (u, "exp", 0) != 1500 || !cape_udc_get_b (u, "active", FALSE))
+  {
+    printf ("wrong values\n");
+    res = 1;
+  }
+
+  {
+    const CapeDatetime* dt = cape_udc_get_d (u, "ts", NULL);
+
+    if (dt == NULL || dt->year != 2020 || dt->month != 2 || dt->day != 29 || dt->msec != 419)
+    {
+      printf ("wrong datetime\n");
+      res = 1;
+    }
+  }
+
+  if (strcmp (cape_udc_get_s (cape_udc_get_node (u, "user"), "name", ""), "admin") || cape_udc_size (cape_udc_get_list (cape_udc_get_node (u, "user"), "roles")) != 3)
+  {
+    printf ("wrong user\n");
+    res = 1;
+  }
+
+  if (strcmp (cape_udc_s (cape_udc_get_at (cape_udc_get_list (cape_udc_get_node (u, "user"), "roles"), -1), ""), "root"))
+  {
+    printf ("wrong position\n");
+    res = 1;
+  }
+
+  // cursors load the list
+  {
+    number_t cnt = 0;
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get_list (u, "items"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      cnt += strlen (cape_udc_get_s (cursor->item, "sku", ""));
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    if (cnt != 4)
+    {
+      printf ("wrong cursor\n");
+      res = 1;
+    }
+  }
+
+  // changes of the document
+  h = cape_udc_get_node (u, "user");
+
+  cape_udc_add_s_cp (h, "email", "admin@example.com");
+  cape_udc_add_n (cape_udc_get_list (h, "roles"), NULL, 42);
+
+  if (strcmp (cape_udc_get_s (h, "email", ""), "admin@example.com") || cape_udc_size (cape_udc_get_list (h, "roles")) != 4)
+  {
+    printf ("wrong change\n");
+    res = 1;
+  }
+
+  // copies and extracted nodes are normal udcs
+  {
+    CapeUdc c = cape_udc_cp (u);
+    CapeUdc items = cape_udc_ext_list (u, "items");
+    CapeString s1;
+    CapeString s2;
+
+    cape_udc_add_n (c, "extra", 1);
+
+    if (cape_udc_get (u, "items") || cape_udc_get (u, "extra") || cape_udc_size (items) != 2 || strcmp (cape_udc_get_s (cape_udc_get_first (items), "sku", ""), "A1"))
+    {
+      printf ("wrong copies\n");
+      res = 1;
+    }
+
+    cape_udc_del (&items);
+
+    s1 = cape_json_to_s (cape_udc_get_node (c, "user"));
+    s2 = cape_json_to_s (cape_udc_get_node (u, "user"));
+
+    if (strcmp (s1, s2))
+    {
+      res = 1;
+    }
+
+    cape_str_del (&s1);
+    cape_str_del (&s2);
+    cape_udc_del (&c);
+  }
+
+  cape_udc_del (&u);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeString ut_payload (void)
+{
+  number_t i;
+  CapeString ret;
+
+  CapeUdc root = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc header = cape_udc_add_node (root, "header");
+  CapeUdc items = cape_udc_add_list (root, "items");
+
+  cape_udc_add_s_cp (header, "id", "4711");
+  cape_udc_add_s_cp (header, "type", "order");
+  cape_udc_add_s_cp (header, "user", "admin");
+  cape_udc_add_n (header, "version", 3);
+
+  for (i = 0; i < UT_OBJECTS; i++)
+  {
+    CapeUdc h = cape_udc_add_node (items, NULL);
+    CapeUdc a = cape_udc_add_list (h, "values");
+
+    cape_udc_add_n (h, "id", i);
+    cape_udc_add_s_cp (h, "name", "some name of an \"object\"");
+    cape_udc_add_s_cp (h, "type", "order");
+    cape_udc_add_f (h, "price", i * 0.25 + 0.1);
+    cape_udc_add_b (h, "active", i % 2);
+
+    cape_udc_add_n (a, NULL, 1);
+    cape_udc_add_f (a, NULL, 2.5);
+  }
+
+  cape_udc_add_n (root, "ts", 1700000000);
+
+  ret = cape_json_to_s (root);
+
+  cape_udc_del (&root);
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+// reads a few fields like a handler does
+static number_t ut_handler (CapeUdc msg)
+{
+  number_t sum = 0;
+  CapeUdc header = cape_udc_get_node (msg, "header");
+
+  sum += strlen (cape_udc_get_s (header, "id", ""));
+  sum += strlen (cape_udc_get_s (header, "type", ""));
+  sum += strlen (cape_udc_get_s (header, "user", ""));
+  sum += cape_udc_get_n (header, "version", 0);
+  sum += cape_udc_get_n (msg, "ts", 0);
+
+  return sum;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_benchmark (void)
+{
+  int res = 0;
+  number_t i, sum1 = 0, sum2 = 0, sum3 = 0;
+  double t1, t2, t3;
+
+  CapeString json = ut_payload ();
+  number_t size = cape_str_size (json);
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeUdc u = cape_json_from_buf (json, size);
+
+    sum1 += ut_handler (u);
+
+    cape_udc_del (&u);
+  }
+
+  cape_stoptimer_stop (st);
+
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeUdc u = cape_json_from_buf_doc (json, size);
+
+    sum2 += ut_handler (u);
+
+    cape_udc_del (&u);
+  }
+
+  cape_stoptimer_stop (st);
+
+  t2 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeUdc u = cape_json_from_buf_lazy (json, size);
+
+    sum3 += ut_handler (u);
+
+    cape_udc_del (&u);
+  }
+
+  cape_stoptimer_stop (st);
+
+  t3 = cape_stoptimer_get (st);
+
+  printf ("%li bytes, 5 fields : parser %.2f ms, document %.2f ms, lazy %.2f ms\n", size, t1 / UT_LOOPS, t2 / UT_LOOPS, t3 / UT_LOOPS);
+
+  if (sum1 != sum2 || sum1 != sum3)
+  {
+    printf ("wrong sum: %li, %li, %li\n", sum1, sum2, sum3);
+    res = 1;
+  }
+
+  // only the used nodes are created
+  {
+    CapeUdc u = cape_json_from_buf_lazy (json, size);
+    number_t used1, used2;
+    CapeString h;
+
+    ut_handler (u);
+
+    used1 = cape_arena_used (cape_udc_arena (u));
+
+    // walks through all nodes
+    h = cape_json_to_s (u);
+
+    used2 = cape_arena_used (cape_udc_arena (u));
+
+    printf ("arena  : %li bytes after 5 fields, %li bytes after all\n", used1, used2);
+
+    if (strcmp (h, json) || used1 - size > used2 / 4)
+    {
+      printf ("wrong lazy document\n");
+      res = 1;
+    }
+
+    cape_str_del (&h);
+    cape_udc_del (&u);
+  }
+
+  cape_str_del (&json);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_same ())
+  {
+    printf ("compare test failed\n");
+    res = 1;
+  }
+
+  if (ut_errors ())
+  {
+    printf ("error test failed\n");
+    res = 1;
+  }
+
+  if (ut_access ())
+  {
+    printf ("access test failed\n");
+    res = 1;
+  }
+
+  if (ut_benchmark ())
+  {
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,521 @@
+#include "fmt/cape_msgpack.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_OBJECTS   100000
+
+//-----------------------------------------------------------------------------
+
+static int ut_equal (CapeUdc a, CapeUdc b)
+{
+  if (a == NULL || b == NULL || cape_udc_type (a) != cape_udc_type (b) || cape_udc_size (a) != cape_udc_size (b))
+  {
+    return FALSE;
+  }
+
+  switch (cape_udc_type (a))
+  {
+    case CAPE_UDC_NODE:
+    case CAPE_UDC_LIST:
+    {
+      int ret = TRUE;
+      CapeUdcCursor* c1 = cape_udc_cursor_new (a, CAPE_DIRECTION_FORW);
+      CapeUdcCursor* c2 = cape_udc_cursor_new (b, CAPE_DIRECTION_FORW);
+
+      while (ret && cape_udc_cursor_next (c1))
+      {
+        ret = cape_udc_cursor_next (c2) && ut_equal (c1->item, c2->item);
+
+        // the order of the nodes is kept
+        if (ret && cape_udc_type (a) == CAPE_UDC_NODE)
+        {
+          ret = strcmp (cape_udc_name (c1->item), cape_udc_name (c2->item)) == 0;
+        }
+      }
+
+      cape_udc_cursor_del (&c1);
+      cape_udc_cursor_del (&c2);
+
+      return ret;
+    }
+    case CAPE_UDC_STRING:
+    {
+      return strcmp (cape_udc_s (a, ""), cape_udc_s (b, "")) == 0;
+    }
+    case CAPE_UDC_NUMBER:
+    {
+      return cape_udc_n (a, 0) == cape_udc_n (b, 0);
+    }
+    case CAPE_UDC_FLOAT:
+    {
+      return cape_udc_f (a, 0) == cape_udc_f (b, 0);
+    }
+    case CAPE_UDC_BOOL:
+    {
+      return cape_udc_b (a, FALSE) == cape_udc_b (b, FALSE);
+    }
+    case CAPE_UDC_DATETIME:
+    {
+      const CapeDatetime* d1 = cape_udc_d (a, NULL);
+      const CapeDatetime* d2 = cape_udc_d (b, NULL);
+
+      return d1->year == d2->year && d1->month == d2->month && d1->day == d2->day && d1->hour == d2->hour && d1->minute == d2->minute && d1->sec == d2->sec && d1->msec == d2->msec && d1->usec == d2->usec;
+    }
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_add_d (CapeUdc list, unsigned int year, unsigned int month, unsigned int day, unsigned int sec, unsigned int msec, unsigned int usec)
+{
+  CapeDatetime dt;
+
+  memset (&dt, 0, sizeof(dt));
+
+  dt.year = year;
+  dt.month = month;
+  dt.day = day;
+  dt.hour = 23;
+  dt.minute = 59;
+  dt.sec = sec;
+  dt.msec = msec;
+  dt.usec = usec;
+
+  cape_udc_add_d (list, NULL, &dt);
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc ut_all_types (void)
+{
+  number_t i;
+  CapeUdc root = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc numbers = cape_udc_add_list (root, "numbers");
+  CapeUdc dates = cape_udc_add_list (root, "dates");
+  CapeUdc node = cape_udc_add_node (root, "node");
+  CapeUdc large = cape_udc_add_list (root, "large");
+
+  number_t values[] = {0, 1, 127, 128, 255, 256, 65535, 65536, 4294967295L, 4294967296L, 9223372036854775807L,
+                       -1, -32, -33, -128, -129, -32768, -32769, -2147483647L - 1, -2147483647L - 2, -9223372036854775807L - 1};
+
+  for (i = 0; i < (number_t)(sizeof(values) / sizeof(number_t)); i++)
+  {
+    cape_udc_add_n (numbers, NULL, values[i]);
+  }
+
+  cape_udc_add_s_cp (root, "empty", "");
+  cape_udc_add_s_cp (root, "text", "some text with \"quotes\" and \xc3\xa4");
+  cape_udc_add_f (root, "pi", 3.141592653589793);
+  cape_udc_add_f (root, "tiny", -1.5e-300);
+  cape_udc_add_b (root, "yes", TRUE);
+  cape_udc_add_b (root, "no", FALSE);
+  cape_udc_add_z (root, "none");
+
+  // 32, 64 and 96 bit timestamps
+  ut_add_d (dates, 2020, 2, 29, 59, 0, 0);
+  ut_add_d (dates, 2020, 2, 29, 59, 419, 0);
+  ut_add_d (dates, 2020, 2, 29, 59, 419, 419123);
+  ut_add_d (dates, 1960, 1, 1, 0, 0, 0);
+  ut_add_d (dates, 2600, 12, 31, 1, 5, 0);
+
+  // sizes of the formats
+  {
+    char buf[70000];
+
+    memset (buf, 'x', sizeof(buf));
+
+    for (i = 0; i < 40; i++)
+    {
+      CapeString h = cape_str_fmt ("key_%li", i);
+
+      buf[i * 7] = 0;
+      cape_udc_add_s_cp (node, h, buf);
+      buf[i * 7] = 'x';
+
+      cape_str_del (&h);
+    }
+
+    buf[300] = 0;
+    cape_udc_add_s_cp (node, "str16", buf);
+    buf[300] = 'x';
+
+    buf[69999] = 0;
+    cape_udc_add_s_cp (node, "str32", buf);
+  }
+
+  for (i = 0; i < 70000; i++)
+  {
+    cape_udc_add_n (large, NULL, i % 300);
+  }
+
+  cape_udc_add_list (root, "empty_list");
+  cape_udc_add_node (root, "empty_node");
+
+  return root;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_round_trip (void)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+
+  CapeUdc u1 = ut_all_types ();
+  CapeStream s = cape_msgpack_to_stream (u1);
+  CapeUdc u2 = cape_msgpack_from_buf (cape_stream_data (s), cape_stream_size (s), err);
+
+  if (u2 == NULL || !ut_equal (u1, u2))
+  {
+    printf ("round trip failed: %s\n", cape_err_text (err));
+    res = 1;
+  }
+
+  // the same bytes again
+  if (u2)
+  {
+    CapeStream h = cape_msgpack_to_stream (u2);
+
+    if (cape_stream_size (h) != cape_stream_size (s) || memcmp (cape_stream_data (h), cape_stream_data (s), cape_stream_size (s)))
+    {
+      printf ("different encoding\n");
+      res = 1;
+    }
+
+    cape_stream_del (&h);
+  }
+
+  cape_udc_del (&u1);
+  cape_udc_del (&u2);
+  cape_stream_del (&s);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+// bytes written by other implementations
+static int ut_compatibility (void)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+
+  CapeUdc u;
+  CapeStream s;
+
+  // {"a":1,"b":[true,-1,1.5]}
+  const char e1[] = "\x82\xa1" "a" "\x01\xa1" "b" "\x93\xc3\xff\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00";
+
+  // float 32, uint 64, bin 8, integer key, timestamp 32 of 2020-01-01
+  const char e2[] = "\x85\xa1" "f" "\xca\x3f\xc0\x00\x00\xa1" "u" "\xcf\x00\x00\x00\x00\x00\x00\x01\x00\xa1" "b" "\xc4\x02" "ok" "\x07\x08\xa1" "d" "\xd6\xff\x5e\x0b\xe1\x00";
+
+  u = cape_json_from_s ("{\"a\":1,\"b\":[true,-1,1.5]}");
+  s = cape_msgpack_to_stream (u);
+
+  if (cape_stream_size (s) != sizeof(e1) - 1 || memcmp (cape_stream_data (s), e1, sizeof(e1) - 1))
+  {
+    printf ("wrong encoding\n");
+    res = 1;
+  }
+
+  cape_stream_del (&s);
+  cape_udc_del (&u);
+
+  u = cape_msgpack_from_buf (e2, sizeof(e2) - 1, err);
+
+  if (u == NULL || cape_udc_get_f (u, "f", 0) != 1.5 || cape_udc_get_n (u, "u", 0) != 256 || strcmp (cape_udc_get_s (u, "b", ""), "ok") || cape_udc_get_n (u, "7", 0) != 8)
+  {
+    printf ("wrong decoding: %s\n", cape_err_text (err));
+    res = 1;
+  }
+  else
+  {
+    const CapeDatetime* dt = cape_udc_get_d (u, "d", NULL);
+
+    if (dt == NULL || dt->year != 2020 || dt->month != 1 || dt->day != 1 || dt->hour || dt->sec)
+    {
+      printf ("wrong timestamp\n");
+      res = 1;
+    }
+  }
+
+  cape_udc_del (&u);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_errors (void)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+
+  const char* wrong[] = {"\x82\xa1" "a" "\x01", "\xd9\x05" "abc", "\xc1", "\xd4\x05\x00", "\x81\xc3\x01", "\xcd\x01", "\x01\x02", "\xc7\x05\xff\x00\x00\x00\x00\x00", NULL};
+  number_t sizes[] = {4, 5, 1, 3, 3, 2, 2, 8};
+  number_t i;
+
+  for (i = 0; wrong[i]; i++)
+  {
+    CapeUdc u = cape_msgpack_from_buf (wrong[i], sizes[i], err);
+
+    if (u || cape_err_code (err) != CAPE_ERR_PARSER)
+    {
+      printf ("wrong data accepted: %li\n", i);
+      res = 1;
+    }
+
+    cape_udc_del (&u);
+  }
+
+  // deeply nested arrays
+  {
+    char buf[2000];
+    CapeUdc u;
+
+    memset (buf, 0x91, sizeof(buf));
+    buf[sizeof(buf) - 1] = 0x01;
+
+    u = cape_msgpack_from_buf (buf, sizeof(buf), err);
+
+    if (u)
+    {
+      printf ("too deep\n");
+      res = 1;
+    }
+  }
+
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+// the reader returns the strings inside of the buffer
+static int ut_reader (void)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+  CapeStream s = cape_stream_new ();
+  CapeCursor cursor = cape_cursor_new ();
+  CapeMsgpackItem item;
+  number_t i, found = 0;
+
+  // several messages after each other
+  for (i = 0; i < 10; i++)
+  {
+    cape_msgpack_append_map (s, 2);
+    cape_msgpack_append_s (s, "id", 2);
+    cape_msgpack_append_n (s, i);
+    cape_msgpack_append_s (s, "name", 4);
+    cape_msgpack_append_s (s, "hello world", 11);
+  }
+
+  cape_cursor_set (cursor, cape_stream_data (s), cape_stream_size (s));
+
+  while (cape_cursor_tail (cursor))
+  {
+    if (cape_msgpack_next (cursor, &item, err))
+    {
+      res = 1;
+      break;
+    }
+
+    if (item.type == CAPE_UDC_STRING && item.size == 11)
+    {
+      if (item.s < cape_stream_data (s) || item.s >= cape_stream_data (s) + cape_stream_size (s) || strncmp (item.s, "hello world", 11))
+      {
+        res = 1;
+      }
+
+      found++;
+    }
+  }
+
+  if (found != 10)
+  {
+    res = 1;
+  }
+
+  // and as udcs
+  cape_cursor_set (cursor, cape_stream_data (s), cape_stream_size (s));
+
+  for (i = 0; i < 10; i++)
+  {
+    CapeUdc u = cape_msgpack_from_cursor (cursor, err);
+
+    if (cape_udc_get_n (u, "id", -1) != i)
+    {
+      res = 1;
+    }
+
+    cape_udc_del (&u);
+  }
+
+  if (cape_cursor_tail (cursor) || cape_msgpack_next (cursor, &item, err) == CAPE_ERR_NONE)
+  {
+    res = 1;
+  }
+
+  cape_cursor_del (&cursor);
+  cape_stream_del (&s);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeUdc ut_document (void)
+{
+  number_t i;
+  CapeUdc list = cape_udc_new (CAPE_UDC_LIST, NULL);
+
+  for (i = 0; i < UT_OBJECTS; i++)
+  {
+    CapeUdc h = cape_udc_add_node (list, NULL);
+    CapeUdc a = cape_udc_add_list (h, "values");
+
+    cape_udc_add_n (h, "id", i);
+    cape_udc_add_s_cp (h, "name", "some name of an object");
+    cape_udc_add_s_cp (h, "type", "order");
+    cape_udc_add_f (h, "price", i * 0.25 + 0.1);
+    cape_udc_add_b (h, "active", i % 2);
+    cape_udc_add_n (h, "count", i * 1000);
+
+    cape_udc_add_n (a, NULL, 1);
+    cape_udc_add_f (a, NULL, 2.5);
+    cape_udc_add_z (a, NULL);
+  }
+
+  return list;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_benchmark (void)
+{
+  int res = 0;
+  double t1, t2, t3;
+  CapeErr err = cape_err_new ();
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeUdc u = ut_document ();
+  CapeString json;
+  CapeStream mp;
+  CapeUdc u1, u2;
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+  json = cape_json_to_s (u);
+  cape_stoptimer_stop (st);
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+  mp = cape_msgpack_to_stream (u);
+  cape_stoptimer_stop (st);
+  t2 = cape_stoptimer_get (st);
+
+  printf ("size   : json %li bytes, msgpack %li bytes\n", cape_str_size (json), cape_stream_size (mp));
+  printf ("encode : json %.2f ms, msgpack %.2f ms\n", t1, t2);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+  u1 = cape_json_from_s (json);
+  cape_stoptimer_stop (st);
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+  u2 = cape_msgpack_from_buf (cape_stream_data (mp), cape_stream_size (mp), err);
+  cape_stoptimer_stop (st);
+  t2 = cape_stoptimer_get (st);
+
+  // reading all values without creating udcs
+  {
+    CapeCursor cursor = cape_cursor_new ();
+    CapeMsgpackItem item;
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_cursor_set (cursor, cape_stream_data (mp), cape_stream_size (mp));
+
+    while (cape_cursor_tail (cursor) && cape_msgpack_next (cursor, &item, err) == CAPE_ERR_NONE);
+
+    cape_stoptimer_stop (st);
+    t3 = cape_stoptimer_get (st);
+
+    cape_cursor_del (&cursor);
+  }
+
+  printf ("decode : json %.2f ms, msgpack %.2f ms, reader %.2f ms\n", t1, t2, t3);
+
+  if (!ut_equal (u, u2) || cape_udc_size (u1) != UT_OBJECTS)
+  {
+    printf ("wrong document\n");
+    res = 1;
+  }
+
+  cape_udc_del (&u);
+  cape_udc_del (&u1);
+  cape_udc_del (&u2);
+  cape_str_del (&json);
+  cape_stream_del (&mp);
+  cape_err_del (&err);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_round_trip ())
+  {
+    printf ("round trip test failed\n");
+    res = 1;
+  }
+
+  if (ut_compatibility ())
+  {
+    printf ("compatibility test failed\n");
+    res = 1;
+  }
+
+  if (ut_errors ())
+  {
+    printf ("error test failed\n");
+    res = 1;
+  }
+
+  if (ut_reader ())
+  {
+    printf ("reader test failed\n");
+    res = 1;
+  }
+
+  if (ut_benchmark ())
+  {
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
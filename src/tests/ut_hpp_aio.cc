@@ -0,0 +1,177 @@
+#include "hpp/cape_aio.hpp"
+#include "sys/cape_log.h"
+
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef CAPE_HPP_COROUTINES
+
+//-----------------------------------------------------------------------------
+
+static int g_done = 0;
+static int g_failed = 0;
+
+//-----------------------------------------------------------------------------
+
+cape::AioTask session (CapeAioTask task, CapeQueue queue)
+{
+  while (true)
+  {
+    std::string_view data = co_await cape::aio_recv (task);
+    
+    if (data.empty())
+    {
+      break;
+    }
+    
+    std::string msg (data);
+    
+    // compute on a worker thread
+    std::string res = co_await cape::aio_offload (task, queue, [&msg]() { return std::string (msg.rbegin(), msg.rend()); });
+    
+    co_await cape::aio_sleep (task, 1);
+    
+    co_await cape::aio_send (task, res.data(), res.size());
+  }
+  
+  g_done++;
+}
+
+//-----------------------------------------------------------------------------
+
+static int g_aborted = 0;
+
+cape::AioTask aborted (CapeAioTask task, CapeQueue queue)
+{
+  try
+  {
+    // the queue is deleted before the function runs
+    co_await cape::aio_offload (task, queue, []() { return 42; });
+    
+    std::cout << "offload of a deleted queue returned a value" << std::endl;
+  }
+  catch (cape::Exception& e)
+  {
+    if (e.code () == CAPE_ERR_PROCESS_ABORT)
+    {
+      g_aborted++;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  CapeErr err = cape_err_new ();
+  
+  CapeAioContext aio = cape_aio_context_new ();
+  
+  CapeQueue queue = cape_queue_new ();
+  
+  int fds[2];
+  
+  cape_aio_context_open (aio, err);
+  
+  cape_queue_start (queue, 1, err);
+  
+  socketpair (AF_UNIX, SOCK_STREAM, 0, fds);
+  
+  {
+    CapeAioTask task = cape_aio_task_new (aio, NULL, NULL, NULL);
+    
+    cape_aio_task_attach (task, cape_aio_socket_new ((void*)(number_t)fds[0]));
+    
+    session (task, queue);
+  }
+  
+  // the client side
+  {
+    const char* messages[] = {"hello", "coroutine", "world"};
+    
+    for (int i = 0; i < 3; i++)
+    {
+      char buf[64];
+      ssize_t n;
+      
+      write (fds[1], messages[i], strlen (messages[i]));
+      
+      // drive the reactor until the answer arrived
+      while (true)
+      {
+        cape_aio_context_next (aio, 10, err);
+        
+        n = recv (fds[1], buf, 64, MSG_DONTWAIT);
+        
+        if (n > 0)
+        {
+          break;
+        }
+      }
+      
+      std::string expected (messages[i]);
+      
+      if (std::string (buf, n) != std::string (expected.rbegin(), expected.rend()))
+      {
+        std::cout << "wrong answer: " << std::string (buf, n) << std::endl;
+        g_failed++;
+      }
+    }
+    
+    close (fds[1]);
+    
+    while (g_done == 0)
+    {
+      cape_aio_context_next (aio, 10, err);
+    }
+    
+    // let the reactor release the task
+    cape_aio_context_next (aio, 10, err);
+  }
+  
+  cape_queue_del (&queue);
+  
+  // an aborted offload throws
+  {
+    CapeQueue stopped = cape_queue_new ();
+    
+    aborted (cape_aio_task_new (aio, NULL, NULL, NULL), stopped);
+    
+    // the reactor starts the task
+    cape_aio_context_next (aio, 10, err);
+    
+    // pending tasks are done without running them
+    cape_queue_del (&stopped);
+    
+    for (int i = 0; i < 100 && g_aborted == 0; i++)
+    {
+      cape_aio_context_next (aio, 10, err);
+    }
+    
+    if (g_aborted == 0)
+    {
+      std::cout << "aborted offload didn't throw" << std::endl;
+      g_failed++;
+    }
+  }
+  
+  cape_aio_context_del (&aio);
+  
+  cape_err_del (&err);
+  
+  return g_failed;
+}
+
+//-----------------------------------------------------------------------------
+
+#else
+
+int main (int argc, char *argv[])
+{
+  return 0;
+}
+
+#endif
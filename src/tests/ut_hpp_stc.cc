@@ -104,6 +104,42 @@ int main (int argc, char *argv[])
   
   
   
+  // copies don't see the changes of each other
+  {
+    cape::Udc copy01 (val01);
+    
+    copy01.add ("col06", 42);
+    copy01.ext ("col01");
+    
+    cape::Udc copy02 (copy01);
+    
+    copy02.add ("col07", 43);
+    
+    if (val01.size () != 5 || copy01.size () != 5 || copy02.size () != 6 || val01["col01"].as ("") != std::string ("hello") || copy02["col06"].as (0) != 42)
+    {
+      cape_log_msg (CAPE_LL_ERROR, "UT", "hpp stc", "copy on write");
+      return 1;
+    }
+  }
+  
+  // copies of a frozen udc share the children
+  {
+    cape::Udc frozen (val01);
+    
+    frozen.freeze ();
+    
+    cape::Udc copy01 (frozen);
+    
+    copy01.add ("col06", 42);
+    copy01.ext ("col01");
+    
+    if (frozen.size () != 5 || copy01.size () != 5 || frozen["col01"].as ("") != std::string ("hello") || copy01["col06"].as (0) != 42)
+    {
+      cape_log_msg (CAPE_LL_ERROR, "UT", "hpp stc", "copy of frozen udc");
+      return 1;
+    }
+  }
+  
   h1.add (val01);
  
   // use the << operator
@@ -116,5 +152,21 @@ int main (int argc, char *argv[])
   
   
   std::cout << "S:'" << stream1 << "'" << std::endl;
+  
+  cape::Map<const char*, cape::Stream> map1;
+  
+  map1.insert ("stream1", &stream1);
+  
+  cape::Map<number_t, cape::Stream> map2;
+  
+  map2.insert (42, &stream1);
+  
+  if (map1.find ("stream1") != &stream1 || map1.find ("stream2") || map2.find (42) != &stream1 || map2.size () != 1)
+  {
+    cape_log_msg (CAPE_LL_ERROR, "UT", "hpp stc", "map");
+    return 1;
+  }
+  
+  return 0;
 }
 
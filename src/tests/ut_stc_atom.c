@@ -0,0 +1,363 @@
+#include "stc/cape_atom.h"
+#include "stc/cape_udc.h"
+#include "stc/cape_stream.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_OBJECTS   100000
+#define UT_KEYS      20
+
+//-----------------------------------------------------------------------------
+
+static int ut_atoms (void)
+{
+  CapeAtoms atoms = cape_atoms_new ();
+  CapeString h = cape_str_cp ("a_key");
+
+  const char* a1 = cape_atoms_get (atoms, "a_key");
+  const char* a2 = cape_atoms_get (atoms, h);
+  const char* a3 = cape_atoms_get (atoms, "b_key");
+  const char* g1 = cape_atoms_get (NULL, "a_key");
+
+  if (a1 != a2 || a1 == a3 || a1 == g1 || strcmp (a1, "a_key") || strcmp (g1, "a_key") || cape_atom_size (a3) != 5)
+  {
+    return 1;
+  }
+
+  if (cape_atoms_size (atoms) != 2 || cape_atoms_get (atoms, NULL))
+  {
+    return 1;
+  }
+
+  // the atom survives the table
+  a1 = cape_atom_cp (a1);
+
+  cape_atoms_del (&atoms);
+
+  if (strcmp (a1, "a_key"))
+  {
+    return 1;
+  }
+
+  cape_atom_del (&a1);
+
+  if (a1)
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_udc (int intern)
+{
+  int res = 0;
+
+  CapeUdc n, c, h;
+
+  cape_udc_intern (intern);
+
+  n = cape_udc_new (CAPE_UDC_NODE, "root");
+
+  cape_udc_add_s_cp (n, "name", "text");
+  cape_udc_add_n (n, "id", 42);
+
+  h = cape_udc_new (CAPE_UDC_LIST, NULL);
+  cape_udc_add_name (n, &h, "items");
+
+  h = cape_udc_get (n, "items");
+  cape_udc_add_n (h, NULL, 1);
+
+  c = cape_udc_cp (n);
+
+  cape_udc_del (&n);
+
+  if (strcmp (cape_udc_name (c), "root") || cape_udc_get_n (c, "id", 0) != 42 || strcmp (cape_udc_get_s (c, "name", ""), "text") || cape_udc_size (cape_udc_get (c, "items")) != 1)
+  {
+    res = 1;
+  }
+
+  // names are shared between the copies
+  if (intern)
+  {
+    CapeUdc d = cape_udc_cp (c);
+
+    if (cape_udc_name (d) != cape_udc_name (c) || cape_udc_name (d) != cape_atoms_get (NULL, "root"))
+    {
+      res = 1;
+    }
+
+    cape_udc_del (&d);
+  }
+
+  cape_udc_del (&c);
+
+  cape_udc_intern (FALSE);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+// names of released udcs don't stay in the global table
+static int ut_global (void)
+{
+  int res = 0;
+  number_t i;
+
+  number_t size = cape_atoms_size (NULL);
+
+  cape_udc_intern (TRUE);
+
+  for (i = 0; i < 1000; i++)
+  {
+    CapeString h = cape_str_fmt ("{\"unique_%li\":{\"unique_%li\":%li}}", i, i + 1, i);
+    CapeUdc u = cape_json_from_s (h);
+
+    if (u == NULL || cape_udc_size (u) != 1 || cape_udc_size (cape_udc_get_first (u)) != 1)
+    {
+      res = 1;
+    }
+
+    cape_udc_del (&u);
+    cape_str_del (&h);
+  }
+
+  cape_udc_intern (FALSE);
+
+  if (cape_atoms_size (NULL) != size)
+  {
+    printf ("global table grows: %li -> %li\n", size, cape_atoms_size (NULL));
+    res = 1;
+  }
+
+  // atoms of cape_atoms_get are kept
+  {
+    const char* a1 = cape_atoms_cp (NULL, "kept_key");
+    const char* a2 = cape_atoms_get (NULL, "kept_key");
+
+    cape_atom_del (&a1);
+
+    if (a2 != cape_atoms_get (NULL, "kept_key") || strcmp (a2, "kept_key") || cape_atoms_size (NULL) != size + 1)
+    {
+      res = 1;
+    }
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeString ut_document (void)
+{
+  CapeStream s = cape_stream_new ();
+  number_t i, j;
+
+  cape_stream_append_c (s, '[');
+
+  for (i = 0; i < UT_OBJECTS; i++)
+  {
+    cape_stream_append_str (s, i ? ",{" : "{");
+
+    for (j = 0; j < UT_KEYS; j++)
+    {
+      cape_stream_append_str (s, j ? ",\"field_" : "\"field_");
+      cape_stream_append_n (s, j);
+      cape_stream_append_str (s, "\":");
+      cape_stream_append_n (s, i + j);
+    }
+
+    cape_stream_append_c (s, '}');
+  }
+
+  cape_stream_append_c (s, ']');
+
+  return cape_stream_to_str (&s);
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t ut_lookup (CapeUdc list, const char** keys)
+{
+  CapeUdcCursor* cursor = cape_udc_cursor_new (list, CAPE_DIRECTION_FORW);
+  number_t sum = 0;
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    number_t j;
+
+    for (j = 0; j < UT_KEYS; j++)
+    {
+      sum += cape_udc_get_n (cursor->item, keys[j], 0);
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+
+  return sum;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_json (void)
+{
+  int res = 0;
+  number_t j, sum1, sum2;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeString doc = ut_document ();
+  CapeAtoms atoms = cape_atoms_new ();
+
+  CapeUdc u1, u2;
+
+  CapeString keys[UT_KEYS];
+  const char* atom_keys[UT_KEYS];
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  u1 = cape_json_from_s (doc);
+
+  cape_stoptimer_stop (st);
+
+  printf ("parse   : copies %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  u2 = cape_json_from_buf_ex (doc, cape_str_size (doc), atoms);
+
+  cape_stoptimer_stop (st);
+
+  printf (", atoms %.2f ms\n", cape_stoptimer_get (st));
+
+  if (u1 == NULL || u2 == NULL || cape_atoms_size (atoms) != UT_KEYS || cape_udc_size (u2) != UT_OBJECTS)
+  {
+    printf ("wrong document\n");
+    return 1;
+  }
+
+  for (j = 0; j < UT_KEYS; j++)
+  {
+    keys[j] = cape_str_fmt ("field_%li", j);
+    atom_keys[j] = cape_atoms_get (atoms, keys[j]);
+  }
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  sum1 = ut_lookup (u1, (const char**)keys);
+
+  cape_stoptimer_stop (st);
+
+  printf ("lookup  : copies %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  sum2 = ut_lookup (u2, atom_keys);
+
+  cape_stoptimer_stop (st);
+
+  printf (", atoms %.2f ms\n", cape_stoptimer_get (st));
+
+  if (sum1 != sum2 || sum1 != ut_lookup (u2, (const char**)keys))
+  {
+    printf ("wrong lookup\n");
+    res = 1;
+  }
+
+  // both documents serialize the same
+  {
+    CapeString h1 = cape_json_to_s (u1);
+    CapeString h2 = cape_json_to_s (u2);
+
+    if (strcmp (h1, h2))
+    {
+      printf ("wrong json\n");
+      res = 1;
+    }
+
+    cape_str_del (&h1);
+    cape_str_del (&h2);
+  }
+
+  // the atoms are kept by the document
+  cape_atoms_del (&atoms);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  {
+    CapeUdc h = cape_udc_cp (u2);
+
+    cape_stoptimer_stop (st);
+
+    printf ("copy    : atoms %.2f ms\n", cape_stoptimer_get (st));
+
+    if (ut_lookup (h, (const char**)keys) != sum1)
+    {
+      res = 1;
+    }
+
+    cape_udc_del (&h);
+  }
+
+  for (j = 0; j < UT_KEYS; j++)
+  {
+    cape_str_del (&(keys[j]));
+  }
+
+  cape_udc_del (&u1);
+  cape_udc_del (&u2);
+
+  cape_str_del (&doc);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_atoms ())
+  {
+    printf ("atoms test failed\n");
+    res = 1;
+  }
+
+  if (ut_udc (FALSE) || ut_udc (TRUE))
+  {
+    printf ("udc test failed\n");
+    res = 1;
+  }
+
+  if (ut_global ())
+  {
+    printf ("global table test failed\n");
+    res = 1;
+  }
+
+  if (ut_json ())
+  {
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,336 @@
+#include "stc/cape_hashmap.h"
+#include "stc/cape_map.h"
+#include "stc/cape_str.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_KEYS      1000000
+
+//-----------------------------------------------------------------------------
+
+static number_t g_destroyed = 0;
+
+static void __STDCALL ut_on_del (void* key, void* val)
+{
+  g_destroyed++;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  CapeHashMap h = cape_hashmap_new (cape_hashmap__hash__n, cape_map__compare__n, ut_on_del, NULL);
+  CapeHashMapCursor cursor;
+  number_t i, count;
+
+  for (i = 0; i < 100000; i++)
+  {
+    cape_hashmap_insert (h, (void*)i, (void*)(i * 2));
+  }
+
+  if (cape_hashmap_size (h) != 100000)
+  {
+    return 1;
+  }
+
+  for (i = 0; i < 100000; i++)
+  {
+    CapeHashMapNode n = cape_hashmap_find (h, (void*)i);
+
+    if (n == NULL || cape_hashmap_node_value (n) != (void*)(i * 2))
+    {
+      printf ("can't find %li\n", i);
+      return 1;
+    }
+  }
+
+  if (cape_hashmap_find (h, (void*)100001))
+  {
+    return 1;
+  }
+
+  // erase all odd keys with a cursor
+  cape_hashmap_cursor_init (h, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_hashmap_cursor_next (&cursor))
+  {
+    if ((number_t)cape_hashmap_node_key (cursor.node) % 2)
+    {
+      cape_hashmap_cursor_erase (h, &cursor);
+    }
+  }
+
+  if (cape_hashmap_size (h) != 50000 || g_destroyed != 50000)
+  {
+    printf ("wrong size after erase: %li\n", cape_hashmap_size (h));
+    return 1;
+  }
+
+  // reuse the deleted slots
+  for (i = 1; i < 100000; i += 2)
+  {
+    cape_hashmap_insert (h, (void*)i, (void*)(i * 2));
+  }
+
+  for (i = 0; i < 100000; i++)
+  {
+    if (cape_hashmap_find (h, (void*)i) == NULL)
+    {
+      return 1;
+    }
+  }
+
+  // count backwards
+  count = 0;
+
+  cape_hashmap_cursor_init (h, &cursor, CAPE_DIRECTION_PREV);
+
+  while (cape_hashmap_cursor_prev (&cursor))
+  {
+    count++;
+  }
+
+  if (count != 100000)
+  {
+    return 1;
+  }
+
+  cape_hashmap_del (&h);
+
+  if (g_destroyed != 150000)
+  {
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_on_del_str (void* key, void* val)
+{
+  CapeString h = key;
+
+  cape_str_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_on_clone (void* key_original, void* val_original, void** key_clone, void** val_clone)
+{
+  *key_clone = cape_str_cp (key_original);
+  *val_clone = val_original;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_bench_strings (CapeString* keys)
+{
+  number_t i, found = 0;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  {
+    CapeMap m = cape_map_new (NULL, NULL, NULL);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      cape_map_insert (m, keys[i], (void*)i);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("string keys: CapeMap     insert %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      found += (cape_map_find (m, keys[i]) != NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", find %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_map_del (&m);
+  }
+
+  {
+    CapeHashMap h = cape_hashmap_new (NULL, NULL, NULL, NULL);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      cape_hashmap_insert (h, keys[i], (void*)i);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("string keys: CapeHashMap insert %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      found += (cape_hashmap_find (h, keys[i]) != NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", find %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_hashmap_del (&h);
+  }
+
+  cape_stoptimer_del (&st);
+
+  return found != 2 * UT_KEYS;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_bench_numbers (void)
+{
+  number_t i, found = 0;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  {
+    CapeMap m = cape_map_new (cape_map__compare__n, NULL, NULL);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      cape_map_insert (m, (void*)(i * 7919), (void*)i);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("number keys: CapeMap     insert %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      found += (cape_map_find (m, (void*)(i * 7919)) != NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", find %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_map_del (&m);
+  }
+
+  {
+    CapeHashMap h = cape_hashmap_new (cape_hashmap__hash__n, cape_map__compare__n, NULL, NULL);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      cape_hashmap_insert (h, (void*)(i * 7919), (void*)i);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("number keys: CapeHashMap insert %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      found += (cape_hashmap_find (h, (void*)(i * 7919)) != NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", find %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_hashmap_del (&h);
+  }
+
+  cape_stoptimer_del (&st);
+
+  return found != 2 * UT_KEYS;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i;
+
+  CapeString* keys = CAPE_ALLOC (UT_KEYS * sizeof(CapeString));
+
+  if (ut_correctness ())
+  {
+    printf ("correctness test failed\n");
+    res = 1;
+  }
+
+  // clone with string keys
+  {
+    CapeHashMap h1 = cape_hashmap_new (NULL, NULL, ut_on_del_str, NULL);
+    CapeHashMap h2;
+
+    cape_hashmap_insert (h1, cape_str_cp ("hello"), NULL);
+    cape_hashmap_insert (h1, cape_str_cp ("world"), NULL);
+
+    h2 = cape_hashmap_clone (h1, ut_on_clone);
+
+    cape_hashmap_del (&h1);
+
+    if (cape_hashmap_find (h2, "world") == NULL || cape_hashmap_size (h2) != 2)
+    {
+      res = 1;
+    }
+
+    cape_hashmap_del (&h2);
+  }
+
+  for (i = 0; i < UT_KEYS; i++)
+  {
+    keys[i] = cape_str_fmt ("key_%li_%li", i * 31, i);
+  }
+
+  if (ut_bench_strings (keys))
+  {
+    printf ("string benchmark failed\n");
+    res = 1;
+  }
+
+  if (ut_bench_numbers ())
+  {
+    printf ("number benchmark failed\n");
+    res = 1;
+  }
+
+  for (i = 0; i < UT_KEYS; i++)
+  {
+    cape_str_del (&(keys[i]));
+  }
+
+  CAPE_FREE (keys);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+#include "stc/cape_list.h"
+#include "stc/cape_str.h"
+#include "sys/cape_queue.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_ITEMS     1000000
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  number_t key;
+
+  CapeString name;
+
+  number_t pos;       // the original position
+
+} UtItem;
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_on_del (void* ptr)
+{
+  UtItem* item = ptr;
+
+  cape_str_del (&(item->name));
+
+  CAPE_DEL (&item, UtItem);
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_on_compare (void* ptr1, void* ptr2)
+{
+  UtItem* a = ptr1;
+  UtItem* b = ptr2;
+
+  return (a->key > b->key) - (a->key < b->key);
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t __STDCALL ut_on_key_n (void* ptr)
+{
+  return ((UtItem*)ptr)->key;
+}
+
+//-----------------------------------------------------------------------------
+
+static const char* __STDCALL ut_on_key_s (void* ptr)
+{
+  return ((UtItem*)ptr)->name;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeList ut_create (number_t size)
+{
+  CapeList list = cape_list_new (ut_on_del);
+  number_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    UtItem* item = CAPE_NEW (UtItem);
+
+    // many duplicates to check the stable order
+    item->key = (i * 2654435761UL) % (size / 4 + 1);
+    item->name = cape_str_fmt ("%08li", item->key);
+    item->pos = i;
+
+    cape_list_push_back (list, item);
+  }
+
+  return list;
+}
+
+//-----------------------------------------------------------------------------
+
+// the order must be sorted and stable, checks both directions
+static int ut_check (CapeList list, number_t size)
+{
+  CapeListCursor cursor;
+  UtItem* last = NULL;
+  number_t count = 0;
+
+  cape_list_cursor_init (list, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_list_cursor_next (&cursor))
+  {
+    UtItem* item = cape_list_node_data (cursor.node);
+
+    if (last && (last->key > item->key || (last->key == item->key && last->pos > item->pos)))
+    {
+      return 1;
+    }
+
+    last = item;
+    count++;
+  }
+
+  cape_list_cursor_init (list, &cursor, CAPE_DIRECTION_PREV);
+
+  while (cape_list_cursor_prev (&cursor))
+  {
+    count--;
+  }
+
+  return count != 0 || cape_list_size (list) != size;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_run (const char* name, int mode, CapeQueue queue, number_t size)
+{
+  int res;
+  CapeList list = ut_create (size);
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  cape_stoptimer_start (st);
+
+  switch (mode)
+  {
+    case 0: cape_list_sort (list, ut_on_compare); break;
+    case 1: cape_list_sort_key_n (list, ut_on_key_n); break;
+    case 2: cape_list_sort_key_s (list, ut_on_key_s); break;
+    case 3: cape_list_sort_queue (list, ut_on_compare, queue); break;
+  }
+
+  cape_stoptimer_stop (st);
+
+  if (size == UT_ITEMS)
+  {
+    printf ("%-10s: %.2f ms\n", name, cape_stoptimer_get (st));
+  }
+
+  res = ut_check (list, size);
+
+  if (res)
+  {
+    printf ("%s: wrong order for %li items\n", name, size);
+  }
+
+  cape_list_del (&list);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  int mode;
+
+  CapeErr err = cape_err_new ();
+  CapeQueue queue = cape_queue_new ();
+
+  const char* names[4] = {"compare", "key n", "key s", "parallel"};
+
+  number_t sizes[6] = {0, 1, 2, 17, 1000, UT_ITEMS};
+
+  if (cape_queue_start (queue, 4, err))
+  {
+    printf ("can't start queue: %s\n", cape_err_text (err));
+    res = 1;
+  }
+
+  for (mode = 0; mode < 4; mode++)
+  {
+    number_t i;
+
+    for (i = 0; i < 6; i++)
+    {
+      res |= ut_run (names[mode], mode, queue, sizes[i]);
+    }
+  }
+
+  cape_queue_del (&queue);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
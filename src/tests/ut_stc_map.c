@@ -0,0 +1,382 @@
+#include "stc/cape_map.h"
+#include "stc/cape_str.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_KEYS      1000000
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_on_clone (void* key_original, void* val_original, void** key_clone, void** val_clone)
+{
+  *key_clone = key_original;
+  *val_clone = val_original;
+}
+
+//-----------------------------------------------------------------------------
+
+// the cloned keys have the reverse order
+static void __STDCALL ut_on_clone_reverse (void* key_original, void* val_original, void** key_clone, void** val_clone)
+{
+  *key_clone = (void*)(1000 - (number_t)key_original);
+  *val_clone = val_original;
+}
+
+//-----------------------------------------------------------------------------
+
+static void __STDCALL ut_on_del (void* key, void* val)
+{
+  CapeString h = key;
+
+  cape_str_del (&h);
+}
+
+//-----------------------------------------------------------------------------
+
+// same as the built-in compare functions, but forces the generic map
+static int __STDCALL ut_compare_s (const void* a, const void* b, void* ptr)
+{
+  return strcmp (a, b);
+}
+
+static int __STDCALL ut_compare_n (const void* a, const void* b, void* ptr)
+{
+  return cape_map__compare__n (a, b, ptr);
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_bench (const char* name, CapeMap m, void** keys)
+{
+  number_t i, found = 0;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_KEYS; i++)
+  {
+    cape_map_insert (m, keys[i], NULL);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("%-16s: insert %.2f ms", name, cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_KEYS; i++)
+  {
+    found += (cape_map_find (m, keys[i]) != NULL);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", find %.2f ms (%li)\n", cape_stoptimer_get (st), found);
+
+  cape_map_del (&m);
+  cape_stoptimer_del (&st);
+}
+
+//-----------------------------------------------------------------------------
+
+// checks the order in both directions
+static int ut_check (CapeMap m, number_t size)
+{
+  CapeMapCursor cursor;
+  number_t i = 0;
+
+  cape_map_cursor_init (m, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_map_cursor_next (&cursor))
+  {
+    if ((number_t)cape_map_node_key (cursor.node) != i * 2 + 2)
+    {
+      return 1;
+    }
+
+    i++;
+  }
+
+  if (i != size)
+  {
+    return 1;
+  }
+
+  cape_map_cursor_init (m, &cursor, CAPE_DIRECTION_PREV);
+
+  while (cape_map_cursor_prev (&cursor))
+  {
+    i--;
+
+    if ((number_t)cape_map_node_key (cursor.node) != i * 2 + 2)
+    {
+      return 1;
+    }
+  }
+
+  return i != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  void** keys = CAPE_ALLOC (UT_KEYS * sizeof(void*));
+
+  for (i = 0; i < UT_KEYS; i++)
+  {
+    // 0 would be a NULL key
+    keys[i] = (void*)(i * 2 + 2);
+  }
+
+  // insert one by one
+  {
+    CapeMap m = cape_map_new (cape_map__compare__n, NULL, NULL);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      cape_map_insert (m, keys[i], NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("insert: %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_map_clr (m);
+
+    cape_stoptimer_stop (st);
+
+    printf ("clear : %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_map_del (&m);
+  }
+
+  // bulk build
+  {
+    CapeMap m = cape_map_new (cape_map__compare__n, NULL, NULL);
+    CapeMap c;
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    if (!cape_map_build_sorted (m, keys, NULL, UT_KEYS))
+    {
+      res = 1;
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("build : %.2f ms\n", cape_stoptimer_get (st));
+
+    if (ut_check (m, UT_KEYS))
+    {
+      printf ("wrong order after build\n");
+      res = 1;
+    }
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    c = cape_map_clone (m, ut_on_clone);
+
+    cape_stoptimer_stop (st);
+
+    printf ("clone : %.2f ms\n", cape_stoptimer_get (st));
+
+    if (ut_check (c, UT_KEYS))
+    {
+      printf ("wrong order after clone\n");
+      res = 1;
+    }
+
+    // the built tree must stay balanced for further changes
+    for (i = 0; i < UT_KEYS; i += 2)
+    {
+      cape_map_erase (c, cape_map_find (c, (void*)(i * 2 + 4)));
+    }
+
+    for (i = 0; i < UT_KEYS; i += 2)
+    {
+      cape_map_insert (c, (void*)(i * 2 + 4), NULL);
+    }
+
+    if (ut_check (c, UT_KEYS) || cape_map_find (c, (void*)1000) == NULL || cape_map_find (c, (void*)1001))
+    {
+      printf ("wrong order after erase and insert\n");
+      res = 1;
+    }
+
+    // unsorted input must be rejected
+    {
+      CapeMap u = cape_map_new (cape_map__compare__n, NULL, NULL);
+      void* unsorted[3] = {(void*)1, (void*)3, (void*)2};
+
+      if (cape_map_build_sorted (u, unsorted, NULL, 3) || cape_map_size (u) != 0)
+      {
+        res = 1;
+      }
+
+      cape_map_del (&u);
+    }
+
+    cape_map_del (&c);
+    cape_map_del (&m);
+  }
+
+  // clones with a different order of the keys
+  {
+    CapeMap m = cape_map_new (cape_map__compare__n, NULL, NULL);
+    CapeMap c;
+
+    for (i = 0; i < 100; i++)
+    {
+      cape_map_insert (m, (void*)i, (void*)i);
+    }
+
+    c = cape_map_clone (m, ut_on_clone_reverse);
+
+    for (i = 0; i < 100; i++)
+    {
+      CapeMapNode n = cape_map_find (c, (void*)(1000 - i));
+
+      if (n == NULL || cape_map_node_value (n) != (void*)i)
+      {
+        printf ("can't find the cloned key %li\n", 1000 - i);
+        res = 1;
+        break;
+      }
+    }
+
+    if (cape_map_size (c) != 100 || cape_map_node_key (cape_map_first (c)) != (void*)901)
+    {
+      printf ("wrong order after clone\n");
+      res = 1;
+    }
+
+    cape_map_del (&c);
+    cape_map_del (&m);
+  }
+
+  // released nodes give the memory back to the map
+  {
+    CapeMap m = cape_map_new (cape_map__compare__n, NULL, NULL);
+    CapeMapNode n;
+    CapeMapNode h;
+
+    cape_map_insert (m, (void*)1, NULL);
+    cape_map_insert (m, (void*)2, NULL);
+
+    n = cape_map_extract_release (m, cape_map_find (m, (void*)1));
+    h = n;
+
+    cape_map_node_release (m, &n);
+
+    if (n || cape_map_insert (m, (void*)3, NULL) != h)
+    {
+      printf ("released node was not reused\n");
+      res = 1;
+    }
+
+    cape_map_del (&m);
+  }
+
+  // extracted nodes live longer than the map
+  {
+    CapeMap m = cape_map_new (NULL, ut_on_del, NULL);
+    CapeMapNode n;
+
+    cape_map_insert (m, cape_str_cp ("a"), (void*)1);
+    cape_map_insert (m, cape_str_cp ("b"), (void*)2);
+
+    n = cape_map_extract (m, cape_map_find (m, "a"));
+
+    cape_map_del (&m);
+
+    if (n == NULL || strcmp (cape_map_node_key (n), "a") || cape_map_node_value (n) != (void*)1)
+    {
+      printf ("wrong extracted node\n");
+      res = 1;
+    }
+
+    if (n)
+    {
+      CapeString key = cape_map_node_key (n);
+
+      cape_str_del (&key);
+    }
+
+    cape_map_node_del (&n);
+  }
+
+  // small maps with string keys and a destroy callback
+  {
+    CapeMap m = cape_map_new (NULL, ut_on_del, NULL);
+    void* skeys[3];
+
+    skeys[0] = cape_str_cp ("a");
+    skeys[1] = cape_str_cp ("b");
+    skeys[2] = cape_str_cp ("c");
+
+    cape_map_build_sorted (m, skeys, NULL, 3);
+
+    cape_map_insert (m, cape_str_cp ("bb"), NULL);
+
+    cape_map_erase (m, cape_map_find (m, "a"));
+
+    if (cape_map_size (m) != 3 || cape_map_find (m, "bb") == NULL || cape_map_find (m, "c") == NULL)
+    {
+      res = 1;
+    }
+
+    cape_map_del (&m);
+  }
+
+  // generic against specialized variants
+  {
+    void** skeys = CAPE_ALLOC (UT_KEYS * sizeof(void*));
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      // spread the keys like hashes
+      skeys[i] = cape_str_fmt ("%08lx_%li", (unsigned long)(i * 2654435761UL) & 0xFFFFFFFF, i);
+    }
+
+    ut_bench ("number generic", cape_map_new (ut_compare_n, NULL, NULL), keys);
+    ut_bench ("number inlined", cape_map_new (cape_map__compare__n, NULL, NULL), keys);
+    ut_bench ("string generic", cape_map_new (ut_compare_s, NULL, NULL), skeys);
+    ut_bench ("string prefix", cape_map_new (NULL, NULL, NULL), skeys);
+
+    for (i = 0; i < UT_KEYS; i++)
+    {
+      CapeString h = skeys[i];
+
+      cape_str_del (&h);
+    }
+
+    CAPE_FREE (skeys);
+  }
+
+  CAPE_FREE (keys);
+
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
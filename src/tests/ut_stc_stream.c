@@ -0,0 +1,410 @@
+#include "stc/cape_stream.h"
+#include "stc/cape_udc.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_file.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOPS     1000000
+#define UT_LARGE     (64 * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  number_t i;
+  CapeString h;
+  CapeStream s = cape_stream_new ();
+
+  // stays in the inline buffer
+  cape_stream_append_str (s, "hello ");
+  cape_stream_append_n (s, 42);
+  cape_stream_append_c (s, ' ');
+  cape_stream_append_f (s, 1.5);
+
+  if (strcmp (cape_stream_get (s), "hello 42 1.5"))
+  {
+    printf ("wrong content: '%s'\n", cape_stream_get (s));
+    return 1;
+  }
+
+  // move to the heap
+  for (i = 0; i < 1000; i++)
+  {
+    cape_stream_append_c (s, 'a' + (i % 26));
+  }
+
+  if (cape_stream_size (s) != 1012 || cape_stream_data (s)[1011] != 'a' + (999 % 26) || strncmp (cape_stream_data (s), "hello 42 1.5abc", 15))
+  {
+    return 1;
+  }
+
+  // drops the large buffer
+  cape_stream_reset_keep (s, 100);
+
+  if (cape_stream_size (s) != 0)
+  {
+    return 1;
+  }
+
+  cape_stream_append_str (s, "small");
+
+  h = cape_stream_to_str (&s);
+
+  if (s || strcmp (h, "small"))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  // a limited growth
+  s = cape_stream_new ();
+
+  cape_stream_growth (s, 150, 4096);
+
+  for (i = 0; i < 100000; i++)
+  {
+    cape_stream_append_buf (s, "0123456789", 10);
+  }
+
+  h = cape_stream_to_str (&s);
+
+  if (cape_str_size (h) != 1000000 || strncmp (h + 999990, "0123456789", 10))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  // the pool returns empty streams
+  s = cape_stream_pool_get ();
+
+  cape_stream_append_str (s, "pooled");
+
+  cape_stream_pool_put (&s);
+
+  if (s)
+  {
+    return 1;
+  }
+
+  s = cape_stream_pool_get ();
+
+  if (cape_stream_size (s) != 0)
+  {
+    return 1;
+  }
+
+  cape_stream_pool_put (&s);
+
+  cape_stream_pool_flush ();
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_append (CapeStream s, number_t i, const char* large)
+{
+  cape_stream_append_str (s, "item ");
+  cape_stream_append_n (s, i);
+
+  // larger than a chunk
+  if (i % 100 == 0)
+  {
+    cape_stream_append_buf (s, large, 200);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_segmented (void)
+{
+  number_t i, cnt, pos = 0;
+  CapeStreamIov iov[4];
+
+  CapeStream s1 = cape_stream_new ();
+  CapeStream s2 = cape_stream_new_seg (64);
+  CapeStream s3 = cape_stream_new ();
+
+  char large[200];
+
+  memset (large, 'x', 200);
+
+  // the same content in both streams
+  for (i = 0; i < 1000; i++)
+  {
+    ut_append (s1, i, large);
+    ut_append (s2, i, large);
+  }
+
+  if (cape_stream_size (s1) != cape_stream_size (s2) || cape_stream_iov_cnt (s2) < 10)
+  {
+    printf ("wrong size of the segmented stream\n");
+    return 1;
+  }
+
+  // compare the segments without flattening
+  for (cnt = cape_stream_iov (s2, 0, iov, 4), i = 0; cnt; cnt = cape_stream_iov (s2, i, iov, 4))
+  {
+    number_t j;
+
+    for (j = 0; j < cnt; j++)
+    {
+      if (memcmp (cape_stream_data (s1) + pos, iov[j].iov_base, iov[j].iov_len))
+      {
+        printf ("wrong segment %li\n", i + j);
+        return 1;
+      }
+
+      pos += iov[j].iov_len;
+    }
+
+    i += cnt;
+  }
+
+  if (i != cape_stream_iov_cnt (s2) || pos != cape_stream_size (s1))
+  {
+    return 1;
+  }
+
+  cape_stream_append_stream (s3, s2);
+
+  // flattens the stream
+  if (strcmp (cape_stream_get (s1), cape_stream_get (s2)) || strcmp (cape_stream_get (s1), cape_stream_get (s3)) || cape_stream_iov_cnt (s2) != 1)
+  {
+    printf ("wrong content of the segmented stream\n");
+    return 1;
+  }
+
+  // continue after flattening
+  cape_stream_append_buf (s2, large, 200);
+  cape_stream_append_buf (s1, large, 200);
+
+  if (cape_stream_size (s1) != cape_stream_size (s2) || strcmp (cape_stream_get (s1), cape_stream_get (s2)))
+  {
+    return 1;
+  }
+
+  cape_stream_clr (s2);
+
+  if (cape_stream_size (s2) != 0 || cape_stream_iov_cnt (s2) != 0)
+  {
+    return 1;
+  }
+
+  cape_stream_del (&s1);
+  cape_stream_del (&s2);
+  cape_stream_del (&s3);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_json_file (void)
+{
+  int res = 0;
+  number_t i;
+
+  CapeErr err = cape_err_new ();
+  CapeUdc udc = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc list = cape_udc_new (CAPE_UDC_LIST, "items");
+  CapeUdc h;
+
+  for (i = 0; i < 100000; i++)
+  {
+    cape_udc_add_n (list, NULL, i);
+  }
+
+  cape_udc_add (udc, &list);
+
+  if (cape_json_to_file ("ut_stc_stream.json", udc, err))
+  {
+    printf ("can't write json: %s\n", cape_err_text (err));
+    res = 1;
+  }
+
+  h = cape_json_from_file ("ut_stc_stream.json", err);
+
+  if (h == NULL || cape_udc_size (cape_udc_get (h, "items")) != 100000)
+  {
+    printf ("wrong json file\n");
+    res = 1;
+  }
+
+  cape_udc_del (&h);
+  cape_udc_del (&udc);
+
+  remove ("ut_stc_stream.json");
+
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_bench_large (CapeStream s, CapeStopTimer st)
+{
+  number_t i;
+
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LARGE / 64; i++)
+  {
+    cape_stream_append_buf (s, "0123456789012345678901234567890123456789012345678901234567890123", 64);
+  }
+
+  cape_stoptimer_stop (st);
+
+  cape_stream_del (&s);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  if (ut_correctness ())
+  {
+    printf ("correctness test failed\n");
+    res = 1;
+  }
+
+  if (ut_segmented ())
+  {
+    printf ("segmented test failed\n");
+    res = 1;
+  }
+
+  if (ut_json_file ())
+  {
+    res = 1;
+  }
+
+  ut_bench_large (cape_stream_new (), st);
+
+  printf ("64 MB contiguous  : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+
+  ut_bench_large (cape_stream_new_seg (0), st);
+
+  printf ("64 MB segmented   : %.2f ms\n", cape_stoptimer_get (st));
+
+  // short lived streams for log lines
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeStream s = cape_stream_new ();
+    CapeString h;
+
+    cape_stream_append_str (s, "[INFO] request ");
+    cape_stream_append_n (s, i);
+    cape_stream_append_str (s, " done");
+
+    h = cape_stream_to_str (&s);
+
+    cape_str_del (&h);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("small to_str   : %.2f ms\n", cape_stoptimer_get (st));
+
+  // streams used as a temporary buffer
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeStream s = cape_stream_new ();
+
+    cape_stream_append_str (s, "[INFO] request ");
+    cape_stream_append_n (s, i);
+    cape_stream_append_str (s, " done");
+
+    res += (cape_stream_size (s) == 0);
+
+    cape_stream_del (&s);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("small del      : %.2f ms\n", cape_stoptimer_get (st));
+
+  // json messages
+  {
+    CapeUdc udc = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc list = cape_udc_new (CAPE_UDC_LIST, "items");
+
+    cape_udc_add_s_cp (udc, "name", "a small json message");
+    cape_udc_add_n (udc, "id", 12345);
+
+    for (i = 0; i < 50; i++)
+    {
+      cape_udc_add_n (list, NULL, i * 1000);
+    }
+
+    cape_udc_add (udc, &list);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_LOOPS / 10; i++)
+    {
+      CapeString h = cape_json_to_s (udc);
+
+      cape_str_del (&h);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("json small     : %.2f ms\n", cape_stoptimer_get (st));
+
+    // a larger message, the pooled stream doesn't need to grow
+    list = cape_udc_new (CAPE_UDC_LIST, "texts");
+
+    for (i = 0; i < 2000; i++)
+    {
+      cape_udc_add_s_cp (list, NULL, "a text with some characters");
+    }
+
+    cape_udc_add (udc, &list);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_LOOPS / 1000; i++)
+    {
+      CapeString h = cape_json_to_s (udc);
+
+      cape_str_del (&h);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("json large     : %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_udc_del (&udc);
+  }
+
+  cape_stream_pool_flush ();
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
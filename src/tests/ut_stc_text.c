@@ -0,0 +1,324 @@
+#include "stc/cape_text.h"
+#include "stc/cape_stream.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOPS     1000000
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  CapeText t;
+  CapeString h;
+  number_t i;
+
+  char expected[1100];
+
+  cape_text_init (&t);
+
+  if (cape_text_size (&t) != 0 || strcmp (cape_text_get (&t), "") || cape_text_capacity (&t) != (number_t)CAPE_TEXT_INLINE)
+  {
+    return 1;
+  }
+
+  // the inline limit
+  for (i = 0; i < (number_t)CAPE_TEXT_INLINE; i++)
+  {
+    cape_text_append_c (&t, 'a' + (char)i);
+  }
+
+  if (cape_text_size (&t) != (number_t)CAPE_TEXT_INLINE || cape_text_capacity (&t) != (number_t)CAPE_TEXT_INLINE || strlen (cape_text_get (&t)) != CAPE_TEXT_INLINE)
+  {
+    printf ("wrong inline text\n");
+    return 1;
+  }
+
+  // leave the inline buffer
+  cape_text_append_c (&t, '!');
+
+  if (cape_text_size (&t) != (number_t)CAPE_TEXT_INLINE + 1 || cape_text_capacity (&t) != 31 || cape_text_get (&t)[CAPE_TEXT_INLINE] != '!')
+  {
+    printf ("wrong heap text\n");
+    return 1;
+  }
+
+  // compare with a plain buffer
+  memset (expected, 0, sizeof(expected));
+
+  cape_text_clr (&t);
+
+  for (i = 0; i < 100; i++)
+  {
+    cape_text_append_n (&t, i % 10);
+    cape_text_append_str (&t, "abcdefghi");
+
+    memcpy (expected + i * 10, "0abcdefghi", 10);
+    expected[i * 10] = '0' + (char)(i % 10);
+  }
+
+  if (cape_text_size (&t) != 1000 || strcmp (cape_text_get (&t), expected) || cape_text_capacity (&t) != 1023 || !cape_text_equal (&t, expected))
+  {
+    printf ("wrong appended text\n");
+    return 1;
+  }
+
+  // append a part of itself
+  cape_text_append_buf (&t, cape_text_get (&t) + 10, 20);
+
+  if (cape_text_size (&t) != 1020 || strncmp (cape_text_get (&t) + 1000, expected + 10, 20))
+  {
+    return 1;
+  }
+
+  cape_text_cut (&t, 5);
+
+  if (!cape_text_equal (&t, "0abcd") || cape_text_equal (&t, "0abc") || cape_text_equal (&t, "0abcde"))
+  {
+    return 1;
+  }
+
+  cape_text_replace (&t, "b", "xyz");
+  cape_text_replace (&t, "0", NULL);
+
+  if (!cape_text_equal (&t, "axyzcd"))
+  {
+    printf ("wrong replaced text: '%s'\n", cape_text_get (&t));
+    return 1;
+  }
+
+  // move out and in again without copies
+  cape_text_set (&t, "a text which is longer than the inline buffer");
+
+  {
+    const char* buf = cape_text_get (&t);
+
+    h = cape_text_to_str (&t);
+
+    if (h != buf || cape_text_size (&t) != 0)
+    {
+      return 1;
+    }
+
+    cape_text_init_mv (&t, &h);
+
+    // the buffer might be resized to the recorded capacity
+    if (h || cape_text_size (&t) != 45 || cape_text_capacity (&t) < 45 || !cape_text_equal (&t, "a text which is longer than the inline buffer"))
+    {
+      return 1;
+    }
+
+    // the source is a part of the text
+    cape_text_set_buf (&t, cape_text_get (&t) + 2, 43);
+
+    if (!cape_text_equal (&t, "text which is longer than the inline buffer"))
+    {
+      return 1;
+    }
+
+    cape_text_set (&t, "a text which is longer than the inline buffer");
+
+    // the capacity of a foreign buffer
+    cape_text_append_str (&t, " and more");
+
+    if (!cape_text_equal (&t, "a text which is longer than the inline buffer and more"))
+    {
+      return 1;
+    }
+  }
+
+  cape_text_done (&t);
+
+  // a string buffer has no spare bytes
+  h = cape_str_cp ("a string which has no spare bytes at the end");
+
+  cape_text_init_mv (&t, &h);
+
+  if (cape_text_capacity (&t) < cape_text_size (&t))
+  {
+    return 1;
+  }
+
+  cape_text_set_buf (&t, cape_text_get (&t) + 2, cape_text_size (&t) - 2);
+
+  if (!cape_text_equal (&t, "string which has no spare bytes at the end"))
+  {
+    return 1;
+  }
+
+  cape_text_done (&t);
+
+  // short strings are copied inline
+  h = cape_str_cp ("short");
+
+  cape_text_init_mv (&t, &h);
+
+  h = cape_text_cp_str (&t);
+
+  if (strcmp (h, "short") || !cape_text_equal (&t, "short"))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  h = cape_text_to_str (&t);
+
+  if (strcmp (h, "short"))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  cape_text_done (&t);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i, sum = 0;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  if (ut_correctness ())
+  {
+    printf ("correctness test failed\n");
+    res = 1;
+  }
+
+  // short keys, built with CapeString
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeString h1 = cape_str_n (i);
+    CapeString h2 = cape_str_catenate_3 ("key_", h1, "_id");
+
+    sum += cape_str_size (h2);
+
+    cape_str_del (&h1);
+    cape_str_del (&h2);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("short : string %.2f ms", cape_stoptimer_get (st));
+
+  // and with the text
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeText t;
+
+    cape_text_init_cp (&t, "key_");
+    cape_text_append_n (&t, i);
+    cape_text_append_str (&t, "_id");
+
+    sum -= cape_text_size (&t);
+
+    cape_text_done (&t);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", text %.2f ms\n", cape_stoptimer_get (st));
+
+  // a growing string
+  {
+    CapeString h = cape_str_cp ("");
+    CapeText t;
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_LOOPS / 100; i++)
+    {
+      CapeString n = cape_str_catenate_2 (h, "a part of a line, ");
+
+      cape_str_replace_mv (&h, &n);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("append: string %.2f ms", cape_stoptimer_get (st));
+
+    cape_text_init (&t);
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_LOOPS / 100; i++)
+    {
+      cape_text_append_str (&t, "a part of a line, ");
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", text %.2f ms\n", cape_stoptimer_get (st));
+
+    if (!cape_text_equal (&t, h))
+    {
+      res = 1;
+    }
+
+    // the cached length for the stream
+    {
+      CapeStream s = cape_stream_new ();
+
+      cape_stoptimer_set (st, 0);
+      cape_stoptimer_start (st);
+
+      for (i = 0; i < 1000; i++)
+      {
+        cape_stream_clr (s);
+        cape_stream_append_str (s, h);
+      }
+
+      cape_stoptimer_stop (st);
+
+      printf ("stream: string %.2f ms", cape_stoptimer_get (st));
+
+      cape_stoptimer_set (st, 0);
+      cape_stoptimer_start (st);
+
+      for (i = 0; i < 1000; i++)
+      {
+        cape_stream_clr (s);
+        cape_stream_append_text (s, &t);
+      }
+
+      cape_stoptimer_stop (st);
+
+      printf (", text %.2f ms\n", cape_stoptimer_get (st));
+
+      cape_stream_del (&s);
+    }
+
+    cape_text_done (&t);
+    cape_str_del (&h);
+  }
+
+  if (sum != 0)
+  {
+    printf ("wrong sizes\n");
+    res = 1;
+  }
+
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
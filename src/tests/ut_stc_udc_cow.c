@@ -0,0 +1,424 @@
+#include "stc/cape_udc.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_ENTRIES   2000
+#define UT_COPIES    1000
+#define UT_LOOPS     200
+#define UT_THREADS   4
+
+//-----------------------------------------------------------------------------
+
+// a configuration with many entries
+static CapeUdc ut_config (number_t entries)
+{
+  number_t i;
+  CapeUdc root = cape_udc_new (CAPE_UDC_NODE, NULL);
+  CapeUdc services = cape_udc_add_node (root, "services");
+  CapeUdc hosts = cape_udc_add_list (root, "hosts");
+
+  cape_udc_add_s_cp (root, "name", "config");
+
+  for (i = 0; i < entries; i++)
+  {
+    CapeString h = cape_str_fmt ("service_%li", i);
+    CapeUdc n = cape_udc_add_node (services, h);
+    CapeUdc p = cape_udc_add_node (n, "params");
+
+    cape_udc_add_s_cp (n, "host", "localhost");
+    cape_udc_add_n (n, "port", 8000 + i);
+    cape_udc_add_b (n, "active", TRUE);
+    cape_udc_add_f (n, "timeout", 1.5);
+    cape_udc_add_s_cp (p, "user", "admin");
+    cape_udc_add_n (p, "retries", 3);
+
+    cape_udc_add_s_cp (hosts, NULL, h);
+
+    cape_str_del (&h);
+  }
+
+  return root;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_isolation (void)
+{
+  CapeUdc c1, c2, c3, h;
+  CapeUdcCursor* cursor;
+
+  CapeUdc root = ut_config (100);
+
+  cape_udc_freeze (root);
+
+  // change a deep value of the copy
+  c1 = cape_udc_cp (root);
+
+  cape_udc_set_s_cp (cape_udc_get (cape_udc_get (cape_udc_get_node (c1, "services"), "service_5"), "host"), "remote");
+  cape_udc_add_n (cape_udc_get_node (cape_udc_get_node (c1, "services"), "service_7"), "extra", 1);
+
+  if (strcmp (cape_udc_get_s (cape_udc_get (cape_udc_get (root, "services"), "service_5"), "host", ""), "localhost"))
+  {
+    printf ("the original was changed\n");
+    return 1;
+  }
+
+  if (strcmp (cape_udc_get_s (cape_udc_get (cape_udc_get (c1, "services"), "service_5"), "host", ""), "remote") || cape_udc_get_n (cape_udc_get (cape_udc_get (c1, "services"), "service_7"), "extra", 0) != 1)
+  {
+    printf ("the copy was not changed\n");
+    return 1;
+  }
+
+  if (cape_udc_get (cape_udc_get (cape_udc_get (root, "services"), "service_7"), "extra"))
+  {
+    return 1;
+  }
+
+  // the frozen udc refuses all changes
+  h = cape_udc_get (root, "services");
+
+  if (cape_udc_ext (h, "service_1") || cape_udc_ext_first (h) || cape_udc_add_n (h, "new", 1) || cape_udc_list_mv (cape_udc_get (root, "hosts")))
+  {
+    printf ("the frozen udc was changed\n");
+    return 1;
+  }
+
+  cape_udc_set_n (cape_udc_get (cape_udc_get (h, "service_1"), "port"), 0);
+
+  if (cape_udc_size (h) != 100 || cape_udc_size (cape_udc_get (root, "hosts")) != 100 || cape_udc_get_n (cape_udc_get (h, "service_1"), "port", 0) != 8001)
+  {
+    printf ("the frozen udc was changed\n");
+    return 1;
+  }
+
+  // copies of copies are independent
+  c2 = cape_udc_cp (c1);
+
+  h = cape_udc_ext (cape_udc_get (c1, "services"), "service_1");
+  cape_udc_del (&h);
+
+  cape_udc_add_s_cp (cape_udc_get (c1, "hosts"), NULL, "new_host");
+
+  if (cape_udc_size (cape_udc_get (root, "services")) != 100 || cape_udc_size (cape_udc_get (c1, "services")) != 99 || cape_udc_size (cape_udc_get (c2, "services")) != 100)
+  {
+    printf ("wrong ext\n");
+    return 1;
+  }
+
+  if (cape_udc_size (cape_udc_get (c1, "hosts")) != 101 || cape_udc_size (cape_udc_get (c2, "hosts")) != 100)
+  {
+    printf ("wrong list\n");
+    return 1;
+  }
+
+  // changes done by a cursor
+  c3 = cape_udc_cp (root);
+
+  cursor = cape_udc_cursor_new (cape_udc_get (c3, "services"), CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    cape_udc_set_n (cape_udc_get (cursor->item, "port"), 0);
+
+    if (cursor->position % 2)
+    {
+      h = cape_udc_cursor_ext (cape_udc_get (c3, "services"), cursor);
+      cape_udc_del (&h);
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+
+  if (cape_udc_size (cape_udc_get (c3, "services")) != 50 || cape_udc_get_n (cape_udc_get_first (cape_udc_get (c3, "services")), "port", -1) != 0)
+  {
+    printf ("wrong cursor\n");
+    return 1;
+  }
+
+  if (cape_udc_get_n (cape_udc_get_first (cape_udc_get (root, "services")), "port", -1) != 8000)
+  {
+    printf ("the cursor changed the original\n");
+    return 1;
+  }
+
+  // the lists are moved out of the copy
+  {
+    CapeList values = cape_udc_list_mv (cape_udc_get (c3, "hosts"));
+
+    if (cape_list_size (values) != 100 || cape_udc_size (cape_udc_get (c3, "hosts")) != 0 || cape_udc_size (cape_udc_get (root, "hosts")) != 100)
+    {
+      printf ("wrong list_mv\n");
+      return 1;
+    }
+
+    cape_list_del (&values);
+  }
+
+  // the copies are still valid without the original
+  cape_udc_del (&root);
+
+  if (cape_udc_get_n (cape_udc_get (cape_udc_get (c2, "services"), "service_99"), "port", 0) != 8099 || strcmp (cape_udc_get_s (cape_udc_get (cape_udc_get (c1, "services"), "service_5"), "host", ""), "remote"))
+  {
+    printf ("wrong copy after delete\n");
+    return 1;
+  }
+
+  // the last copy must not change the arrays of the former original
+  h = cape_udc_cp (c2);
+
+  cape_udc_set_n (cape_udc_get (cape_udc_get (cape_udc_get (c2, "services"), "service_99"), "port"), 1);
+
+  if (cape_udc_get_n (cape_udc_get (cape_udc_get (h, "services"), "service_99"), "port", 0) != 8099)
+  {
+    printf ("wrong copy of a copy\n");
+    return 1;
+  }
+
+  cape_udc_del (&h);
+  cape_udc_del (&c2);
+  cape_udc_del (&c1);
+  cape_udc_del (&c3);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// child pointers taken before the copy change only the original
+static int ut_held (int frozen)
+{
+  int res = 0;
+  CapeUdc root, copy, sub, v;
+
+  if (frozen)
+  {
+    // the copy of a frozen udc is changed instead
+    CapeUdc h = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_node (h, "sub");
+    cape_udc_add_n (h, "v", 1);
+
+    cape_udc_freeze (h);
+
+    root = cape_udc_cp (h);
+
+    cape_udc_del (&h);
+  }
+  else
+  {
+    root = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_node (root, "sub");
+    cape_udc_add_n (root, "v", 1);
+  }
+
+  sub = cape_udc_get (root, "sub");
+  v = cape_udc_get (root, "v");
+
+  copy = cape_udc_cp (root);
+
+  cape_udc_add_n (sub, "k", 1);
+  cape_udc_set_n (v, 42);
+
+  if (cape_udc_size (cape_udc_get (copy, "sub")) != 0 || cape_udc_get_n (copy, "v", 0) != 1)
+  {
+    printf ("the copy was changed\n");
+    res = 1;
+  }
+
+  if (cape_udc_size (cape_udc_get (root, "sub")) != 1 || cape_udc_get_n (root, "v", 0) != 42)
+  {
+    printf ("the original was not changed\n");
+    res = 1;
+  }
+
+  cape_udc_del (&copy);
+  cape_udc_del (&root);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_thread (void* ptr)
+{
+  number_t i;
+
+  for (i = 0; i < UT_COPIES; i++)
+  {
+    CapeUdc h = cape_udc_cp (ptr);
+    CapeUdc n = cape_udc_get (cape_udc_get (h, "services"), "service_3");
+
+    cape_udc_set_n (cape_udc_get (n, "port"), i);
+    cape_udc_set_s_cp (cape_udc_get (cape_udc_get (n, "params"), "user"), "guest");
+
+    cape_udc_del (&h);
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_thread_reader (void* ptr)
+{
+  number_t i;
+
+  for (i = 0; i < UT_COPIES; i++)
+  {
+    CapeUdc h = cape_udc_cp (ptr);
+    CapeUdcCursor* cursor;
+
+    cape_udc_get (ptr, "services");
+    cape_udc_get_s (cape_udc_get (cape_udc_get (ptr, "services"), "service_3"), "host", NULL);
+
+    cursor = cape_udc_cursor_new (cape_udc_get (ptr, "hosts"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor));
+
+    cape_udc_cursor_del (&cursor);
+
+    cape_udc_del (&h);
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+// all threads copy and read the same udc
+static int ut_threads (int frozen)
+{
+  int i, res = 0;
+  CapeThread threads[UT_THREADS];
+
+  CapeUdc root = ut_config (100);
+
+  if (frozen)
+  {
+    cape_udc_freeze (root);
+  }
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    threads[i] = cape_thread_new ();
+
+    cape_thread_start (threads[i], i % 2 ? ut_thread : ut_thread_reader, root);
+  }
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+  }
+
+  if (strcmp (cape_udc_get_s (cape_udc_get (cape_udc_get (cape_udc_get (root, "services"), "service_3"), "params"), "user", ""), "admin"))
+  {
+    res = 1;
+  }
+
+  if (cape_udc_get_n (cape_udc_get (cape_udc_get (root, "services"), "service_3"), "port", 0) != 8003)
+  {
+    res = 1;
+  }
+
+  cape_udc_del (&root);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_benchmark (void)
+{
+  number_t i, sum1 = 0, sum2 = 0;
+  double t1;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeUdc root = ut_config (UT_ENTRIES);
+
+  // copy and change one field
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeUdc h = cape_udc_cp (root);
+
+    cape_udc_set_n (cape_udc_get (cape_udc_get (cape_udc_get (h, "services"), "service_42"), "port"), i);
+
+    sum1 += cape_udc_get_n (cape_udc_get (cape_udc_get (h, "services"), "service_42"), "port", 0);
+
+    cape_udc_del (&h);
+  }
+
+  cape_stoptimer_stop (st);
+
+  t1 = cape_stoptimer_get (st);
+
+  cape_udc_freeze (root);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    CapeUdc h = cape_udc_cp (root);
+
+    cape_udc_set_n (cape_udc_get (cape_udc_get (cape_udc_get (h, "services"), "service_42"), "port"), i);
+
+    sum2 += cape_udc_get_n (cape_udc_get (cape_udc_get (h, "services"), "service_42"), "port", 0);
+
+    cape_udc_del (&h);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("copy and change : deep %.2f ms, frozen %.2f ms\n", t1, cape_stoptimer_get (st));
+
+  cape_udc_del (&root);
+  cape_stoptimer_del (&st);
+
+  return sum1 != sum2;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_isolation ())
+  {
+    printf ("isolation test failed\n");
+    res = 1;
+  }
+
+  if (ut_held (FALSE) || ut_held (TRUE))
+  {
+    printf ("held pointer test failed\n");
+    res = 1;
+  }
+
+  if (ut_threads (FALSE) || ut_threads (TRUE))
+  {
+    printf ("thread test failed\n");
+    res = 1;
+  }
+
+  if (ut_benchmark ())
+  {
+    printf ("benchmark failed\n");
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,411 @@
+#include "stc/cape_udc.h"
+#include "stc/cape_stream.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_OBJECTS   200000
+#define UT_KEYS      10
+
+//-----------------------------------------------------------------------------
+
+// the order of the node children might be different
+static int ut_equal (CapeUdc a, CapeUdc b)
+{
+  if (a == NULL || b == NULL || cape_udc_type (a) != cape_udc_type (b) || cape_udc_size (a) != cape_udc_size (b))
+  {
+    return FALSE;
+  }
+
+  switch (cape_udc_type (a))
+  {
+    case CAPE_UDC_NODE:
+    {
+      int ret = TRUE;
+      CapeUdcCursor* cursor = cape_udc_cursor_new (a, CAPE_DIRECTION_FORW);
+
+      while (ret && cape_udc_cursor_next (cursor))
+      {
+        ret = ut_equal (cursor->item, cape_udc_get (b, cape_udc_name (cursor->item)));
+      }
+
+      cape_udc_cursor_del (&cursor);
+
+      return ret;
+    }
+    case CAPE_UDC_LIST:
+    {
+      int ret = TRUE;
+      CapeUdcCursor* c1 = cape_udc_cursor_new (a, CAPE_DIRECTION_FORW);
+      CapeUdcCursor* c2 = cape_udc_cursor_new (b, CAPE_DIRECTION_FORW);
+
+      while (ret && cape_udc_cursor_next (c1))
+      {
+        ret = cape_udc_cursor_next (c2) && ut_equal (c1->item, c2->item);
+      }
+
+      cape_udc_cursor_del (&c1);
+      cape_udc_cursor_del (&c2);
+
+      return ret;
+    }
+    case CAPE_UDC_STRING:
+    {
+      return strcmp (cape_udc_s (a, ""), cape_udc_s (b, "")) == 0;
+    }
+    case CAPE_UDC_NUMBER:
+    {
+      return cape_udc_n (a, 0) == cape_udc_n (b, 0);
+    }
+    case CAPE_UDC_FLOAT:
+    {
+      return cape_udc_f (a, 0) == cape_udc_f (b, 0);
+    }
+    case CAPE_UDC_BOOL:
+    {
+      return cape_udc_b (a, FALSE) == cape_udc_b (b, FALSE);
+    }
+    case CAPE_UDC_DATETIME:
+    {
+      const CapeDatetime* d1 = cape_udc_d (a, NULL);
+      const CapeDatetime* d2 = cape_udc_d (b, NULL);
+
+      return (d1 && d2) ? memcmp (d1, d2, sizeof(CapeDatetime)) == 0 : d1 == d2;
+    }
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_api (void)
+{
+  number_t i;
+  CapeDatetime dt;
+  CapeUdc doc, n, l, h;
+  CapeUdcCursor* cursor;
+
+  memset (&dt, 0, sizeof(dt));
+  dt.year = 2020;
+  dt.month = 2;
+  dt.day = 29;
+
+  doc = cape_udc_new_doc (CAPE_UDC_NODE, "root");
+
+  cape_udc_add_s_cp (doc, "name", "text");
+  cape_udc_add_n (doc, "id", 42);
+  cape_udc_add_f (doc, "pi", 3.25);
+  cape_udc_add_b (doc, "flag", TRUE);
+  cape_udc_add_d (doc, "date", &dt);
+  cape_udc_add_z (doc, "none");
+
+  n = cape_udc_add_node (doc, "node");
+  cape_udc_add_s_cp (n, "inner", "value");
+
+  l = cape_udc_add_list (doc, "list");
+
+  for (i = 0; i < 100; i++)
+  {
+    cape_udc_add_n (l, NULL, i);
+  }
+
+  if (strcmp (cape_udc_name (doc), "root") || cape_udc_size (doc) != 8 || cape_udc_size (l) != 100)
+  {
+    return 1;
+  }
+
+  if (strcmp (cape_udc_get_s (doc, "name", ""), "text") || cape_udc_get_n (doc, "id", 0) != 42 || cape_udc_get_f (doc, "pi", 0) != 3.25 || !cape_udc_get_b (doc, "flag", FALSE))
+  {
+    printf ("wrong values\n");
+    return 1;
+  }
+
+  if (cape_udc_get_d (doc, "date", NULL)->year != 2020 || cape_udc_get_node (doc, "node") != n || cape_udc_get_list (doc, "list") != l || cape_udc_get (doc, "missing"))
+  {
+    return 1;
+  }
+
+  if (strcmp (cape_udc_get_s (n, "inner", ""), "value") || strcmp (cape_udc_name (cape_udc_get_first (doc)), "date"))
+  {
+    return 1;
+  }
+
+  // cursors in both directions
+  {
+    number_t sum = 0;
+
+    cursor = cape_udc_cursor_new (l, CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      if (cape_udc_n (cursor->item, -1) != cursor->position)
+      {
+        return 1;
+      }
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    cursor = cape_udc_cursor_new (l, CAPE_DIRECTION_PREV);
+
+    i = 100;
+
+    while (cape_udc_cursor_prev (cursor))
+    {
+      if (cape_udc_n (cursor->item, -1) != --i)
+      {
+        return 1;
+      }
+
+      sum++;
+    }
+
+    cape_udc_cursor_del (&cursor);
+
+    if (sum != 100)
+    {
+      return 1;
+    }
+  }
+
+  // remove every second item with the cursor
+  cursor = cape_udc_cursor_new (l, CAPE_DIRECTION_FORW);
+
+  while (cape_udc_cursor_next (cursor))
+  {
+    if (cape_udc_n (cursor->item, 0) % 2)
+    {
+      h = cape_udc_cursor_ext (l, cursor);
+
+      cape_udc_del (&h);
+    }
+  }
+
+  cape_udc_cursor_del (&cursor);
+
+  if (cape_udc_size (l) != 50 || cape_udc_n (cape_udc_get_first (l), -1) != 0)
+  {
+    printf ("wrong cursor ext\n");
+    return 1;
+  }
+
+  // values taken out of the document are copies
+  {
+    CapeString s = cape_udc_ext_s (doc, "name");
+    CapeDatetime* d = cape_udc_d_mv (cape_udc_get (doc, "date"), NULL);
+    CapeList values = cape_udc_list_mv (l);
+
+    if (s == NULL || strcmp (s, "text") || cape_udc_get (doc, "name") || d == NULL || d->day != 29 || cape_list_size (values) != 50 || cape_udc_size (l) != 0)
+    {
+      return 1;
+    }
+
+    cape_str_del (&s);
+    cape_datetime_del (&d);
+    cape_list_del (&values);
+  }
+
+  h = cape_udc_ext_node (doc, "node");
+
+  if (h == NULL || cape_udc_get (doc, "node") || strcmp (cape_udc_get_s (h, "inner", ""), "value"))
+  {
+    return 1;
+  }
+
+  // a normal udc is copied into the document
+  cape_udc_add_name (doc, &h, "moved");
+
+  if (h || strcmp (cape_udc_get_s (cape_udc_get (doc, "moved"), "inner", ""), "value"))
+  {
+    return 1;
+  }
+
+  // a copy of the document is a normal udc
+  h = cape_udc_cp (doc);
+
+  if (!ut_equal (h, doc))
+  {
+    printf ("wrong copy\n");
+    return 1;
+  }
+
+  // and the document can be added to it
+  {
+    CapeUdc d = cape_udc_cp (doc);
+    CapeUdc e = cape_udc_new_doc (CAPE_UDC_NODE, NULL);
+
+    cape_udc_add_n (e, "id", 7);
+
+    cape_udc_add_name (d, &e, "sub");
+
+    if (e || cape_udc_get_n (cape_udc_get (d, "sub"), "id", 0) != 7)
+    {
+      return 1;
+    }
+
+    cape_udc_merge_mv (doc, &d);
+
+    if (cape_udc_get_n (cape_udc_get (doc, "sub"), "id", 0) != 7)
+    {
+      printf ("wrong merge\n");
+      return 1;
+    }
+  }
+
+  cape_udc_del (&h);
+  cape_udc_del (&doc);
+
+  if (doc)
+  {
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static CapeString ut_document (void)
+{
+  CapeStream s = cape_stream_new ();
+  number_t i, j;
+
+  cape_stream_append_c (s, '[');
+
+  for (i = 0; i < UT_OBJECTS; i++)
+  {
+    cape_stream_append_str (s, i ? ",{" : "{");
+
+    for (j = 0; j < UT_KEYS; j++)
+    {
+      cape_stream_append_str (s, j ? ",\"field_" : "\"field_");
+      cape_stream_append_n (s, j);
+
+      if (j % 2)
+      {
+        cape_stream_append_str (s, "\":\"some text\"");
+      }
+      else
+      {
+        cape_stream_append_str (s, "\":");
+        cape_stream_append_n (s, i + j);
+      }
+    }
+
+    cape_stream_append_str (s, ",\"sub\":{\"a\":[1,2.5,true,null]}}");
+  }
+
+  cape_stream_append_c (s, ']');
+
+  return cape_stream_to_str (&s);
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_json (void)
+{
+  int res = 0;
+  double t1;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeString text = ut_document ();
+  CapeUdc u1, u2;
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  u1 = cape_json_from_s (text);
+
+  cape_stoptimer_stop (st);
+
+  printf ("parse : udc %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  u2 = cape_json_from_buf_doc (text, cape_str_size (text));
+
+  cape_stoptimer_stop (st);
+
+  printf (", doc %.2f ms\n", cape_stoptimer_get (st));
+
+  if (u1 == NULL || u2 == NULL || cape_udc_size (u2) != UT_OBJECTS || !ut_equal (u1, u2))
+  {
+    printf ("wrong document\n");
+    res = 1;
+  }
+
+  // the children are sorted by name, like in the parsed udc
+  {
+    CapeString h = cape_json_to_s (cape_udc_get_first (u2));
+
+    if (strncmp (h, "{\"field_0\":0,\"field_1\":\"some text\",\"field_2\":2", 45))
+    {
+      printf ("wrong order: %s\n", h);
+      res = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  // the document first, the large free calls would pay for the small ones
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  cape_udc_del (&u2);
+
+  cape_stoptimer_stop (st);
+
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  cape_udc_del (&u1);
+
+  cape_stoptimer_stop (st);
+
+  printf ("free  : udc %.2f ms, doc %.2f ms\n", cape_stoptimer_get (st), t1);
+
+  // broken documents
+  u2 = cape_json_from_buf_doc ("{\"a\":[1,2,{\"b\":", 15);
+
+  if (u2)
+  {
+    res = 1;
+  }
+
+  cape_str_del (&text);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_api ())
+  {
+    printf ("api test failed\n");
+    res = 1;
+  }
+
+  if (ut_json ())
+  {
+    printf ("json test failed\n");
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
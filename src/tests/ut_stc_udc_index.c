@@ -0,0 +1,336 @@
+#include "stc/cape_udc.h"
+#include "stc/cape_map.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOKUPS   2000000
+
+//-----------------------------------------------------------------------------
+
+static CapeString* ut_keys (number_t size)
+{
+  number_t i;
+  CapeString* keys = CAPE_ALLOC (size * sizeof(CapeString));
+
+  for (i = 0; i < size; i++)
+  {
+    keys[i] = cape_str_fmt ("request_field_%li", i);
+  }
+
+  return keys;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_keys_del (CapeString* keys, number_t size)
+{
+  number_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    cape_str_del (&(keys[i]));
+  }
+
+  CAPE_FREE (keys);
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_node (CapeUdc node, number_t size)
+{
+  number_t i;
+  CapeString* keys = ut_keys (size);
+  CapeUdc h;
+
+  for (i = 0; i < size; i++)
+  {
+    cape_udc_add_n (node, keys[i], i);
+  }
+
+  // duplicates are not added
+  h = cape_udc_add_n (node, keys[0], -1);
+
+  if (cape_udc_size (node) != size || cape_udc_n (h, -1) != 0)
+  {
+    printf ("wrong duplicate\n");
+    return 1;
+  }
+
+  for (i = 0; i < size; i++)
+  {
+    if (cape_udc_get_n (node, keys[i], -1) != i)
+    {
+      printf ("wrong value for %s\n", keys[i]);
+      return 1;
+    }
+  }
+
+  if (cape_udc_get (node, "missing") || cape_udc_get (node, "request_field_") || cape_udc_get (node, NULL))
+  {
+    return 1;
+  }
+
+  // the children are sorted by name
+  {
+    const char* last = NULL;
+    CapeUdcCursor* cursor = cape_udc_cursor_new (node, CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      if (last && strcmp (last, cape_udc_name (cursor->item)) >= 0)
+      {
+        printf ("wrong order\n");
+        return 1;
+      }
+
+      last = cape_udc_name (cursor->item);
+    }
+
+    cape_udc_cursor_del (&cursor);
+  }
+
+  // remove every third child, the others must be found at their new position
+  for (i = 0; i < size; i += 3)
+  {
+    h = cape_udc_ext (node, keys[i]);
+
+    if (h == NULL || cape_udc_n (h, -1) != i || cape_udc_get (node, keys[i]))
+    {
+      printf ("wrong ext\n");
+      return 1;
+    }
+
+    cape_udc_del (&h);
+  }
+
+  for (i = 0; i < size; i++)
+  {
+    if (cape_udc_get_n (node, keys[i], -1) != (i % 3 ? i : -1))
+    {
+      printf ("wrong value after ext\n");
+      return 1;
+    }
+  }
+
+  // and back again
+  for (i = 0; i < size; i += 3)
+  {
+    cape_udc_add_n (node, keys[i], i);
+  }
+
+  // the copy has the same children
+  h = cape_udc_cp (node);
+
+  for (i = 0; i < size; i++)
+  {
+    if (cape_udc_get_n (h, keys[i], -1) != i)
+    {
+      printf ("wrong copy\n");
+      return 1;
+    }
+  }
+
+  cape_udc_del (&h);
+
+  ut_keys_del (keys, size);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  number_t sizes[] = {1, 4, 16, 17, 64, 1000};
+  number_t i;
+
+  for (i = 0; i < (number_t)(sizeof(sizes) / sizeof(number_t)); i++)
+  {
+    CapeUdc n1 = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc n2 = cape_udc_new_doc (CAPE_UDC_NODE, NULL);
+
+    if (ut_node (n1, sizes[i]) || ut_node (n2, sizes[i]))
+    {
+      printf ("node test failed for %li children\n", sizes[i]);
+      return 1;
+    }
+
+    cape_udc_del (&n1);
+    cape_udc_del (&n2);
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// a name is added only once, the existing child is returned
+static int ut_duplicate (CapeUdc node)
+{
+  int res = 0;
+  number_t i;
+
+  CapeUdc sub = cape_udc_add_node (node, "sub");
+  CapeUdc h;
+
+  cape_udc_add_n (sub, "a", 1);
+
+  // the existing child is kept as it is
+  h = cape_udc_add_node (node, "sub");
+
+  if (h != sub || cape_udc_size (node) != 1 || cape_udc_get_n (h, "a", 0) != 1)
+  {
+    printf ("wrong duplicate node\n");
+    res = 1;
+  }
+
+  // the type of the new item doesn't matter
+  h = cape_udc_add_n (node, "sub", 42);
+
+  if (h != sub || cape_udc_type (cape_udc_get (node, "sub")) != CAPE_UDC_NODE)
+  {
+    printf ("wrong duplicate value\n");
+    res = 1;
+  }
+
+  // the same for nodes with an index
+  for (i = 0; i < 100; i++)
+  {
+    CapeString key = cape_str_fmt ("key_%li", i);
+
+    cape_udc_add_n (node, key, i);
+
+    if (cape_udc_n (cape_udc_add_n (node, key, -1), -1) != i)
+    {
+      printf ("wrong duplicate in a large node\n");
+      res = 1;
+    }
+
+    cape_str_del (&key);
+  }
+
+  if (cape_udc_size (node) != 101)
+  {
+    res = 1;
+  }
+
+  // lists don't have names
+  {
+    CapeUdc l = cape_udc_add_list (node, "list");
+
+    cape_udc_add_n (l, "same", 1);
+    cape_udc_add_n (l, "same", 2);
+
+    if (cape_udc_size (l) != 2)
+    {
+      printf ("wrong list\n");
+      res = 1;
+    }
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_benchmark (number_t size)
+{
+  int res = 0;
+  number_t i, sum1 = 0, sum2 = 0;
+  double t1;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeString* keys = ut_keys (size);
+  CapeString* lookups = ut_keys (size);
+
+  CapeUdc node = cape_udc_new (CAPE_UDC_NODE, NULL);
+
+  // the former implementation of nodes
+  CapeMap map = cape_map_new (NULL, NULL, NULL);
+
+  for (i = 0; i < size; i++)
+  {
+    cape_udc_add_n (node, keys[i], i);
+    cape_map_insert (map, keys[i], (void*)i);
+  }
+
+  // the keys are not the same pointers
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOKUPS; i++)
+  {
+    sum1 += (number_t)cape_map_node_value (cape_map_find (map, lookups[i % size]));
+  }
+
+  cape_stoptimer_stop (st);
+
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOKUPS; i++)
+  {
+    sum2 += cape_udc_get_n (node, lookups[i % size], 0);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("%4li fields: map %.2f ms, node %.2f ms\n", size, t1, cape_stoptimer_get (st));
+
+  if (sum1 != sum2)
+  {
+    printf ("wrong sum\n");
+    res = 1;
+  }
+
+  cape_map_del (&map);
+  cape_udc_del (&node);
+  cape_stoptimer_del (&st);
+
+  ut_keys_del (keys, size);
+  ut_keys_del (lookups, size);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_correctness ())
+  {
+    res = 1;
+  }
+
+  {
+    CapeUdc n1 = cape_udc_new (CAPE_UDC_NODE, NULL);
+    CapeUdc n2 = cape_udc_new_doc (CAPE_UDC_NODE, NULL);
+
+    if (ut_duplicate (n1) || ut_duplicate (n2))
+    {
+      printf ("duplicate test failed\n");
+      res = 1;
+    }
+
+    cape_udc_del (&n1);
+    cape_udc_del (&n2);
+  }
+
+  if (ut_benchmark (4) || ut_benchmark (64) || ut_benchmark (4096))
+  {
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
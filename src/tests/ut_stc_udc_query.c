@@ -0,0 +1,320 @@
+#include "stc/cape_udc_query.h"
+#include "fmt/cape_json.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOPS   200000
+
+//-----------------------------------------------------------------------------
+
+static const char* ut_message =
+  "{\"header\":{\"id\":\"4711\",\"type\":\"order\",\"version\":3,\"user\":{\"name\":\"admin\",\"roles\":[\"read\",\"write\",\"root\"]}},"
+  "\"body\":{\"items\":[{\"sku\":\"A1\",\"qty\":2,\"price\":9.5},{\"sku\":\"B2\",\"qty\":1,\"price\":20.0},{\"sku\":\"C3\",\"qty\":5,\"price\":1.25}],"
+  "\"total\":45.25,\"currency\":\"EUR\",\"address\":{\"city\":\"Berlin\",\"zip\":\"10115\",\"street\":\"Main\"}},"
+  "\"meta\":{\"trace\":{\"id\":\"t-1\",\"span\":\"s-2\"},\"ts\":1700000000,\"source\":\"web\",\"flags\":[true,false]}}";
+
+static const char* ut_paths[] =
+{
+  "header.id", "header.type", "header.version", "header.user.name", "header.user.roles[0]", "header.user.roles[-1]",
+  "body.items[0].sku", "body.items[0].qty", "body.items[0].price", "body.items[1].sku", "body.items[1].qty", "body.items[2].sku",
+  "body.total", "body.currency", "body.address.city", "body.address.zip",
+  "meta.trace.id", "meta.trace.span", "meta.ts", "meta.source", "meta.flags[1]", NULL
+};
+
+//-----------------------------------------------------------------------------
+
+static int ut_errors (void)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+  CapeUdcQuery query = cape_udc_query_new ();
+
+  const char* wrong[] = {"a..b", ".a", "a.", "a[", "a[x]", "a[1", "a]", "a.[1]", "[]", NULL};
+  const char** p;
+
+  for (p = wrong; *p; p++)
+  {
+    if (cape_udc_query_add (query, *p, err) != CAPE_ERR_PARSER)
+    {
+      printf ("path was accepted: %s\n", *p);
+      res = 1;
+    }
+  }
+
+  // nothing was added
+  if (cape_udc_query_size (query) != 0 || cape_udc_query_add (query, NULL, err) == CAPE_ERR_NONE)
+  {
+    res = 1;
+  }
+
+  cape_udc_query_del (&query);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_results (CapeUdc msg)
+{
+  int res = 0;
+  CapeErr err = cape_err_new ();
+  CapeUdcQuery query = cape_udc_query_new ();
+  CapeUdc results[10];
+
+  const char* paths[] = {"header.user.roles[1]", "body.items[-1].price", "missing.path", "body.items[3]", "body", "", "header.user.roles[1]", "[0]", "meta.ts", NULL};
+  const char** p;
+
+  for (p = paths; *p; p++)
+  {
+    if (cape_udc_query_add (query, *p, err))
+    {
+      printf ("can't add path: %s\n", cape_err_text (err));
+      res = 1;
+    }
+  }
+
+  if (cape_udc_query_size (query) != 9 || cape_udc_query_run (query, msg, results) != 7)
+  {
+    printf ("wrong number of results\n");
+    res = 1;
+  }
+
+  if (strcmp (cape_udc_s (results[0], ""), "write") || cape_udc_f (results[1], 0) != 1.25 || results[2] || results[3])
+  {
+    printf ("wrong results\n");
+    res = 1;
+  }
+
+  // the empty path is the udc itself, the same path twice gets the same udc
+  if (results[4] != cape_udc_get (msg, "body") || results[5] != msg || results[6] != results[0] || results[7] != cape_udc_get (msg, "body") || cape_udc_n (results[8], 0) != 1700000000)
+  {
+    printf ("wrong results\n");
+    res = 1;
+  }
+
+  if (cape_udc_query_run (query, NULL, results) != 0 || results[0])
+  {
+    res = 1;
+  }
+
+  cape_udc_query_del (&query);
+  cape_err_del (&err);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+// how the values were read before
+static number_t ut_chains (CapeUdc msg)
+{
+  number_t sum = 0;
+
+  CapeUdc header = cape_udc_get_node (msg, "header");
+  CapeUdc user = cape_udc_get_node (header, "user");
+  CapeUdc items = cape_udc_get_list (cape_udc_get_node (msg, "body"), "items");
+
+  sum += strlen (cape_udc_get_s (header, "id", ""));
+  sum += strlen (cape_udc_get_s (header, "type", ""));
+  sum += cape_udc_get_n (header, "version", 0);
+  sum += strlen (cape_udc_get_s (user, "name", ""));
+  sum += strlen (cape_udc_s (cape_udc_get_first (cape_udc_get_list (user, "roles")), ""));
+
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get_list (user, "roles"), CAPE_DIRECTION_PREV);
+
+    if (cape_udc_cursor_prev (cursor))
+    {
+      sum += strlen (cape_udc_s (cursor->item, ""));
+    }
+
+    cape_udc_cursor_del (&cursor);
+  }
+
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (items, CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      switch (cursor->position)
+      {
+        case 0:
+        {
+          sum += strlen (cape_udc_get_s (cursor->item, "sku", ""));
+          sum += cape_udc_get_n (cursor->item, "qty", 0);
+          sum += (number_t)cape_udc_get_f (cursor->item, "price", 0);
+          break;
+        }
+        case 1:
+        {
+          sum += strlen (cape_udc_get_s (cursor->item, "sku", ""));
+          sum += cape_udc_get_n (cursor->item, "qty", 0);
+          break;
+        }
+        case 2:
+        {
+          sum += strlen (cape_udc_get_s (cursor->item, "sku", ""));
+          break;
+        }
+      }
+    }
+
+    cape_udc_cursor_del (&cursor);
+  }
+
+  sum += (number_t)cape_udc_get_f (cape_udc_get_node (msg, "body"), "total", 0);
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (msg, "body"), "currency", ""));
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (cape_udc_get_node (msg, "body"), "address"), "city", ""));
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (cape_udc_get_node (msg, "body"), "address"), "zip", ""));
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (cape_udc_get_node (msg, "meta"), "trace"), "id", ""));
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (cape_udc_get_node (msg, "meta"), "trace"), "span", ""));
+  sum += cape_udc_get_n (cape_udc_get_node (msg, "meta"), "ts", 0);
+  sum += strlen (cape_udc_get_s (cape_udc_get_node (msg, "meta"), "source", ""));
+
+  {
+    CapeUdcCursor* cursor = cape_udc_cursor_new (cape_udc_get_list (cape_udc_get_node (msg, "meta"), "flags"), CAPE_DIRECTION_FORW);
+
+    while (cape_udc_cursor_next (cursor))
+    {
+      if (cursor->position == 1)
+      {
+        sum += cape_udc_b (cursor->item, TRUE) ? 1 : 0;
+      }
+    }
+
+    cape_udc_cursor_del (&cursor);
+  }
+
+  return sum;
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t ut_plan (CapeUdcQuery query, CapeUdc msg)
+{
+  number_t sum = 0;
+  CapeUdc r[32];
+
+  cape_udc_query_run (query, msg, r);
+
+  sum += strlen (cape_udc_s (r[0], ""));
+  sum += strlen (cape_udc_s (r[1], ""));
+  sum += cape_udc_n (r[2], 0);
+  sum += strlen (cape_udc_s (r[3], ""));
+  sum += strlen (cape_udc_s (r[4], ""));
+  sum += strlen (cape_udc_s (r[5], ""));
+  sum += strlen (cape_udc_s (r[6], ""));
+  sum += cape_udc_n (r[7], 0);
+  sum += (number_t)cape_udc_f (r[8], 0);
+  sum += strlen (cape_udc_s (r[9], ""));
+  sum += cape_udc_n (r[10], 0);
+  sum += strlen (cape_udc_s (r[11], ""));
+  sum += (number_t)cape_udc_f (r[12], 0);
+  sum += strlen (cape_udc_s (r[13], ""));
+  sum += strlen (cape_udc_s (r[14], ""));
+  sum += strlen (cape_udc_s (r[15], ""));
+  sum += strlen (cape_udc_s (r[16], ""));
+  sum += strlen (cape_udc_s (r[17], ""));
+  sum += cape_udc_n (r[18], 0);
+  sum += strlen (cape_udc_s (r[19], ""));
+  sum += cape_udc_b (r[20], TRUE) ? 1 : 0;
+
+  return sum;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_benchmark (CapeUdc msg)
+{
+  number_t i, sum1 = 0, sum2 = 0;
+  double t1;
+  const char** p;
+
+  CapeErr err = cape_err_new ();
+  CapeUdcQuery query = cape_udc_query_new ();
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  for (p = ut_paths; *p; p++)
+  {
+    cape_udc_query_add (query, *p, err);
+  }
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum1 += ut_chains (msg);
+  }
+
+  cape_stoptimer_stop (st);
+
+  t1 = cape_stoptimer_get (st);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum2 += ut_plan (query, msg);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("%li paths : get chains %.2f ms, query %.2f ms\n", cape_udc_query_size (query), t1, cape_stoptimer_get (st));
+
+  cape_udc_query_del (&query);
+  cape_err_del (&err);
+  cape_stoptimer_del (&st);
+
+  if (sum1 != sum2)
+  {
+    printf ("wrong sum: %li != %li\n", sum1, sum2);
+    return 1;
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  CapeUdc msg = cape_json_from_s (ut_message);
+
+  if (msg == NULL)
+  {
+    printf ("can't parse the message\n");
+    return 1;
+  }
+
+  if (ut_errors ())
+  {
+    printf ("error test failed\n");
+    res = 1;
+  }
+
+  if (ut_results (msg))
+  {
+    printf ("result test failed\n");
+    res = 1;
+  }
+
+  if (ut_benchmark (msg))
+  {
+    res = 1;
+  }
+
+  cape_udc_del (&msg);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
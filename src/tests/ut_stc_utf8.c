@@ -0,0 +1,495 @@
+#include "stc/cape_utf8.h"
+#include "stc/cape_str.h"
+#include "stc/cape_list.h"
+#include "fmt/cape_tokenizer.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_ROUNDS    20000
+#define UT_LARGE     (4 * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+
+static cape_uint64 g_state = 88172645463325252ULL;
+
+static number_t ut_random (number_t max)
+{
+  // xorshift64
+  g_state ^= g_state << 13;
+  g_state ^= g_state >> 7;
+  g_state ^= g_state << 17;
+
+  return (number_t)(g_state % (cape_uint64)max);
+}
+
+//-----------------------------------------------------------------------------
+
+// writes a random character, returns the length
+static number_t ut_char (char* buf)
+{
+  number_t cp;
+
+  switch (ut_random (6))
+  {
+    case 0: cp = 0x80 + ut_random (0x800 - 0x80); break;
+    case 1: cp = 0x800 + ut_random (0xD800 - 0x800); break;
+    case 2: cp = 0xE000 + ut_random (0x10000 - 0xE000); break;
+    case 3: cp = 0x10000 + ut_random (0x110000 - 0x10000); break;
+    default: cp = 1 + ut_random (0x7F); break;
+  }
+
+  if (cp < 0x80)
+  {
+    buf[0] = (char)cp;
+    return 1;
+  }
+
+  if (cp < 0x800)
+  {
+    buf[0] = (char)(0xC0 | (cp >> 6));
+    buf[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+
+  if (cp < 0x10000)
+  {
+    buf[0] = (char)(0xE0 | (cp >> 12));
+    buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    buf[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+
+  buf[0] = (char)(0xF0 | (cp >> 18));
+  buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  buf[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+//-----------------------------------------------------------------------------
+
+// valid text, mostly ascii as in real data
+static number_t ut_text (char* buf, number_t size, int ascii_only)
+{
+  number_t len = 0;
+
+  while (len + 4 < size)
+  {
+    if (ascii_only || ut_random (4))
+    {
+      buf[len++] = (char)(' ' + ut_random (95));
+    }
+    else
+    {
+      len += ut_char (buf + len);
+    }
+  }
+
+  buf[len] = '\0';
+
+  return len;
+}
+
+//-----------------------------------------------------------------------------
+
+// the character walk of cape_str_len before the kernels
+static number_t ut_len_scalar (const char* s)
+{
+  number_t len = 0;
+
+  while (*s)
+  {
+    len++;
+    s += cape_str_char__len (*s);
+  }
+
+  return len;
+}
+
+//-----------------------------------------------------------------------------
+
+// the character walk of cape_str_find_utf8 before the kernels
+static int ut_find_scalar (const char* haystack, const char* needle, number_t* pos_len, number_t* pos_size)
+{
+  const char* spos = haystack;
+  number_t cpos = 0;
+  number_t len = (number_t)strlen (needle);
+
+  while (*spos)
+  {
+    if (strncmp (spos, needle, len) == 0)
+    {
+      *pos_len = cpos;
+      *pos_size = spos - haystack;
+
+      return TRUE;
+    }
+
+    spos += cape_str_char__len (*spos);
+    cpos++;
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_vectors (void)
+{
+  int kernel;
+
+  const char* valid[8] = {"", "abc", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF"};
+
+  // overlong, surrogate, too large, truncated, lonely continuation, 5 bytes
+  const char* invalid[10] = {"\xC0\x80", "\xC1\xBF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "a\xE2\x82", "\x80", "\xF8\x88\x80\x80\x80"};
+
+  for (kernel = CAPE_UTF8_SCALAR; kernel <= CAPE_UTF8_AVX2; kernel++)
+  {
+    number_t i;
+
+    if (cape_utf8_kernel (kernel) != kernel)
+    {
+      continue;
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+      number_t chars;
+
+      if (!cape_utf8_check (valid[i], strlen (valid[i]), &chars) || chars != (i ? (i == 1 ? 3 : 1) : 0))
+      {
+        printf ("kernel %i: valid vector %li failed\n", kernel, i);
+        return 1;
+      }
+    }
+
+    for (i = 0; i < 10; i++)
+    {
+      char buf[64];
+
+      if (cape_utf8_check (invalid[i], strlen (invalid[i]), NULL))
+      {
+        printf ("kernel %i: invalid vector %li failed\n", kernel, i);
+        return 1;
+      }
+
+      // at the end of a long block
+      memset (buf, 'x', 64);
+      memcpy (buf + 64 - strlen (invalid[i]), invalid[i], strlen (invalid[i]));
+
+      if (cape_utf8_check (buf, 64, NULL))
+      {
+        printf ("kernel %i: invalid vector %li at the end failed\n", kernel, i);
+        return 1;
+      }
+    }
+  }
+
+  cape_utf8_kernel (CAPE_UTF8_AUTO);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// all kernels must return the same as the scalar kernel
+static int ut_fuzz_kernels (void)
+{
+  number_t round;
+  static char buf[20000];
+
+  for (round = 0; round < UT_ROUNDS; round++)
+  {
+    int kernel;
+    number_t len, needle_pos, needle_len, scalar_chars = -1, scalar_count;
+    int scalar_valid;
+    const char* scalar_found;
+
+    // some large texts to overflow the byte counters
+    len = ut_text (buf, round % 100 ? 5 + ut_random (300) : 20000, round % 3 == 0);
+
+    // mutate the text
+    if (round % 2 && len)
+    {
+      buf[ut_random (len)] = (char)(0x80 + ut_random (0x80));
+    }
+
+    needle_pos = len ? ut_random (len) : 0;
+    needle_len = ut_random (len - needle_pos + 1);
+
+    if (needle_len > 40)
+    {
+      needle_len = 1 + ut_random (40);
+    }
+
+    cape_utf8_kernel (CAPE_UTF8_SCALAR);
+
+    scalar_valid = cape_utf8_check (buf, len, &scalar_chars);
+    scalar_count = cape_utf8_count (buf, len);
+    scalar_found = cape_utf8_find (buf, len, buf + needle_pos, needle_len);
+
+    for (kernel = CAPE_UTF8_SSE2; kernel <= CAPE_UTF8_AVX2; kernel++)
+    {
+      number_t chars = -1;
+
+      if (cape_utf8_kernel (kernel) != kernel)
+      {
+        continue;
+      }
+
+      if (cape_utf8_check (buf, len, &chars) != scalar_valid || (scalar_valid && chars != scalar_chars))
+      {
+        printf ("kernel %i: check differs in round %li\n", kernel, round);
+        return 1;
+      }
+
+      if (cape_utf8_count (buf, len) != scalar_count || cape_utf8_find (buf, len, buf + needle_pos, needle_len) != scalar_found)
+      {
+        printf ("kernel %i: count or find differs in round %li\n", kernel, round);
+        return 1;
+      }
+    }
+  }
+
+  cape_utf8_kernel (CAPE_UTF8_AUTO);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// the string functions must return the same as before for valid text
+static int ut_fuzz_str (void)
+{
+  number_t round;
+  char buf[600];
+  char needle[20];
+
+  for (round = 0; round < UT_ROUNDS; round++)
+  {
+    number_t pos_len1 = 0, pos_size1 = 0, pos_len2 = 0, pos_size2 = 0;
+    int found1, found2;
+
+    number_t len = ut_text (buf, 5 + ut_random (500), FALSE);
+
+    // a needle from the text or a random one
+    if (round % 2 && len > 20)
+    {
+      number_t pos = ut_random (len - 10);
+
+      // move to the start of a character
+      while ((buf[pos] & 0xC0) == 0x80)
+      {
+        pos--;
+      }
+
+      memcpy (needle, buf + pos, 10);
+      needle[10] = '\0';
+
+      // cut a broken character at the end
+      while (!cape_utf8_check (needle, strlen (needle), NULL))
+      {
+        needle[strlen (needle) - 1] = '\0';
+      }
+    }
+    else
+    {
+      ut_text (needle, 6 + ut_random (8), FALSE);
+    }
+
+    if (cape_str_len (buf) != ut_len_scalar (buf))
+    {
+      printf ("cape_str_len differs in round %li\n", round);
+      return 1;
+    }
+
+    found1 = cape_str_find_utf8 (buf, needle, &pos_len1, &pos_size1);
+    found2 = ut_find_scalar (buf, needle, &pos_len2, &pos_size2);
+
+    if (found1 != found2 || pos_len1 != pos_len2 || pos_size1 != pos_size2)
+    {
+      printf ("cape_str_find_utf8 differs in round %li\n", round);
+      return 1;
+    }
+
+    // the tokenizer returns the positions without the needles
+    {
+      CapeList list = cape_tokenizer_str_utf8 (buf, needle);
+      CapeListCursor cursor;
+
+      number_t offset = 0, skipped = 0;
+
+      cape_list_cursor_init (list, &cursor, CAPE_DIRECTION_FORW);
+
+      while (cape_list_cursor_next (&cursor))
+      {
+        if (!ut_find_scalar (buf + offset, needle, &pos_len2, &pos_size2) || (number_t)cape_list_node_data (cursor.node) != skipped + pos_len2)
+        {
+          printf ("cape_tokenizer_str_utf8 differs in round %li\n", round);
+          return 1;
+        }
+
+        skipped += pos_len2;
+        offset += pos_size2 + strlen (needle);
+      }
+
+      if (ut_find_scalar (buf + offset, needle, &pos_len2, &pos_size2))
+      {
+        printf ("cape_tokenizer_str_utf8 misses a token in round %li\n", round);
+        return 1;
+      }
+
+      cape_list_del (&list);
+    }
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_trim (void)
+{
+  int res = 0;
+  number_t i;
+
+  const char* tests[6][2] =
+  {
+    {"", ""},
+    {" \t\n ", ""},
+    {"  \xC3\xA4 b \xE2\x82\xAC\r\n", "\xC3\xA4 b \xE2\x82\xAC"},
+    {"\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80"},
+    {"abc   ", "abc"},
+    {"\x01 x", "x"}
+  };
+
+  for (i = 0; i < 6; i++)
+  {
+    CapeString h = cape_str_trim_utf8 (tests[i][0]);
+
+    if (strcmp (h, tests[i][1]))
+    {
+      printf ("wrong trim: '%s'\n", h);
+      res = 1;
+    }
+
+    cape_str_del (&h);
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_benchmark (int ascii_only)
+{
+  int kernel;
+  number_t len, sum = 0;
+  char* buf = CAPE_ALLOC (UT_LARGE + 1);
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  const char* names[3] = {"scalar", "sse2", "avx2"};
+
+  len = ut_text (buf, UT_LARGE, ascii_only);
+
+  printf ("%s text of 4 MB, 10 times\n", ascii_only ? "ascii" : "mixed");
+
+  for (kernel = CAPE_UTF8_SCALAR; kernel <= CAPE_UTF8_AVX2; kernel++)
+  {
+    number_t i;
+
+    if (cape_utf8_kernel (kernel) != kernel)
+    {
+      continue;
+    }
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < 10; i++)
+    {
+      sum += cape_str_len (buf);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("  %-6s: len %.2f ms", names[kernel], cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < 10; i++)
+    {
+      sum += (cape_utf8_find (buf, len, "not in the text", 15) == NULL);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", find %.2f ms\n", cape_stoptimer_get (st));
+  }
+
+  {
+    number_t i;
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < 10; i++)
+    {
+      sum += ut_len_scalar (buf);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("  walk  : len %.2f ms (before the kernels)\n", cape_stoptimer_get (st));
+  }
+
+  cape_utf8_kernel (CAPE_UTF8_AUTO);
+
+  if (sum == 0)
+  {
+    printf ("no result\n");
+  }
+
+  CAPE_FREE (buf);
+  cape_stoptimer_del (&st);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_vectors ())
+  {
+    res = 1;
+  }
+
+  if (ut_fuzz_kernels ())
+  {
+    res = 1;
+  }
+
+  if (ut_fuzz_str ())
+  {
+    res = 1;
+  }
+
+  if (ut_trim ())
+  {
+    res = 1;
+  }
+
+  ut_benchmark (FALSE);
+  ut_benchmark (TRUE);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
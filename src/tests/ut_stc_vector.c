@@ -0,0 +1,353 @@
+#include "stc/cape_vector.h"
+#include "stc/cape_list.h"
+#include "stc/cape_str.h"
+#include "sys/cape_time.h"
+
+// c includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_ITEMS     1000000
+#define UT_RANDOM    100
+
+//-----------------------------------------------------------------------------
+
+static number_t g_destroyed = 0;
+
+static void __STDCALL ut_on_del (void* ptr)
+{
+  CapeString h = ptr;
+
+  cape_str_del (&h);
+
+  g_destroyed++;
+}
+
+//-----------------------------------------------------------------------------
+
+static void* __STDCALL ut_on_clone (void* ptr)
+{
+  return cape_str_cp (ptr);
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_on_compare (void* ptr1, void* ptr2)
+{
+  number_t a = (number_t)ptr1 / 4;
+  number_t b = (number_t)ptr2 / 4;
+
+  return (a > b) - (a < b);
+}
+
+//-----------------------------------------------------------------------------
+
+static number_t ut_random (number_t i)
+{
+  return (i * 2654435761UL) % UT_ITEMS;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_correctness (void)
+{
+  CapeVector v = cape_vector_new (ut_on_del);
+  CapeVectorCursor cursor;
+  number_t i;
+
+  // use both ends, the buffer wraps around
+  for (i = 0; i < 100; i++)
+  {
+    cape_vector_push_back (v, cape_str_fmt ("%li", i + 100));
+    cape_vector_push_front (v, cape_str_fmt ("%li", 99 - i));
+  }
+
+  if (cape_vector_size (v) != 200)
+  {
+    return 1;
+  }
+
+  for (i = 0; i < 200; i++)
+  {
+    if (atoi (cape_vector_at (v, i)) != i)
+    {
+      printf ("wrong element at %li\n", i);
+      return 1;
+    }
+  }
+
+  if (cape_vector_at (v, 200) || cape_vector_at (v, -1))
+  {
+    return 1;
+  }
+
+  // erase all odd elements with a cursor
+  cape_vector_cursor_init (v, &cursor, CAPE_DIRECTION_FORW);
+
+  while (cape_vector_cursor_next (&cursor))
+  {
+    if (atoi (cape_vector_node_data (cursor.node)) % 2)
+    {
+      cape_vector_cursor_erase (v, &cursor);
+    }
+  }
+
+  if (cape_vector_size (v) != 100 || g_destroyed != 100)
+  {
+    return 1;
+  }
+
+  // erase every third element backwards
+  cape_vector_cursor_init (v, &cursor, CAPE_DIRECTION_PREV);
+
+  while (cape_vector_cursor_prev (&cursor))
+  {
+    if (atoi (cape_vector_node_data (cursor.node)) % 3 == 0)
+    {
+      cape_vector_cursor_erase (v, &cursor);
+    }
+  }
+
+  for (i = 0; i < cape_vector_size (v); i++)
+  {
+    number_t n = atoi (cape_vector_at (v, i));
+
+    if (n % 2 || n % 3 == 0 || (i && n <= atoi (cape_vector_at (v, i - 1))))
+    {
+      printf ("wrong element after erase: %li\n", n);
+      return 1;
+    }
+  }
+
+  {
+    CapeVector c = cape_vector_clone (v, ut_on_clone);
+    CapeString h = cape_vector_pop_front (c);
+
+    if (cape_vector_size (c) != cape_vector_size (v) - 1 || strcmp (h, "2") || strcmp (cape_vector_at (c, 0), "4"))
+    {
+      return 1;
+    }
+
+    cape_str_del (&h);
+
+    h = cape_vector_pop_back (c);
+
+    if (strcmp (h, "196"))
+    {
+      return 1;
+    }
+
+    cape_str_del (&h);
+
+    cape_vector_del (&c);
+  }
+
+  g_destroyed = 0;
+
+  cape_vector_del (&v);
+
+  if (g_destroyed != 66)
+  {
+    return 1;
+  }
+
+  // the sort must be stable
+  {
+    CapeVector s = cape_vector_new (NULL);
+
+    for (i = 0; i < 10000; i++)
+    {
+      cape_vector_push_front (s, (void*)ut_random (i));
+    }
+
+    cape_vector_sort (s, ut_on_compare);
+
+    for (i = 1; i < 10000; i++)
+    {
+      number_t a = (number_t)cape_vector_at (s, i - 1);
+      number_t b = (number_t)cape_vector_at (s, i);
+
+      if (a / 4 > b / 4)
+      {
+        printf ("wrong order at %li\n", i);
+        return 1;
+      }
+    }
+
+    cape_vector_del (&s);
+  }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i, sum1 = 0, sum2 = 0;
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  CapeList l = cape_list_new (NULL);
+  CapeVector v = cape_vector_new (NULL);
+
+  if (ut_correctness ())
+  {
+    printf ("correctness test failed\n");
+    res = 1;
+  }
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_ITEMS; i++)
+  {
+    cape_list_push_back (l, (void*)ut_random (i));
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("push  : list   %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_ITEMS; i++)
+  {
+    cape_vector_push_back (v, (void*)ut_random (i));
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", vector %.2f ms\n", cape_stoptimer_get (st));
+
+  // iteration
+  {
+    CapeListCursor cursor1;
+    CapeVectorCursor cursor2;
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_list_cursor_init (l, &cursor1, CAPE_DIRECTION_FORW);
+
+    while (cape_list_cursor_next (&cursor1))
+    {
+      sum1 += (number_t)cape_list_node_data (cursor1.node);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("iterate: list   %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_vector_cursor_init (v, &cursor2, CAPE_DIRECTION_FORW);
+
+    while (cape_vector_cursor_next (&cursor2))
+    {
+      sum2 += (number_t)cape_vector_node_data (cursor2.node);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", vector %.2f ms\n", cape_stoptimer_get (st));
+  }
+
+  // random access
+  {
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_RANDOM; i++)
+    {
+      sum1 += (number_t)cape_list_position (l, ut_random (i));
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("random: list   %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    for (i = 0; i < UT_RANDOM; i++)
+    {
+      sum2 += (number_t)cape_vector_at (v, ut_random (i));
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf (", vector %.2f ms (%i accesses)\n", cape_stoptimer_get (st), UT_RANDOM);
+  }
+
+  // sort
+  {
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_list_sort (l, ut_on_compare);
+
+    cape_stoptimer_stop (st);
+
+    printf ("sort  : list   %.2f ms", cape_stoptimer_get (st));
+
+    cape_stoptimer_set (st, 0);
+    cape_stoptimer_start (st);
+
+    cape_vector_sort (v, ut_on_compare);
+
+    cape_stoptimer_stop (st);
+
+    printf (", vector %.2f ms\n", cape_stoptimer_get (st));
+  }
+
+  // both sorts are stable
+  {
+    CapeListCursor cursor;
+
+    i = 0;
+
+    cape_list_cursor_init (l, &cursor, CAPE_DIRECTION_FORW);
+
+    while (cape_list_cursor_next (&cursor))
+    {
+      if (cape_list_node_data (cursor.node) != cape_vector_at (v, i++))
+      {
+        res = 1;
+        break;
+      }
+    }
+  }
+
+  if (sum1 != sum2 || res)
+  {
+    printf ("list and vector differ\n");
+    res = 1;
+  }
+
+  // pop front until empty
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  while (cape_vector_hasContent (v))
+  {
+    cape_vector_pop_front (v);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("pop   : vector %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_vector_del (&v);
+  cape_list_del (&l);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
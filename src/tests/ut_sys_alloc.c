@@ -0,0 +1,263 @@
+#include "sys/cape_alloc.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_time.h"
+#include "stc/cape_list.h"
+#include "stc/cape_str.h"
+
+// c includes
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_THREADS   4
+#define UT_LOOPS     200000
+#define UT_BATCH     64
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  number_t values[5];
+
+} UtSmall;
+
+typedef struct
+{
+  number_t values[13];
+
+} UtMedium;
+
+//-----------------------------------------------------------------------------
+
+static int ut_is_zero (void* ptr, number_t size)
+{
+  number_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    if (((char*)ptr)[i])
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_worker (void* ptr)
+{
+  int* p_failed = ptr;
+  number_t i, j;
+
+  UtSmall* smalls[UT_BATCH];
+  UtMedium* mediums[UT_BATCH];
+
+  for (i = 0; i < UT_LOOPS / UT_BATCH; i++)
+  {
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      smalls[j] = CAPE_NEW (UtSmall);
+      mediums[j] = CAPE_NEW (UtMedium);
+
+      if (!ut_is_zero (smalls[j], sizeof(UtSmall)) || !ut_is_zero (mediums[j], sizeof(UtMedium)))
+      {
+        *p_failed = TRUE;
+      }
+
+      // dirty the memory, the next allocation must be zeroed again
+      memset (smalls[j], 0xAA, sizeof(UtSmall));
+      memset (mediums[j], 0xBB, sizeof(UtMedium));
+    }
+
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      CAPE_DEL (&(smalls[j]), UtSmall);
+      CAPE_DEL (&(mediums[j]), UtMedium);
+    }
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_bench_system (CapeStopTimer st)
+{
+  number_t i, j;
+
+  UtSmall* smalls[UT_BATCH];
+
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS / UT_BATCH; i++)
+  {
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      // the old way: malloc, memset and memset on release
+      smalls[j] = malloc (sizeof(UtSmall));
+
+      memset (smalls[j], 0, sizeof(UtSmall));
+    }
+
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      memset (smalls[j], 0, sizeof(UtSmall));
+
+      free (smalls[j]);
+    }
+  }
+
+  cape_stoptimer_stop (st);
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_bench_cape (CapeStopTimer st)
+{
+  number_t i, j;
+
+  UtSmall* smalls[UT_BATCH];
+
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS / UT_BATCH; i++)
+  {
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      smalls[j] = CAPE_NEW (UtSmall);
+    }
+
+    for (j = 0; j < UT_BATCH; j++)
+    {
+      CAPE_DEL (&(smalls[j]), UtSmall);
+    }
+  }
+
+  cape_stoptimer_stop (st);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  int failed = FALSE;
+  number_t i;
+
+  CapeAllocStats stats;
+
+  // threads with their own caches
+  {
+    CapeThread threads[UT_THREADS];
+
+    for (i = 0; i < UT_THREADS; i++)
+    {
+      threads[i] = cape_thread_new ();
+
+      cape_thread_start (threads[i], ut_worker, &failed);
+    }
+
+    for (i = 0; i < UT_THREADS; i++)
+    {
+      cape_thread_join (threads[i]);
+      cape_thread_del (&(threads[i]));
+    }
+
+    if (failed)
+    {
+      printf ("memory was not zeroed\n");
+      res = 1;
+    }
+  }
+
+  cape_alloc_stats (&stats);
+
+  printf ("allocs = %li, hits = %li, frees = %li, released = %li, cached = %li, threads = %li\n", stats.allocs, stats.hits, stats.frees, stats.released, stats.cached, stats.threads);
+
+#ifndef CAPE_ALLOC_NOCACHE
+
+  // all terminated threads must have released their caches
+  if (stats.allocs < UT_THREADS * UT_LOOPS * 2 || stats.hits == 0 || stats.cached > 64)
+  {
+    printf ("wrong statistics\n");
+    res = 1;
+  }
+
+#endif
+
+  // blocks from other allocations can be released by CAPE_FREE
+  {
+    char* h1 = strdup ("hello world");
+    CapeString h2 = cape_str_cp ("hello world");
+
+    CAPE_FREE (h1);
+
+    h1 = CAPE_ALLOC (12);
+
+    if (!ut_is_zero (h1, 12))
+    {
+      res = 1;
+    }
+
+    free (h1);
+
+    cape_str_del (&h2);
+  }
+
+  // a list with many nodes
+  {
+    number_t round;
+    CapeStopTimer st = cape_stoptimer_new ();
+
+    cape_stoptimer_start (st);
+
+    for (round = 0; round < 10; round++)
+    {
+      CapeList list = cape_list_new (NULL);
+
+      for (i = 0; i < 100000; i++)
+      {
+        cape_list_push_back (list, (void*)i);
+      }
+
+      cape_list_del (&list);
+    }
+
+    cape_stoptimer_stop (st);
+
+    printf ("list: 10 x 100000 nodes in %.2f ms\n", cape_stoptimer_get (st));
+
+    cape_stoptimer_del (&st);
+  }
+
+  {
+    CapeStopTimer st1 = cape_stoptimer_new ();
+    CapeStopTimer st2 = cape_stoptimer_new ();
+
+    ut_bench_system (st1);
+    ut_bench_cape (st2);
+
+    printf ("system: %i x new/del in %.2f ms\n", UT_LOOPS, cape_stoptimer_get (st1));
+    printf ("cape  : %i x new/del in %.2f ms\n", UT_LOOPS, cape_stoptimer_get (st2));
+
+    cape_stoptimer_del (&st1);
+    cape_stoptimer_del (&st2);
+  }
+
+  cape_alloc_flush ();
+
+  cape_alloc_stats (&stats);
+
+  if (stats.cached != 0)
+  {
+    printf ("cache was not flushed\n");
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,173 @@
+#include "sys/cape_mutex.h"
+#include "sys/cape_log.h"
+#include "sys/cape_thread.h"
+
+//-----------------------------------------------------------------------------
+
+#define UT_THREADS   4
+#define UT_LOOPS     200000
+
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+  CapeMutex mutex;
+
+  CapeRwLock rwlock;
+
+  number_t counter;
+
+  number_t reads;
+
+} UtContext;
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_mutex__worker (void* ptr)
+{
+  UtContext* ctx = ptr;
+  number_t i;
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_mutex_lock (ctx->mutex);
+
+    ctx->counter++;
+
+    cape_mutex_unlock (ctx->mutex);
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_rwlock__worker (void* ptr)
+{
+  UtContext* ctx = ptr;
+  number_t i;
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    if (i % 16 == 0)
+    {
+      cape_rwlock_lock_w (ctx->rwlock);
+
+      ctx->counter++;
+
+      cape_rwlock_unlock_w (ctx->rwlock);
+    }
+    else
+    {
+      cape_rwlock_lock_r (ctx->rwlock);
+
+      if (ctx->counter >= 0)
+      {
+        cape_mutex_lock (ctx->mutex);
+
+        ctx->reads++;
+
+        cape_mutex_unlock (ctx->mutex);
+      }
+
+      cape_rwlock_unlock_r (ctx->rwlock);
+    }
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_run (UtContext* ctx, cape_thread_worker_fct fct)
+{
+  CapeThread threads[UT_THREADS];
+  int i;
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    threads[i] = cape_thread_new ();
+
+    cape_thread_start (threads[i], fct, ctx);
+  }
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    cape_thread_join (threads[i]);
+
+    cape_thread_del (&(threads[i]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+// c includes
+#include <stdio.h>
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  UtContext ctx;
+
+  // adaptive mutex with statistics
+  {
+    CapeMutexStats stats;
+
+    ctx.mutex = cape_mutex_new_ex (CAPE_MUTEX_STATS);
+    ctx.counter = 0;
+
+    ut_run (&ctx, ut_mutex__worker);
+
+    cape_mutex_stats (ctx.mutex, &stats);
+
+    printf ("mutex: counter = %li, acquired = %li, contended = %li, parked = %li\n", ctx.counter, stats.acquired, stats.contended, stats.parked);
+
+    if (ctx.counter != UT_THREADS * UT_LOOPS || stats.acquired != UT_THREADS * UT_LOOPS)
+    {
+      res = 1;
+    }
+
+    cape_mutex_del (&(ctx.mutex));
+  }
+
+  // embedded mutex
+  {
+    CapeMutexInline m;
+
+    cape_mutex_init (&m, 0);
+
+    if (cape_mutex_trylock (&m) == FALSE)
+    {
+      res = 1;
+    }
+
+    cape_mutex_unlock (&m);
+
+    cape_mutex_done (&m);
+  }
+
+  // reader / writer lock
+  {
+    ctx.mutex = cape_mutex_new ();
+    ctx.rwlock = cape_rwlock_new ();
+    ctx.counter = 0;
+    ctx.reads = 0;
+
+    ut_run (&ctx, ut_rwlock__worker);
+
+    printf ("rwlock: writes = %li, reads = %li\n", ctx.counter, ctx.reads);
+
+    if (ctx.counter + ctx.reads != UT_THREADS * UT_LOOPS)
+    {
+      res = 1;
+    }
+
+    cape_rwlock_del (&(ctx.rwlock));
+    cape_mutex_del (&(ctx.mutex));
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
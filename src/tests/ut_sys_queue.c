@@ -1,6 +1,7 @@
 #include "sys/cape_queue.h"
 #include "sys/cape_log.h"
 #include "sys/cape_thread.h"
+#include "sys/cape_time.h"
 
 //-----------------------------------------------------------------------------
 
@@ -15,9 +16,159 @@ static void __STDCALL cape_queue01_callback (void* ptr, number_t pos)
 
 //-----------------------------------------------------------------------------
 
+static void __STDCALL cape_queue02_callback (void* ptr, number_t pos)
+{
+  number_t* counter = ptr;
+  
+  __sync_fetch_and_add (counter, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+static void* __STDCALL cape_queue03_callback (void* ptr, number_t pos, CapeErr err)
+{
+  if (pos % 10 == 9)
+  {
+    cape_err_set (err, CAPE_ERR_WRONG_VALUE, "failed on purpose");
+    
+    return NULL;
+  }
+  
+  {
+    number_t* res = CAPE_NEW (number_t);
+    
+    *res = pos * pos;
+    
+    return res;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 // c includes
 #include <stdio.h>
 
+//-----------------------------------------------------------------------------
+
+// more tasks than a semaphore can count (SEMVMX)
+#define UT_BATCH_SIZE 40000
+
+static int ut_queue_batch (CapeErr err)
+{
+  int res = 0;
+  
+  CapeQueue queue = cape_queue_new ();
+  
+  CapeQueueTask* tasks = CAPE_ALLOC (sizeof(CapeQueueTask) * UT_BATCH_SIZE);
+  
+  number_t counter = 0;
+  
+  cape_queue_start (queue, 4, err);
+  
+  // single adds
+  {
+    CapeSync sync = cape_sync_new ();
+    number_t i;
+    CapeStopTimer st = cape_stoptimer_new ();
+    
+    cape_stoptimer_start (st);
+    
+    for (i = 0; i < UT_BATCH_SIZE; i++)
+    {
+      cape_queue_add (queue, sync, cape_queue02_callback, NULL, &counter, i);
+    }
+    
+    cape_sync_del (&sync);
+    
+    cape_stoptimer_stop (st);
+    
+    printf ("queue add:   %i tasks in %.2f ms\n", UT_BATCH_SIZE, cape_stoptimer_get (st));
+    
+    cape_stoptimer_del (&st);
+  }
+  
+  // batch add
+  {
+    CapeSync sync = cape_sync_new ();
+    number_t i;
+    CapeStopTimer st = cape_stoptimer_new ();
+    
+    cape_stoptimer_start (st);
+    
+    for (i = 0; i < UT_BATCH_SIZE; i++)
+    {
+      tasks[i].on_event = cape_queue02_callback;
+      tasks[i].on_done = NULL;
+      tasks[i].ptr = &counter;
+      tasks[i].pos = i;
+    }
+    
+    cape_queue_add_batch (queue, sync, tasks, UT_BATCH_SIZE);
+    
+    cape_sync_del (&sync);
+    
+    cape_stoptimer_stop (st);
+    
+    printf ("queue batch: %i tasks in %.2f ms\n", UT_BATCH_SIZE, cape_stoptimer_get (st));
+    
+    cape_stoptimer_del (&st);
+  }
+  
+  if (counter != 2 * UT_BATCH_SIZE)
+  {
+    printf ("counter mismatch: %li\n", counter);
+    res = 1;
+  }
+  
+  // futures
+  {
+    CapeFuture futures[100];
+    number_t i;
+    
+    for (i = 0; i < 100; i++)
+    {
+      futures[i] = cape_queue_add_future (queue, cape_queue03_callback, NULL, i);
+    }
+    
+    for (i = 0; i < 100; i++)
+    {
+      number_t* val = cape_future_get (futures[i], err);
+      
+      if (i % 10 == 9)
+      {
+        if (val || cape_err_code (err) != CAPE_ERR_WRONG_VALUE)
+        {
+          res = 1;
+        }
+        
+        cape_err_clr (err);
+      }
+      else
+      {
+        if (val == NULL || *val != i * i)
+        {
+          res = 1;
+        }
+        
+        if (val)
+        {
+          CAPE_DEL (&val, number_t);
+        }
+      }
+      
+      cape_future_del (&(futures[i]));
+    }
+  }
+  
+  cape_queue_del (&queue);
+  
+  CAPE_FREE (tasks);
+  
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
 int main (int argc, char *argv[])
 {
   CapeErr err = cape_err_new ();
@@ -45,6 +196,13 @@ int main (int argc, char *argv[])
   // this shall stop all threads
   cape_queue_del (&queue01);
   
+  if (ut_queue_batch (err))
+  {
+    cape_log_msg (CAPE_LL_ERROR, "CAPE", "UT :: queue", "batch or future test failed");
+    
+    return 1;
+  }
+  
   if (cape_err_code(err))
   {
     cape_log_fmt (CAPE_LL_ERROR, "CAPE", "UT :: queue", "error: %s", cape_err_text(err));
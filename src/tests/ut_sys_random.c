@@ -0,0 +1,399 @@
+#include "sys/cape_random.h"
+#include "sys/cape_thread.h"
+#include "sys/cape_time.h"
+#include "stc/cape_str.h"
+
+// c includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOPS     1000000
+#define UT_UNIQUE    100000
+#define UT_THREADS   4
+
+//-----------------------------------------------------------------------------
+
+// the old implementation
+static void ut_uuid_rand (char* buf)
+{
+  sprintf (buf, "%04X%04X-%04X-%04X-%04X-%04X%04X%04X",
+          rand() & 0xffff, rand() & 0xffff,
+          rand() & 0xffff,
+          ((rand() & 0x0fff) | 0x4000),
+          rand() % 0x3fff + 0x8000,
+          rand() & 0xffff, rand() & 0xffff, rand() & 0xffff);
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_uuid_check (const char* uuid, int version)
+{
+  int i;
+
+  if (strlen (uuid) != 36)
+  {
+    return 1;
+  }
+
+  for (i = 0; i < 36; i++)
+  {
+    if (i == 8 || i == 13 || i == 18 || i == 23)
+    {
+      if (uuid[i] != '-')
+      {
+        return 1;
+      }
+    }
+    else if (!((uuid[i] >= '0' && uuid[i] <= '9') || (uuid[i] >= 'A' && uuid[i] <= 'F')))
+    {
+      return 1;
+    }
+  }
+
+  // version and variant
+  return uuid[14] != '0' + version || strchr ("89AB", uuid[19]) == NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_compare (const void* a, const void* b)
+{
+  return strcmp (a, b);
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_uuids (int version)
+{
+  number_t i;
+  char* buf = malloc (UT_UNIQUE * CAPE_STR_UUID_SIZE);
+
+  cape_str_uuid_batch (buf, UT_UNIQUE, version);
+
+  for (i = 0; i < UT_UNIQUE; i++)
+  {
+    const char* h = buf + i * CAPE_STR_UUID_SIZE;
+
+    if (ut_uuid_check (h, version))
+    {
+      printf ("wrong uuid: %s\n", h);
+      return 1;
+    }
+
+    // the time ordered uuids are sorted within one thread
+    if (version == 7 && i && strncmp (h - CAPE_STR_UUID_SIZE, h, 18) > 0)
+    {
+      printf ("wrong order: %s > %s\n", h - CAPE_STR_UUID_SIZE, h);
+      return 1;
+    }
+  }
+
+  qsort (buf, UT_UNIQUE, CAPE_STR_UUID_SIZE, ut_compare);
+
+  for (i = 1; i < UT_UNIQUE; i++)
+  {
+    if (strcmp (buf + (i - 1) * CAPE_STR_UUID_SIZE, buf + i * CAPE_STR_UUID_SIZE) == 0)
+    {
+      printf ("duplicate uuid\n");
+      return 1;
+    }
+  }
+
+  free (buf);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_numbers (void)
+{
+  number_t i, counts[10];
+  CapeString h;
+
+  memset (counts, 0, sizeof(counts));
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    counts[cape_random_n (10)]++;
+  }
+
+  // roughly uniform
+  for (i = 0; i < 10; i++)
+  {
+    if (counts[i] < UT_LOOPS / 10 - UT_LOOPS / 100 || counts[i] > UT_LOOPS / 10 + UT_LOOPS / 100)
+    {
+      printf ("not uniform: %li -> %li\n", i, counts[i]);
+      return 1;
+    }
+  }
+
+  for (i = 0; i < 50; i++)
+  {
+    number_t j;
+
+    h = cape_str_random (i);
+
+    if ((number_t)strlen (h) != i)
+    {
+      return 1;
+    }
+
+    for (j = 0; j < i; j++)
+    {
+      if (h[j] < 'a' || h[j] > 'z')
+      {
+        return 1;
+      }
+    }
+
+    cape_str_del (&h);
+  }
+
+  h = cape_str_uuid ();
+
+  if (ut_uuid_check (h, 4))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  h = cape_str_uuid_v7 ();
+
+  if (ut_uuid_check (h, 7))
+  {
+    return 1;
+  }
+
+  cape_str_del (&h);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// the child must not repeat the numbers of the parent
+static int ut_fork (void)
+{
+  int fds[2];
+  pid_t pid;
+  cape_uint64 a = 0, b;
+
+  cape_random_u64 ();
+
+  if (pipe (fds))
+  {
+    return 1;
+  }
+
+  pid = fork ();
+
+  if (pid == 0)
+  {
+    cape_uint64 h = cape_random_u64 ();
+
+    if (write (fds[1], &h, sizeof(h)) != sizeof(h))
+    {
+      _exit (1);
+    }
+
+    _exit (0);
+  }
+
+  b = cape_random_u64 ();
+
+  if (read (fds[0], &a, sizeof(a)) != sizeof(a))
+  {
+    return 1;
+  }
+
+  waitpid (pid, NULL, 0);
+
+  close (fds[0]);
+  close (fds[1]);
+
+  return a == b;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_thread (void* ptr)
+{
+  number_t i;
+  char buf[CAPE_STR_UUID_SIZE];
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_str_uuid_buf (buf, 4);
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_thread_rand (void* ptr)
+{
+  number_t i;
+  char buf[CAPE_STR_UUID_SIZE + 4];
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    ut_uuid_rand (buf);
+  }
+
+  return FALSE;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_threads (cape_thread_worker_fct fct, CapeStopTimer st)
+{
+  int i;
+  CapeThread threads[UT_THREADS];
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    threads[i] = cape_thread_new ();
+
+    cape_thread_start (threads[i], fct, NULL);
+  }
+
+  for (i = 0; i < UT_THREADS; i++)
+  {
+    cape_thread_join (threads[i]);
+    cape_thread_del (&(threads[i]));
+  }
+
+  cape_stoptimer_stop (st);
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+  number_t i;
+  CapeStopTimer st = cape_stoptimer_new ();
+  char buf[CAPE_STR_UUID_SIZE + 4];
+  char* batch = malloc (1000 * CAPE_STR_UUID_SIZE);
+
+  if (ut_uuids (4) || ut_uuids (7))
+  {
+    printf ("uuid test failed\n");
+    res = 1;
+  }
+
+  if (ut_numbers ())
+  {
+    printf ("number test failed\n");
+    res = 1;
+  }
+
+  if (ut_fork ())
+  {
+    printf ("fork test failed\n");
+    res = 1;
+  }
+
+  // the secure mode
+  cape_random_mode (CAPE_RANDOM_SECURE);
+
+  if (ut_uuids (4) || ut_numbers ())
+  {
+    printf ("secure mode failed\n");
+    res = 1;
+  }
+
+  cape_random_mode (CAPE_RANDOM_FAST);
+
+  // single thread
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    ut_uuid_rand (buf);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("uuid  : rand %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_str_uuid_buf (buf, 4);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", v4 %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_str_uuid_buf (buf, 7);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", v7 %.2f ms", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS / 1000; i++)
+  {
+    cape_str_uuid_batch (batch, 1000, 4);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", batch %.2f ms", cape_stoptimer_get (st));
+
+  cape_random_mode (CAPE_RANDOM_SECURE);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_str_uuid_buf (buf, 4);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf (", secure %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_random_mode (CAPE_RANDOM_FAST);
+
+  // all threads together
+  ut_threads (ut_thread_rand, st);
+
+  printf ("uuid %i threads: rand %.2f ms", UT_THREADS, cape_stoptimer_get (st));
+
+  ut_threads (ut_thread, st);
+
+  printf (", v4 %.2f ms\n", cape_stoptimer_get (st));
+
+  free (batch);
+  cape_stoptimer_del (&st);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
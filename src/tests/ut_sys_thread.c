@@ -0,0 +1,178 @@
+#ifdef __GNUC__
+#define _GNU_SOURCE 1
+#endif
+
+#include "sys/cape_thread.h"
+#include "sys/cape_err.h"
+
+// c includes
+#include <stdio.h>
+
+#if defined __LINUX_OS
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+//-----------------------------------------------------------------------------
+
+static int ut_topology (void)
+{
+  int res = 0;
+  number_t i;
+
+  number_t cpus = cape_thread_topo_cpus ();
+  number_t nodes = cape_thread_topo_nodes ();
+
+  printf ("topology : %li cpus, %li nodes\n", cpus, nodes);
+
+  if (cpus < 1 || nodes < 1 || nodes > cpus)
+  {
+    printf ("wrong topology\n");
+    res = 1;
+  }
+
+  for (i = 0; i < cpus; i++)
+  {
+    number_t node = cape_thread_topo_node (i);
+
+    if (node < 0 || node >= nodes)
+    {
+      printf ("wrong node of cpu %li: %li\n", i, node);
+      res = 1;
+    }
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined __LINUX_OS
+
+// returns the only cpu of the affinity mask, -1 if there are more
+static number_t ut_pinned_cpu (void)
+{
+  cpu_set_t cpus;
+  number_t i;
+
+  if (pthread_getaffinity_np (pthread_self (), sizeof(cpu_set_t), &cpus) || CPU_COUNT (&cpus) != 1)
+  {
+    return -1;
+  }
+
+  for (i = 0; i < CPU_SETSIZE; i++)
+  {
+    if (CPU_ISSET (i, &cpus))
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+static int __STDCALL ut_pin__worker (void* ptr)
+{
+  number_t* p_cpu = ptr;
+
+  *p_cpu = (ut_pinned_cpu () == 0 && sched_getcpu () == 0) ? 0 : -1;
+
+  return FALSE;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static int ut_pin (void)
+{
+  int res = 0;
+
+#if defined __LINUX_OS
+
+  CapeErr err = cape_err_new ();
+
+  // the first online cpu is used for index 0
+  if (cape_thread_pin_self (CAPE_THREAD_PIN_CORES, 0, err))
+  {
+    printf ("can't pin: %s\n", cape_err_text (err));
+    res = 1;
+  }
+  else if (ut_pinned_cpu () != 0 || sched_getcpu () != 0)
+  {
+    printf ("not pinned to cpu 0\n");
+    res = 1;
+  }
+
+  // threads are started on their cpus
+  {
+    number_t cpu = -1;
+    number_t cpus[] = {0};
+
+    CapeThread t1 = cape_thread_new ();
+    CapeThread t2 = cape_thread_new ();
+
+    cape_thread_pin (t1, CAPE_THREAD_PIN_CORES, cape_thread_topo_cpus ());
+    cape_thread_start (t1, ut_pin__worker, &cpu);
+    cape_thread_join (t1);
+
+    if (cpu != 0)
+    {
+      printf ("thread is not on cpu 0\n");
+      res = 1;
+    }
+
+    cpu = -1;
+
+    cape_thread_cpus (t2, cpus, 1);
+    cape_thread_start (t2, ut_pin__worker, &cpu);
+    cape_thread_join (t2);
+
+    if (cpu != 0)
+    {
+      printf ("thread is not on cpu 0\n");
+      res = 1;
+    }
+
+    cape_thread_del (&t1);
+    cape_thread_del (&t2);
+  }
+
+  // a whole node includes cpu 0
+  if (cape_thread_pin_self (CAPE_THREAD_PIN_NODES, cape_thread_topo_node (0), err))
+  {
+    printf ("can't pin to the node: %s\n", cape_err_text (err));
+    res = 1;
+  }
+
+  cape_err_del (&err);
+
+#endif
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  int res = 0;
+
+  if (ut_topology ())
+  {
+    printf ("topology test failed\n");
+    res = 1;
+  }
+
+  if (ut_pin ())
+  {
+    printf ("pin test failed\n");
+    res = 1;
+  }
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
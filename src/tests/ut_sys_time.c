@@ -1,11 +1,255 @@
 #include "sys/cape_time.h"
+#include "stc/cape_stream.h"
 
 // c includes
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+//-----------------------------------------------------------------------------
+
+#define UT_LOOPS     1000000
+
+//-----------------------------------------------------------------------------
+
+static int ut_compare (const char* name, CapeString h, const char* expected)
+{
+  int res = strcmp (h, expected) != 0;
+
+  if (res)
+  {
+    printf ("%s: '%s' != '%s'\n", name, h, expected);
+  }
+
+  cape_str_del (&h);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_numbers (void)
+{
+  number_t values[8] = {0, 1, -1, 9, 10, 99, LONG_MAX, LONG_MIN};
+  number_t i;
+  char buf[30];
+  char expected[30];
+
+  CapeStream s = cape_stream_new ();
+
+  for (i = 0; i < 8 + 100000; i++)
+  {
+    // fixed values first, then numbers of all lengths
+    number_t n = i < 8 ? values[i] : (number_t)((unsigned long)(i * 2654435761UL) << (i % 40)) / (1 + i % 7);
+
+    snprintf (expected, 30, "%li", n);
+
+    if (cape_str_n_buf (buf, n) != (number_t)strlen (expected) || strcmp (buf, expected))
+    {
+      printf ("wrong number: '%s' != '%s'\n", buf, expected);
+      return 1;
+    }
+
+    cape_stream_clr (s);
+    cape_stream_append_n (s, n);
+
+    if (strcmp (cape_stream_get (s), expected))
+    {
+      return 1;
+    }
+  }
+
+  cape_stream_del (&s);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static int ut_formats (void)
+{
+  int res = 0;
+  char buf[CAPE_DATETIME_BUF];
+
+  CapeDatetime dt;
+  CapeStream s = cape_stream_new ();
+
+  memset (&dt, 0, sizeof(CapeDatetime));
+
+  dt.year = 2018;
+  dt.month = 5;
+  dt.day = 13;
+  dt.hour = 7;
+  dt.minute = 5;
+  dt.sec = 40;
+  dt.msec = 9;
+
+  res |= ut_compare ("STD_S", cape_datetime_s__std_s (&dt), "2018-05-13T07:05:40Z");
+  res |= ut_compare ("STD", cape_datetime_s__std (&dt), "2018-05-13T07:05:40.009Z");
+  res |= ut_compare ("STR", cape_datetime_s__str (&dt), "2018-05-13 07:05:40");
+  res |= ut_compare ("LOG", cape_datetime_s__log (&dt), "20180513-07:05:40.009");
+  res |= ut_compare ("GMT", cape_datetime_s__gmt (&dt), "Sun, 13 May 2018 07:05:40 GMT");
+  res |= ut_compare ("PRE", cape_datetime_s__pre (&dt), "2018_05_13__07_05_40__");
+  res |= ut_compare ("ISO8601", cape_datetime_s__ISO8601 (&dt), "20180513T070540Z");
+
+  // the weekday in january and a leap year
+  dt.year = 2000;
+  dt.month = 1;
+  dt.day = 1;
+
+  res |= ut_compare ("GMT", cape_datetime_s__gmt (&dt), "Sat, 01 Jan 2000 07:05:40 GMT");
+
+  dt.month = 2;
+  dt.day = 29;
+
+  res |= ut_compare ("GMT", cape_datetime_s__gmt (&dt), "Tue, 29 Feb 2000 07:05:40 GMT");
+
+  dt.year = 1999;
+  dt.month = 12;
+  dt.day = 31;
+
+  res |= ut_compare ("GMT", cape_datetime_s__gmt (&dt), "Fri, 31 Dec 1999 07:05:40 GMT");
+
+  // small years are padded except in the ISO format
+  dt.year = 7;
+  dt.msec = 999;
+
+  res |= ut_compare ("STD", cape_datetime_s__std (&dt), "0007-12-31T07:05:40.999Z");
+  res |= ut_compare ("STR", cape_datetime_s__str (&dt), "7-12-31 07:05:40");
+
+  // values out of range are written completely as printf does
+  dt.year = 12345;
+  dt.msec = 1234;
+
+  if (cape_datetime_b__std (&dt, buf) != 26 || strcmp (buf, "12345-12-31T07:05:40.1234Z"))
+  {
+    printf ("wrong buffer: '%s'\n", buf);
+    res = 1;
+  }
+
+  cape_stream_append_str (s, "[");
+  cape_stream_append_d (s, &dt);
+  cape_stream_append_str (s, "]");
+
+  if (strcmp (cape_stream_get (s), "[12345-12-31T07:05:40.1234Z]"))
+  {
+    res = 1;
+  }
+
+  cape_stream_del (&s);
+
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+
+static void ut_benchmark (void)
+{
+  number_t i, sum = 0;
+  char buf[CAPE_DATETIME_BUF];
+
+  CapeDatetime dt;
+  CapeStream s = cape_stream_new ();
+  CapeStopTimer st = cape_stoptimer_new ();
+
+  cape_datetime_utc (&dt);
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum += snprintf (buf, 30, "%li", i * 7919);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("number snprintf : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum -= cape_str_n_buf (buf, i * 7919);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("number table    : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum += snprintf (buf, CAPE_DATETIME_BUF, "%04i-%02i-%02iT%02i:%02i:%02i.%03iZ", dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.sec, dt.msec);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("datetime printf : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    sum -= cape_datetime_b__std (&dt, buf);
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("datetime table  : %.2f ms\n", cape_stoptimer_get (st));
+
+  cape_stoptimer_set (st, 0);
+  cape_stoptimer_start (st);
+
+  for (i = 0; i < UT_LOOPS; i++)
+  {
+    cape_stream_append_n (s, i);
+    cape_stream_append_d (s, &dt);
+
+    if (cape_stream_size (s) > 60000)
+    {
+      cape_stream_clr (s);
+    }
+  }
+
+  cape_stoptimer_stop (st);
+
+  printf ("stream n + d    : %.2f ms\n", cape_stoptimer_get (st));
+
+  if (sum)
+  {
+    printf ("wrong length\n");
+  }
+
+  cape_stream_del (&s);
+  cape_stoptimer_del (&st);
+}
+
+//-----------------------------------------------------------------------------
 
 int main (int argc, char *argv[])
 {
+  int res = 0;
+
   CapeDatetime utc_time;
+
+  if (ut_numbers ())
+  {
+    printf ("number test failed\n");
+    res = 1;
+  }
+
+  if (ut_formats ())
+  {
+    printf ("format test failed\n");
+    res = 1;
+  }
+
+  ut_benchmark ();
   
   cape_datetime_utc (&utc_time);
   
@@ -60,5 +304,5 @@ int main (int argc, char *argv[])
    printf ("-> UNIX    : '%lu'\n", unix_timestamp);
  }
  
- return 0;
+ return res;
 }